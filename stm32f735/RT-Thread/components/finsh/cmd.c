@@ -28,6 +28,7 @@
  * 2018-11-22     Jesven       list_thread add smp support
  * 2018-12-27     Jesven       Fix the problem that disable interrupt too long in list_thread
  *                             Provide protection for the "first layer of objects" when list_*
+ * 2026-10-17     stm32f735    list_sem shows the release path counts
  */
 
 #include <rthw.h>
@@ -325,6 +326,16 @@ long list_sem(void)
     }
     while (next != (rt_list_t*)RT_NULL);
 
+#ifdef RT_USING_SEM_HANDOFF
+    {
+        struct rt_sem_stat stat;
+
+        rt_sem_get_stat(&stat);
+        rt_kprintf("release: post %u, handoff %u, schedule %u\n",
+                   stat.post, stat.handoff, stat.schedule);
+    }
+#endif
+
     return 0;
 }
 FINSH_FUNCTION_EXPORT(list_sem, list semaphore in system);
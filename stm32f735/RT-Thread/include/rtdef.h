@@ -28,6 +28,10 @@
  * 2019-03-14     armink       change version number to v3.1.3
  * 2019-06-12     armink       change version number to v3.1.4
  * 2020-05-14     armink       change version number to v3.1.5
+ * 2026-10-17     stm32f735    add single-producer/single-consumer ring buffer
+ * 2026-10-17     stm32f735    add zero-copy buffer queue
+ * 2026-10-17     stm32f735    add semaphore release statistics
+ * 2026-10-17     stm32f735    add priority bucket index for IPC suspend lists
  */
 
 #ifndef __RT_DEF_H__
@@ -428,6 +432,18 @@ struct rt_object_information
 #define RT_TIMER_SKIP_LIST_MASK         0x3
 #endif
 
+/*
+ * hierarchical timing wheel (RT_USING_TIMER_WHEEL): RT_TIMER_WHEEL_LEVELS
+ * levels of 2^RT_TIMER_WHEEL_BITS slots; a timer uses row[0] as its slot node
+ */
+#ifndef RT_TIMER_WHEEL_BITS
+#define RT_TIMER_WHEEL_BITS             6
+#endif
+
+#ifndef RT_TIMER_WHEEL_LEVELS
+#define RT_TIMER_WHEEL_LEVELS           4
+#endif
+
 /**
  * timer structure
  */
@@ -510,6 +526,12 @@ struct rt_thread
 #endif
     rt_uint32_t number_mask;
 
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    /* priority ordered IPC suspend list */
+    rt_list_t   ipc_bucket;                             /**< links the last waiter of each priority, next is RT_NULL otherwise */
+    rt_uint8_t  ipc_priority;                           /**< priority the thread was queued with */
+#endif
+
 #if defined(RT_USING_EVENT)
     /* thread event */
     rt_uint32_t event_set;
@@ -569,6 +591,18 @@ struct rt_semaphore
     rt_uint16_t          reserved;                      /**< reserved field */
 };
 typedef struct rt_semaphore *rt_sem_t;
+
+#ifdef RT_USING_SEM_HANDOFF
+/**
+ * Semaphore release paths (RT_USING_SEM_HANDOFF)
+ */
+struct rt_sem_stat
+{
+    rt_uint32_t          post;                          /**< no waiter, value increased */
+    rt_uint32_t          handoff;                       /**< switched directly to the woken thread */
+    rt_uint32_t          schedule;                      /**< woken thread left to rt_schedule */
+};
+#endif
 #endif
 
 #ifdef RT_USING_MUTEX
@@ -654,6 +688,43 @@ struct rt_messagequeue
 typedef struct rt_messagequeue *rt_mq_t;
 #endif
 
+/**
+ * single-producer/single-consumer byte ring buffer
+ *
+ * head and tail are free-running byte counters, each written by one side
+ * only; size is a power of two.
+ */
+struct rt_ringbuf
+{
+    rt_uint8_t          *buffer;                        /**< storage, size bytes */
+    rt_uint32_t          size;                          /**< size of buffer, power of two */
+
+    volatile rt_uint32_t head;                          /**< bytes written, updated by the producer */
+    volatile rt_uint32_t tail;                          /**< bytes read, updated by the consumer */
+
+#ifdef RT_USING_SEMAPHORE
+    volatile rt_uint32_t wait;                          /**< bytes the blocked consumer waits for, 0 if none */
+    struct rt_semaphore  sem;                           /**< wakes the consumer */
+#endif
+};
+typedef struct rt_ringbuf *rt_ringbuf_t;
+
+#if defined(RT_USING_MAILBOX) && defined(RT_USING_MEMPOOL)
+/**
+ * zero-copy buffer queue
+ *
+ * Queues pointers to blocks of a memory pool instead of copying payloads;
+ * several queues may share one pool so a block can pass through a chain
+ * of stages without being copied.
+ */
+struct rt_bufq
+{
+    struct rt_mailbox    mb;                            /**< queued block pointers */
+    struct rt_mempool   *mp;                            /**< pool owning the blocks */
+};
+typedef struct rt_bufq *rt_bufq_t;
+#endif
+
 /**@}*/
 
 /**
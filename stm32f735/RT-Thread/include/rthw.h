@@ -10,6 +10,7 @@
  * 2006-09-24     Bernard      add rt_hw_context_switch_to declaration
  * 2012-12-29     Bernard      add rt_hw_exception_install declaration
  * 2017-10-17     Hichard      add some micros
+ * 2026-10-17     stm32f735    add memory barriers for lock-free structures
  */
 
 #ifndef __RT_HW_H__
@@ -38,6 +39,34 @@ extern "C" {
 #define RT_CPU_CACHE_LINE_SZ    32
 #endif
 
+/*
+ * Memory barriers for lock-free structures shared between interrupt and
+ * thread context (rt_ringbuf). A port may define its own before this file.
+ *
+ * acquire: after reading the index published by the other side, before
+ *          reading the data it covers
+ * release: after writing data, before publishing the index that covers it
+ * full:    orders an earlier store against a later load
+ */
+#ifndef rt_hw_barrier_acquire
+#if defined(__CC_ARM)
+#define rt_hw_barrier_acquire()     __dmb(0xF)
+#define rt_hw_barrier_release()     __dmb(0xF)
+#define rt_hw_barrier_full()        __dmb(0xF)
+#elif defined(__GNUC__) || defined(__clang__)
+#define rt_hw_barrier_acquire()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define rt_hw_barrier_release()     __atomic_thread_fence(__ATOMIC_RELEASE)
+#define rt_hw_barrier_full()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__ICCARM__)
+#include <intrinsics.h>
+#define rt_hw_barrier_acquire()     __DMB()
+#define rt_hw_barrier_release()     __DMB()
+#define rt_hw_barrier_full()        __DMB()
+#else
+#error "rt_hw_barrier_* not defined for this compiler"
+#endif
+#endif
+
 enum RT_HW_CACHE_OPS
 {
     RT_HW_CACHE_FLUSH      = 0x01,
@@ -13,6 +13,10 @@
  * 2010-04-11     yi.qiu       add module feature
  * 2013-06-24     Bernard      add rt_kprintf re-define when not use RT_USING_CONSOLE.
  * 2016-08-09     ArdaFu       add new thread and interrupt hook.
+ * 2026-10-17     stm32f735    add ring buffer interface
+ * 2026-10-17     stm32f735    add mailbox peek/commit and buffer queue interface
+ * 2026-10-17     stm32f735    add semaphore release handoff interface
+ * 2026-10-17     stm32f735    add rt_ipc_list_remove for priority bucket index
  */
 
 #ifndef __RT_THREAD_H__
@@ -172,6 +176,9 @@ void rt_system_scheduler_start(void);
 void rt_schedule(void);
 void rt_schedule_insert_thread(struct rt_thread *thread);
 void rt_schedule_remove_thread(struct rt_thread *thread);
+#ifdef RT_USING_SEM_HANDOFF
+rt_err_t rt_schedule_handoff(struct rt_thread *thread);
+#endif
 
 void rt_enter_critical(void);
 void rt_exit_critical(void);
@@ -268,6 +275,10 @@ void rt_memheap_free(void *ptr);
 
 /**@{*/
 
+#ifdef RT_USING_IPC_PRIO_BUCKET
+void rt_ipc_list_remove(struct rt_thread *thread);
+#endif
+
 #ifdef RT_USING_SEMAPHORE
 /*
  * semaphore interface
@@ -284,6 +295,9 @@ rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time);
 rt_err_t rt_sem_trytake(rt_sem_t sem);
 rt_err_t rt_sem_release(rt_sem_t sem);
 rt_err_t rt_sem_control(rt_sem_t sem, int cmd, void *arg);
+#ifdef RT_USING_SEM_HANDOFF
+void rt_sem_get_stat(struct rt_sem_stat *stat);
+#endif
 #endif
 
 #ifdef RT_USING_MUTEX
@@ -336,6 +350,8 @@ rt_err_t rt_mb_send_wait(rt_mailbox_t mb,
                          rt_ubase_t  value,
                          rt_int32_t   timeout);
 rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+rt_err_t rt_mb_peek(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+rt_err_t rt_mb_commit(rt_mailbox_t mb);
 rt_err_t rt_mb_control(rt_mailbox_t mb, int cmd, void *arg);
 #endif
 
@@ -369,6 +385,49 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
 rt_err_t rt_mq_control(rt_mq_t mq, int cmd, void *arg);
 #endif
 
+#if defined(RT_USING_MAILBOX) && defined(RT_USING_MEMPOOL)
+/*
+ * buffer queue interface
+ */
+rt_err_t rt_bufq_init(rt_bufq_t   bq,
+                      const char *name,
+                      rt_mp_t     mp,
+                      void       *msgpool,
+                      rt_size_t   size,
+                      rt_uint8_t  flag);
+rt_err_t rt_bufq_detach(rt_bufq_t bq);
+
+void *rt_bufq_alloc(rt_bufq_t bq, rt_int32_t timeout);
+void rt_bufq_free(rt_bufq_t bq, void *buffer);
+
+rt_err_t rt_bufq_send(rt_bufq_t bq, void *buffer);
+rt_err_t rt_bufq_send_wait(rt_bufq_t bq, void *buffer, rt_int32_t timeout);
+rt_err_t rt_bufq_recv(rt_bufq_t bq, void **buffer, rt_int32_t timeout);
+rt_err_t rt_bufq_peek(rt_bufq_t bq, void **buffer, rt_int32_t timeout);
+rt_err_t rt_bufq_commit(rt_bufq_t bq);
+#endif
+
+/*
+ * ring buffer interface
+ */
+rt_err_t rt_ringbuf_init(rt_ringbuf_t rb, const char *name, void *pool, rt_uint32_t size);
+rt_err_t rt_ringbuf_detach(rt_ringbuf_t rb);
+void rt_ringbuf_reset(rt_ringbuf_t rb);
+
+rt_size_t rt_ringbuf_data_len(rt_ringbuf_t rb);
+rt_size_t rt_ringbuf_space_len(rt_ringbuf_t rb);
+
+rt_size_t rt_ringbuf_put(rt_ringbuf_t rb, const void *data, rt_size_t length);
+rt_size_t rt_ringbuf_reserve(rt_ringbuf_t rb, void **ptr);
+void rt_ringbuf_commit(rt_ringbuf_t rb, rt_size_t length);
+
+rt_size_t rt_ringbuf_get(rt_ringbuf_t rb, void *data, rt_size_t length);
+rt_size_t rt_ringbuf_peek(rt_ringbuf_t rb, void **ptr);
+void rt_ringbuf_consume(rt_ringbuf_t rb, rt_size_t length);
+#ifdef RT_USING_SEMAPHORE
+rt_err_t rt_ringbuf_wait(rt_ringbuf_t rb, rt_size_t length, rt_int32_t timeout);
+#endif
+
 /**@}*/
 
 #ifdef RT_USING_DEVICE
@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     stm32f735    first version
+ * 2026-10-17     stm32f735    add simulated core clock
+ * 2026-10-17     stm32f735    add tickless idle
+ * 2026-10-17     stm32f735    add WFI, fault signals and short busy delays
+ * 2026-10-17     stm32f735    remove tickless idle, the simulator runs tickless.c
+ */
+
+/*
+ * POSIX host port.
+ *
+ * All RT-Thread threads run on one host thread (the "CPU"), each on its own
+ * ucontext. Interrupts are simulated with signals: SIGALRM is the SysTick,
+ * SIGUSR1 delivers interrupts raised by rt_hw_posix_irq_trigger(). Disabling
+ * interrupts only sets a flag; a signal that arrives while the flag is set
+ * leaves its vector pending and is dispatched by rt_hw_interrupt_enable().
+ *
+ * A context switch requested from an interrupt is deferred until the last
+ * handler has returned, like PendSV on Cortex-M.
+ *
+ * Host threads that simulate peripherals must block SIGALRM and SIGUSR1 so
+ * that both signals are always delivered to the CPU thread.
+ *
+ * SIGSEGV, SIGBUS, SIGILL and SIGFPE are the fault exceptions: the hook set
+ * by rt_hw_exception_install() runs first, then the default action ends the
+ * process.
+ */
+
+#define _GNU_SOURCE
+#include <rthw.h>
+#include <rtthread.h>
+#include "cpuport.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+#define POSIX_IRQ_SIGNAL    SIGUSR1
+
+struct posix_context
+{
+    ucontext_t  uc;
+
+    void      (*entry)(void *parameter);
+    void       *parameter;
+    void      (*exit)(void);
+};
+
+static volatile sig_atomic_t irq_disabled = 1;
+static volatile unsigned long irq_pending;
+static struct rt_irq_desc irq_desc[POSIX_IRQ_MAX];
+
+/* switch requested from interrupt context, performed on interrupt exit */
+static rt_ubase_t switch_from;
+static rt_ubase_t switch_to;
+static volatile sig_atomic_t switch_pending;
+
+/*
+ * simulated core clock, cycles = cycle_base + (now - cycle_ns) * hz / 1e9;
+ * written on the CPU thread with interrupts disabled, read anywhere under
+ * the sequence counter
+ */
+static volatile rt_uint32_t core_clock = POSIX_CORE_CLOCK_DEFAULT;
+static rt_uint64_t cycle_base;
+static rt_uint64_t cycle_ns;
+static volatile unsigned int cycle_seq;
+
+static rt_err_t (*exception_hook)(void *context);
+
+static pthread_t cpu_thread;
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+
+static struct posix_context *posix_context_of(rt_ubase_t sp)
+{
+    return *(struct posix_context **)(*(rt_uint8_t **)sp);
+}
+
+static void posix_irq_dispatch(void)
+{
+    unsigned long pending;
+    int vector;
+
+    while ((pending = __atomic_exchange_n(&irq_pending, 0, __ATOMIC_SEQ_CST)) != 0)
+    {
+        rt_interrupt_enter();
+        for (vector = 0; vector < POSIX_IRQ_MAX; vector++)
+        {
+            if ((pending & (1UL << vector)) && irq_desc[vector].handler != RT_NULL)
+                irq_desc[vector].handler(vector, irq_desc[vector].param);
+        }
+        rt_interrupt_leave();
+    }
+
+    if (switch_pending)
+    {
+        switch_pending = 0;
+        swapcontext(&posix_context_of(switch_from)->uc, &posix_context_of(switch_to)->uc);
+
+        /* resumed: the interrupted code had interrupts enabled */
+        irq_disabled = 0;
+    }
+}
+
+static void posix_signal_handler(int sig)
+{
+    if (sig == SIGALRM)
+        __atomic_fetch_or(&irq_pending, 1UL << POSIX_IRQ_SYSTICK, __ATOMIC_SEQ_CST);
+
+    if (!irq_disabled)
+        posix_irq_dispatch();
+}
+
+static void posix_fault_handler(int sig, siginfo_t *info, void *context)
+{
+    /* no more simulated interrupts, the hook may print through polled output */
+    irq_disabled = 1;
+
+    if (exception_hook == RT_NULL || exception_hook(context) != RT_EOK)
+    {
+        rt_kprintf("\nfault: %s at %p, thread %.*s\n", strsignal(sig), info->si_addr,
+                   RT_NAME_MAX, rt_thread_self() != RT_NULL ? rt_thread_self()->name : "-");
+    }
+
+    /* SA_RESETHAND: the faulting instruction runs again with the default action */
+}
+
+static void posix_cpu_init(void)
+{
+    static const int fault_signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE };
+    struct sigaction sa;
+    unsigned int i;
+
+    cpu_thread = pthread_self();
+
+    sa.sa_sigaction = posix_fault_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGALRM);
+    sigaddset(&sa.sa_mask, POSIX_IRQ_SIGNAL);
+    for (i = 0; i < sizeof(fault_signals) / sizeof(fault_signals[0]); i++)
+        sigaction(fault_signals[i], &sa, RT_NULL);
+
+    sa.sa_handler = posix_signal_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGALRM);
+    sigaddset(&sa.sa_mask, POSIX_IRQ_SIGNAL);
+    sigaction(SIGALRM, &sa, RT_NULL);
+    sigaction(POSIX_IRQ_SIGNAL, &sa, RT_NULL);
+}
+
+static void posix_thread_start(void)
+{
+    struct posix_context *ctx = posix_context_of((rt_ubase_t)&rt_thread_self()->sp);
+
+    /* a new thread always starts with interrupts enabled */
+    rt_hw_interrupt_enable(0);
+
+    ctx->entry(ctx->parameter);
+    ctx->exit();
+}
+
+/**
+ * This function will initialize thread stack
+ *
+ * The thread runs on a host stack allocated here; the RT-Thread stack only
+ * keeps a pointer to the context at its top, so that the stack checks of
+ * the kernel still see a sane sp. Host stacks are not reclaimed when the
+ * thread is deleted.
+ *
+ * @param tentry the entry of thread
+ * @param parameter the parameter of entry
+ * @param stack_addr the beginning stack address
+ * @param texit the function will be called when thread exit
+ *
+ * @return stack address
+ */
+rt_uint8_t *rt_hw_stack_init(void       *tentry,
+                             void       *parameter,
+                             rt_uint8_t *stack_addr,
+                             void       *texit)
+{
+    struct posix_context *ctx;
+    rt_uint8_t *sp;
+
+    pthread_once(&cpu_once, posix_cpu_init);
+
+    ctx = malloc(sizeof(struct posix_context));
+    RT_ASSERT(ctx != RT_NULL);
+
+    getcontext(&ctx->uc);
+    ctx->uc.uc_stack.ss_sp = malloc(POSIX_THREAD_STACK_SIZE);
+    ctx->uc.uc_stack.ss_size = POSIX_THREAD_STACK_SIZE;
+    ctx->uc.uc_link = RT_NULL;
+    RT_ASSERT(ctx->uc.uc_stack.ss_sp != RT_NULL);
+    sigdelset(&ctx->uc.uc_sigmask, SIGALRM);
+    sigdelset(&ctx->uc.uc_sigmask, POSIX_IRQ_SIGNAL);
+    makecontext(&ctx->uc, posix_thread_start, 0);
+
+    ctx->entry = (void (*)(void *))tentry;
+    ctx->parameter = parameter;
+    ctx->exit = (void (*)(void))texit;
+
+    sp = (rt_uint8_t *)RT_ALIGN_DOWN((rt_ubase_t)stack_addr, sizeof(void *));
+    sp -= sizeof(void *);
+    *(struct posix_context **)sp = ctx;
+
+    return sp;
+}
+
+/*
+ * Interrupt enable/disable
+ */
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    rt_base_t level = irq_disabled;
+
+    irq_disabled = 1;
+    return level;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    irq_disabled = level;
+
+    /* deliver interrupts that arrived while disabled */
+    if (!level && irq_pending != 0)
+        pthread_kill(cpu_thread, POSIX_IRQ_SIGNAL);
+}
+
+/*
+ * Context switch
+ */
+void rt_hw_context_switch_to(rt_ubase_t to)
+{
+    setcontext(&posix_context_of(to)->uc);
+}
+
+void rt_hw_context_switch(rt_ubase_t from, rt_ubase_t to)
+{
+    swapcontext(&posix_context_of(from)->uc, &posix_context_of(to)->uc);
+
+    /* resumed: rt_schedule() called us with interrupts disabled */
+    irq_disabled = 1;
+}
+
+void rt_hw_context_switch_interrupt(rt_ubase_t from, rt_ubase_t to)
+{
+    if (!switch_pending)
+    {
+        switch_from = from;
+        switch_pending = 1;
+    }
+    switch_to = to;
+}
+
+/*
+ * Simulated interrupt controller
+ */
+void rt_hw_interrupt_init(void)
+{
+    pthread_once(&cpu_once, posix_cpu_init);
+}
+
+void rt_hw_interrupt_mask(int vector)
+{
+}
+
+void rt_hw_interrupt_umask(int vector)
+{
+}
+
+rt_isr_handler_t rt_hw_interrupt_install(int vector, rt_isr_handler_t handler,
+                                         void *param, const char *name)
+{
+    rt_isr_handler_t old_handler = RT_NULL;
+
+    if (vector >= 0 && vector < POSIX_IRQ_MAX)
+    {
+        old_handler = irq_desc[vector].handler;
+        irq_desc[vector].handler = handler;
+        irq_desc[vector].param = param;
+    }
+
+    return old_handler;
+}
+
+void rt_hw_posix_irq_trigger(int vector)
+{
+    RT_ASSERT(vector >= 0 && vector < POSIX_IRQ_MAX);
+
+    __atomic_fetch_or(&irq_pending, 1UL << vector, __ATOMIC_SEQ_CST);
+    pthread_kill(cpu_thread, POSIX_IRQ_SIGNAL);
+}
+
+static void posix_systick_isr(int vector, void *param)
+{
+    rt_tick_increase();
+}
+
+/* periodic SysTick, the first one after first_us */
+static void posix_systick_start(long first_us)
+{
+    struct itimerval tv;
+
+    tv.it_interval.tv_sec = 0;
+    tv.it_interval.tv_usec = 1000000 / RT_TICK_PER_SECOND;
+    tv.it_value.tv_sec = first_us / 1000000;
+    tv.it_value.tv_usec = first_us % 1000000;
+    if (first_us <= 0)
+        tv.it_value.tv_usec = 1;
+    setitimer(ITIMER_REAL, &tv, RT_NULL);
+}
+
+void rt_hw_systick_init(void)
+{
+    rt_hw_interrupt_install(POSIX_IRQ_SYSTICK, posix_systick_isr, RT_NULL, "tick");
+
+    posix_systick_start(1000000 / RT_TICK_PER_SECOND);
+}
+
+void rt_hw_posix_idle(void)
+{
+    sigset_t mask;
+
+    /* sleep until the next signal, handled as soon as it arrives */
+    pthread_sigmask(SIG_SETMASK, RT_NULL, &mask);
+    sigdelset(&mask, SIGALRM);
+    sigdelset(&mask, POSIX_IRQ_SIGNAL);
+    sigsuspend(&mask);
+}
+
+void rt_hw_posix_wfi(void)
+{
+    sigset_t block, old, wait;
+
+    /* a signal between the check and sigsuspend() stays queued until then */
+    sigemptyset(&block);
+    sigaddset(&block, SIGALRM);
+    sigaddset(&block, POSIX_IRQ_SIGNAL);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    if (irq_pending == 0)
+    {
+        wait = old;
+        sigdelset(&wait, SIGALRM);
+        sigdelset(&wait, POSIX_IRQ_SIGNAL);
+        sigsuspend(&wait);
+    }
+    pthread_sigmask(SIG_SETMASK, &old, RT_NULL);
+}
+
+static rt_uint64_t posix_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static rt_uint64_t posix_cycles_at(rt_uint64_t now, rt_uint32_t *hz)
+{
+    rt_uint64_t cycles, elapsed;
+    unsigned int seq;
+
+    do
+    {
+        seq = __atomic_load_n(&cycle_seq, __ATOMIC_ACQUIRE);
+        *hz = core_clock;
+        elapsed = now - cycle_ns;
+        cycles = cycle_base + elapsed / 1000000000ULL * *hz + elapsed % 1000000000ULL * *hz / 1000000000ULL;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&cycle_seq, __ATOMIC_RELAXED));
+
+    return cycles;
+}
+
+void rt_hw_posix_core_clock_set(rt_uint32_t hz)
+{
+    rt_uint64_t now, base;
+    rt_uint32_t old;
+    rt_base_t level;
+
+    RT_ASSERT(hz > 0);
+
+    level = rt_hw_interrupt_disable();
+    now = posix_now_ns();
+    base = posix_cycles_at(now, &old);
+
+    __atomic_fetch_add(&cycle_seq, 1, __ATOMIC_RELEASE);
+    cycle_base = base;
+    cycle_ns = now;
+    core_clock = hz;
+    __atomic_fetch_add(&cycle_seq, 1, __ATOMIC_RELEASE);
+    rt_hw_interrupt_enable(level);
+}
+
+rt_uint32_t rt_hw_posix_core_clock_get(void)
+{
+    return core_clock;
+}
+
+rt_uint32_t rt_hw_posix_cycles(void)
+{
+    rt_uint32_t hz;
+
+    return (rt_uint32_t)posix_cycles_at(posix_now_ns(), &hz);
+}
+
+void rt_hw_posix_delay_cycles(rt_uint32_t cycles)
+{
+    rt_uint64_t end = posix_now_ns() + (rt_uint64_t)cycles * 1000000000ULL / core_clock;
+    struct timespec ts;
+
+    /* the host wakes up tens of microseconds late, spin the short ones */
+    if (end - posix_now_ns() > POSIX_DELAY_SPIN_NS)
+    {
+        end -= POSIX_DELAY_SPIN_NS;
+        ts.tv_sec = end / 1000000000ULL;
+        ts.tv_nsec = end % 1000000000ULL;
+
+        /* a signal ends the sleep early, keep sleeping until the deadline */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, RT_NULL) != 0);
+        end += POSIX_DELAY_SPIN_NS;
+    }
+
+    while (posix_now_ns() < end);
+}
+
+void rt_hw_exception_install(rt_err_t (*exception_handle)(void *context))
+{
+    exception_hook = exception_handle;
+}
+
+/*
+ * Cache operations are no-ops on the host
+ */
+void rt_hw_cpu_icache_enable(void)
+{
+}
+
+void rt_hw_cpu_icache_disable(void)
+{
+}
+
+rt_base_t rt_hw_cpu_icache_status(void)
+{
+    return 0;
+}
+
+void rt_hw_cpu_icache_ops(int ops, void *addr, int size)
+{
+}
+
+void rt_hw_cpu_dcache_enable(void)
+{
+}
+
+void rt_hw_cpu_dcache_disable(void)
+{
+}
+
+rt_base_t rt_hw_cpu_dcache_status(void)
+{
+    return 0;
+}
+
+void rt_hw_cpu_dcache_ops(int ops, void *addr, int size)
+{
+}
+
+/**
+ * shutdown CPU
+ */
+void rt_hw_cpu_shutdown(void)
+{
+    rt_kprintf("shutdown...\n");
+    exit(0);
+}
+
+/**
+ * reset CPU
+ */
+void rt_hw_cpu_reset(void)
+{
+    rt_kprintf("reset is not supported on the host, exit\n");
+    exit(0);
+}
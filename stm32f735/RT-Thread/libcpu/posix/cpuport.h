@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     stm32f735    first version
+ * 2026-10-17     stm32f735    add simulated core clock
+ * 2026-10-17     stm32f735    add tickless idle
+ * 2026-10-17     stm32f735    add WFI, fault signals and short busy delays
+ * 2026-10-17     stm32f735    remove tickless idle, the simulator runs tickless.c
+ */
+
+#ifndef __CPUPORT_POSIX_H__
+#define __CPUPORT_POSIX_H__
+
+#include <rtthread.h>
+#include <rthw.h>
+
+/* simulated interrupt vectors, vector 0 is the SysTick */
+#define POSIX_IRQ_SYSTICK       0
+#define POSIX_IRQ_MAX           32
+
+/* host stack for every RT-Thread thread, the RT-Thread stack only keeps a pointer */
+#ifndef POSIX_THREAD_STACK_SIZE
+#define POSIX_THREAD_STACK_SIZE (256 * 1024)
+#endif
+
+/* rt_hw_posix_delay_cycles() spins for the last part of a delay */
+#ifndef POSIX_DELAY_SPIN_NS
+#define POSIX_DELAY_SPIN_NS     50000ULL
+#endif
+
+/* simulated core clock after reset, the target boots on HSI */
+#ifndef POSIX_CORE_CLOCK_DEFAULT
+#define POSIX_CORE_CLOCK_DEFAULT 64000000UL
+#endif
+
+/**
+ * This function starts the simulated SysTick, which calls rt_tick_increase()
+ * RT_TICK_PER_SECOND times per second from interrupt context.
+ */
+void rt_hw_systick_init(void);
+
+/**
+ * This function marks a simulated interrupt as pending. It may be called
+ * from any host thread (e.g. a thread polling a pty for a simulated UART);
+ * the handler installed by rt_hw_interrupt_install() runs on the RT-Thread
+ * CPU thread as soon as interrupts are enabled.
+ */
+void rt_hw_posix_irq_trigger(int vector);
+
+/**
+ * Idle hook: sleep the host until the next simulated interrupt instead of
+ * spinning in the idle thread.
+ */
+void rt_hw_posix_idle(void);
+
+/**
+ * WFI: called with interrupts disabled, sleep the host until a simulated
+ * interrupt becomes pending, without taking it; returns at once if one is
+ * already pending. The interrupt runs when the caller enables interrupts.
+ */
+void rt_hw_posix_wfi(void);
+
+/**
+ * Simulated core clock. The host counterpart of switching a clock profile:
+ * the cycle counter keeps counting from where it was and advances at the
+ * new rate from now on.
+ */
+void rt_hw_posix_core_clock_set(rt_uint32_t hz);
+rt_uint32_t rt_hw_posix_core_clock_get(void);
+
+/**
+ * Free-running core cycle counter, the host equivalent of DWT->CYCCNT,
+ * derived from the host monotonic clock and the simulated core clock.
+ */
+rt_uint32_t rt_hw_posix_cycles(void);
+
+/**
+ * Peripheral models express their timings in core cycles (e.g. a DMA
+ * block, a CRYP job) and call this to spend the matching host time, so a
+ * slower clock profile makes the modelled peripherals slower too. The last
+ * POSIX_DELAY_SPIN_NS of the delay is spent spinning, so short delays keep
+ * their length instead of the host wake-up latency.
+ */
+void rt_hw_posix_delay_cycles(rt_uint32_t cycles);
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     stm32f735    zero-copy buffer queue
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#if defined(RT_USING_MAILBOX) && defined(RT_USING_MEMPOOL)
+
+/**
+ * @addtogroup IPC
+ */
+
+/**@{*/
+
+/*
+ * A buffer queue is a mailbox of block pointers plus the memory pool the
+ * blocks come from. Each block has exactly one owner at a time:
+ *
+ *   rt_bufq_alloc      the caller owns a new block
+ *   rt_bufq_send       ownership passes to the queue; on error the caller
+ *                      still owns the block
+ *   rt_bufq_recv       ownership passes to the receiver, which frees the
+ *                      block or sends it on to another queue of the pool
+ *   rt_bufq_peek       the block stays queued and owned by the queue; the
+ *                      receiver works on it in place
+ *   rt_bufq_commit     the peeked block is dequeued and returned to the pool
+ *
+ * Only a pointer is moved per hop, so the cost is that of rt_mb_send and
+ * rt_mb_recv regardless of the block size.
+ */
+
+/*
+ * An allocated block carries its pool in the header word in front of it
+ * (see rt_mp_alloc); a free block carries the free list link instead.
+ */
+#define BUFQ_BLOCK_OWNER(buffer) \
+    (*(rt_uint8_t **)((rt_uint8_t *)(buffer) - sizeof(rt_uint8_t *)))
+
+/**
+ * This function will initialize a buffer queue.
+ *
+ * @param bq the buffer queue object
+ * @param name the name of buffer queue
+ * @param mp the memory pool providing the blocks
+ * @param msgpool the storage of the queued pointers
+ * @param size the maximum number of queued blocks
+ * @param flag the flag of buffer queue
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_bufq_init(rt_bufq_t   bq,
+                      const char *name,
+                      rt_mp_t     mp,
+                      void       *msgpool,
+                      rt_size_t   size,
+                      rt_uint8_t  flag)
+{
+    RT_ASSERT(bq != RT_NULL);
+    RT_ASSERT(mp != RT_NULL);
+
+    bq->mp = mp;
+
+    return rt_mb_init(&bq->mb, name, msgpool, size, flag);
+}
+
+/**
+ * This function will detach a buffer queue. Blocks still queued are
+ * returned to the memory pool.
+ *
+ * @param bq the buffer queue object
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_bufq_detach(rt_bufq_t bq)
+{
+    rt_ubase_t value;
+
+    RT_ASSERT(bq != RT_NULL);
+
+    while (rt_mb_recv(&bq->mb, &value, RT_WAITING_NO) == RT_EOK)
+        rt_mp_free((void *)value);
+
+    return rt_mb_detach(&bq->mb);
+}
+
+/**
+ * This function will allocate a block from the memory pool of a buffer
+ * queue. The caller owns the block.
+ *
+ * @param bq the buffer queue object
+ * @param timeout the waiting time for a free block
+ *
+ * @return the block, RT_NULL on timeout
+ */
+void *rt_bufq_alloc(rt_bufq_t bq, rt_int32_t timeout)
+{
+    RT_ASSERT(bq != RT_NULL);
+
+    return rt_mp_alloc(bq->mp, timeout);
+}
+
+/**
+ * This function will return a block owned by the caller to the memory pool
+ * of a buffer queue.
+ *
+ * @param bq the buffer queue object
+ * @param buffer the block
+ */
+void rt_bufq_free(rt_bufq_t bq, void *buffer)
+{
+    RT_ASSERT(bq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(BUFQ_BLOCK_OWNER(buffer) == (rt_uint8_t *)bq->mp);
+
+    rt_mp_free(buffer);
+}
+
+/**
+ * This function will queue a block, waiting for a free slot for the
+ * specified time. On success the queue owns the block; on error the caller
+ * still owns it.
+ *
+ * @param bq the buffer queue object
+ * @param buffer the block, allocated from the pool of the queue
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_bufq_send_wait(rt_bufq_t bq, void *buffer, rt_int32_t timeout)
+{
+    RT_ASSERT(bq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    /* a block that was freed or belongs to another pool cannot be sent */
+    RT_ASSERT(BUFQ_BLOCK_OWNER(buffer) == (rt_uint8_t *)bq->mp);
+
+    return rt_mb_send_wait(&bq->mb, (rt_ubase_t)buffer, timeout);
+}
+
+/**
+ * This function will queue a block without waiting.
+ *
+ * @param bq the buffer queue object
+ * @param buffer the block, allocated from the pool of the queue
+ *
+ * @return the error code, -RT_EFULL if the queue is full
+ */
+rt_err_t rt_bufq_send(rt_bufq_t bq, void *buffer)
+{
+    return rt_bufq_send_wait(bq, buffer, 0);
+}
+
+/**
+ * This function will dequeue a block. The receiver owns the block and
+ * shall free it or send it on.
+ *
+ * @param bq the buffer queue object
+ * @param buffer the block will be saved in
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_bufq_recv(rt_bufq_t bq, void **buffer, rt_int32_t timeout)
+{
+    rt_ubase_t value;
+    rt_err_t result;
+
+    RT_ASSERT(bq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+
+    result = rt_mb_recv(&bq->mb, &value, timeout);
+    if (result == RT_EOK)
+        *buffer = (void *)value;
+
+    return result;
+}
+
+/**
+ * This function will return the block at the head of a buffer queue
+ * without dequeuing it. The block stays owned by the queue and keeps its
+ * slot until rt_bufq_commit, so a queue using peek must have only one
+ * receiver.
+ *
+ * @param bq the buffer queue object
+ * @param buffer the block will be saved in
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_bufq_peek(rt_bufq_t bq, void **buffer, rt_int32_t timeout)
+{
+    rt_ubase_t value;
+    rt_err_t result;
+
+    RT_ASSERT(bq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+
+    result = rt_mb_peek(&bq->mb, &value, timeout);
+    if (result == RT_EOK)
+        *buffer = (void *)value;
+
+    return result;
+}
+
+/**
+ * This function will dequeue the block returned by rt_bufq_peek and return
+ * it to the memory pool.
+ *
+ * @param bq the buffer queue object
+ *
+ * @return the error code, -RT_EEMPTY if the queue is empty
+ */
+rt_err_t rt_bufq_commit(rt_bufq_t bq)
+{
+    rt_ubase_t value;
+    rt_err_t result;
+
+    RT_ASSERT(bq != RT_NULL);
+
+    /* the receiver is the only one dequeuing, the head is still the peeked block */
+    value  = bq->mb.msg_pool[bq->mb.out_offset];
+    result = rt_mb_commit(&bq->mb);
+    if (result == RT_EOK)
+        rt_mp_free((void *)value);
+
+    return result;
+}
+
+/**@}*/
+
+#endif /* defined(RT_USING_MAILBOX) && defined(RT_USING_MEMPOOL) */
@@ -37,6 +37,10 @@
  * 2020-07-29     Meco Man     fix thread->event_set/event_info when received an
  *                             event without pending
  * 2020-10-11     Meco Man     add value overflow-check code
+ * 2026-10-17     stm32f735    add mailbox peek/commit for zero-copy buffer queue
+ * 2026-10-17     stm32f735    add direct handoff on semaphore release (RT_USING_SEM_HANDOFF)
+ * 2026-10-17     stm32f735    add priority bucket index for RT_IPC_FLAG_PRIO suspend lists
+ *                             (RT_USING_IPC_PRIO_BUCKET)
  */
 
 #include <rtthread.h>
@@ -69,6 +73,109 @@ rt_inline rt_err_t rt_ipc_object_init(struct rt_ipc_object *ipc)
     return RT_EOK;
 }
 
+#ifdef RT_USING_IPC_PRIO_BUCKET
+/*
+ * A RT_IPC_FLAG_PRIO suspend list stays one list sorted by priority, FIFO
+ * within a priority, so list->next is still the thread to resume. The last
+ * waiter of each priority present on the list is also linked through
+ * ipc_bucket into a circular index ordered by priority, which is entered
+ * from the last thread of the list (the last waiter of the lowest priority).
+ * Finding the insertion point walks the index instead of the list, so it
+ * costs at most one step per priority present, whatever the number of
+ * waiters. Threads that are not the last of their priority, and threads on
+ * FIFO lists, have ipc_bucket.next set to RT_NULL.
+ */
+#define IPC_BUCKET_ENTRY(node)  rt_list_entry(node, struct rt_thread, ipc_bucket)
+
+rt_inline void _ipc_bucket_unlink(struct rt_thread *thread)
+{
+    rt_list_remove(&(thread->ipc_bucket));
+    thread->ipc_bucket.next = RT_NULL;
+}
+
+static void _ipc_bucket_insert(rt_list_t *list, struct rt_thread *thread)
+{
+    struct rt_thread *last, *sthread;
+
+    thread->ipc_priority = thread->current_priority;
+
+    if (rt_list_isempty(list))
+    {
+        rt_list_insert_before(list, &(thread->tlist));
+        rt_list_init(&(thread->ipc_bucket));
+
+        return;
+    }
+
+    /* walk the index from the lowest priority towards the highest */
+    last    = rt_list_entry(list->prev, struct rt_thread, tlist);
+    sthread = last;
+    while (sthread->ipc_priority > thread->ipc_priority)
+    {
+        sthread = IPC_BUCKET_ENTRY(sthread->ipc_bucket.prev);
+        if (sthread == last)
+        {
+            /* higher than every waiter: head of the list, first in the index */
+            rt_list_insert_after(list, &(thread->tlist));
+            rt_list_insert_after(&(last->ipc_bucket), &(thread->ipc_bucket));
+
+            return;
+        }
+    }
+
+    /* behind the last waiter of the same or the next higher priority */
+    rt_list_insert_after(&(sthread->tlist), &(thread->tlist));
+    rt_list_insert_after(&(sthread->ipc_bucket), &(thread->ipc_bucket));
+    if (sthread->ipc_priority == thread->ipc_priority)
+        _ipc_bucket_unlink(sthread);
+}
+
+/**
+ * This function will remove a thread from the suspend list it is on and
+ * keep the priority index of the list. It shall be called with interrupt
+ * disabled instead of removing thread->tlist of a suspended thread directly.
+ *
+ * @param thread the thread to be removed
+ */
+void rt_ipc_list_remove(struct rt_thread *thread)
+{
+    struct rt_thread *sthread;
+    rt_list_t *node;
+    rt_bool_t alone;
+
+    if (thread->ipc_bucket.next != RT_NULL)
+    {
+        /* thread is the last of its priority, node is the thread before it */
+        node = thread->tlist.prev;
+        if (thread->ipc_bucket.next == &(thread->ipc_bucket))
+        {
+            /* only one priority on the list */
+            alone = (node == thread->tlist.next);
+        }
+        else
+        {
+            /* the last waiter of the next higher priority, or of the lowest
+             * priority (the list tail) if thread has the highest one */
+            sthread = IPC_BUCKET_ENTRY(thread->ipc_bucket.prev);
+            if (sthread->ipc_priority > thread->ipc_priority)
+                alone = (node == sthread->tlist.next);
+            else
+                alone = (node == &(sthread->tlist));
+        }
+
+        /* the thread before it takes over as the last of the priority */
+        if (alone == RT_FALSE)
+        {
+            sthread = rt_list_entry(node, struct rt_thread, tlist);
+            rt_list_insert_after(&(thread->ipc_bucket), &(sthread->ipc_bucket));
+        }
+        _ipc_bucket_unlink(thread);
+    }
+
+    rt_list_remove(&(thread->tlist));
+}
+#endif
+
 /**
  * This function will suspend a thread to a specified list. IPC object or some
  * double-queue object (mailbox etc.) contains this kind of list.
@@ -94,6 +201,9 @@ rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
         break;
 
     case RT_IPC_FLAG_PRIO:
+#ifdef RT_USING_IPC_PRIO_BUCKET
+        _ipc_bucket_insert(list, thread);
+#else
         {
             struct rt_list_node *n;
             struct rt_thread *sthread;
@@ -119,6 +229,7 @@ rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
             if (n == list)
                 rt_list_insert_before(list, &(thread->tlist));
         }
+#endif
         break;
 
     default:
@@ -191,6 +302,10 @@ rt_inline rt_err_t rt_ipc_list_resume_all(rt_list_t *list)
 }
 
 #ifdef RT_USING_SEMAPHORE
+#ifdef RT_USING_SEM_HANDOFF
+static struct rt_sem_stat _sem_stat;
+#endif
+
 /**
  * This function will initialize a semaphore and put it under control of
  * resource management.
@@ -434,6 +549,9 @@ rt_err_t rt_sem_release(rt_sem_t sem)
 {
     register rt_base_t temp;
     register rt_bool_t need_schedule;
+#ifdef RT_USING_SEM_HANDOFF
+    struct rt_thread *thread;
+#endif
 
     /* parameter check */
     RT_ASSERT(sem != RT_NULL);
@@ -453,15 +571,36 @@ rt_err_t rt_sem_release(rt_sem_t sem)
 
     if (!rt_list_isempty(&sem->parent.suspend_thread))
     {
+#ifdef RT_USING_SEM_HANDOFF
+        thread = rt_list_entry(sem->parent.suspend_thread.next, struct rt_thread, tlist);
+
+        /* resume the suspended thread */
+        rt_ipc_list_resume(&(sem->parent.suspend_thread));
+
+        /* switch to it directly if it preempts the current thread */
+        if (rt_schedule_handoff(thread) == RT_EOK)
+        {
+            _sem_stat.handoff ++;
+        }
+        else
+        {
+            _sem_stat.schedule ++;
+            need_schedule = RT_TRUE;
+        }
+#else
         /* resume the suspended thread */
         rt_ipc_list_resume(&(sem->parent.suspend_thread));
         need_schedule = RT_TRUE;
+#endif
     }
     else
     {
         if(sem->value < RT_SEM_VALUE_MAX)
         {
             sem->value ++; /* increase value */
+#ifdef RT_USING_SEM_HANDOFF
+            _sem_stat.post ++;
+#endif
         }
         else
         {
@@ -480,6 +619,25 @@ rt_err_t rt_sem_release(rt_sem_t sem)
     return RT_EOK;
 }
 
+#ifdef RT_USING_SEM_HANDOFF
+/**
+ * This function will get the counts of the semaphore release paths of all
+ * semaphores since startup.
+ *
+ * @param stat the counts will be saved in
+ */
+void rt_sem_get_stat(struct rt_sem_stat *stat)
+{
+    register rt_base_t temp;
+
+    RT_ASSERT(stat != RT_NULL);
+
+    temp = rt_hw_interrupt_disable();
+    *stat = _sem_stat;
+    rt_hw_interrupt_enable(temp);
+}
+#endif
+
 /**
  * This function can get or set some extra attributions of a semaphore object.
  *
@@ -1618,17 +1776,14 @@ rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value)
     return rt_mb_send_wait(mb, value, 0);
 }
 
-/**
- * This function will receive a mail from mailbox object, if there is no mail
- * in mailbox object, the thread shall wait for a specified time.
- *
- * @param mb the mailbox object
- * @param value the received mail will be saved in
- * @param timeout the waiting time
- *
- * @return the error code
+/*
+ * Wait for a mail and read it. When remove is RT_FALSE the mail is left at
+ * the head of the mailbox and its slot stays occupied until rt_mb_commit.
  */
-rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+static rt_err_t _rt_mb_recv(rt_mailbox_t mb,
+                            rt_ubase_t  *value,
+                            rt_int32_t   timeout,
+                            rt_bool_t    remove)
 {
     struct rt_thread *thread;
     register rt_ubase_t temp;
@@ -1724,6 +1879,16 @@ rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
     /* fill ptr */
     *value = mb->msg_pool[mb->out_offset];
 
+    if (!remove)
+    {
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mb->parent.parent)));
+
+        return RT_EOK;
+    }
+
     /* increase output offset */
     ++ mb->out_offset;
     if (mb->out_offset >= mb->size)
@@ -1758,6 +1923,91 @@ rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
     return RT_EOK;
 }
 
+/**
+ * This function will receive a mail from mailbox object, if there is no mail
+ * in mailbox object, the thread shall wait for a specified time.
+ *
+ * @param mb the mailbox object
+ * @param value the received mail will be saved in
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+{
+    return _rt_mb_recv(mb, value, timeout, RT_TRUE);
+}
+
+/**
+ * This function will read the mail at the head of mailbox object without
+ * removing it, if there is no mail in mailbox object, the thread shall wait
+ * for a specified time. The mail keeps its slot until rt_mb_commit is
+ * called, so a mailbox using peek must have only one receiver.
+ *
+ * @param mb the mailbox object
+ * @param value the mail at the head will be saved in
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_mb_peek(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+{
+    return _rt_mb_recv(mb, value, timeout, RT_FALSE);
+}
+
+/**
+ * This function will remove the mail returned by rt_mb_peek from mailbox
+ * object and wake up a sender waiting for the freed slot.
+ *
+ * @param mb the mailbox object
+ *
+ * @return the error code
+ */
+rt_err_t rt_mb_commit(rt_mailbox_t mb)
+{
+    register rt_ubase_t temp;
+
+    /* parameter check */
+    RT_ASSERT(mb != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mb->parent.parent) == RT_Object_Class_MailBox);
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    if (mb->entry == 0)
+    {
+        rt_hw_interrupt_enable(temp);
+
+        return -RT_EEMPTY;
+    }
+
+    /* increase output offset */
+    ++ mb->out_offset;
+    if (mb->out_offset >= mb->size)
+        mb->out_offset = 0;
+
+    /* decrease message entry */
+    mb->entry --;
+
+    /* resume suspended thread */
+    if (!rt_list_isempty(&(mb->suspend_sender_thread)))
+    {
+        rt_ipc_list_resume(&(mb->suspend_sender_thread));
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        rt_schedule();
+
+        return RT_EOK;
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    return RT_EOK;
+}
+
 /**
  * This function can get or set some extra attributions of a mailbox object.
  *
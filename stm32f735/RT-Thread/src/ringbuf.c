@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     stm32f735    single-producer/single-consumer ring buffer
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+/**
+ * @addtogroup IPC
+ */
+
+/**@{*/
+
+/*
+ * One producer (typically an ISR) and one consumer (a thread) share the
+ * buffer without disabling interrupts. head is only written by the
+ * producer and tail only by the consumer; each side publishes its index
+ * with a release barrier after touching the data and reads the other
+ * side's index with an acquire barrier before touching the data.
+ *
+ * The producer functions (put, reserve, commit) must not be called
+ * concurrently with each other, nor must the consumer functions (get,
+ * peek, consume, wait); one producer and one consumer may run at the same
+ * time in any context.
+ */
+
+#ifdef RT_USING_SEMAPHORE
+static void _rt_ringbuf_notify(rt_ringbuf_t rb, rt_uint32_t head)
+{
+    rt_uint32_t wait;
+
+    /* the new head must be visible before the consumer's flag is read */
+    rt_hw_barrier_full();
+    wait = rb->wait;
+    if (wait != 0 && head - rb->tail >= wait)
+    {
+        rb->wait = 0;
+        rt_sem_release(&rb->sem);
+    }
+}
+#endif
+
+/**
+ * This function will initialize a ring buffer.
+ *
+ * @param rb the ring buffer object
+ * @param name the name of the consumer wake-up semaphore
+ * @param pool the storage of the ring buffer
+ * @param size the size of the storage, must be a power of two
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_ringbuf_init(rt_ringbuf_t rb, const char *name, void *pool, rt_uint32_t size)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(pool != RT_NULL);
+    RT_ASSERT(size != 0 && (size & (size - 1)) == 0);
+
+    rb->buffer = (rt_uint8_t *)pool;
+    rb->size   = size;
+    rb->head   = 0;
+    rb->tail   = 0;
+
+#ifdef RT_USING_SEMAPHORE
+    rb->wait   = 0;
+
+    return rt_sem_init(&rb->sem, name, 0, RT_IPC_FLAG_FIFO);
+#else
+    return RT_EOK;
+#endif
+}
+
+/**
+ * This function will detach a ring buffer. A consumer blocked in
+ * rt_ringbuf_wait will be woken up with -RT_ERROR.
+ *
+ * @param rb the ring buffer object
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_ringbuf_detach(rt_ringbuf_t rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+#ifdef RT_USING_SEMAPHORE
+    return rt_sem_detach(&rb->sem);
+#else
+    return RT_EOK;
+#endif
+}
+
+/**
+ * This function will discard all data in a ring buffer. It must not run
+ * concurrently with the producer or the consumer.
+ *
+ * @param rb the ring buffer object
+ */
+void rt_ringbuf_reset(rt_ringbuf_t rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    rb->tail = rb->head;
+}
+
+/**
+ * This function will return the number of bytes that can be read.
+ *
+ * @param rb the ring buffer object
+ *
+ * @return the data length in bytes
+ */
+rt_size_t rt_ringbuf_data_len(rt_ringbuf_t rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    return rb->head - rb->tail;
+}
+
+/**
+ * This function will return the number of bytes that can be written.
+ *
+ * @param rb the ring buffer object
+ *
+ * @return the free space in bytes
+ */
+rt_size_t rt_ringbuf_space_len(rt_ringbuf_t rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    return rb->size - (rb->head - rb->tail);
+}
+
+/**
+ * This function will copy data into a ring buffer (producer side). If
+ * there is not enough space, only the part that fits is written.
+ *
+ * @param rb the ring buffer object
+ * @param data the data to write
+ * @param length the length of data
+ *
+ * @return the number of bytes written
+ */
+rt_size_t rt_ringbuf_put(rt_ringbuf_t rb, const void *data, rt_size_t length)
+{
+    rt_uint32_t head, tail, offset, first;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(data != RT_NULL || length == 0);
+
+    head = rb->head;
+    tail = rb->tail;
+    /* the consumer has finished reading up to tail */
+    rt_hw_barrier_acquire();
+
+    if (length > rb->size - (head - tail))
+        length = rb->size - (head - tail);
+    if (length == 0)
+        return 0;
+
+    offset = head & (rb->size - 1);
+    first  = rb->size - offset;
+    if (first > length)
+        first = length;
+    rt_memcpy(rb->buffer + offset, data, first);
+    rt_memcpy(rb->buffer, (const rt_uint8_t *)data + first, length - first);
+
+    rt_hw_barrier_release();
+    rb->head = head + length;
+
+#ifdef RT_USING_SEMAPHORE
+    _rt_ringbuf_notify(rb, head + length);
+#endif
+
+    return length;
+}
+
+/**
+ * This function will return the contiguous free space at the write
+ * position (producer side). The caller fills it in place and publishes
+ * the bytes with rt_ringbuf_commit. Less than the total free space is
+ * returned when the free space wraps around the end of the storage.
+ *
+ * @param rb the ring buffer object
+ * @param ptr the write position
+ *
+ * @return the contiguous free space in bytes, 0 if the buffer is full
+ */
+rt_size_t rt_ringbuf_reserve(rt_ringbuf_t rb, void **ptr)
+{
+    rt_uint32_t head, tail, offset, length;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    head = rb->head;
+    tail = rb->tail;
+    rt_hw_barrier_acquire();
+
+    offset = head & (rb->size - 1);
+    length = rb->size - (head - tail);
+    if (length > rb->size - offset)
+        length = rb->size - offset;
+
+    *ptr = rb->buffer + offset;
+
+    return length;
+}
+
+/**
+ * This function will publish bytes written in place after
+ * rt_ringbuf_reserve (producer side).
+ *
+ * @param rb the ring buffer object
+ * @param length the number of bytes written, at most the reserved length
+ */
+void rt_ringbuf_commit(rt_ringbuf_t rb, rt_size_t length)
+{
+    rt_uint32_t head;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(length <= rb->size - (rb->head - rb->tail));
+
+    if (length == 0)
+        return;
+
+    head = rb->head + length;
+    rt_hw_barrier_release();
+    rb->head = head;
+
+#ifdef RT_USING_SEMAPHORE
+    _rt_ringbuf_notify(rb, head);
+#endif
+}
+
+/**
+ * This function will copy data out of a ring buffer (consumer side).
+ *
+ * @param rb the ring buffer object
+ * @param data the buffer to copy into
+ * @param length the size of the buffer
+ *
+ * @return the number of bytes read
+ */
+rt_size_t rt_ringbuf_get(rt_ringbuf_t rb, void *data, rt_size_t length)
+{
+    rt_uint32_t head, tail, offset, first;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(data != RT_NULL || length == 0);
+
+    tail = rb->tail;
+    head = rb->head;
+    /* the producer has finished writing up to head */
+    rt_hw_barrier_acquire();
+
+    if (length > head - tail)
+        length = head - tail;
+    if (length == 0)
+        return 0;
+
+    offset = tail & (rb->size - 1);
+    first  = rb->size - offset;
+    if (first > length)
+        first = length;
+    rt_memcpy(data, rb->buffer + offset, first);
+    rt_memcpy((rt_uint8_t *)data + first, rb->buffer, length - first);
+
+    rt_hw_barrier_release();
+    rb->tail = tail + length;
+
+    return length;
+}
+
+/**
+ * This function will return the contiguous data at the read position
+ * (consumer side) without removing it. The caller releases the bytes
+ * with rt_ringbuf_consume once it no longer needs them.
+ *
+ * @param rb the ring buffer object
+ * @param ptr the read position
+ *
+ * @return the contiguous data length in bytes, 0 if the buffer is empty
+ */
+rt_size_t rt_ringbuf_peek(rt_ringbuf_t rb, void **ptr)
+{
+    rt_uint32_t head, tail, offset, length;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    tail = rb->tail;
+    head = rb->head;
+    rt_hw_barrier_acquire();
+
+    offset = tail & (rb->size - 1);
+    length = head - tail;
+    if (length > rb->size - offset)
+        length = rb->size - offset;
+
+    *ptr = rb->buffer + offset;
+
+    return length;
+}
+
+/**
+ * This function will release bytes returned by rt_ringbuf_peek to the
+ * producer (consumer side).
+ *
+ * @param rb the ring buffer object
+ * @param length the number of bytes to release, at most the data length
+ */
+void rt_ringbuf_consume(rt_ringbuf_t rb, rt_size_t length)
+{
+    rt_uint32_t tail;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(length <= rb->head - rb->tail);
+
+    tail = rb->tail + length;
+    /* reads of the released bytes are complete before the producer reuses them */
+    rt_hw_barrier_release();
+    rb->tail = tail;
+}
+
+#ifdef RT_USING_SEMAPHORE
+/**
+ * This function will block the consumer until at least length bytes can
+ * be read. The producer wakes the consumer only when the threshold is
+ * reached, not on every write. It shall be called in thread context.
+ *
+ * @param rb the ring buffer object
+ * @param length the number of bytes to wait for, 1 to the buffer size
+ * @param timeout the waiting time
+ *
+ * @return RT_EOK when the data is available, -RT_ETIMEOUT on timeout
+ */
+rt_err_t rt_ringbuf_wait(rt_ringbuf_t rb, rt_size_t length, rt_int32_t timeout)
+{
+    rt_tick_t start;
+    rt_int32_t left;
+    rt_err_t result;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(length > 0 && length <= rb->size);
+
+    start = rt_tick_get();
+    while (rb->head - rb->tail < length)
+    {
+        /* publish the threshold, then look again: the producer either sees it or the data is already here */
+        rb->wait = length;
+        rt_hw_barrier_full();
+        if (rb->head - rb->tail >= length)
+        {
+            rb->wait = 0;
+            break;
+        }
+
+        left = timeout;
+        if (timeout > 0)
+        {
+            left = timeout - (rt_int32_t)(rt_tick_get() - start);
+            if (left <= 0)
+                left = RT_WAITING_NO;
+        }
+
+        /* a stale wake-up (threshold met while we were checking) only costs one more loop */
+        result = rt_sem_take(&rb->sem, left);
+        if (result != RT_EOK)
+        {
+            rb->wait = 0;
+            return result;
+        }
+    }
+
+    return RT_EOK;
+}
+#endif
+
+/**@}*/
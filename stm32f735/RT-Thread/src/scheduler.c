@@ -27,6 +27,7 @@
  *                             rt_schedule_insert_thread won't insert current task to ready queue
  *                             in smp version, rt_hw_context_switch_interrupt maybe switch to
  *                               new task directly
+ * 2026-10-17     stm32f735    add rt_schedule_handoff for direct switch on IPC wake-up
  *
  */
 
@@ -176,7 +177,7 @@ void rt_system_scheduler_start(void)
     rt_current_thread = to_thread;
 
     /* switch to new thread */
-    rt_hw_context_switch_to((rt_uint32_t)&to_thread->sp);
+    rt_hw_context_switch_to((rt_ubase_t)&to_thread->sp);
 
     /* never come back */
 }
@@ -187,6 +188,48 @@ void rt_system_scheduler_start(void)
 
 /**@{*/
 
+/*
+ * Make to_thread the current thread and request the context switch.
+ * Must be called with interrupt disabled; in thread context the switch
+ * happens once interrupt is enabled again.
+ */
+static void _rt_scheduler_switch(struct rt_thread *to_thread, rt_uint8_t priority)
+{
+    struct rt_thread *from_thread;
+
+    rt_current_priority = priority;
+    from_thread         = rt_current_thread;
+    rt_current_thread   = to_thread;
+
+    RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (from_thread, to_thread));
+
+    /* switch to new thread */
+    RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
+                 ("[%d]switch to priority#%d "
+                  "thread:%.*s(sp:0x%p), "
+                  "from thread:%.*s(sp: 0x%p)\n",
+                  rt_interrupt_nest, priority,
+                  RT_NAME_MAX, to_thread->name, to_thread->sp,
+                  RT_NAME_MAX, from_thread->name, from_thread->sp));
+
+#ifdef RT_USING_OVERFLOW_CHECK
+    _rt_scheduler_stack_check(to_thread);
+#endif
+
+    if (rt_interrupt_nest == 0)
+    {
+        rt_hw_context_switch((rt_ubase_t)&from_thread->sp,
+                             (rt_ubase_t)&to_thread->sp);
+    }
+    else
+    {
+        RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("switch in interrupt\n"));
+
+        rt_hw_context_switch_interrupt((rt_ubase_t)&from_thread->sp,
+                                       (rt_ubase_t)&to_thread->sp);
+    }
+}
+
 /**
  * This function will perform one schedule. It will select one thread
  * with the highest priority level, then switch to it.
@@ -195,7 +238,6 @@ void rt_schedule(void)
 {
     rt_base_t level;
     struct rt_thread *to_thread;
-    struct rt_thread *from_thread;
 
     /* disable interrupt */
     level = rt_hw_interrupt_disable();
@@ -222,48 +264,55 @@ void rt_schedule(void)
         /* if the destination thread is not the same as current thread */
         if (to_thread != rt_current_thread)
         {
-            rt_current_priority = (rt_uint8_t)highest_ready_priority;
-            from_thread         = rt_current_thread;
-            rt_current_thread   = to_thread;
-
-            RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (from_thread, to_thread));
+            _rt_scheduler_switch(to_thread, (rt_uint8_t)highest_ready_priority);
+        }
+    }
 
-            /* switch to new thread */
-            RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
-                         ("[%d]switch to priority#%d "
-                          "thread:%.*s(sp:0x%p), "
-                          "from thread:%.*s(sp: 0x%p)\n",
-                          rt_interrupt_nest, highest_ready_priority,
-                          RT_NAME_MAX, to_thread->name, to_thread->sp,
-                          RT_NAME_MAX, from_thread->name, from_thread->sp));
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
 
-#ifdef RT_USING_OVERFLOW_CHECK
-            _rt_scheduler_stack_check(to_thread);
-#endif
+#ifdef RT_USING_SEM_HANDOFF
+/**
+ * This function will switch to a thread that an IPC object has just made
+ * ready, without searching the ready table, if that thread is now the
+ * highest priority ready thread and has a higher priority than the current
+ * thread. It shall be called with interrupt disabled, after the thread was
+ * inserted into the ready queue.
+ *
+ * @param thread the thread just made ready
+ *
+ * @return RT_EOK if the switch was requested; -RT_ERROR if the caller
+ *         shall call rt_schedule as usual
+ */
+rt_err_t rt_schedule_handoff(struct rt_thread *thread)
+{
+    RT_ASSERT(thread != RT_NULL);
 
-            if (rt_interrupt_nest == 0)
-            {
-                rt_hw_context_switch((rt_ubase_t)&from_thread->sp,
-                                     (rt_ubase_t)&to_thread->sp);
+    if (rt_scheduler_lock_nest != 0 || rt_current_thread == RT_NULL)
+        return -RT_ERROR;
 
-                /* enable interrupt */
-                rt_hw_interrupt_enable(level);
+    if (thread->current_priority >= rt_current_thread->current_priority)
+        return -RT_ERROR;
 
-                return ;
-            }
-            else
-            {
-                RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("switch in interrupt\n"));
+    /* the same choice rt_schedule would make: no ready thread of a higher
+     * priority, and the first one of its own priority */
+#if RT_THREAD_PRIORITY_MAX > 32
+    if ((rt_thread_ready_priority_group & (thread->number_mask - 1)) != 0 ||
+        (rt_thread_ready_table[thread->number] & (thread->high_mask - 1)) != 0)
+        return -RT_ERROR;
+#else
+    if ((rt_thread_ready_priority_group & (thread->number_mask - 1)) != 0)
+        return -RT_ERROR;
+#endif
+    if (rt_thread_priority_table[thread->current_priority].next != &(thread->tlist))
+        return -RT_ERROR;
 
-                rt_hw_context_switch_interrupt((rt_ubase_t)&from_thread->sp,
-                                               (rt_ubase_t)&to_thread->sp);
-            }
-        }
-    }
+    _rt_scheduler_switch(thread, thread->current_priority);
 
-    /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    return RT_EOK;
 }
+#endif
 
 /*
  * This function will insert a thread to system ready queue. The state of
@@ -26,6 +26,8 @@
                                bug when thread has not startup.
  * 2018-11-22     Jesven       yield is same to rt_schedule
  *                             add support for tasks bound to cpu
+ * 2026-10-17     stm32f735    rt_thread_delay_until advances *tick by inc_tick
+ * 2026-10-17     stm32f735    keep the priority bucket index of IPC suspend lists
  */
 
 #include <rthw.h>
@@ -143,6 +145,9 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
 {
     /* init thread list */
     rt_list_init(&(thread->tlist));
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    thread->ipc_bucket.next = RT_NULL;
+#endif
 
     thread->entry = (void *)entry;
     thread->parameter = parameter;
@@ -319,6 +324,15 @@ rt_err_t rt_thread_detach(rt_thread_t thread)
 
     if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_INIT)
     {
+#ifdef RT_USING_IPC_PRIO_BUCKET
+        if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND)
+        {
+            /* leave the IPC suspend list first, keeping its priority index */
+            lock = rt_hw_interrupt_disable();
+            rt_ipc_list_remove(thread);
+            rt_hw_interrupt_enable(lock);
+        }
+#endif
         /* remove from schedule */
         rt_schedule_remove_thread(thread);
     }
@@ -420,6 +434,15 @@ rt_err_t rt_thread_delete(rt_thread_t thread)
 
     if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_INIT)
     {
+#ifdef RT_USING_IPC_PRIO_BUCKET
+        if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND)
+        {
+            /* leave the IPC suspend list first, keeping its priority index */
+            lock = rt_hw_interrupt_disable();
+            rt_ipc_list_remove(thread);
+            rt_hw_interrupt_enable(lock);
+        }
+#endif
         /* remove from schedule */
         rt_schedule_remove_thread(thread);
     }
@@ -541,6 +564,12 @@ rt_err_t rt_thread_delay(rt_tick_t tick)
 /**
  * This function will let current thread delay until (*tick + inc_tick).
  *
+ * *tick is advanced by inc_tick rather than set to the tick the thread
+ * actually runs at, so a late wakeup (e.g. rt_tick fixed up after tickless
+ * idle, or a higher priority thread running) does not shift the following
+ * periods. When the deadline has already passed, *tick restarts from the
+ * current tick.
+ *
  * @param tick the tick of last wakeup.
  * @param inc_tick the increment tick
  *
@@ -563,13 +592,16 @@ rt_err_t rt_thread_delay_until(rt_tick_t *tick, rt_tick_t inc_tick)
 
     if (rt_tick_get() - *tick < inc_tick)
     {
-        *tick = *tick + inc_tick - rt_tick_get();
+        rt_tick_t left_tick;
+
+        *tick += inc_tick;
+        left_tick = *tick - rt_tick_get();
 
         /* suspend thread */
         rt_thread_suspend(thread);
 
         /* reset the timeout of thread timer and start it */
-        rt_timer_control(&(thread->thread_timer), RT_TIMER_CTRL_SET_TIME, tick);
+        rt_timer_control(&(thread->thread_timer), RT_TIMER_CTRL_SET_TIME, &left_tick);
         rt_timer_start(&(thread->thread_timer));
 
         /* enable interrupt */
@@ -585,12 +617,11 @@ rt_err_t rt_thread_delay_until(rt_tick_t *tick, rt_tick_t inc_tick)
     }
     else
     {
+        /* the deadline has passed, start the next period from now */
+        *tick = rt_tick_get();
         rt_hw_interrupt_enable(level);
     }
 
-    /* get the wakeup tick */
-    *tick = rt_tick_get();
-
     return RT_EOK;
 }
 
@@ -773,7 +804,11 @@ rt_err_t rt_thread_resume(rt_thread_t thread)
     temp = rt_hw_interrupt_disable();
 
     /* remove from suspend list */
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    rt_ipc_list_remove(thread);
+#else
     rt_list_remove(&(thread->tlist));
+#endif
 
     rt_timer_stop(&thread->thread_timer);
 
@@ -808,7 +843,11 @@ void rt_thread_timeout(void *parameter)
     thread->error = -RT_ETIMEOUT;
 
     /* remove from suspend list */
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    rt_ipc_list_remove(thread);
+#else
     rt_list_remove(&(thread->tlist));
+#endif
 
     /* insert to schedule ready list */
     rt_schedule_insert_thread(thread);
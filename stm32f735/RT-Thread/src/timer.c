@@ -16,13 +16,36 @@
  * 2012-12-15     Bernard      fix the next timeout issue in soft timer
  * 2014-07-12     Bernard      does not lock scheduler when invoking soft-timer
  *                             timeout function.
+ * 2026-10-17     stm32f735    add hierarchical timing wheel (RT_USING_TIMER_WHEEL)
  */
 
 #include <rtthread.h>
 #include <rthw.h>
 
+#ifdef RT_USING_TIMER_WHEEL
+#define RT_TIMER_WHEEL_SIZE     (1UL << RT_TIMER_WHEEL_BITS)
+#define RT_TIMER_WHEEL_MASK     (RT_TIMER_WHEEL_SIZE - 1)
+
+/*
+ * Hierarchical timing wheel. Level n holds the timers that expire between
+ * 2^(n*BITS) and 2^((n+1)*BITS) ticks after wheel->tick, in the slot given by
+ * bits [n*BITS, (n+1)*BITS) of the timeout tick. Start and stop are O(1); a
+ * higher level slot is cascaded into the lower levels once per revolution of
+ * the level below, so each timer is moved at most LEVELS - 1 times.
+ */
+struct rt_timer_wheel
+{
+    rt_tick_t tick;                     /**< next tick to be processed */
+    rt_uint32_t count;                  /**< started timers, including those being run by check */
+    rt_list_t slot[RT_TIMER_WHEEL_LEVELS][RT_TIMER_WHEEL_SIZE];
+};
+
+/* hard timer wheel */
+static struct rt_timer_wheel rt_timer_wheel;
+#else
 /* hard timer list */
 static rt_list_t rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif
 
 #ifdef RT_USING_TIMER_SOFT
 
@@ -39,8 +62,13 @@ static rt_list_t rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
 
 /* soft timer status */
 static rt_uint8_t soft_timer_status = RT_SOFT_TIMER_IDLE;
+#ifdef RT_USING_TIMER_WHEEL
+/* soft timer wheel */
+static struct rt_timer_wheel rt_soft_timer_wheel;
+#else
 /* soft timer list */
 static rt_list_t rt_soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif
 static struct rt_thread timer_thread;
 ALIGN(RT_ALIGN_SIZE)
 static rt_uint8_t timer_thread_stack[RT_TIMER_THREAD_STACK_SIZE];
@@ -111,6 +139,7 @@ static void _rt_timer_init(rt_timer_t timer,
 }
 
 /* the fist timer always in the last row */
+#ifndef RT_USING_TIMER_WHEEL
 static rt_tick_t rt_timer_list_next_timeout(rt_list_t timer_list[])
 {
     struct rt_timer *timer;
@@ -132,17 +161,267 @@ static rt_tick_t rt_timer_list_next_timeout(rt_list_t timer_list[])
 
     return timeout_tick;
 }
+#endif
+
+#ifdef RT_USING_TIMER_WHEEL
+rt_inline struct rt_timer_wheel *_rt_timer_wheel_of(rt_timer_t timer)
+{
+#ifdef RT_USING_TIMER_SOFT
+    if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
+        return &rt_soft_timer_wheel;
+#endif
+    return &rt_timer_wheel;
+}
+#endif
 
 rt_inline void _rt_timer_remove(rt_timer_t timer)
 {
     int i;
 
+#ifdef RT_USING_TIMER_WHEEL
+    /* still in a slot, or in the expired/run list of a check */
+    if (!rt_list_isempty(&timer->row[0]))
+        _rt_timer_wheel_of(timer)->count--;
+#endif
+
     for (i = 0; i < RT_TIMER_SKIP_LIST_LEVEL; i++)
     {
         rt_list_remove(&timer->row[i]);
     }
 }
 
+#ifdef RT_USING_TIMER_WHEEL
+static void _rt_timer_wheel_init(struct rt_timer_wheel *wheel)
+{
+    int lvl, i;
+
+    wheel->tick = rt_tick_get();
+    wheel->count = 0;
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVELS; lvl++)
+    {
+        for (i = 0; i < RT_TIMER_WHEEL_SIZE; i++)
+        {
+            rt_list_init(&wheel->slot[lvl][i]);
+        }
+    }
+}
+
+/* put a timer into its slot, interrupt shall be disabled */
+static void _rt_timer_wheel_insert(struct rt_timer_wheel *wheel, rt_timer_t timer)
+{
+    rt_tick_t expires = timer->timeout_tick;
+    rt_tick_t delta = expires - wheel->tick;
+    int lvl;
+
+    /* already due (the wheel has passed its tick), run it on the next tick processed */
+    if (delta >= RT_TICK_MAX / 2)
+    {
+        expires = wheel->tick;
+        delta = 0;
+    }
+
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVELS - 1; lvl++)
+    {
+        if (delta < (1UL << ((lvl + 1) * RT_TIMER_WHEEL_BITS)))
+            break;
+    }
+
+#if RT_TIMER_WHEEL_LEVELS * RT_TIMER_WHEEL_BITS < 32
+    /* beyond the wheel span: park in the last slot of the top level, it is
+     * placed again by its real timeout tick when that slot is cascaded */
+    if (delta >= (1UL << (RT_TIMER_WHEEL_LEVELS * RT_TIMER_WHEEL_BITS)))
+        expires = wheel->tick + (1UL << (RT_TIMER_WHEEL_LEVELS * RT_TIMER_WHEEL_BITS)) - 1;
+#endif
+
+    /* insert at the tail, timers with the same timeout run in start order */
+    rt_list_insert_before(&wheel->slot[lvl][(expires >> (lvl * RT_TIMER_WHEEL_BITS)) & RT_TIMER_WHEEL_MASK],
+                          &timer->row[0]);
+}
+
+/* move all nodes of list to the tail of head */
+rt_inline void _rt_timer_list_splice(rt_list_t *list, rt_list_t *head)
+{
+    if (rt_list_isempty(list))
+        return;
+
+    list->next->prev = head->prev;
+    head->prev->next = list->next;
+    list->prev->next = head;
+    head->prev = list->prev;
+    rt_list_init(list);
+}
+
+/*
+ * process wheel->tick: cascade the higher levels whose lower level wrapped,
+ * move the timers due at this tick to expired and advance the wheel by one
+ * tick; interrupt shall be disabled
+ */
+static void _rt_timer_wheel_advance(struct rt_timer_wheel *wheel, rt_list_t *expired)
+{
+    rt_tick_t tick = wheel->tick;
+    rt_list_t list;
+    int lvl;
+
+    for (lvl = 1; lvl < RT_TIMER_WHEEL_LEVELS; lvl++)
+    {
+        if ((tick >> ((lvl - 1) * RT_TIMER_WHEEL_BITS)) & RT_TIMER_WHEEL_MASK)
+            break;
+
+        rt_list_init(&list);
+        _rt_timer_list_splice(&wheel->slot[lvl][(tick >> (lvl * RT_TIMER_WHEEL_BITS)) & RT_TIMER_WHEEL_MASK],
+                              &list);
+        while (!rt_list_isempty(&list))
+        {
+            struct rt_timer *t = rt_list_entry(list.next, struct rt_timer, row[0]);
+
+            rt_list_remove(&t->row[0]);
+            _rt_timer_wheel_insert(wheel, t);
+        }
+    }
+
+    _rt_timer_list_splice(&wheel->slot[0][tick & RT_TIMER_WHEEL_MASK], expired);
+    wheel->tick = tick + 1;
+}
+
+/*
+ * the earliest timer of each level is in the first non-empty slot after the
+ * current position (the current slot of a higher level has been cascaded,
+ * timers left there are one revolution ahead)
+ */
+static rt_tick_t rt_timer_wheel_next_timeout(struct rt_timer_wheel *wheel)
+{
+    struct rt_timer *timer;
+    register rt_base_t level;
+    rt_tick_t timeout_tick = RT_TICK_MAX, delta, delta_min = RT_TICK_MAX;
+    rt_list_t *slot, *node;
+    int lvl, i, pos;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVELS; lvl++)
+    {
+        pos = (wheel->tick >> (lvl * RT_TIMER_WHEEL_BITS)) & RT_TIMER_WHEEL_MASK;
+        if (lvl > 0)
+            pos++;
+
+        for (i = 0; i < RT_TIMER_WHEEL_SIZE; i++)
+        {
+            slot = &wheel->slot[lvl][(pos + i) & RT_TIMER_WHEEL_MASK];
+            if (rt_list_isempty(slot))
+                continue;
+
+            for (node = slot->next; node != slot; node = node->next)
+            {
+                timer = rt_list_entry(node, struct rt_timer, row[0]);
+                delta = timer->timeout_tick - wheel->tick;
+                if (delta >= RT_TICK_MAX / 2)
+                    delta = 0;
+                if (delta < delta_min)
+                {
+                    delta_min = delta;
+                    timeout_tick = timer->timeout_tick;
+                }
+            }
+            break;
+        }
+    }
+
+    /* no timer in the wheel, catch up with the current tick so that the
+     * next check does not walk through the ticks passed while it was idle */
+    if (timeout_tick == RT_TICK_MAX)
+        wheel->tick = rt_tick_get();
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+
+    return timeout_tick;
+}
+
+/*
+ * run every tick up to the current tick; hard timers are called with
+ * interrupt disabled, soft timers with interrupt enabled
+ */
+static void _rt_timer_wheel_check(struct rt_timer_wheel *wheel, rt_bool_t soft)
+{
+    struct rt_timer *t;
+    register rt_base_t level;
+    rt_list_t expired, list;
+
+    rt_list_init(&expired);
+    rt_list_init(&list);
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    while ((rt_tick_get() - wheel->tick) < RT_TICK_MAX / 2)
+    {
+        _rt_timer_wheel_advance(wheel, &expired);
+
+        while (!rt_list_isempty(&expired))
+        {
+            t = rt_list_entry(expired.next, struct rt_timer, row[0]);
+
+            RT_OBJECT_HOOK_CALL(rt_timer_enter_hook, (t));
+
+            /* remove timer from the expired list firstly */
+            rt_list_remove(&t->row[0]);
+            if (!(t->parent.flag & RT_TIMER_FLAG_PERIODIC))
+            {
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+            }
+            /* add timer to temporary list  */
+            rt_list_insert_after(&list, &(t->row[0]));
+
+#ifdef RT_USING_TIMER_SOFT
+            if (soft)
+            {
+                soft_timer_status = RT_SOFT_TIMER_BUSY;
+                /* enable interrupt */
+                rt_hw_interrupt_enable(level);
+            }
+#endif
+
+            /* call timeout function */
+            t->timeout_func(t->parameter);
+
+            RT_OBJECT_HOOK_CALL(rt_timer_exit_hook, (t));
+
+#ifdef RT_USING_TIMER_SOFT
+            if (soft)
+            {
+                /* disable interrupt */
+                level = rt_hw_interrupt_disable();
+                soft_timer_status = RT_SOFT_TIMER_IDLE;
+            }
+#endif
+
+            /* Check whether the timer object is detached or started again */
+            if (rt_list_isempty(&list))
+            {
+                continue;
+            }
+            rt_list_remove(&(t->row[0]));
+            wheel->count--;
+            if ((t->parent.flag & RT_TIMER_FLAG_PERIODIC) &&
+                (t->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+            {
+                /* start it */
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+                rt_timer_start(t);
+            }
+        }
+
+        /* let pending interrupts in between two ticks */
+        rt_hw_interrupt_enable(level);
+        level = rt_hw_interrupt_disable();
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+#endif /* RT_USING_TIMER_WHEEL */
+
 #if RT_DEBUG_TIMER
 static int rt_timer_count_height(struct rt_timer *timer)
 {
@@ -310,12 +589,16 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
  */
 rt_err_t rt_timer_start(rt_timer_t timer)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    struct rt_timer_wheel *wheel;
+#else
     unsigned int row_lvl;
     rt_list_t *timer_list;
-    register rt_base_t level;
     rt_list_t *row_head[RT_TIMER_SKIP_LIST_LEVEL];
     unsigned int tst_nr;
     static unsigned int random_nr;
+#endif
+    register rt_base_t level;
 
     /* timer check */
     RT_ASSERT(timer != RT_NULL);
@@ -337,6 +620,18 @@ rt_err_t rt_timer_start(rt_timer_t timer)
     RT_ASSERT(timer->init_tick < RT_TICK_MAX / 2);
     timer->timeout_tick = rt_tick_get() + timer->init_tick;
 
+#ifdef RT_USING_TIMER_WHEEL
+    wheel = _rt_timer_wheel_of(timer);
+
+    /* an empty wheel has not been checked since it went idle (tickless
+     * sleep, suspended timer thread): catch up with the current tick, so
+     * the next check does not walk through every tick passed meanwhile */
+    if (wheel->count == 0 && (rt_tick_get() - wheel->tick) < RT_TICK_MAX / 2)
+        wheel->tick = rt_tick_get();
+    wheel->count++;
+
+    _rt_timer_wheel_insert(wheel, timer);
+#else
 #ifdef RT_USING_TIMER_SOFT
     if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
     {
@@ -400,6 +695,7 @@ rt_err_t rt_timer_start(rt_timer_t timer)
          * bits. */
         tst_nr >>= (RT_TIMER_SKIP_LIST_MASK + 1) >> 1;
     }
+#endif /* RT_USING_TIMER_WHEEL */
 
     timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
 
@@ -521,6 +817,13 @@ rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
  */
 void rt_timer_check(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check enter\n"));
+
+    _rt_timer_wheel_check(&rt_timer_wheel, RT_FALSE);
+
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check leave\n"));
+#else
     struct rt_timer *t;
     rt_tick_t current_tick;
     register rt_base_t level;
@@ -586,6 +889,7 @@ void rt_timer_check(void)
     rt_hw_interrupt_enable(level);
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check leave\n"));
+#endif /* RT_USING_TIMER_WHEEL */
 }
 
 /**
@@ -595,7 +899,11 @@ void rt_timer_check(void)
  */
 rt_tick_t rt_timer_next_timeout_tick(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    return rt_timer_wheel_next_timeout(&rt_timer_wheel);
+#else
     return rt_timer_list_next_timeout(rt_timer_list);
+#endif
 }
 
 #ifdef RT_USING_TIMER_SOFT
@@ -605,6 +913,13 @@ rt_tick_t rt_timer_next_timeout_tick(void)
  */
 void rt_soft_timer_check(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check enter\n"));
+
+    _rt_timer_wheel_check(&rt_soft_timer_wheel, RT_TRUE);
+
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check leave\n"));
+#else
     rt_tick_t current_tick;
     struct rt_timer *t;
     register rt_base_t level;
@@ -675,6 +990,7 @@ void rt_soft_timer_check(void)
     rt_hw_interrupt_enable(level);
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check leave\n"));
+#endif /* RT_USING_TIMER_WHEEL */
 }
 
 /* system timer thread entry */
@@ -685,7 +1001,11 @@ static void rt_thread_timer_entry(void *parameter)
     while (1)
     {
         /* get the next timeout tick */
+#ifdef RT_USING_TIMER_WHEEL
+        next_timeout = rt_timer_wheel_next_timeout(&rt_soft_timer_wheel);
+#else
         next_timeout = rt_timer_list_next_timeout(rt_soft_timer_list);
+#endif
         if (next_timeout == RT_TICK_MAX)
         {
             /* no software timer exist, suspend self. */
@@ -720,12 +1040,16 @@ static void rt_thread_timer_entry(void *parameter)
  */
 void rt_system_timer_init(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    _rt_timer_wheel_init(&rt_timer_wheel);
+#else
     int i;
 
     for (i = 0; i < sizeof(rt_timer_list) / sizeof(rt_timer_list[0]); i++)
     {
         rt_list_init(rt_timer_list + i);
     }
+#endif
 }
 
 /**
@@ -736,6 +1060,9 @@ void rt_system_timer_init(void)
 void rt_system_timer_thread_init(void)
 {
 #ifdef RT_USING_TIMER_SOFT
+#ifdef RT_USING_TIMER_WHEEL
+    _rt_timer_wheel_init(&rt_soft_timer_wheel);
+#else
     int i;
 
     for (i = 0;
@@ -744,6 +1071,7 @@ void rt_system_timer_thread_init(void)
     {
         rt_list_init(rt_soft_timer_list + i);
     }
+#endif
 
     /* start software timer thread */
     rt_thread_init(&timer_thread,
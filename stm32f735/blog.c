@@ -0,0 +1,291 @@
+/*
+ * blog.c - 二进制延迟日志
+ *
+ * 写者 (线程或中断) 只在关中断下把 2 + nargs 个字写入记录环, 不做格式化,
+ * 开销与参数个数成正比, 约数十个周期:
+ *
+ *   word0  nargs << 24 | 格式 ID (格式串在 BlogFmt 段内的偏移)
+ *   word1  DWT 周期计数
+ *   word2~ 参数
+ *
+ * 后台线程周期性取出记录:
+ *   text   模式在目标上格式化, 经 rt_kprintf 输出 (交互调试用)
+ *   binary 模式把记录原样打包, 包头带 tick/周期数对照和累计丢弃数,
+ *          COBS 编码后以 0x00 分隔, 经控制台发送. 控制台上的普通文本不含
+ *          0x00, 主机端 tools/blog_decode 按固件映像中的 BlogFmt 段还原文本,
+ *          其余字节原样透传.
+ *
+ *   包 (COBS 编码前, 小端):
+ *   +-----+-----+---------+-------+--------+--------+---------+---------+
+ *   | 'B' | 'L' | version | count | tick32 | cycles | dropped | records |
+ *   +-----+-----+---------+-------+--------+--------+---------+---------+
+ */
+
+#include "blog.h"
+#include "console.h"
+#include "lat_hist.h"
+#include <rthw.h>
+#include <string.h>
+
+#define BLOG_RING_MASK          (BLOG_RING_WORDS - 1)
+#define BLOG_PACKET_VERSION     1
+#define BLOG_PACKET_HDR_SIZE    16
+#define BLOG_COBS_SIZE(n)       ((n) + (n) / 254 + 1)
+
+#if defined(__CC_ARM) || defined(__CLANG_ARM)
+extern const char BlogFmt$$Base;
+#define BLOG_FMT_BASE           (&BlogFmt$$Base)
+#elif defined(__GNUC__)
+/* GNU ld 为名称是合法标识符的段自动生成 __start_<段名> */
+extern const char __start_BlogFmt[];
+#define BLOG_FMT_BASE           (__start_BlogFmt)
+#endif
+
+static struct
+{
+    rt_uint32_t          ring[BLOG_RING_WORDS];
+    volatile rt_uint32_t head;          /* 写者关中断推进 */
+    volatile rt_uint32_t tail;          /* 后台线程推进 */
+    volatile rt_uint8_t  mode;
+    volatile rt_uint8_t  wake;          /* 已请求提前唤醒后台线程 */
+
+    struct rt_semaphore  sem;
+    rt_thread_t          thread;
+
+    /* 统计 */
+    rt_uint32_t          records;
+    rt_uint32_t          dropped;       /* 记录环满丢弃的记录 */
+    rt_uint32_t          max_used;      /* 记录环最高水位 (字) */
+    rt_uint32_t          packets;
+    rt_uint32_t          bytes;
+} blog;
+
+/* 包和编码缓冲区只由后台线程使用 */
+static rt_uint8_t blog_packet[BLOG_PACKET_HDR_SIZE + BLOG_PACKET_SIZE];
+static rt_uint8_t blog_frame[BLOG_COBS_SIZE(sizeof(blog_packet)) + 2];
+
+/* =================================================================================
+ * 1. 写者
+ * ================================================================================= */
+
+void blog_write(const char *fmt, rt_uint32_t nargs, const rt_uint32_t *args)
+{
+    rt_uint32_t stamp = lat_now();
+    rt_uint32_t head, used, i;
+    rt_bool_t wake = RT_FALSE;
+    rt_base_t level;
+
+    if (blog.mode == BLOG_MODE_OFF)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    head = blog.head;
+    used = head - blog.tail + 2 + nargs;
+    if (used > BLOG_RING_WORDS)
+    {
+        blog.dropped++;
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    blog.ring[head & BLOG_RING_MASK]       = (nargs << 24) | (rt_uint32_t)(fmt - BLOG_FMT_BASE);
+    blog.ring[(head + 1) & BLOG_RING_MASK] = stamp;
+    for (i = 0; i < nargs; i++)
+        blog.ring[(head + 2 + i) & BLOG_RING_MASK] = args[i];
+    blog.head = head + 2 + nargs;
+
+    blog.records++;
+    if (used > blog.max_used)
+        blog.max_used = used;
+    if (used >= BLOG_RING_WORDS / 2 && !blog.wake)
+    {
+        blog.wake = 1;
+        wake = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (wake && blog.thread != RT_NULL)
+        rt_sem_release(&blog.sem);
+}
+
+/* =================================================================================
+ * 2. 后台线程
+ * ================================================================================= */
+
+static void blog_drain_text(void)
+{
+    rt_uint32_t tail = blog.tail, head = blog.head;
+    rt_uint32_t hdr, stamp, nargs, i;
+    rt_uint32_t a[BLOG_MAX_ARGS] = {0};
+
+    while (tail != head)
+    {
+        hdr   = blog.ring[tail & BLOG_RING_MASK];
+        stamp = blog.ring[(tail + 1) & BLOG_RING_MASK];
+        nargs = hdr >> 24;
+        for (i = 0; i < nargs; i++)
+            a[i] = blog.ring[(tail + 2 + i) & BLOG_RING_MASK];
+        tail += 2 + nargs;
+
+        /* 先归还空间再输出, 输出可能阻塞 */
+        blog.tail = tail;
+
+        rt_kprintf("[%10u] ", stamp);
+        rt_kprintf(BLOG_FMT_BASE + (hdr & 0xFFFFFF), a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+}
+
+/* COBS 编码: 输出不含 0x00, 返回编码后长度 */
+static rt_size_t blog_cobs(const rt_uint8_t *in, rt_size_t len, rt_uint8_t *out)
+{
+    rt_size_t code_pos = 0, pos = 1, i;
+    rt_uint8_t code = 1;
+
+    for (i = 0; i < len; i++)
+    {
+        if (in[i] != 0)
+        {
+            out[pos++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF)
+        {
+            out[code_pos] = code;
+            code_pos = pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+
+    return pos;
+}
+
+static void blog_put32(rt_uint8_t *p, rt_uint32_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = value >> 24;
+}
+
+static void blog_drain_binary(void)
+{
+    rt_uint32_t tail = blog.tail, head = blog.head;
+    rt_uint32_t nwords, i;
+    rt_size_t len, n;
+    rt_uint8_t count;
+
+    while (tail != head)
+    {
+        /* 只打包完整记录 */
+        len = BLOG_PACKET_HDR_SIZE;
+        count = 0;
+        while (tail != head && count < 0xFF)
+        {
+            nwords = 2 + (blog.ring[tail & BLOG_RING_MASK] >> 24);
+            if (len + nwords * 4 > sizeof(blog_packet))
+                break;
+            for (i = 0; i < nwords; i++)
+                blog_put32(&blog_packet[len + i * 4], blog.ring[(tail + i) & BLOG_RING_MASK]);
+            len += nwords * 4;
+            tail += nwords;
+            count++;
+        }
+        blog.tail = tail;
+
+        blog_packet[0] = 'B';
+        blog_packet[1] = 'L';
+        blog_packet[2] = BLOG_PACKET_VERSION;
+        blog_packet[3] = count;
+        blog_put32(&blog_packet[4], rt_tick_get());
+        blog_put32(&blog_packet[8], lat_now());
+        blog_put32(&blog_packet[12], blog.dropped);
+
+        blog_frame[0] = 0;
+        n = blog_cobs(blog_packet, len, &blog_frame[1]);
+        blog_frame[n + 1] = 0;
+        console_write(blog_frame, n + 2);
+
+        blog.packets++;
+        blog.bytes += n + 2;
+    }
+}
+
+static void blog_entry(void *parameter)
+{
+    while (1)
+    {
+        rt_sem_take(&blog.sem, rt_tick_from_millisecond(BLOG_DRAIN_MS));
+        blog.wake = 0;
+
+        switch (blog.mode)
+        {
+        case BLOG_MODE_TEXT:
+            blog_drain_text();
+            break;
+        case BLOG_MODE_BINARY:
+            blog_drain_binary();
+            break;
+        default:
+            blog.tail = blog.head;
+            break;
+        }
+    }
+}
+
+/* =================================================================================
+ * 3. 初始化
+ * ================================================================================= */
+
+rt_err_t blog_init(void)
+{
+    rt_sem_init(&blog.sem, "blog", 0, RT_IPC_FLAG_FIFO);
+
+    blog.thread = rt_thread_create("blog", blog_entry, RT_NULL, BLOG_THREAD_STACK_SIZE,
+                                   BLOG_THREAD_PRIORITY, 10);
+    if (blog.thread == RT_NULL)
+        return -RT_ENOMEM;
+
+    blog.mode = BLOG_DEFAULT_MODE;
+    rt_thread_startup(blog.thread);
+
+    return RT_EOK;
+}
+
+void blog_set_mode(enum blog_mode mode)
+{
+    blog.mode = mode;
+}
+
+/* =================================================================================
+ * 4. 调试命令
+ * ================================================================================= */
+
+static int blog_stat(int argc, char **argv)
+{
+    static const char *mode_name[] = { "off", "text", "binary" };
+    int i;
+
+    if (argc > 1)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            if (rt_strcmp(argv[1], mode_name[i]) == 0)
+                break;
+        }
+        if (i == 3)
+        {
+            rt_kprintf("usage: blog_stat [off|text|binary]\n");
+            return -1;
+        }
+        blog_set_mode((enum blog_mode)i);
+    }
+
+    rt_kprintf("mode     : %s\n", mode_name[blog.mode]);
+    rt_kprintf("records  : %d, dropped %d\n", blog.records, blog.dropped);
+    rt_kprintf("ring     : %d / %d words (max %d)\n", blog.head - blog.tail, BLOG_RING_WORDS, blog.max_used);
+    rt_kprintf("packets  : %d (%d bytes)\n", blog.packets, blog.bytes);
+
+    return 0;
+}
+MSH_CMD_EXPORT(blog_stat, deferred log stats and mode: blog_stat [off|text|binary]);
@@ -0,0 +1,68 @@
+/* blog.h - 二进制延迟日志: 热路径只记录格式 ID、时间戳和原始参数, 由后台线程发送, 主机解码 */
+#ifndef __BLOG_H__
+#define __BLOG_H__
+
+#include <rtthread.h>
+
+#define BLOG_RING_WORDS         1024    /* 记录环 (字, 2 的幂) */
+#define BLOG_MAX_ARGS           6
+#define BLOG_PACKET_SIZE        256     /* 单个二进制包的记录字节上限 */
+#define BLOG_DRAIN_MS           50      /* 后台线程发送周期; 记录环过半时提前唤醒 */
+#define BLOG_THREAD_STACK_SIZE  1024
+#define BLOG_THREAD_PRIORITY    25      /* 低于桥接和 finsh */
+
+/* 格式串所在段: 记录中的格式 ID 为格式串在段内的偏移 */
+#define BLOG_SECTION            "BlogFmt"
+
+enum blog_mode
+{
+    BLOG_MODE_OFF = 0,                  /* 不记录 */
+    BLOG_MODE_TEXT,                     /* 后台线程在目标上格式化后经 rt_kprintf 输出 */
+    BLOG_MODE_BINARY,                   /* 后台线程把记录原样打包, 经控制台发给主机解码 */
+};
+
+#ifndef BLOG_DEFAULT_MODE
+#define BLOG_DEFAULT_MODE       BLOG_MODE_BINARY
+#endif
+
+/*
+ * 用法同 rt_kprintf: BLOG("%s: crc error, seq %d\n", rx->name, seq);
+ *
+ * 参数按 32 位原样保存, 只支持整数、字符和指针 (%d %u %x %c %p 等),
+ * 不支持浮点和 64 位参数; %s 只能指向映像中的常量字符串 (解码时从
+ * 映像取内容). 最多 BLOG_MAX_ARGS 个参数 (含 %.*s 的长度). 线程和
+ * 中断上下文均可调用, 记录环满时丢弃并计数.
+ */
+#define BLOG(...)                                                                   \
+    do                                                                              \
+    {                                                                               \
+        static const char blog_fmt_[] SECTION(BLOG_SECTION) = BLOG_FMT_(__VA_ARGS__, ~); \
+        blog_write(blog_fmt_, BLOG_NARGS_(__VA_ARGS__),                             \
+                   BLOG_CAT_(BLOG_ARGV_, BLOG_NARGS_(__VA_ARGS__))(__VA_ARGS__));   \
+    } while (0)
+
+void     blog_write(const char *fmt, rt_uint32_t nargs, const rt_uint32_t *args);
+
+/* 创建后台线程并按 BLOG_DEFAULT_MODE 开始记录, 在 console_init() 之后调用 */
+rt_err_t blog_init(void);
+void     blog_set_mode(enum blog_mode mode);
+
+/* 以下为 BLOG() 的实现细节 */
+#define BLOG_CAT_(a, b)         BLOG_CAT2_(a, b)
+#define BLOG_CAT2_(a, b)        a##b
+#define BLOG_FMT_(fmt, ...)     fmt
+#define BLOG_NARGS_(...)        BLOG_NARGS2_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, ~)
+#define BLOG_NARGS2_(f, a1, a2, a3, a4, a5, a6, n, ...) n
+#define BLOG_W_(x)              ((rt_uint32_t)(rt_ubase_t)(x))
+#define BLOG_ARGV_0(f)                          RT_NULL
+#define BLOG_ARGV_1(f, a)                       ((const rt_uint32_t[]){ BLOG_W_(a) })
+#define BLOG_ARGV_2(f, a, b)                    ((const rt_uint32_t[]){ BLOG_W_(a), BLOG_W_(b) })
+#define BLOG_ARGV_3(f, a, b, c)                 ((const rt_uint32_t[]){ BLOG_W_(a), BLOG_W_(b), BLOG_W_(c) })
+#define BLOG_ARGV_4(f, a, b, c, d)              ((const rt_uint32_t[]){ BLOG_W_(a), BLOG_W_(b), BLOG_W_(c), \
+                                                                        BLOG_W_(d) })
+#define BLOG_ARGV_5(f, a, b, c, d, e)           ((const rt_uint32_t[]){ BLOG_W_(a), BLOG_W_(b), BLOG_W_(c), \
+                                                                        BLOG_W_(d), BLOG_W_(e) })
+#define BLOG_ARGV_6(f, a, b, c, d, e, g)        ((const rt_uint32_t[]){ BLOG_W_(a), BLOG_W_(b), BLOG_W_(c), \
+                                                                        BLOG_W_(d), BLOG_W_(e), BLOG_W_(g) })
+
+#endif
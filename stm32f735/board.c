@@ -4,17 +4,43 @@
 #include <rtthread.h>
 #include <rthw.h>
 #include "stm32h7xx_hal.h"
+#include "board.h"
+#include "console.h"
+#include "uart_port.h"
 
-/* 引用 main.c 定义的串口句柄 */
-extern UART_HandleTypeDef huart3; 
 extern void SystemClock_Config(void);
-extern int MX_USART3_UART_Init(void);
 
 /* 堆内存定义 */
 extern int Image$$RW_IRAM1$$ZI$$Limit; 
 #define HEAP_BEGIN  ((void *)&Image$$RW_IRAM1$$ZI$$Limit)
 #define HEAP_END    (void *)(0x20020000) 
 
+/* DMA 缓冲池 (AXI SRAM) */
+#if defined(__CC_ARM) || defined(__CLANG_ARM)
+static rt_uint8_t dma_pool[BOARD_DMA_POOL_SIZE] __attribute__((at(BOARD_DMA_POOL_ADDR)));
+#else
+ALIGN(32) static rt_uint8_t dma_pool[BOARD_DMA_POOL_SIZE] SECTION(".dma_pool");
+#endif
+static rt_size_t dma_pool_used = 0;
+
+void *board_dma_alloc(rt_size_t size)
+{
+    void *ptr = RT_NULL;
+    rt_base_t level;
+
+    size = RT_ALIGN(size, RT_CPU_CACHE_LINE_SZ);
+
+    level = rt_hw_interrupt_disable();
+    if (dma_pool_used + size <= BOARD_DMA_POOL_SIZE)
+    {
+        ptr = &dma_pool[dma_pool_used];
+        dma_pool_used += size;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return ptr;
+}
+
 /* 1. 板级初始化 */
 void rt_hw_board_init(void)
 {
@@ -26,18 +52,16 @@ void rt_hw_board_init(void)
         SCB->CPACR |= ((3UL << 10*2)|(3UL << 11*2));
     #endif
 
+    /* SysTick 由 clock_profile_apply() 按 CPU 频率和 RT_TICK_PER_SECOND 配置 */
     HAL_Init();
     SystemClock_Config();
 
-    /* SysTick 配置 */
-    HAL_SYSTICK_Config(HAL_RCC_GetHCLKFreq() / RT_TICK_PER_SECOND);
-    HAL_NVIC_SetPriority(SysTick_IRQn, 15, 0);
-
     /* 堆初始化 */
     rt_system_heap_init(HEAP_BEGIN, HEAP_END);
 
-    /* 初始化调试串口 (UART3) */
-    MX_USART3_UART_Init();
+    /* 初始化全部串口, 控制台 (UART3) 之后的输出走 DMA */
+    uart_port_init();
+    console_init(uart_port_find("uart3"));
 
 #ifdef RT_USING_COMPONENTS_INIT
     rt_components_board_init();
@@ -55,38 +79,27 @@ void SysTick_Handler(void)
     HAL_IncTick();
 }
 
-/* 3. [关键] 手动实现控制台输出 (替代 Serial 驱动) */
-void rt_hw_console_output(const char *str)
+/*
+ * HAL 的超时 (PLL 锁定、时钟切换等) 以 HAL_GetTick 计, 启动时和 clock_profile_apply()
+ * 中关着中断, SysTick 中断进不来; 此时按 COUNTFLAG (读 CTRL 即清零) 推进, 超时仍然有效.
+ * 关中断前残留的 COUNTFLAG 或开中断后补进的 SysTick 中断只让 HAL 节拍多走 1 ms.
+ */
+uint32_t HAL_GetTick(void)
 {
-    rt_size_t i = 0, size = 0;
-    char a = '\r';
+    if (__get_PRIMASK() && (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk))
+        uwTick += uwTickFreq;
 
-    size = rt_strlen(str);
-    for (i = 0; i < size; i++)
-    {
-        if (*(str + i) == '\n')
-        {
-            HAL_UART_Transmit(&huart3, (uint8_t *)&a, 1, 10);
-        }
-        HAL_UART_Transmit(&huart3, (uint8_t *)(str + i), 1, 10);
-    }
+    return uwTick;
+}
+
+/* 3. [关键] 控制台输出, 经 uart_port 发送队列异步 DMA 发送, 见 console.c */
+void rt_hw_console_output(const char *str)
+{
+    console_output(str);
 }
 
-/* 4. [关键] 手动实现控制台输入 (给 Shell 用) */
+/* 4. [关键] 控制台输入 (给 Shell 用), 阻塞到 DMA 接收到字符 */
 char rt_hw_console_getchar(void)
 {
-    int ch = -1;
-    uint8_t data;
-    
-    /* 检查是否有数据，不阻塞 */
-    if (__HAL_UART_GET_FLAG(&huart3, UART_FLAG_RXNE))
-    {
-        HAL_UART_Receive(&huart3, &data, 1, 0);
-        ch = data;
-    }
-    else
-    {
-        rt_thread_mdelay(10); /* 释放CPU */
-    }
-    return ch;
+    return console_getchar();
 }
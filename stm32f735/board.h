@@ -3,6 +3,15 @@
 #define __BOARD_H__
 
 #include "stm32h7xx_hal.h"
+#include <rtthread.h>
+
 void SystemClock_Config(void);
 
-#endif
\ No newline at end of file
+/* DMA 缓冲池: DMA1/DMA2 无法访问 DTCM (0x20000000), 固定放在 AXI SRAM 末尾 */
+#define BOARD_DMA_POOL_ADDR     0x24048000
+#define BOARD_DMA_POOL_SIZE     0x8000
+
+/* 从 DMA 缓冲池分配 (32字节/Cache Line 对齐, 仅初始化阶段调用, 不释放) */
+void *board_dma_alloc(rt_size_t size);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * bridge_frame.h - 桥接端口帧格式
+ *
+ *   +------+------+---------+---------+---------+-----------+----------+
+ *   | 0xA5 | 0x5A | seq(16) | len(16) | rsv(16) | payload   | crc32    |
+ *   +------+------+---------+---------+---------+-----------+----------+
+ *
+ * 多字节字段均为小端. len 为载荷字节数, 须为 16 的倍数 (AES 块) 且不超过
+ * BRIDGE_FRAME_MAX_LEN; 第三个字段使载荷 4 字节对齐, 请求帧中为 0,
+ * 回传帧中为 credit: 链路接收窗口 (块数). 主机保证已发送但未收到回传的
+ * 载荷块数不超过最近一次收到的 credit, 链路就不会因接收队列满而丢帧;
+ * 丢失的请求 (CRC 错误等) 没有回传, 由主机超时回收其占用的窗口.
+ * crc32 为标准 CRC-32 (与 zlib.crc32 相同), 覆盖 seq/len/rsv 和载荷,
+ * 由 CRC 外设计算. 回传帧沿用请求帧的 seq.
+ */
+#ifndef __BRIDGE_FRAME_H__
+#define __BRIDGE_FRAME_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+#define BRIDGE_FRAME_SYNC0          0xA5
+#define BRIDGE_FRAME_SYNC1          0x5A
+#define BRIDGE_FRAME_HDR_SIZE       8
+#define BRIDGE_FRAME_CRC_SIZE       4
+#define BRIDGE_FRAME_MAX_LEN        256     /* 载荷上限, 16 块 */
+#define BRIDGE_FRAME_MAX_SIZE       (BRIDGE_FRAME_HDR_SIZE + BRIDGE_FRAME_MAX_LEN + BRIDGE_FRAME_CRC_SIZE)
+
+rt_err_t    bridge_frame_init(CRC_HandleTypeDef *hcrc);
+
+/*
+ * 计算帧 CRC: hdr 为帧头 (含同步字), 载荷可分两段.
+ * 只能在线程上下文调用, 内部以互斥量独占 CRC 外设.
+ */
+rt_uint32_t bridge_frame_crc(const rt_uint8_t *hdr, const rt_uint8_t *p1, rt_size_t n1,
+                             const rt_uint8_t *p2, rt_size_t n2);
+
+/* 在 buf 中填写帧头 (含 credit) 和 CRC, 载荷须已位于 buf + BRIDGE_FRAME_HDR_SIZE; 返回帧总长 */
+rt_size_t   bridge_frame_seal(rt_uint8_t *buf, rt_uint16_t seq, rt_size_t len, rt_uint16_t credit);
+
+#endif
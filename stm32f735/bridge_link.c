@@ -0,0 +1,114 @@
+/*
+ * bridge_link.c - 桥接链路表
+ *
+ * 每条链路 = UART 端口 + 接收引擎 + CRYP 提交端口 + 流水线 + 工作线程,
+ * 全部由下面的常量表描述, 新增链路只需在 uart_port.c 的端口表和本表中
+ * 各加一行. 中断路径不查表: uart_port 由 HAL 句柄地址直接换算出端口,
+ * 再经注册的回调参数直达本链路的 bridge_rx / bridge_pipe.
+ */
+
+#include "bridge_link.h"
+#include "uart_port.h"
+
+static const struct bridge_link_cfg bridge_link_cfg[] =
+{
+    /* name  rx    pipe  uart     dir              key */
+    { "u7", "s7", "p7", "uart7", CRYPTO_ENCRYPT, 0 },
+    { "u1", "s1", "p1", "uart1", CRYPTO_DECRYPT, 0 },
+};
+
+#define BRIDGE_LINK_NUM     (sizeof(bridge_link_cfg) / sizeof(bridge_link_cfg[0]))
+
+/* 链路数超过接收/CRYP 端口表时编译报错 */
+typedef char bridge_link_num_check[(BRIDGE_LINK_NUM <= BRIDGE_LINK_MAX &&
+                                    BRIDGE_LINK_MAX <= BRIDGE_RX_MAX &&
+                                    BRIDGE_LINK_MAX <= CRYPTO_PORT_MAX) ? 1 : -1];
+
+static struct bridge_link bridge_links[BRIDGE_LINK_NUM];
+
+/* =================================================================================
+ * 1. 初始化
+ * ================================================================================= */
+
+static rt_err_t bridge_link_setup(struct bridge_link *link, const struct bridge_link_cfg *cfg)
+{
+    rt_err_t result;
+
+    link->cfg  = cfg;
+    link->uart = uart_port_find(cfg->uart);
+    if (link->uart == RT_NULL)
+        return -RT_ERROR;
+
+    crypto_port_register(&link->crypto, cfg->name);
+
+    result = bridge_rx_init(&link->rx, cfg->rx_name, link->uart);
+    if (result != RT_EOK)
+        return result;
+
+    result = bridge_pipe_init(&link->pipe, cfg->pipe_name, &link->rx, link->uart,
+                              (enum crypto_dir)cfg->dir, cfg->key, &link->crypto);
+    if (result != RT_EOK)
+        return result;
+
+    link->thread = rt_thread_create(cfg->name, bridge_pipe_entry, &link->pipe,
+                                    BRIDGE_LINK_STACK_SIZE, BRIDGE_LINK_PRIORITY, 5);
+    if (link->thread == RT_NULL)
+        return -RT_ENOMEM;
+
+    return RT_EOK;
+}
+
+rt_err_t bridge_link_init(void)
+{
+    rt_err_t result = RT_EOK;
+    rt_size_t i;
+
+    /* 先建好全部链路再开始接收, 接收回调不会遇到未初始化的流水线 */
+    for (i = 0; i < BRIDGE_LINK_NUM; i++)
+    {
+        if (bridge_link_setup(&bridge_links[i], &bridge_link_cfg[i]) != RT_EOK)
+        {
+            rt_kprintf("[ERR] bridge link %s on %s init failed\n", bridge_link_cfg[i].name,
+                       bridge_link_cfg[i].uart);
+            bridge_links[i].cfg = RT_NULL;
+            result = -RT_ERROR;
+        }
+    }
+
+    for (i = 0; i < BRIDGE_LINK_NUM; i++)
+    {
+        if (bridge_links[i].cfg == RT_NULL)
+            continue;
+
+        rt_thread_startup(bridge_links[i].thread);
+        bridge_rx_start(&bridge_links[i].rx);
+    }
+
+    return result;
+}
+
+/* =================================================================================
+ * 2. 调试命令
+ * ================================================================================= */
+
+static int bridge_link(int argc, char **argv)
+{
+    struct bridge_link *link;
+    rt_size_t i;
+
+    rt_kprintf("link     uart     dir key frames     drop_blk throttle stalls   tx_err   pending\n");
+    rt_kprintf("-------- -------- --- --- ---------- -------- -------- -------- -------- -------\n");
+    for (i = 0; i < BRIDGE_LINK_NUM; i++)
+    {
+        link = &bridge_links[i];
+        if (link->cfg == RT_NULL) continue;
+
+        rt_kprintf("%-8s %-8s %s %3d %10d %8d %8d %8d %8d %7d\n", link->cfg->name, link->cfg->uart,
+                   link->cfg->dir == CRYPTO_ENCRYPT ? "enc" : "dec", link->cfg->key,
+                   link->rx.frames, link->rx.dropped_blocks, link->uart->rx_throttles,
+                   link->pipe.slot_stalls, link->pipe.tx_errors, link->pipe.fill_idx - link->pipe.tx_idx);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(bridge_link, show bridge link table and pipeline counters);
@@ -0,0 +1,41 @@
+/* bridge_link.h - 桥接链路表: 每条链路由一个 UART 端口、接收引擎、CRYP 提交端口和流水线组成 */
+#ifndef __BRIDGE_LINK_H__
+#define __BRIDGE_LINK_H__
+
+#include <rtthread.h>
+#include "bridge_rx.h"
+#include "bridge_pipe.h"
+#include "crypto_batch.h"
+
+#define BRIDGE_LINK_MAX             8       /* 链路数上限, 受接收/CRYP 端口表大小约束 */
+#define BRIDGE_LINK_STACK_SIZE      2048
+#define BRIDGE_LINK_PRIORITY        15
+
+/* 静态链路描述, 见 bridge_link.c 中的链路表 */
+struct bridge_link_cfg
+{
+    const char          *name;              /* 工作线程与 CRYP 提交端口名 */
+    const char          *rx_name;           /* 接收统计名 */
+    const char          *pipe_name;         /* 流水线信号量与延迟直方图名 */
+    const char          *uart;              /* uart_port 名 */
+    rt_uint8_t           dir;               /* enum crypto_dir */
+    rt_uint8_t           key;               /* 密钥槽, 见 crypto_key.h */
+};
+
+struct bridge_link
+{
+    const struct bridge_link_cfg *cfg;
+    struct uart_port    *uart;
+    struct bridge_rx     rx;
+    struct crypto_port   crypto;
+    struct bridge_pipe   pipe;
+    rt_thread_t          thread;
+};
+
+/*
+ * 按链路表初始化全部链路并启动接收, 须在 uart_port_init() 和
+ * crypto_server_init() 之后调用. 单条链路失败时跳过, 返回最后一个错误.
+ */
+rt_err_t bridge_link_init(void);
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * bridge_pipe.c - RX-DMA -> CRYP-DMA -> TX-DMA 三级流水线
+ *
+ * 每个端口有 BRIDGE_PIPE_SLOTS 个缓冲槽, 按序流转:
+ *   线程: 取空闲槽 -> 从 bridge_rx 取接收队列中已有的连续若干帧 (载荷合计不超过
+ *         批处理上限) -> 作为一个任务提交给 CRYP 服务线程
+ *   CRYP 完成回调: 逐帧封帧 (沿用各自请求 seq) -> 标记槽可发送 -> 若 UART 空闲立即启动 TX DMA
+ *   TX 完成中断: 归还槽 -> 启动下一个已加密槽的发送
+ * 接收 N+1、加密 N、发送 N-1 同时进行, 持续吞吐取决于最慢的一级.
+ *
+ * 合帧只取已经到达的帧, 不为凑批等待: 空闲时一槽一帧, 延迟不变; 积压时小帧
+ * 合成一次 CRYP DMA 与一次 TX DMA, 代价是槽内先到的帧要等同槽后续帧加密完、
+ * 并随它们一起发送.
+ */
+
+#include "bridge_pipe.h"
+#include "bridge_frame.h"
+#include "blog.h"
+#include "board.h"
+#include <rthw.h>
+
+/* =================================================================================
+ * 1. 发送级 (中断上下文)
+ * ================================================================================= */
+
+/* 按序启动下一个可发送的槽, 失败槽直接回收 */
+static void bridge_pipe_kick_tx(struct bridge_pipe *pipe)
+{
+    struct bridge_slot *slot;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    while (!pipe->tx_busy && pipe->tx_idx != pipe->fill_idx)
+    {
+        slot = &pipe->slot[pipe->tx_idx % BRIDGE_PIPE_SLOTS];
+
+        if (slot->state == BRIDGE_SLOT_CRYPT)
+            break;
+
+        if (slot->state == BRIDGE_SLOT_READY)
+        {
+            if (uart_port_send(pipe->uart, slot->out, slot->tx_len) == RT_EOK)
+            {
+                pipe->tx_busy = 1;
+                break;
+            }
+            pipe->tx_errors++;
+            BLOG("%s: tx failed, seq %d\n", pipe->rx->name, slot->seq[0]);
+        }
+
+        pipe->tx_idx++;
+        rt_sem_release(&pipe->free_slots);
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+void bridge_pipe_tx_done(struct bridge_pipe *pipe)
+{
+    struct bridge_slot *slot;
+    rt_uint32_t now = lat_now();
+    rt_base_t level;
+    int i;
+
+    level = rt_hw_interrupt_disable();
+    if (pipe->tx_busy)
+    {
+        slot = &pipe->slot[pipe->tx_idx % BRIDGE_PIPE_SLOTS];
+        lat_hist_add(&pipe->lat[BRIDGE_LAT_TX], now - slot->t_cryp[1]);
+        for (i = 0; i < slot->nframes; i++)
+            lat_hist_add(&pipe->lat[BRIDGE_LAT_TOTAL], now - slot->t_rx[i]);
+
+        pipe->tx_busy = 0;
+        pipe->tx_idx++;
+        rt_sem_release(&pipe->free_slots);
+    }
+    rt_hw_interrupt_enable(level);
+
+    bridge_pipe_kick_tx(pipe);
+}
+
+static void bridge_pipe_port_tx_done(void *param)
+{
+    bridge_pipe_tx_done((struct bridge_pipe *)param);
+}
+
+/* =================================================================================
+ * 2. 加密级
+ * ================================================================================= */
+
+static void bridge_pipe_crypt_done(void *param, rt_err_t result)
+{
+    struct bridge_slot *slot = (struct bridge_slot *)param;
+    struct bridge_pipe *pipe = slot->pipe;
+    rt_size_t offset, start, len;
+    int i;
+
+    lat_hist_add(&pipe->lat[BRIDGE_LAT_QUEUE], slot->t_cryp[0] - slot->t_pop);
+    lat_hist_add(&pipe->lat[BRIDGE_LAT_CRYP], slot->t_cryp[1] - slot->t_cryp[0]);
+
+    if (result == RT_EOK)
+    {
+        /*
+         * 密文由 CRYP 连续写在首帧帧头之后. 由后往前把各帧密文挪到自己的帧头之后
+         * 并封帧: 每帧后移 i 个帧头加 CRC, 不会覆盖前面尚未挪动的密文.
+         * 帧头和 CRC 由 CPU 写入, TX DMA 前回写.
+         */
+        offset = slot->nblocks * BRIDGE_BLOCK_SIZE;
+        start  = offset + slot->nframes * (BRIDGE_FRAME_HDR_SIZE + BRIDGE_FRAME_CRC_SIZE);
+        slot->tx_len = start;
+        for (i = slot->nframes - 1; i >= 0; i--)
+        {
+            len     = slot->blocks[i] * BRIDGE_BLOCK_SIZE;
+            offset -= len;
+            start  -= BRIDGE_FRAME_HDR_SIZE + len + BRIDGE_FRAME_CRC_SIZE;
+            if (start != offset)
+                rt_memmove(slot->out + start + BRIDGE_FRAME_HDR_SIZE, slot->out + BRIDGE_FRAME_HDR_SIZE + offset, len);
+            bridge_frame_seal(slot->out + start, slot->seq[i], len, BRIDGE_RX_CREDIT);
+        }
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, slot->out, slot->tx_len);
+        slot->state = BRIDGE_SLOT_READY;
+    }
+    else
+    {
+        slot->state = BRIDGE_SLOT_FAILED;
+    }
+    bridge_pipe_kick_tx(pipe);
+}
+
+/* =================================================================================
+ * 3. 初始化与工作线程
+ * ================================================================================= */
+
+rt_err_t bridge_pipe_init(struct bridge_pipe *pipe, const char *name, struct bridge_rx *rx,
+                          struct uart_port *uart, enum crypto_dir dir, rt_uint8_t key,
+                          struct crypto_port *port)
+{
+    static const char *stage_name[BRIDGE_LAT_STAGES] = { "wake", "queue", "cryp", "tx", "total" };
+    int i;
+
+    rt_memset(pipe, 0, sizeof(struct bridge_pipe));
+    pipe->rx    = rx;
+    pipe->uart  = uart;
+    pipe->dir   = dir;
+    pipe->key   = key;
+    pipe->port  = port;
+
+    for (i = 0; i < BRIDGE_PIPE_SLOTS; i++)
+    {
+        pipe->slot[i].pipe = pipe;
+        pipe->slot[i].in   = board_dma_alloc(BRIDGE_FRAME_MAX_LEN);
+        pipe->slot[i].out  = board_dma_alloc(BRIDGE_PIPE_SLOT_SIZE);
+        if (pipe->slot[i].in == RT_NULL || pipe->slot[i].out == RT_NULL)
+            return -RT_ENOMEM;
+    }
+
+    for (i = 0; i < BRIDGE_LAT_STAGES; i++)
+        lat_hist_init(&pipe->lat[i], name, stage_name[i]);
+
+    uart_port_set_tx_callback(uart, bridge_pipe_port_tx_done, pipe);
+
+    return rt_sem_init(&pipe->free_slots, name, BRIDGE_PIPE_SLOTS, RT_IPC_FLAG_FIFO);
+}
+
+void bridge_pipe_entry(void *parameter)
+{
+    struct bridge_pipe *pipe = (struct bridge_pipe *)parameter;
+    struct bridge_slot *slot;
+    struct bridge_rx_frame info;
+    struct crypto_job job;
+    rt_size_t limit, max, n;
+    rt_err_t result;
+    int i;
+
+    rt_memset(&job, 0, sizeof(job));
+    job.dir  = pipe->dir;
+    job.key  = pipe->key;
+    job.done = bridge_pipe_crypt_done;
+
+    while (1)
+    {
+        if (bridge_rx_wait(pipe->rx, RT_WAITING_FOREVER) != RT_EOK) continue;
+
+        while (bridge_rx_available(pipe->rx) > 0)
+        {
+            /* 发送跟不上时在此反压, 帧留在接收队列中 */
+            if (rt_sem_trytake(&pipe->free_slots) != RT_EOK)
+            {
+                pipe->slot_stalls++;
+                BLOG("%s: tx slots full\n", pipe->rx->name);
+                rt_sem_take(&pipe->free_slots, RT_WAITING_FOREVER);
+            }
+
+            /* 首帧总是取出; 后续帧只合并已在队列中且放得下的 */
+            slot  = &pipe->slot[pipe->fill_idx % BRIDGE_PIPE_SLOTS];
+            limit = crypto_batch_limit();
+            slot->nblocks = 0;
+            slot->nframes = 0;
+            do
+            {
+                max = slot->nframes ? limit - slot->nblocks : BRIDGE_FRAME_MAX_LEN / BRIDGE_BLOCK_SIZE;
+                n = bridge_rx_pop(pipe->rx, slot->in + slot->nblocks * BRIDGE_BLOCK_SIZE, max, &info);
+                if (n == 0)
+                    break;
+                slot->seq[slot->nframes]    = info.seq;
+                slot->blocks[slot->nframes] = n;
+                slot->t_rx[slot->nframes]   = info.stamp;
+                slot->nblocks += n;
+                slot->nframes++;
+            } while (slot->nblocks < limit);
+
+            /* 队列中剩下的都是 CRC 错误帧 */
+            if (slot->nframes == 0)
+            {
+                rt_sem_release(&pipe->free_slots);
+                continue;
+            }
+
+            slot->t_pop = lat_now();
+            for (i = 0; i < slot->nframes; i++)
+                lat_hist_add(&pipe->lat[BRIDGE_LAT_WAKE], slot->t_pop - slot->t_rx[i]);
+            slot->state = BRIDGE_SLOT_CRYPT;
+
+            /* 先登记再提交: 服务线程优先级更高, 可能在 submit 返回前完成 */
+            __DMB();
+            pipe->fill_idx++;
+
+            job.in      = slot->in;
+            job.out     = slot->out + BRIDGE_FRAME_HDR_SIZE;
+            job.nblocks = slot->nblocks;
+            job.param   = slot;
+            job.cycles  = slot->t_cryp;
+
+            /* 端口队列深度不小于槽数, 不会满 */
+            result = crypto_port_submit(pipe->port, &job);
+            RT_ASSERT(result == RT_EOK);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/* bridge_pipe.h - RX-DMA -> CRYP-DMA -> TX-DMA 三级流水线 */
+#ifndef __BRIDGE_PIPE_H__
+#define __BRIDGE_PIPE_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+#include "bridge_rx.h"
+#include "crypto_batch.h"
+#include "lat_hist.h"
+
+#define BRIDGE_PIPE_SLOTS       3       /* 每端口缓冲槽: 加密 N / 发送 N-1 / 填充 N+1 */
+
+/* 每槽合并的帧数上限: 载荷合计不超过批处理上限, 每帧至少一块 */
+#define BRIDGE_PIPE_SLOT_FRAMES CRYPTO_BATCH_MAX_BLOCKS
+/* 槽发送缓冲: 各回传帧首尾相接, 载荷合计不超过一个最大帧 */
+#define BRIDGE_PIPE_SLOT_SIZE   (BRIDGE_FRAME_MAX_LEN + \
+                                 BRIDGE_PIPE_SLOT_FRAMES * (BRIDGE_FRAME_HDR_SIZE + BRIDGE_FRAME_CRC_SIZE))
+
+/* 延迟分段 (DWT 周期) */
+enum bridge_lat_stage
+{
+    BRIDGE_LAT_WAKE = 0,                /* 帧收齐 -> 工作线程取帧 (每帧) */
+    BRIDGE_LAT_QUEUE,                   /* 取帧 -> CRYP 开始 (每槽, 下同) */
+    BRIDGE_LAT_CRYP,                    /* CRYP 开始 -> 结束 */
+    BRIDGE_LAT_TX,                      /* CRYP 结束 -> TX 完成 */
+    BRIDGE_LAT_TOTAL,                   /* 帧收齐 -> TX 完成 (每帧) */
+    BRIDGE_LAT_STAGES,
+};
+
+enum bridge_slot_state
+{
+    BRIDGE_SLOT_CRYPT = 0,              /* 已提交 CRYP */
+    BRIDGE_SLOT_READY,                  /* 加密完成, 等待发送 */
+    BRIDGE_SLOT_FAILED,                 /* 加密失败, 直接丢弃 */
+};
+
+struct bridge_pipe;
+
+struct bridge_slot
+{
+    struct bridge_pipe  *pipe;
+    rt_uint8_t          *in;            /* DMA 缓冲: 各帧请求载荷, 连续存放 */
+    rt_uint8_t          *out;           /* DMA 缓冲: 各帧完整回传帧, 首尾相接 */
+    rt_uint16_t          nblocks;       /* 各帧块数之和, 一个 CRYP 任务 */
+    rt_uint16_t          nframes;
+    rt_uint16_t          tx_len;        /* out 中待发送的字节数 */
+
+    /* 每帧的 seq 与块数, 封帧时按此切分密文 */
+    rt_uint16_t          seq[BRIDGE_PIPE_SLOT_FRAMES];
+    rt_uint8_t           blocks[BRIDGE_PIPE_SLOT_FRAMES];
+
+    /* 时间戳 (DWT 周期) */
+    rt_uint32_t          t_rx[BRIDGE_PIPE_SLOT_FRAMES];
+    rt_uint32_t          t_pop;
+    rt_uint32_t          t_cryp[2];     /* CRYP 开始/结束, 由服务线程写入 */
+    volatile rt_uint8_t  state;
+};
+
+struct bridge_pipe
+{
+    struct bridge_rx    *rx;
+    struct uart_port    *uart;
+    enum crypto_dir      dir;
+    rt_uint8_t           key;           /* 密钥槽 */
+    struct crypto_port  *port;
+
+    struct bridge_slot   slot[BRIDGE_PIPE_SLOTS];
+    volatile rt_uint32_t fill_idx;      /* 已提交加密的槽数 (线程) */
+    volatile rt_uint32_t tx_idx;        /* 已发送完成的槽数 (中断) */
+    rt_uint8_t           tx_busy;
+
+    struct rt_semaphore  free_slots;    /* 空闲槽计数, 发送完成时归还 */
+
+    /* 统计 */
+    rt_uint32_t          slot_stalls;   /* 等待空闲槽 (发送跟不上) */
+    rt_uint32_t          tx_errors;     /* 启动发送失败, DMA 错误计入端口统计 */
+
+    /* 各段延迟直方图, 每段只有一个写者 (线程/服务线程/TX 中断) */
+    struct lat_hist      lat[BRIDGE_LAT_STAGES];
+};
+
+rt_err_t bridge_pipe_init(struct bridge_pipe *pipe, const char *name, struct bridge_rx *rx,
+                          struct uart_port *uart, enum crypto_dir dir, rt_uint8_t key,
+                          struct crypto_port *port);
+
+/* 工作线程入口, parameter 为 struct bridge_pipe * */
+void     bridge_pipe_entry(void *parameter);
+
+/* 中断上下文: 端口发送完成回调 (TX DMA 出错也按完成处理) */
+void     bridge_pipe_tx_done(struct bridge_pipe *pipe);
+
+#endif
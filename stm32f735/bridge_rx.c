@@ -0,0 +1,380 @@
+/*
+ * bridge_rx.c - 桥接端口 DMA + IDLE 接收引擎
+ *
+ * 端口 DMA 以循环模式持续写入 ring, 半满/全满/线路空闲时 uart_port 回调
+ * bridge_rx_input(), 按帧格式 (见 bridge_frame.h)
+ * 解析新到字节, 载荷以 16 字节块写入块队列, 帧尾收齐后提交整帧,
+ * 一批事件只唤醒一次工作线程. CRC 由工作线程在 bridge_rx_pop() 中校验,
+ * 中断里不占用 CRC 外设.
+ *
+ * 帧边界只由同步字和长度决定, 不依赖字节间隔, 主机可以无间隙连续发送.
+ * 帧头非法时从同步字之后的下一个字节继续搜索; CRC 错误只丢弃当前帧.
+ *
+ * bridge_rx_input() 只依赖 ring 内容和 DMA 写位置, 主机端可直接用
+ * 模拟 UART/DMA 模型驱动.
+ */
+
+#include "bridge_rx.h"
+#include "bridge_frame.h"
+#include "lat_hist.h"
+#include "blog.h"
+#include "board.h"
+#include <rthw.h>
+#include <string.h>
+
+static struct bridge_rx *rx_table[BRIDGE_RX_MAX];
+
+/* =================================================================================
+ * 1. 初始化
+ * ================================================================================= */
+
+static void bridge_rx_event(void *param, rt_uint16_t pos)
+{
+    bridge_rx_input((struct bridge_rx *)param, pos);
+}
+
+static void bridge_rx_port_reset(void *param)
+{
+    bridge_rx_reset((struct bridge_rx *)param);
+}
+
+rt_err_t bridge_rx_init(struct bridge_rx *rx, const char *name, struct uart_port *port)
+{
+    int i;
+
+    RT_ASSERT(rx != RT_NULL);
+    RT_ASSERT(port != RT_NULL);
+
+    memset(rx, 0, sizeof(struct bridge_rx));
+    rx->name = name;
+    rx->port = port;
+
+    for (i = 0; i < BRIDGE_RX_MAX; i++)
+    {
+        if (rx_table[i] == RT_NULL)
+        {
+            rx_table[i] = rx;
+            break;
+        }
+    }
+
+    uart_port_set_rx_callback(port, bridge_rx_event, bridge_rx_port_reset, rx);
+
+    return rt_sem_init(&rx->sem, name, 0, RT_IPC_FLAG_FIFO);
+}
+
+rt_err_t bridge_rx_start(struct bridge_rx *rx)
+{
+    rt_err_t result;
+    rt_base_t level;
+
+    rx->ring_pos = 0;
+    rx->state = BRIDGE_RX_SYNC0;
+
+    /* 只打开接收, 回传帧由 bridge_pipe 直接从槽缓冲区发送; 关中断确保首个事件前 ring 已就绪 */
+    level = rt_hw_interrupt_disable();
+    result = uart_port_open(rx->port, UART_PORT_DMA_RX);
+    rx->ring      = rx->port->rx_buf;
+    rx->ring_size = rx->port->hw->rx_size;
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+/* =================================================================================
+ * 2. 中断侧: 帧解析入队
+ * ================================================================================= */
+
+static void bridge_rx_consume(struct bridge_rx *rx, const rt_uint8_t *data, rt_size_t len);
+
+/* 帧头收齐: 非法则从同步字之后重新搜索, 队列放不下则整帧跳过 */
+static void bridge_rx_header(struct bridge_rx *rx)
+{
+    rt_uint8_t rescan[BRIDGE_FRAME_HDR_SIZE - 2];
+    rt_uint16_t len = rx->hdr[4] | (rx->hdr[5] << 8);
+
+    if (len == 0 || len > BRIDGE_FRAME_MAX_LEN || (len % BRIDGE_BLOCK_SIZE) != 0 ||
+        rx->hdr[6] != 0 || rx->hdr[7] != 0)
+    {
+        /* 同步字可能是载荷中的巧合, 帧头里的字节还要参与搜索 (不足一个帧头, 不会再递归) */
+        rx->bad_header++;
+        BLOG("%s: bad header, len %d\n", rx->name, len);
+        rx->state = BRIDGE_RX_SYNC0;
+        memcpy(rescan, &rx->hdr[2], sizeof(rescan));
+        bridge_rx_consume(rx, rescan, sizeof(rescan));
+        return;
+    }
+
+    rx->len  = len;
+    rx->pos  = 0;
+    rx->skip = (BRIDGE_RX_QUEUE_DEPTH - (rx->head - rx->tail)) < len / BRIDGE_BLOCK_SIZE;
+    rx->state = BRIDGE_RX_PAYLOAD;
+}
+
+/* 载荷直接写到块队列 head 之后, 返回消费的字节数 */
+static rt_size_t bridge_rx_payload(struct bridge_rx *rx, const rt_uint8_t *data, rt_size_t len)
+{
+    rt_size_t n, offset;
+    rt_uint32_t block;
+
+    n = rx->len - rx->pos;
+    if (n > len) n = len;
+
+    if (!rx->skip)
+    {
+        for (offset = 0; offset < n; )
+        {
+            rt_size_t chunk = BRIDGE_BLOCK_SIZE - ((rx->pos + offset) % BRIDGE_BLOCK_SIZE);
+
+            if (chunk > n - offset) chunk = n - offset;
+            block = (rx->head + (rx->pos + offset) / BRIDGE_BLOCK_SIZE) & (BRIDGE_RX_QUEUE_DEPTH - 1);
+            memcpy(&rx->queue[block][(rx->pos + offset) % BRIDGE_BLOCK_SIZE], data + offset, chunk);
+            offset += chunk;
+        }
+    }
+
+    rx->pos += n;
+    if (rx->pos == rx->len)
+    {
+        rx->pos = 0;
+        rx->state = BRIDGE_RX_CRC;
+    }
+
+    return n;
+}
+
+/* CRC 收齐: 提交帧, CRC 留给取帧的线程校验, 中断里不占用 CRC 外设 */
+static void bridge_rx_commit(struct bridge_rx *rx)
+{
+    rt_uint32_t head = rx->head;
+    rt_uint16_t nblocks = rx->len / BRIDGE_BLOCK_SIZE;
+    struct bridge_rx_frame *frame;
+
+    rx->state = BRIDGE_RX_SYNC0;
+
+    if (rx->skip)
+    {
+        rx->dropped++;
+        rx->dropped_blocks += nblocks;
+        BLOG("%s: queue full, dropped seq %d (%d blocks)\n", rx->name, rx->hdr[2] | (rx->hdr[3] << 8), nblocks);
+        return;
+    }
+
+    frame = &rx->frame[rx->frame_head & (BRIDGE_RX_QUEUE_DEPTH - 1)];
+    frame->seq     = rx->hdr[2] | (rx->hdr[3] << 8);
+    frame->nblocks = nblocks;
+    frame->stamp   = lat_now();
+    frame->crc     = rx->trailer[0] | (rx->trailer[1] << 8) | (rx->trailer[2] << 16) |
+                     ((rt_uint32_t)rx->trailer[3] << 24);
+    __DMB();
+    rx->head = head + nblocks;
+    rx->frame_head++;
+    rx->frames++;
+}
+
+static void bridge_rx_consume(struct bridge_rx *rx, const rt_uint8_t *data, rt_size_t len)
+{
+    rt_size_t n;
+
+    while (len > 0)
+    {
+        switch (rx->state)
+        {
+        case BRIDGE_RX_SYNC0:
+            if (*data == BRIDGE_FRAME_SYNC0)
+            {
+                rx->hdr[0] = *data;
+                rx->state = BRIDGE_RX_SYNC1;
+            }
+            data++; len--;
+            break;
+
+        case BRIDGE_RX_SYNC1:
+            if (*data == BRIDGE_FRAME_SYNC1)
+            {
+                rx->hdr[1] = *data;
+                rx->pos = 2;
+                rx->state = BRIDGE_RX_HEADER;
+                data++; len--;
+            }
+            else
+            {
+                /* 不消费: 当前字节可能是新的 SYNC0 */
+                rx->state = BRIDGE_RX_SYNC0;
+            }
+            break;
+
+        case BRIDGE_RX_HEADER:
+            rx->hdr[rx->pos++] = *data++; len--;
+            if (rx->pos == BRIDGE_FRAME_HDR_SIZE)
+                bridge_rx_header(rx);
+            break;
+
+        case BRIDGE_RX_PAYLOAD:
+            n = bridge_rx_payload(rx, data, len);
+            data += n; len -= n;
+            break;
+
+        case BRIDGE_RX_CRC:
+            rx->trailer[rx->pos++] = *data++; len--;
+            if (rx->pos == BRIDGE_FRAME_CRC_SIZE)
+                bridge_rx_commit(rx);
+            break;
+
+        default:
+            rx->state = BRIDGE_RX_SYNC0;
+            break;
+        }
+    }
+}
+
+void bridge_rx_input(struct bridge_rx *rx, rt_uint16_t pos)
+{
+    rt_uint32_t frame_head = rx->frame_head;
+
+    rx->events++;
+
+    /* 全满 (TC) 时 pos 为 ring_size, 与起点 0 是同一位置; 否则重复的全满事件会被当成整圈新数据 */
+    if (pos == rx->ring_size)
+        pos = 0;
+    if (pos == rx->ring_pos)
+        return;
+
+    rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, rx->ring, rx->ring_size);
+
+    if (pos > rx->ring_pos)
+    {
+        rx->bytes += pos - rx->ring_pos;
+        bridge_rx_consume(rx, &rx->ring[rx->ring_pos], pos - rx->ring_pos);
+    }
+    else
+    {
+        /* DMA 已回绕 */
+        rx->bytes += rx->ring_size - rx->ring_pos + pos;
+        bridge_rx_consume(rx, &rx->ring[rx->ring_pos], rx->ring_size - rx->ring_pos);
+        bridge_rx_consume(rx, &rx->ring[0], pos);
+    }
+
+    rx->ring_pos = pos;
+
+    /* 队列将满: 有硬件流控时暂停接收, 没有时只能在帧头处整帧丢弃 */
+    if (BRIDGE_RX_QUEUE_DEPTH - (rx->head - rx->tail) < BRIDGE_RX_PAUSE_BLOCKS)
+        uart_port_rx_throttle(rx->port, RT_TRUE);
+
+    /* 本批有新帧才唤醒, 一次唤醒处理整批 */
+    if (rx->frame_head != frame_head)
+        rt_sem_release(&rx->sem);
+}
+
+void bridge_rx_reset(struct bridge_rx *rx)
+{
+    /* 端口已从缓冲区起点重新接收, 丢弃未完成的帧 */
+    rx->resets++;
+    rx->ring_pos = 0;
+    rx->state = BRIDGE_RX_SYNC0;
+}
+
+/* =================================================================================
+ * 3. 线程侧: 取帧
+ * ================================================================================= */
+
+rt_err_t bridge_rx_wait(struct bridge_rx *rx, rt_int32_t timeout)
+{
+    /* 每批释放一次信号量, 醒来后由调用者用 bridge_rx_pop() 逐帧取空队列 */
+    return rt_sem_take(&rx->sem, timeout);
+}
+
+/* 在队列中校验队首帧: 按帧信息还原帧头 (rsv 已在解析时确认为 0), 载荷回绕时分两段 */
+static rt_bool_t bridge_rx_crc_ok(struct bridge_rx *rx, const struct bridge_rx_frame *frame, rt_uint32_t tail)
+{
+    rt_uint32_t first = tail & (BRIDGE_RX_QUEUE_DEPTH - 1);
+    rt_uint16_t len = frame->nblocks * BRIDGE_BLOCK_SIZE;
+    rt_size_t n1 = len, n2 = 0;
+    rt_uint8_t hdr[BRIDGE_FRAME_HDR_SIZE] =
+    {
+        BRIDGE_FRAME_SYNC0, BRIDGE_FRAME_SYNC1, frame->seq & 0xFF, frame->seq >> 8, len & 0xFF, len >> 8, 0, 0,
+    };
+
+    if (first + frame->nblocks > BRIDGE_RX_QUEUE_DEPTH)
+    {
+        n1 = (BRIDGE_RX_QUEUE_DEPTH - first) * BRIDGE_BLOCK_SIZE;
+        n2 = len - n1;
+    }
+
+    return bridge_frame_crc(hdr, rx->queue[first], n1, rx->queue[0], n2) == frame->crc;
+}
+
+rt_size_t bridge_rx_pop(struct bridge_rx *rx, rt_uint8_t *blocks, rt_size_t max, struct bridge_rx_frame *info)
+{
+    rt_uint32_t frame_tail, tail;
+    struct bridge_rx_frame *frame;
+    rt_size_t count;
+    rt_bool_t ok;
+
+    while (rx->frame_head != rx->frame_tail)
+    {
+        frame_tail = rx->frame_tail;
+        tail = rx->tail;
+
+        __DMB();
+        frame = &rx->frame[frame_tail & (BRIDGE_RX_QUEUE_DEPTH - 1)];
+        count = frame->nblocks;
+
+        /* 放不下的帧留到下次, 先不校验 */
+        if (count > max)
+            return 0;
+
+        ok = bridge_rx_crc_ok(rx, frame, tail);
+        if (ok)
+        {
+            *info = *frame;
+            for (rt_size_t i = 0; i < count; i++)
+            {
+                memcpy(blocks, rx->queue[(tail + i) & (BRIDGE_RX_QUEUE_DEPTH - 1)], BRIDGE_BLOCK_SIZE);
+                blocks += BRIDGE_BLOCK_SIZE;
+            }
+        }
+        else
+        {
+            rx->crc_errors++;
+            BLOG("%s: crc error, seq %d\n", rx->name, frame->seq);
+        }
+
+        __DMB();
+        rx->tail = tail + count;
+        rx->frame_tail = frame_tail + 1;
+
+        if (rx->port->rx_throttled && BRIDGE_RX_QUEUE_DEPTH - (rx->head - rx->tail) >= BRIDGE_RX_RESUME_BLOCKS)
+            uart_port_rx_throttle(rx->port, RT_FALSE);
+
+        if (ok)
+            return count;
+    }
+
+    return 0;
+}
+
+/* =================================================================================
+ * 4. 调试命令
+ * ================================================================================= */
+
+static int bridge_rx(int argc, char **argv)
+{
+    int i;
+
+    rt_kprintf("port     bytes      frames     dropped  drop_blk bad_hdr  crc_err  restart  overrun  line_err throttle\n");
+    rt_kprintf("-------- ---------- ---------- -------- -------- -------- -------- -------- -------- -------- --------\n");
+    for (i = 0; i < BRIDGE_RX_MAX; i++)
+    {
+        struct bridge_rx *rx = rx_table[i];
+
+        if (rx == RT_NULL) continue;
+
+        rt_kprintf("%-8.*s %10d %10d %8d %8d %8d %8d %8d %8d %8d %8d\n", RT_NAME_MAX, rx->name,
+                   rx->bytes, rx->frames, rx->dropped, rx->dropped_blocks, rx->bad_header, rx->crc_errors,
+                   rx->resets, rx->port->overruns, rx->port->line_errors, rx->port->rx_throttles);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(bridge_rx, show bridge port receive and UART error counters);
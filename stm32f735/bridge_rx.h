@@ -0,0 +1,103 @@
+/* bridge_rx.h - 桥接端口 DMA + IDLE 接收引擎 */
+#ifndef __BRIDGE_RX_H__
+#define __BRIDGE_RX_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+#include "bridge_frame.h"
+#include "uart_port.h"
+
+#define BRIDGE_BLOCK_SIZE       16      /* AES 块长度 */
+#define BRIDGE_RX_QUEUE_DEPTH   64      /* 待处理块队列深度 (2 的幂, 可容纳 4 个最大帧) */
+#define BRIDGE_RX_MAX           8       /* bridge_rx 命令可列出的端口数 */
+
+/* 回传帧通告的接收窗口 (块): 在途块数不超过队列深度, 队列就不会满 */
+#define BRIDGE_RX_CREDIT        BRIDGE_RX_QUEUE_DEPTH
+
+/*
+ * 硬件流控端口: 块队列空闲低于 PAUSE 时暂停接收 DMA, 由 RTS 反压对端,
+ * 空闲回到 RESUME 以上再恢复. 余量须容纳 DMA 环形缓冲区中尚未解析的
+ * 字节 (256) 和一个正在接收的最大帧.
+ */
+#define BRIDGE_RX_PAUSE_BLOCKS  (2 * BRIDGE_FRAME_MAX_LEN / BRIDGE_BLOCK_SIZE)
+#define BRIDGE_RX_RESUME_BLOCKS (BRIDGE_RX_PAUSE_BLOCKS + BRIDGE_FRAME_MAX_LEN / BRIDGE_BLOCK_SIZE)
+
+/* 帧解析状态, 帧格式见 bridge_frame.h */
+enum bridge_rx_state
+{
+    BRIDGE_RX_SYNC0 = 0,
+    BRIDGE_RX_SYNC1,
+    BRIDGE_RX_HEADER,
+    BRIDGE_RX_PAYLOAD,
+    BRIDGE_RX_CRC,
+};
+
+/* 已收齐的帧, CRC 在取帧时校验 */
+struct bridge_rx_frame
+{
+    rt_uint16_t         seq;
+    rt_uint16_t         nblocks;
+    rt_uint32_t         stamp;              /* 帧收齐时的 DWT 周期数 */
+    rt_uint32_t         crc;                /* 帧尾收到的 CRC */
+};
+
+struct bridge_rx
+{
+    const char         *name;
+    struct uart_port   *port;
+
+    /* 端口的 DMA 循环缓冲区, 由 DMA 写入, ISR 读取 */
+    rt_uint8_t         *ring;
+    rt_uint16_t         ring_size;
+    rt_uint16_t         ring_pos;           /* 已消费到的 DMA 写位置 */
+
+    /* 帧解析 (仅 ISR 访问); 载荷直接写入块队列, 帧收齐后提交, 由取帧方校验 CRC */
+    rt_uint8_t          state;
+    rt_uint8_t          skip;               /* 队列满, 本帧只解析不入队 */
+    rt_uint8_t          hdr[BRIDGE_FRAME_HDR_SIZE];
+    rt_uint8_t          trailer[BRIDGE_FRAME_CRC_SIZE];
+    rt_uint16_t         pos;                /* 当前字段内已收字节 */
+    rt_uint16_t         len;                /* 载荷字节数 */
+
+    /* 块队列与帧队列: ISR 单生产者, 工作线程单消费者 */
+    rt_uint8_t          queue[BRIDGE_RX_QUEUE_DEPTH][BRIDGE_BLOCK_SIZE];
+    volatile rt_uint32_t head;
+    volatile rt_uint32_t tail;
+    struct bridge_rx_frame frame[BRIDGE_RX_QUEUE_DEPTH];
+    volatile rt_uint32_t frame_head;
+    volatile rt_uint32_t frame_tail;
+
+    struct rt_semaphore sem;
+
+    /* 统计 */
+    rt_uint32_t         events;             /* HT/TC/IDLE 事件次数 */
+    rt_uint32_t         bytes;
+    rt_uint32_t         frames;             /* 收齐的帧, 含 CRC 错误帧 */
+    rt_uint32_t         dropped;            /* 队列满丢弃的帧 */
+    rt_uint32_t         dropped_blocks;     /* 其中的载荷块数 */
+    rt_uint32_t         bad_header;         /* 同步字后帧头非法, 重新搜索同步字 */
+    rt_uint32_t         crc_errors;         /* 取帧时计数 (线程) */
+    rt_uint32_t         resets;             /* UART 错误后丢弃半帧的次数, 错误明细见端口统计 */
+};
+
+rt_err_t  bridge_rx_init(struct bridge_rx *rx, const char *name, struct uart_port *port);
+rt_err_t  bridge_rx_start(struct bridge_rx *rx);
+
+/* ISR 上下文 (端口接收回调): pos 为 DMA 在循环缓冲区中的写位置 */
+void      bridge_rx_input(struct bridge_rx *rx, rt_uint16_t pos);
+void      bridge_rx_reset(struct bridge_rx *rx);
+
+/* 线程上下文 */
+rt_err_t  bridge_rx_wait(struct bridge_rx *rx, rt_int32_t timeout);
+rt_inline rt_size_t bridge_rx_available(struct bridge_rx *rx)
+{
+    return rx->frame_head - rx->frame_tail;
+}
+
+/*
+ * 取出一帧的载荷和帧信息, 返回块数. 先校验 CRC, 错误帧计数后跳过;
+ * 没有正确的帧, 或下一帧超过 max 块 (留在队列中, 尚未校验) 时返回 0.
+ */
+rt_size_t bridge_rx_pop(struct bridge_rx *rx, rt_uint8_t *blocks, rt_size_t max, struct bridge_rx_frame *info);
+
+#endif
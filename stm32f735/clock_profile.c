@@ -0,0 +1,234 @@
+/*
+ * clock_profile.c - 系统时钟档位: PLL1/电压档位/Flash 等待/外设内核时钟, 运行时可切换
+ *
+ * 三档均以 HSI (64 MHz) 为源, 不依赖板上晶振:
+ *   perf      PLL1 550 MHz, AXI/AHB 275 MHz, APB 137.5 MHz, VOS0, 3 WS
+ *             (550 MHz 需要选项字节 CPUFREQ_BOOST, 未置位时降为 520 MHz)
+ *   balanced  PLL1 400 MHz, AXI/AHB 200 MHz, APB 100 MHz,   VOS1, 2 WS
+ *   lowpower  HSI 直出 64 MHz, 总线不分频,                  VOS3, 1 WS
+ * PLL1 参考为 HSI/32 = 2 MHz (宽 VCO), P 分频为 1, 核心频率 = 2 MHz * N.
+ *
+ * USART1/3/7 的内核时钟在高速档取 APB (波特率误差更小), 低功耗档取 HSI;
+ * 切换后由 uart_port_reclock() 按新频率重算 BRR, 波特率不变; hrtimer_tim_reclock()
+ * 重设 TIM2 分频, 高精度定时器保持 1 MHz.
+ *
+ * 切换在关中断下进行, PLL 锁定等 HAL 超时靠 board.c 的 HAL_GetTick 在关中断时
+ * 按 SysTick COUNTFLAG 计时; VOSRDY 的等待同样有超时. 提频前任何一步失败都留在 HSI.
+ */
+
+#include "clock_profile.h"
+#include "uart_port.h"
+#include "hrtimer.h"
+#include <rthw.h>
+
+#define CLOCK_PLL_M             32      /* HSI / 32 = 2 MHz */
+#define CLOCK_FLASH_LATENCY_MAX FLASH_LATENCY_3
+#define CLOCK_PLL_N_NO_BOOST    260     /* 未开 CPUFREQ_BOOST 时 VOS0 最高 520 MHz */
+#define CLOCK_VOS_TIMEOUT_MS    10
+
+static const struct clock_profile clock_profiles[CLOCK_PROFILE_NUM] =
+{
+    {
+        "perf", PWR_REGULATOR_VOLTAGE_SCALE0, 0, 275,
+        RCC_HCLK_DIV2, RCC_APB1_DIV2, RCC_APB2_DIV2, RCC_APB3_DIV2, RCC_APB4_DIV2, FLASH_LATENCY_3,
+        RCC_USART16CLKSOURCE_D2PCLK2, RCC_USART234578CLKSOURCE_D2PCLK1,
+    },
+    {
+        "balanced", PWR_REGULATOR_VOLTAGE_SCALE1, 1, 200,
+        RCC_HCLK_DIV2, RCC_APB1_DIV2, RCC_APB2_DIV2, RCC_APB3_DIV2, RCC_APB4_DIV2, FLASH_LATENCY_2,
+        RCC_USART16CLKSOURCE_D2PCLK2, RCC_USART234578CLKSOURCE_D2PCLK1,
+    },
+    {
+        "lowpower", PWR_REGULATOR_VOLTAGE_SCALE3, 3, 0,
+        RCC_HCLK_DIV1, RCC_APB1_DIV1, RCC_APB2_DIV1, RCC_APB3_DIV1, RCC_APB4_DIV1, FLASH_LATENCY_1,
+        RCC_USART16CLKSOURCE_HSI, RCC_USART234578CLKSOURCE_HSI,
+    },
+};
+
+static const struct clock_profile *clock_current = RT_NULL;
+static rt_uint8_t clock_vos_level = 3;      /* 复位后为 VOS3 */
+
+/* =================================================================================
+ * 1. 切换
+ * ================================================================================= */
+
+static rt_err_t clock_set_vos(const struct clock_profile *p)
+{
+    uint32_t tickstart;
+
+    __HAL_PWR_VOLTAGESCALING_CONFIG(p->vos);
+    tickstart = HAL_GetTick();
+    while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY))
+    {
+        if (HAL_GetTick() - tickstart > CLOCK_VOS_TIMEOUT_MS)
+            return -RT_ETIMEOUT;
+    }
+    clock_vos_level = p->vos_level;
+
+    return RT_EOK;
+}
+
+/* PLL1 倍频: 550 MHz 档位只在 CPUFREQ_BOOST 选项字节置位时可用 */
+static rt_uint16_t clock_pll_n(const struct clock_profile *p)
+{
+    if (p->pll_n > CLOCK_PLL_N_NO_BOOST && !(FLASH->OPTSR2_CUR & FLASH_OPTSR2_CPUFREQ_BOOST))
+        return CLOCK_PLL_N_NO_BOOST;
+
+    return p->pll_n;
+}
+
+rt_err_t clock_profile_apply(enum clock_profile_id id)
+{
+    const struct clock_profile *p;
+    RCC_OscInitTypeDef osc = {0};
+    RCC_ClkInitTypeDef clk = {0};
+    RCC_PeriphCLKInitTypeDef periph = {0};
+    rt_err_t result = RT_EOK;
+    rt_base_t level;
+
+    if ((int)id < 0 || id >= CLOCK_PROFILE_NUM)
+        return -RT_EINVAL;
+    p = &clock_profiles[id];
+
+    level = rt_hw_interrupt_disable();
+    uart_port_suspend();
+
+    /* 1. 先切回 HSI, PLL1 不再作为系统时钟才能重配; 过渡期用最大等待周期 */
+    clk.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2 |
+                    RCC_CLOCKTYPE_D3PCLK1 | RCC_CLOCKTYPE_D1PCLK1;
+    clk.SYSCLKSource   = RCC_SYSCLKSOURCE_HSI;
+    clk.SYSCLKDivider  = RCC_SYSCLK_DIV1;
+    clk.AHBCLKDivider  = RCC_HCLK_DIV1;
+    clk.APB1CLKDivider = RCC_APB1_DIV1;
+    clk.APB2CLKDivider = RCC_APB2_DIV1;
+    clk.APB3CLKDivider = RCC_APB3_DIV1;
+    clk.APB4CLKDivider = RCC_APB4_DIV1;
+    if (HAL_RCC_ClockConfig(&clk, CLOCK_FLASH_LATENCY_MAX) != HAL_OK)
+        result = -RT_ERROR;
+
+    /* 2. 升压在提频之前, 电压未就绪则不提频 */
+    if (result == RT_EOK && p->vos_level < clock_vos_level)
+        result = clock_set_vos(p);
+
+    /* 3. PLL1: HSI/32 * N / 1 */
+    osc.OscillatorType      = RCC_OSCILLATORTYPE_HSI;
+    osc.HSIState            = RCC_HSI_DIV1;
+    osc.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
+    if (p->pll_n != 0)
+    {
+        osc.PLL.PLLState  = RCC_PLL_ON;
+        osc.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+        osc.PLL.PLLM      = CLOCK_PLL_M;
+        osc.PLL.PLLN      = clock_pll_n(p);
+        osc.PLL.PLLP      = 1;
+        osc.PLL.PLLQ      = 4;
+        osc.PLL.PLLR      = 2;
+        osc.PLL.PLLRGE    = RCC_PLL1VCIRANGE_1;
+        osc.PLL.PLLVCOSEL = RCC_PLL1VCOWIDE;
+        osc.PLL.PLLFRACN  = 0;
+    }
+    else
+    {
+        osc.PLL.PLLState  = RCC_PLL_OFF;
+    }
+    if (result == RT_EOK && HAL_RCC_OscConfig(&osc) != HAL_OK)
+        result = -RT_ERROR;
+
+    /* 4. 目标分频与 Flash 等待周期 (PLL 失败时留在 HSI) */
+    if (result == RT_EOK)
+    {
+        clk.SYSCLKSource   = (p->pll_n != 0) ? RCC_SYSCLKSOURCE_PLLCLK : RCC_SYSCLKSOURCE_HSI;
+        clk.AHBCLKDivider  = p->ahb_div;
+        clk.APB1CLKDivider = p->apb1_div;
+        clk.APB2CLKDivider = p->apb2_div;
+        clk.APB3CLKDivider = p->apb3_div;
+        clk.APB4CLKDivider = p->apb4_div;
+        if (HAL_RCC_ClockConfig(&clk, p->flash_latency) != HAL_OK)
+            result = -RT_ERROR;
+    }
+
+    /* 5. 降压在降频之后; 超时时新频率已生效, 留在较高的电压上照常运行 */
+    if (result == RT_EOK)
+    {
+        clock_current = p;
+        if (p->vos_level > clock_vos_level)
+            result = clock_set_vos(p);
+    }
+    else
+    {
+        clock_current = RT_NULL;
+    }
+
+    /* 6. UART 内核时钟; 没有档位时是 HSI 直出、总线不分频, 取 APB */
+    periph.PeriphClockSelection      = RCC_PERIPHCLK_USART16 | RCC_PERIPHCLK_USART234578;
+    periph.Usart16ClockSelection     = clock_current ? clock_current->usart16_src : RCC_USART16CLKSOURCE_D2PCLK2;
+    periph.Usart234578ClockSelection = clock_current ? clock_current->usart234578_src :
+                                                       RCC_USART234578CLKSOURCE_D2PCLK1;
+    HAL_RCCEx_PeriphCLKConfig(&periph);
+
+    /* 7. HAL_RCC_ClockConfig 会把 SysTick 改回 1 kHz 的 HAL 节拍, 按 CPU 频率重装 */
+    HAL_SYSTICK_Config(SystemCoreClock / RT_TICK_PER_SECOND);
+    HAL_NVIC_SetPriority(SysTick_IRQn, 15, 0);
+
+    uart_port_reclock();
+    hrtimer_tim_reclock();
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+const struct clock_profile *clock_profile_current(void)
+{
+    return clock_current;
+}
+
+rt_uint32_t clock_profile_usart_hz(USART_TypeDef *instance)
+{
+    if (instance == USART1 || instance == USART6)
+    {
+        if (clock_current != RT_NULL && clock_current->usart16_src == RCC_USART16CLKSOURCE_HSI)
+            return HSI_VALUE;
+        return HAL_RCC_GetPCLK2Freq();
+    }
+
+    if (clock_current != RT_NULL && clock_current->usart234578_src == RCC_USART234578CLKSOURCE_HSI)
+        return HSI_VALUE;
+    return HAL_RCC_GetPCLK1Freq();
+}
+
+/* =================================================================================
+ * 2. 调试命令
+ * ================================================================================= */
+
+static int clock_profile(int argc, char **argv)
+{
+    int i;
+
+    if (argc > 1)
+    {
+        for (i = 0; i < CLOCK_PROFILE_NUM; i++)
+        {
+            if (rt_strcmp(argv[1], clock_profiles[i].name) == 0)
+                break;
+        }
+        if (i == CLOCK_PROFILE_NUM)
+        {
+            rt_kprintf("usage: clock_profile [perf|balanced|lowpower]\n");
+            return -1;
+        }
+        if (clock_profile_apply((enum clock_profile_id)i) != RT_EOK)
+            rt_kprintf("[ERR] switch to %s failed\n", clock_profiles[i].name);
+        /* 直方图以周期计数, 换档前后的样本不可比 */
+        rt_kprintf("clock changed, run 'lat_hist reset' before measuring\n");
+    }
+
+    rt_kprintf("profile  : %s\n", clock_current ? clock_current->name : "none");
+    rt_kprintf("cpu      : %d Hz\n", SystemCoreClock);
+    rt_kprintf("hclk     : %d Hz\n", HAL_RCC_GetHCLKFreq());
+    rt_kprintf("pclk1/2  : %d / %d Hz\n", HAL_RCC_GetPCLK1Freq(), HAL_RCC_GetPCLK2Freq());
+    rt_kprintf("usart1   : %d Hz kernel\n", clock_profile_usart_hz(USART1));
+    rt_kprintf("usart3/7 : %d Hz kernel\n", clock_profile_usart_hz(USART3));
+
+    return 0;
+}
+MSH_CMD_EXPORT(clock_profile, show or switch clock profile: clock_profile [perf|balanced|lowpower]);
@@ -0,0 +1,51 @@
+/* clock_profile.h - 系统时钟档位: PLL1/电压档位/Flash 等待/外设内核时钟, 运行时可切换 */
+#ifndef __CLOCK_PROFILE_H__
+#define __CLOCK_PROFILE_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+enum clock_profile_id
+{
+    CLOCK_PROFILE_PERF = 0,             /* 550 MHz (未开 CPUFREQ_BOOST 时 520 MHz), VOS0 */
+    CLOCK_PROFILE_BALANCED,             /* 400 MHz, VOS1 */
+    CLOCK_PROFILE_LOWPOWER,             /* 64 MHz HSI 直出, VOS3 */
+    CLOCK_PROFILE_NUM,
+};
+
+#ifndef CLOCK_PROFILE_DEFAULT
+#define CLOCK_PROFILE_DEFAULT   CLOCK_PROFILE_PERF
+#endif
+
+struct clock_profile
+{
+    const char          *name;
+    rt_uint32_t          vos;           /* PWR_REGULATOR_VOLTAGE_SCALEx */
+    rt_uint8_t           vos_level;     /* 0~3, 越小电压越高 */
+    rt_uint16_t          pll_n;         /* PLL1 倍频 (HSI/32 = 2 MHz 参考, P=1); 0 表示直接用 HSI */
+    rt_uint32_t          ahb_div;       /* RCC_HCLK_DIVx: AXI/AHB, CRYP 在 AHB2 上, 没有独立内核时钟 */
+    rt_uint32_t          apb1_div;
+    rt_uint32_t          apb2_div;
+    rt_uint32_t          apb3_div;
+    rt_uint32_t          apb4_div;
+    rt_uint32_t          flash_latency;
+    rt_uint32_t          usart16_src;   /* USART1 内核时钟 */
+    rt_uint32_t          usart234578_src; /* USART3/UART7 内核时钟 */
+};
+
+/*
+ * 切换到指定档位: 先切回 HSI 再重配 PLL1, 升压在提频之前、降压在降频之后,
+ * 然后按新的 CPU 频率重装 SysTick, 并重新计算各 UART 的 BRR 和 TIM2 的分频.
+ * 切换期间关中断 (数百微秒), 正在收发的字节可能损坏, 桥接按 CRC 丢帧.
+ * PLL 不锁定或升压超时返回错误, clock_profile_current() 为 RT_NULL, 系统留在
+ * HSI 64 MHz; 降压超时也返回错误, 但新档位已生效, 只是电压留在原来的档位.
+ */
+rt_err_t clock_profile_apply(enum clock_profile_id id);
+
+/* 当前档位; 启动前或切换失败后为 RT_NULL */
+const struct clock_profile *clock_profile_current(void);
+
+/* UART 内核时钟频率, 按当前档位的时钟源计算 */
+rt_uint32_t clock_profile_usart_hz(USART_TypeDef *instance);
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ * console.c - 调试串口 (USART3) 控制台: DMA 异步输出与 DMA 接收
+ *
+ * 收发都经过 uart_port ("uart3"):
+ * rt_kprintf 的输出在关中断下展开 CRLF 并拷入端口发送队列, 立即返回;
+ * TX DMA 按队列中的连续段依次发送. 队列满时按策略丢弃或 (仅线程上下文) 等待;
+ * 丢弃策略只针对中断和高优先级线程, finsh 等低优先级线程仍等待.
+ *
+ * 输入由 DMA 写入端口接收缓冲区, 线路空闲事件释放信号量, finsh 线程
+ * 在信号量上阻塞等待, 空闲时不再周期唤醒.
+ *
+ * panic 模式下端口切换为同步模式, 把队列剩余内容与之后的输出都以轮询
+ * 方式直接写 TDR, 不依赖中断和 HAL 句柄状态, 断言和硬件异常中也能使用.
+ */
+
+#include "console.h"
+#include "board.h"
+#include <rthw.h>
+
+static struct
+{
+    struct uart_port    *port;
+
+    rt_uint8_t           policy;
+    volatile rt_uint8_t  panic;
+    struct rt_semaphore  space;         /* 阻塞策略下等待空间 */
+    rt_uint16_t          waiters;       /* 尚未被发送完成计数的等待者, 见 console_wait_cancel */
+
+    struct rt_semaphore  rx_sem;        /* 有新输入时释放, 消费者醒来后取空 */
+
+    /* 统计 */
+    rt_uint32_t          bytes;
+    rt_uint32_t          dropped;       /* 丢弃的输出条数 */
+    rt_uint32_t          dropped_bytes;
+    rt_uint32_t          blocked;       /* 等待空间的次数 */
+    rt_uint32_t          rx_bytes;
+} console;
+
+/* =================================================================================
+ * 1. 轮询发送 (panic 模式)
+ * ================================================================================= */
+
+static void console_poll_write(const char *str, rt_size_t len, rt_bool_t raw)
+{
+    if (console.port == RT_NULL)
+        return;
+
+    while (len--)
+    {
+        if (*str == '\n' && !raw)
+            uart_port_putc(console.port, '\r');
+        uart_port_putc(console.port, *str++);
+    }
+}
+
+/* =================================================================================
+ * 2. 发送完成 (中断上下文)
+ * ================================================================================= */
+
+static void console_tx_done(void *param)
+{
+    rt_base_t level;
+
+    /* 唤醒全部等待者, 各自重新检查空间 */
+    level = rt_hw_interrupt_disable();
+    while (console.waiters > 0)
+    {
+        console.waiters--;
+        rt_sem_release(&console.space);
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+/* =================================================================================
+ * 3. 入队
+ * ================================================================================= */
+
+/*
+ * 等待超时后撤销本线程的等待 (关中断调用). 超时与发送完成可能交错: 发送完成
+ * 已把本线程从 waiters 中减去并释放了一次信号量, 而本线程已不在信号量上挂起.
+ * 此时信号量上留有这次释放, 取走它即可; 否则本线程仍计在 waiters 中, 撤销计数.
+ * 任一等待者在等待期间, waiters 加信号量值等于等待者数, 两种情况都保持这一点.
+ */
+static void console_wait_cancel(void)
+{
+    if (rt_sem_trytake(&console.space) != RT_EOK)
+    {
+        RT_ASSERT(console.waiters > 0);
+        console.waiters--;
+    }
+}
+
+/*
+ * 只有调度已启动的普通线程、且调用前中断是打开的, 才允许等待;
+ * 丢弃策略下再限于低优先级线程
+ */
+static rt_bool_t console_can_block(rt_base_t level)
+{
+    rt_thread_t self = rt_thread_self();
+
+    if (level != 0 || rt_interrupt_get_nest() != 0 || self == RT_NULL || self == rt_thread_idle_gethandler())
+        return RT_FALSE;
+
+    return console.policy == CONSOLE_POLICY_BLOCK || self->current_priority >= CONSOLE_BLOCK_PRIORITY;
+}
+
+static void console_enqueue(const char *str, rt_size_t len, rt_bool_t raw)
+{
+    rt_size_t need = len, start, i;
+    rt_base_t level;
+
+    for (i = 0; i < len && !raw; i++)
+    {
+        if (str[i] == '\n')
+            need++;
+    }
+
+    level = rt_hw_interrupt_disable();
+    while (uart_port_tx_space(console.port) < need)
+    {
+        if (!console_can_block(level))
+        {
+            console.dropped++;
+            console.dropped_bytes += need;
+            rt_hw_interrupt_enable(level);
+            return;
+        }
+
+        console.blocked++;
+        console.waiters++;
+        rt_hw_interrupt_enable(level);
+        if (rt_sem_take(&console.space, rt_tick_from_millisecond(CONSOLE_TX_BLOCK_MS)) != RT_EOK)
+        {
+            level = rt_hw_interrupt_disable();
+            console_wait_cancel();
+            console.dropped++;
+            console.dropped_bytes += need;
+            rt_hw_interrupt_enable(level);
+            return;
+        }
+        level = rt_hw_interrupt_disable();
+    }
+
+    /* 按行分段入队, 全部放入后只启动一次 DMA */
+    for (start = 0, i = 0; i < len && !raw; i++)
+    {
+        if (str[i] == '\n')
+        {
+            uart_port_tx_put(console.port, str + start, i - start);
+            uart_port_tx_put(console.port, "\r", 1);
+            start = i;
+        }
+    }
+    uart_port_tx_put(console.port, str + start, len - start);
+    console.bytes += need;
+
+    uart_port_tx_kick(console.port);
+    rt_hw_interrupt_enable(level);
+}
+
+void console_output(const char *str)
+{
+    rt_size_t len;
+
+    if (console.port == RT_NULL || console.panic)
+    {
+        console_poll_write(str, rt_strlen(str), RT_FALSE);
+        return;
+    }
+
+    /* 长输出 (如 msh help) 分段入队 */
+    while (*str)
+    {
+        for (len = 0; len < CONSOLE_TX_CHUNK && str[len]; len++);
+        console_enqueue(str, len, RT_FALSE);
+        str += len;
+    }
+}
+
+void console_write(const void *data, rt_size_t len)
+{
+    if (console.port == RT_NULL || console.panic)
+    {
+        console_poll_write((const char *)data, len, RT_TRUE);
+        return;
+    }
+
+    console_enqueue((const char *)data, len, RT_TRUE);
+}
+
+void console_set_policy(enum console_policy policy)
+{
+    console.policy = policy;
+}
+
+rt_err_t console_wait_space(rt_size_t size)
+{
+    rt_err_t result = RT_EOK;
+    rt_base_t level;
+
+    if (console.port == RT_NULL || console.panic)
+        return RT_EOK;
+
+    level = rt_hw_interrupt_disable();
+    while (uart_port_tx_space(console.port) < size)
+    {
+        if (level != 0 || rt_interrupt_get_nest() != 0 || rt_thread_self() == RT_NULL)
+        {
+            result = -RT_EBUSY;
+            break;
+        }
+
+        console.waiters++;
+        rt_hw_interrupt_enable(level);
+        result = rt_sem_take(&console.space, rt_tick_from_millisecond(CONSOLE_TX_BLOCK_MS));
+        level = rt_hw_interrupt_disable();
+        if (result != RT_EOK)
+        {
+            console_wait_cancel();
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+rt_uint32_t console_dropped(void)
+{
+    return console.dropped;
+}
+
+/* =================================================================================
+ * 4. 接收
+ * ================================================================================= */
+
+static void console_rx_event(void *param, rt_uint16_t pos)
+{
+    /* 消费者每次醒来都会取空缓冲区, 信号量不必逐事件计数 */
+    if (console.rx_sem.value == 0)
+        rt_sem_release(&console.rx_sem);
+}
+
+int console_getchar(void)
+{
+    char ch;
+
+    while (uart_port_read(console.port, &ch, 1) == 0)
+        rt_sem_take(&console.rx_sem, RT_WAITING_FOREVER);
+    console.rx_bytes++;
+
+    return (rt_uint8_t)ch;
+}
+
+/* =================================================================================
+ * 5. panic 模式
+ * ================================================================================= */
+
+void console_panic(void)
+{
+    console.panic = 1;
+    if (console.port != RT_NULL)
+        uart_port_sync(console.port);
+}
+
+#ifdef RT_DEBUG
+static void console_assert_hook(const char *ex, const char *func, rt_size_t line)
+{
+    volatile char dummy = 0;
+
+    console_panic();
+    rt_kprintf("(%s) assertion failed at function:%s, line number:%d \n", ex, func, line);
+    while (dummy == 0);
+}
+#endif
+
+static rt_err_t console_exception_hook(void *context)
+{
+    console_panic();
+
+    /* 继续由 cpuport.c 打印寄存器现场 */
+    return -RT_ERROR;
+}
+
+/* =================================================================================
+ * 6. 初始化
+ * ================================================================================= */
+
+rt_err_t console_init(struct uart_port *port)
+{
+    rt_err_t result;
+
+    if (port == RT_NULL)
+        return -RT_ERROR;
+
+    console.policy = CONSOLE_TX_POLICY;
+
+#ifdef RT_DEBUG
+    rt_assert_set_hook(console_assert_hook);
+#endif
+    rt_hw_exception_install(console_exception_hook);
+
+    rt_sem_init(&console.space, "con", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&console.rx_sem, "conrx", 0, RT_IPC_FLAG_FIFO);
+    uart_port_set_rx_callback(port, console_rx_event, RT_NULL, RT_NULL);
+    uart_port_set_tx_callback(port, console_tx_done, RT_NULL);
+
+    /* 发送队列分配失败时端口退回轮询发送, 输出仍可用 */
+    result = uart_port_open(port, UART_PORT_DMA_RX | UART_PORT_DMA_TX);
+
+    /* 最后设置 port, 之后的输出才进入端口 */
+    console.port = port;
+
+    return result;
+}
+
+/* =================================================================================
+ * 7. 调试命令
+ * ================================================================================= */
+
+static int console_stat(int argc, char **argv)
+{
+    struct uart_port *port = console.port;
+
+    if (argc > 1)
+    {
+        if (rt_strcmp(argv[1], "drop") == 0)
+            console_set_policy(CONSOLE_POLICY_DROP);
+        else if (rt_strcmp(argv[1], "block") == 0)
+            console_set_policy(CONSOLE_POLICY_BLOCK);
+        else
+        {
+            rt_kprintf("usage: console_stat [drop|block]\n");
+            return -1;
+        }
+    }
+
+    if (port == RT_NULL)
+        return -1;
+
+    if (console.policy == CONSOLE_POLICY_BLOCK)
+        rt_kprintf("mode     : %s, policy block\n", console.panic ? "panic" : (port->tx_buf ? "dma" : "poll"));
+    else
+        rt_kprintf("mode     : %s, policy drop (priority >= %d blocks)\n",
+                   console.panic ? "panic" : (port->tx_buf ? "dma" : "poll"), CONSOLE_BLOCK_PRIORITY);
+    rt_kprintf("bytes    : %d\n", console.bytes);
+    rt_kprintf("used     : %d / %d (max %d)\n", port->tx_head - port->tx_tail, port->hw->tx_size,
+               port->tx_max_used);
+    rt_kprintf("dropped  : %d (%d bytes)\n", console.dropped, console.dropped_bytes);
+    rt_kprintf("blocked  : %d\n", console.blocked);
+    rt_kprintf("errors   : %d\n", port->tx_errors);
+    rt_kprintf("rx       : %d bytes, restart %d, overrun %d, error %d\n", console.rx_bytes,
+               port->rx_restarts, port->overruns, port->line_errors);
+
+    return 0;
+}
+MSH_CMD_EXPORT(console_stat, console output stats and overflow policy: console_stat [drop|block]);
@@ -0,0 +1,64 @@
+/* console.h - 调试串口 (USART3) 控制台: DMA 异步输出与 DMA 接收 */
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <rtthread.h>
+#include "uart_port.h"
+
+/* 收发缓冲区大小见 uart_port.c 端口表 ("uart3") */
+#define CONSOLE_TX_CHUNK        128     /* 单次入队上限, 限制关中断时间 */
+#define CONSOLE_TX_BLOCK_MS     250     /* 等待空间的上限, 超时丢弃; 长于整个队列的一次 DMA (约 180 ms) */
+
+/* 缓冲区满时的处理策略 */
+enum console_policy
+{
+    CONSOLE_POLICY_DROP = 0,            /* 丢弃整条输出; 低优先级线程 (见 CONSOLE_BLOCK_PRIORITY) 仍等待 */
+    CONSOLE_POLICY_BLOCK,               /* 线程上下文等待 DMA 腾出空间; 中断/关中断时仍丢弃 */
+};
+
+#ifndef CONSOLE_TX_POLICY
+#define CONSOLE_TX_POLICY       CONSOLE_POLICY_DROP
+#endif
+
+/*
+ * 丢弃策略下, 优先级数值不小于此值的线程 (finsh、blog 等) 队列满时仍等待,
+ * 命令输出不被截断; 桥接、CRYP 等高优先级线程和中断从不因控制台阻塞
+ */
+#ifndef CONSOLE_BLOCK_PRIORITY
+#define CONSOLE_BLOCK_PRIORITY  16
+#endif
+
+/* uart_port_init() 之后调用, 以发送队列和 DMA 接收打开端口; 之前的输出丢弃 */
+rt_err_t console_init(struct uart_port *port);
+
+/* rt_hw_console_output 的实现: LF 在入队时展开为 CRLF */
+void     console_output(const char *str);
+
+/*
+ * 原样输出二进制数据 (不展开换行), 整段一次入队, 不会与其他输出交错;
+ * len 不超过发送队列大小. 用于 blog 二进制包.
+ */
+void     console_write(const void *data, rt_size_t len);
+
+void     console_set_policy(enum console_policy policy);
+
+/*
+ * 等待发送队列至少有 size 字节空闲 (线程上下文, 与策略无关, 超时见
+ * CONSOLE_TX_BLOCK_MS). 大段输出 (如 trace dump) 逐行先等待再输出, 不会被丢弃;
+ * 中断或关中断时返回 -RT_EBUSY
+ */
+rt_err_t console_wait_space(rt_size_t size);
+
+/* 累计丢弃的输出条数, 调用者前后相减可知一段输出是否完整 */
+rt_uint32_t console_dropped(void);
+
+/* rt_hw_console_getchar 的实现: 阻塞到收到一个字符 (finsh 线程调用) */
+int      console_getchar(void);
+
+/*
+ * 进入 panic 模式: 端口切换为同步模式 (见 uart_port_sync), 之后所有输出
+ * 都以轮询方式直接写 UART. 用于断言失败和硬件异常, 不再恢复.
+ */
+void     console_panic(void);
+
+#endif
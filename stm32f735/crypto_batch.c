@@ -0,0 +1,360 @@
+/*
+ * crypto_batch.c - CRYP 服务线程
+ *
+ * CRYP 只由本文件的服务线程操作, 各端口通过无锁任务队列提交任务
+ * 描述符, 出错复位也只在服务线程内进行, 不会打断另一端口的在途任务.
+ *
+ * 每个任务是若干连续 16 字节块 (一帧载荷), 按批处理上限分段, 每段一次
+ * HAL_CRYP_Encrypt_DMA / HAL_CRYP_Decrypt_DMA 提交. 服务线程优先挑选与上一任务同方向的任务,
+ * 减少加密/解密之间的密钥准备切换 (见 crypto_key.c); 同方向连续处理
+ * CRYPTO_SERVER_MAX_BURST 个任务后让出给另一方向. 同一端口内的任务
+ * 始终按提交顺序执行.
+ */
+
+#include "crypto_batch.h"
+#include "crypto_key.h"
+#include "lat_hist.h"
+#include "bridge_rx.h"
+#include "blog.h"
+#include <rthw.h>
+#include <stdlib.h>
+
+extern void MX_CRYP_Init(void);
+
+static CRYP_HandleTypeDef *cryp = RT_NULL;
+
+static struct crypto_port *port_table[CRYPTO_PORT_MAX];
+
+/* 待处理任务计数: 每次提交释放一次 */
+static struct rt_semaphore job_sem;
+
+/* DMA 完成信号: 完成/出错中断释放 */
+static struct rt_semaphore done_sem;
+static volatile rt_err_t done_result;
+
+static volatile rt_size_t batch_limit = CRYPTO_BATCH_MAX_BLOCKS;   /* msh 线程可随时修改 */
+
+/* 调度状态 (仅服务线程访问) */
+static rt_uint8_t  cur_dir = CRYPTO_ENCRYPT;
+static rt_uint32_t burst;
+static int         rr_idx;
+
+/* 服务线程统计 */
+static rt_uint32_t dir_switches;
+static rt_uint32_t resets;
+
+/* =================================================================================
+ * 1. 端口与任务提交
+ * ================================================================================= */
+
+void crypto_port_register(struct crypto_port *port, const char *name)
+{
+    int i;
+
+    rt_memset(port, 0, sizeof(struct crypto_port));
+    port->name = name;
+    port->last_tick = rt_tick_get();
+
+    for (i = 0; i < CRYPTO_PORT_MAX; i++)
+    {
+        if (port_table[i] == RT_NULL)
+        {
+            port_table[i] = port;
+            break;
+        }
+    }
+}
+
+rt_size_t crypto_batch_limit(void)
+{
+    return batch_limit;
+}
+
+rt_err_t crypto_port_submit(struct crypto_port *port, const struct crypto_job *job)
+{
+    rt_uint32_t head = port->head;
+    rt_uint32_t depth;
+
+    RT_ASSERT(job->nblocks > 0 && job->nblocks <= CRYPTO_BATCH_MAX_BLOCKS);
+    RT_ASSERT(job->done != RT_NULL);
+
+    depth = head - port->tail;
+    if (depth >= CRYPTO_PORT_QUEUE_DEPTH)
+        return -RT_EFULL;
+
+    port->queue[head % CRYPTO_PORT_QUEUE_DEPTH] = *job;
+    port->queue[head % CRYPTO_PORT_QUEUE_DEPTH].submit_cycles = lat_now();
+    __DMB();
+    port->head = head + 1;
+
+    if (depth + 1 > port->depth_max) port->depth_max = depth + 1;
+
+    rt_sem_release(&job_sem);
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 2. 服务线程
+ * ================================================================================= */
+
+/* DMA 完成/出错回调 (CRYP 注册回调默认指向这两个弱函数) */
+void HAL_CRYP_OutCpltCallback(CRYP_HandleTypeDef *hcryp)
+{
+    done_result = RT_EOK;
+    rt_sem_release(&done_sem);
+}
+
+void HAL_CRYP_ErrorCallback(CRYP_HandleTypeDef *hcryp)
+{
+    done_result = -RT_EIO;
+    rt_sem_release(&done_sem);
+}
+
+/* 选下一个端口: 优先同方向, 连续过多或无同方向任务时切换方向 */
+static struct crypto_port *crypto_server_pick(void)
+{
+    struct crypto_port *port, *same = RT_NULL, *other = RT_NULL;
+    int i, idx, same_idx = 0, other_idx = 0;
+
+    for (i = 1; i <= CRYPTO_PORT_MAX; i++)
+    {
+        idx  = (rr_idx + i) % CRYPTO_PORT_MAX;
+        port = port_table[idx];
+        if (port == RT_NULL || port->head == port->tail)
+            continue;
+
+        if (port->queue[port->tail % CRYPTO_PORT_QUEUE_DEPTH].dir == cur_dir)
+        {
+            if (same == RT_NULL) { same = port; same_idx = idx; }
+        }
+        else
+        {
+            if (other == RT_NULL) { other = port; other_idx = idx; }
+        }
+    }
+
+    if (same != RT_NULL && (other == RT_NULL || burst < CRYPTO_SERVER_MAX_BURST))
+    {
+        burst++;
+        rr_idx = same_idx;
+        return same;
+    }
+
+    if (other != RT_NULL)
+    {
+        cur_dir = !cur_dir;
+        burst = 1;
+        dir_switches++;
+        rr_idx = other_idx;
+    }
+
+    return other;
+}
+
+/* 在途任务超时: 复位 CRYP (仅服务线程调用) */
+static void crypto_server_reset(void)
+{
+    HAL_CRYP_DeInit(cryp);
+    MX_CRYP_Init();
+    crypto_key_invalidate();
+    resets++;
+}
+
+/* 启动一段 DMA 并等待完成 */
+static rt_err_t crypto_server_dma(rt_uint8_t dir, const rt_uint8_t *in, rt_uint8_t *out, rt_size_t size)
+{
+    HAL_StatusTypeDef status;
+
+    /* 丢弃复位前迟到的完成信号 */
+    rt_sem_control(&done_sem, RT_IPC_CMD_RESET, RT_NULL);
+
+    if (dir == CRYPTO_ENCRYPT)
+        status = HAL_CRYP_Encrypt_DMA(cryp, (uint32_t *)in, size, (uint32_t *)out);
+    else
+        status = HAL_CRYP_Decrypt_DMA(cryp, (uint32_t *)in, size, (uint32_t *)out);
+
+    if (status != HAL_OK)
+        return -RT_EBUSY;
+
+    if (rt_sem_take(&done_sem, rt_tick_from_millisecond(CRYPTO_BATCH_TIMEOUT_MS)) != RT_EOK)
+    {
+        BLOG("[cryp] timeout, reset\n");
+        crypto_server_reset();
+        return -RT_ETIMEOUT;
+    }
+
+    return done_result;
+}
+
+/*
+ * 任务按批处理上限分段执行, 每段一次 HAL 调用. 上限在入口读一次: crypto_batch
+ * 命令可能在任务中途修改它, 缓存回写/失效与分段路径须按同一个值决定.
+ */
+static rt_err_t crypto_server_run(const struct crypto_job *job)
+{
+    rt_size_t limit = batch_limit;
+    rt_size_t size = job->nblocks * BRIDGE_BLOCK_SIZE;
+    rt_size_t offset, chunk;
+    HAL_StatusTypeDef status;
+    rt_err_t result;
+
+    result = crypto_key_select(cryp, job->key, job->dir);
+    if (result != RT_EOK)
+        return result;
+
+    if (limit > 1)
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, (void *)job->in, size);
+
+    for (offset = 0; offset < size; offset += chunk)
+    {
+        chunk = limit * BRIDGE_BLOCK_SIZE;
+        if (chunk > size - offset) chunk = size - offset;
+
+        if (limit == 1)
+        {
+            /* 单块轮询路径 (对比基准) */
+            if (job->dir == CRYPTO_ENCRYPT)
+                status = HAL_CRYP_Encrypt(cryp, (uint32_t *)(job->in + offset), chunk,
+                                          (uint32_t *)(job->out + offset), CRYPTO_BATCH_TIMEOUT_MS);
+            else
+                status = HAL_CRYP_Decrypt(cryp, (uint32_t *)(job->in + offset), chunk,
+                                          (uint32_t *)(job->out + offset), CRYPTO_BATCH_TIMEOUT_MS);
+
+            result = (status == HAL_OK) ? RT_EOK : -RT_EIO;
+        }
+        else
+        {
+            result = crypto_server_dma(job->dir, job->in + offset, job->out + offset, chunk);
+        }
+
+        if (result != RT_EOK)
+            return result;
+    }
+
+    if (limit > 1)
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, job->out, size);
+
+    return RT_EOK;
+}
+
+static void crypto_server_entry(void *parameter)
+{
+    struct crypto_port *port;
+    struct crypto_job job;
+    rt_uint32_t lat;
+    rt_err_t result;
+
+    while (1)
+    {
+        rt_sem_take(&job_sem, RT_WAITING_FOREVER);
+
+        port = crypto_server_pick();
+        RT_ASSERT(port != RT_NULL);
+
+        /* 拷出后立即归还队列项 */
+        job = port->queue[port->tail % CRYPTO_PORT_QUEUE_DEPTH];
+        __DMB();
+        port->tail++;
+
+        if (job.cycles != RT_NULL) job.cycles[0] = lat_now();
+        result = crypto_server_run(&job);
+        if (job.cycles != RT_NULL) job.cycles[1] = lat_now();
+
+        if (result == RT_EOK)
+        {
+            port->blocks += job.nblocks;
+            port->batches++;
+            if (job.nblocks > port->max_batch) port->max_batch = job.nblocks;
+        }
+        else
+        {
+            /* 失败时 HAL 可能已置位 KeyIVConfig 而密钥未装好 */
+            crypto_key_invalidate();
+            port->errors++;
+        }
+
+        /* 按完成时的主频换算; 提交时的 tick 只有 1 ms 分辨率, 短任务全部记为 0 */
+        lat = lat_us(lat_now() - job.submit_cycles);
+        port->lat_sum += lat;
+        if (lat > port->lat_max) port->lat_max = lat;
+
+        job.done(job.param, result);
+    }
+}
+
+rt_err_t crypto_server_init(CRYP_HandleTypeDef *hcryp)
+{
+    rt_thread_t tid;
+
+    cryp = hcryp;
+
+    rt_sem_init(&job_sem, "cjob", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&done_sem, "cdone", 0, RT_IPC_FLAG_FIFO);
+
+    tid = rt_thread_create("cryp", crypto_server_entry, RT_NULL,
+                           CRYPTO_SERVER_STACK_SIZE, CRYPTO_SERVER_PRIORITY, 5);
+    if (tid == RT_NULL)
+        return -RT_ENOMEM;
+
+    return rt_thread_startup(tid);
+}
+
+/* =================================================================================
+ * 3. 调试命令
+ * ================================================================================= */
+
+static int crypto_batch(int argc, char **argv)
+{
+    int n;
+
+    if (argc > 1)
+    {
+        n = atoi(argv[1]);
+        if (n < 1 || n > CRYPTO_BATCH_MAX_BLOCKS)
+        {
+            rt_kprintf("batch limit must be 1..%d\n", CRYPTO_BATCH_MAX_BLOCKS);
+            return -RT_EINVAL;
+        }
+        batch_limit = n;
+    }
+
+    rt_kprintf("batch limit: %d block(s)%s\n", batch_limit,
+               batch_limit == 1 ? " (single-block polling)" : " (DMA)");
+    return 0;
+}
+MSH_CMD_EXPORT(crypto_batch, show or set CRYP batch limit);
+
+static int crypto_stat(void)
+{
+    rt_tick_t now = rt_tick_get();
+    rt_uint32_t rate, avg, lat_avg;
+    int i;
+
+    rt_kprintf("port     blocks/s  blocks     batches    avg  max  errors queue qmax lat_avg lat_max\n");
+    rt_kprintf("-------- --------- ---------- ---------- ---- ---- ------ ----- ---- ------- -------\n");
+    for (i = 0; i < CRYPTO_PORT_MAX; i++)
+    {
+        struct crypto_port *port = port_table[i];
+        rt_uint32_t jobs;
+
+        if (port == RT_NULL) continue;
+
+        rate = 0;
+        if (now != port->last_tick)
+            rate = (rt_uint64_t)(port->blocks - port->last_blocks) * RT_TICK_PER_SECOND / (now - port->last_tick);
+        avg = port->batches ? port->blocks / port->batches : 0;
+        jobs = port->batches + port->errors;
+        lat_avg = jobs ? (rt_uint32_t)(port->lat_sum / jobs) : 0;
+
+        rt_kprintf("%-8.*s %9d %10d %10d %4d %4d %6d %5d %4d %7d %7d\n", RT_NAME_MAX, port->name,
+                   rate, port->blocks, port->batches, avg, port->max_batch, port->errors,
+                   crypto_port_pending(port), port->depth_max, lat_avg, port->lat_max);
+
+        port->last_blocks = port->blocks;
+        port->last_tick = now;
+    }
+    rt_kprintf("latency in us, dir switches: %d, resets: %d\n", dir_switches, resets);
+
+    return 0;
+}
+MSH_CMD_EXPORT(crypto_stat, show CRYP throughput since last call);
@@ -0,0 +1,83 @@
+/* crypto_batch.h - CRYP 服务线程: 多端口共享的批处理任务队列 */
+#ifndef __CRYPTO_BATCH_H__
+#define __CRYPTO_BATCH_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+#define CRYPTO_BATCH_MAX_BLOCKS     16      /* 单次 DMA 提交的块数上限 */
+#define CRYPTO_BATCH_TIMEOUT_MS     100
+#define CRYPTO_PORT_MAX             8
+#define CRYPTO_PORT_QUEUE_DEPTH     4       /* 每端口任务队列深度 (2 的幂, 不小于流水线槽数) */
+#define CRYPTO_SERVER_MAX_BURST     8       /* 同方向连续处理上限, 防止另一方向饿死 */
+
+#define CRYPTO_SERVER_STACK_SIZE    1024
+#define CRYPTO_SERVER_PRIORITY      14      /* 高于端口线程, 完成后尽快回调 */
+
+enum crypto_dir
+{
+    CRYPTO_ENCRYPT = 0,
+    CRYPTO_DECRYPT,
+};
+
+/* 任务完成回调: 在服务线程上下文调用 */
+typedef void (*crypto_done_t)(void *param, rt_err_t result);
+
+/* 任务描述符, 提交时按值拷入端口队列 */
+struct crypto_job
+{
+    rt_uint8_t          dir;            /* enum crypto_dir */
+    rt_uint8_t          key;            /* 密钥槽, 见 crypto_key.h */
+    rt_uint16_t         nblocks;
+    const rt_uint8_t   *in;             /* DMA 缓冲, 来自 board_dma_alloc */
+    rt_uint8_t         *out;
+    crypto_done_t       done;
+    void               *param;
+    rt_uint32_t        *cycles;         /* 可选: 写入 CRYP 开始/结束的 DWT 周期数 */
+    rt_uint32_t         submit_cycles;  /* 由 crypto_port_submit 填写 (lat_now) */
+};
+
+/* 提交端口: 端口线程单生产者, 服务线程单消费者 */
+struct crypto_port
+{
+    const char          *name;
+
+    struct crypto_job    queue[CRYPTO_PORT_QUEUE_DEPTH];
+    volatile rt_uint32_t head;
+    volatile rt_uint32_t tail;
+
+    /* 吞吐统计 */
+    rt_uint32_t          blocks;
+    rt_uint32_t          batches;
+    rt_uint32_t          max_batch;
+    rt_uint32_t          errors;
+
+    /* 调优: 提交到完成的延迟 (us) 与队列深度 */
+    rt_uint64_t          lat_sum;
+    rt_uint32_t          lat_max;
+    rt_uint32_t          depth_max;
+
+    /* crypto_stat 命令上次采样点, 用于计算 blocks/s */
+    rt_uint32_t          last_blocks;
+    rt_tick_t            last_tick;
+};
+
+/* 创建服务线程, 此后只有该线程操作 CRYP */
+rt_err_t  crypto_server_init(CRYP_HandleTypeDef *hcryp);
+void      crypto_port_register(struct crypto_port *port, const char *name);
+
+/* 当前批处理上限 (块); 为 1 时走原单块轮询路径, 便于对比 */
+rt_size_t crypto_batch_limit(void);
+
+/*
+ * 提交一个任务 (不阻塞). 无论成败, done 都会被调用一次.
+ * 队列满时返回 -RT_EFULL, 此时不会回调.
+ */
+rt_err_t  crypto_port_submit(struct crypto_port *port, const struct crypto_job *job);
+
+rt_inline rt_size_t crypto_port_pending(struct crypto_port *port)
+{
+    return port->head - port->tail;
+}
+
+#endif
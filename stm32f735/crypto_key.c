@@ -0,0 +1,104 @@
+/*
+ * crypto_key.c - CRYP 密钥槽管理
+ *
+ * MX_CRYP_Init 使用 CRYP_KEYIVCONFIG_ONCE: HAL 只在 hcryp->KeyIVConfig
+ * 为 0 时写密钥 (解密时还要执行一次 ALGOMODE_AES_KEY 密钥准备).
+ * 本文件记录硬件中当前的 (槽, 方向) 上下文, 只有槽或方向变化时才
+ * 清零 KeyIVConfig 让 HAL 重新装载; 连续同槽同方向的任务直接复用.
+ *
+ * CRYP 密钥寄存器只写, 解密准备后的密钥无法读回保存, 所以硬件中
+ * 同一时刻只缓存一个上下文; CRYP 服务线程按方向聚合任务 (见
+ * crypto_batch.c), 使这一个上下文尽可能长时间有效.
+ */
+
+#include "crypto_key.h"
+#include "crypto_batch.h"
+
+#define CRYPTO_KEY_NONE     0xFF
+
+static const rt_uint32_t *key_table[CRYPTO_KEY_SLOTS];
+static struct crypto_key_stat key_stat[CRYPTO_KEY_SLOTS];
+
+/* 硬件中已装载的上下文 */
+static rt_uint8_t loaded_slot = CRYPTO_KEY_NONE;
+static rt_uint8_t loaded_dir;
+
+rt_err_t crypto_key_set(rt_uint8_t slot, const rt_uint32_t *key)
+{
+    if (slot >= CRYPTO_KEY_SLOTS || key == RT_NULL)
+        return -RT_EINVAL;
+
+    key_table[slot] = key;
+
+    /* 替换了正在使用的密钥, 下次必须重新装载 */
+    if (slot == loaded_slot)
+        loaded_slot = CRYPTO_KEY_NONE;
+
+    return RT_EOK;
+}
+
+void crypto_key_invalidate(void)
+{
+    loaded_slot = CRYPTO_KEY_NONE;
+}
+
+rt_err_t crypto_key_select(CRYP_HandleTypeDef *hcryp, rt_uint8_t slot, rt_uint8_t dir)
+{
+    CRYP_ConfigTypeDef conf;
+
+    if (slot >= CRYPTO_KEY_SLOTS || key_table[slot] == RT_NULL)
+        return -RT_EINVAL;
+
+    if (slot == loaded_slot && dir == loaded_dir && hcryp->KeyIVConfig == 1U)
+    {
+        key_stat[slot].avoided++;
+        return RT_EOK;
+    }
+
+    if (hcryp->Init.pKey != key_table[slot])
+    {
+        HAL_CRYP_GetConfig(hcryp, &conf);
+        conf.pKey = (uint32_t *)key_table[slot];
+        conf.KeyIVConfigSkip = CRYP_KEYIVCONFIG_ONCE;
+        if (HAL_CRYP_SetConfig(hcryp, &conf) != HAL_OK)
+        {
+            loaded_slot = CRYPTO_KEY_NONE;
+            return -RT_EBUSY;
+        }
+    }
+
+    /* 下一次 HAL 加解密调用重新写密钥 (解密含密钥准备) */
+    hcryp->KeyIVConfig = 0U;
+    loaded_slot = slot;
+    loaded_dir  = dir;
+
+    if (dir == CRYPTO_ENCRYPT)
+        key_stat[slot].enc_loads++;
+    else
+        key_stat[slot].dec_preps++;
+
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 调试命令
+ * ================================================================================= */
+
+static int crypto_key(void)
+{
+    int i;
+
+    rt_kprintf("slot loaded  enc_loads  dec_preps  avoided\n");
+    rt_kprintf("---- ------- ---------- ---------- ----------\n");
+    for (i = 0; i < CRYPTO_KEY_SLOTS; i++)
+    {
+        if (key_table[i] == RT_NULL) continue;
+
+        rt_kprintf("%4d %-7s %10d %10d %10d\n", i,
+                   i != loaded_slot ? "-" : (loaded_dir == CRYPTO_ENCRYPT ? "enc" : "dec"),
+                   key_stat[i].enc_loads, key_stat[i].dec_preps, key_stat[i].avoided);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(crypto_key, show CRYP key slot cache statistics);
@@ -0,0 +1,29 @@
+/* crypto_key.h - CRYP 密钥槽管理 (避免重复的解密密钥准备) */
+#ifndef __CRYPTO_KEY_H__
+#define __CRYPTO_KEY_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+#define CRYPTO_KEY_SLOTS        4       /* AES-128 密钥槽 */
+
+struct crypto_key_stat
+{
+    rt_uint32_t  enc_loads;             /* 写入加密密钥 */
+    rt_uint32_t  dec_preps;             /* 解密密钥准备 (ALGOMODE_AES_KEY) */
+    rt_uint32_t  avoided;               /* 槽和方向均未变化, 跳过装载 */
+};
+
+/* 设置槽 slot 的密钥 (4 个字, 调用者保证其生命周期) */
+rt_err_t crypto_key_set(rt_uint8_t slot, const rt_uint32_t *key);
+
+/*
+ * 在提交前切换到 (slot, dir) 上下文, 仅由 CRYP 服务线程调用.
+ * 与硬件中已装载的上下文相同时跳过密钥装载/准备.
+ */
+rt_err_t crypto_key_select(CRYP_HandleTypeDef *hcryp, rt_uint8_t slot, rt_uint8_t dir);
+
+/* CRYP 复位后调用: 硬件中的密钥已失效 */
+void     crypto_key_invalidate(void);
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * hrtimer.c - 微秒级高精度定时器
+ *
+ * 内核定时器以 tick 计时, rt_tick_from_millisecond 按 RT_TICK_PER_SECOND
+ * 取整, 亚毫秒的协议超时和发送节拍只能靠提高 SysTick 频率. 这里另用一个
+ * 自由运行的 32 位 1 MHz 计数器 (后端见 hrtimer_tim.c): 激活的定时器按到期
+ * 计数值排序, 比较寄存器始终指向链表头, 只有到期时才进中断.
+ *
+ * 写比较值时计数器可能已经越过它 (到期很近或关中断较久), 硬件不会再匹配,
+ * 因此写入后回读计数值, 已错过则由后端直接挂起比较中断.
+ *
+ * 硬定时器回调在比较中断中执行 (开中断), 须短小且不能阻塞; 软定时器
+ * 在 hrtimer 线程中回调, 线程未来得及处理又到期时合并为一次.
+ *
+ * 本文件只依赖后端的三个函数, 主机端 tools/hrtimer_sim 用虚拟计数器驱动.
+ */
+
+#include "hrtimer.h"
+#include <rthw.h>
+
+static const struct rt_hrtimer_clock *hrtimer_clock;
+static rt_list_t hrtimer_list = RT_LIST_OBJECT_INIT(hrtimer_list);
+static rt_list_t hrtimer_soft_list = RT_LIST_OBJECT_INIT(hrtimer_soft_list);
+static struct rt_semaphore hrtimer_sem;
+static struct rt_hrtimer_stat hrtimer_stat;
+
+/* 计数值先后, 相差须小于半个计数周期 */
+#define HRTIMER_BEFORE_EQ(a, b)     ((rt_int32_t)((a) - (b)) <= 0)
+
+/* =================================================================================
+ * 1. 激活链表与比较值
+ * ================================================================================= */
+
+static void hrtimer_insert(rt_hrtimer_t timer)
+{
+    rt_list_t *n;
+
+    /* 定时器数量少, 线性插入; 同一时刻到期的按启动先后 */
+    for (n = hrtimer_list.next; n != &hrtimer_list; n = n->next)
+    {
+        if ((rt_int32_t)(rt_list_entry(n, struct rt_hrtimer, list)->expire - timer->expire) > 0)
+            break;
+    }
+    rt_list_insert_before(n, &timer->list);
+    timer->flag |= RT_HRTIMER_FLAG_ACTIVATED;
+}
+
+static void hrtimer_program(void)
+{
+    rt_hrtimer_t head;
+
+    if (rt_list_isempty(&hrtimer_list))
+        return;
+
+    head = rt_list_entry(hrtimer_list.next, struct rt_hrtimer, list);
+    hrtimer_clock->set_compare(head->expire);
+
+    /* 写入前后计数器已到达比较值, 不会再匹配 */
+    if (HRTIMER_BEFORE_EQ(head->expire, hrtimer_clock->count()))
+        hrtimer_clock->trigger();
+}
+
+static void hrtimer_remove(rt_hrtimer_t timer)
+{
+    rt_list_remove(&timer->list);
+    rt_list_remove(&timer->soft);
+    timer->flag &= ~RT_HRTIMER_FLAG_ACTIVATED;
+}
+
+/* =================================================================================
+ * 2. 接口
+ * ================================================================================= */
+
+void rt_hrtimer_init(rt_hrtimer_t timer, void (*timeout)(void *parameter), void *parameter,
+                     rt_uint32_t us, rt_uint8_t flag)
+{
+    RT_ASSERT(timer != RT_NULL);
+    RT_ASSERT(timeout != RT_NULL);
+    RT_ASSERT(us > 0 && us <= RT_HRTIMER_MAX_US);
+
+    rt_list_init(&timer->list);
+    rt_list_init(&timer->soft);
+    timer->timeout   = timeout;
+    timer->parameter = parameter;
+    timer->time      = us;
+    timer->expire    = 0;
+    timer->flag      = flag & ~RT_HRTIMER_FLAG_ACTIVATED;
+}
+
+rt_err_t rt_hrtimer_start_at(rt_hrtimer_t timer, rt_uint32_t expire)
+{
+    rt_base_t level;
+
+    RT_ASSERT(timer != RT_NULL);
+
+    if (hrtimer_clock == RT_NULL)
+        return -RT_ERROR;
+
+    /* 等待线程回调的保留, 重新计时不取消已到期的那一次 */
+    level = rt_hw_interrupt_disable();
+    rt_list_remove(&timer->list);
+    timer->expire = expire;
+    hrtimer_insert(timer);
+    if (hrtimer_list.next == &timer->list)
+        hrtimer_program();
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_hrtimer_start(rt_hrtimer_t timer)
+{
+    RT_ASSERT(timer != RT_NULL);
+
+    if (hrtimer_clock == RT_NULL)
+        return -RT_ERROR;
+
+    return rt_hrtimer_start_at(timer, hrtimer_clock->count() + timer->time);
+}
+
+rt_err_t rt_hrtimer_stop(rt_hrtimer_t timer)
+{
+    rt_base_t level;
+
+    RT_ASSERT(timer != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (!(timer->flag & RT_HRTIMER_FLAG_ACTIVATED) && rt_list_isempty(&timer->soft))
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_ERROR;
+    }
+    /* 链表头被移除时比较值不动, 多出的一次中断找不到到期定时器, 重新设置即可 */
+    hrtimer_remove(timer);
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+void rt_hrtimer_set_time(rt_hrtimer_t timer, rt_uint32_t us)
+{
+    RT_ASSERT(timer != RT_NULL);
+    RT_ASSERT(us > 0 && us <= RT_HRTIMER_MAX_US);
+
+    timer->time = us;
+}
+
+rt_uint32_t rt_hrtimer_now(void)
+{
+    return hrtimer_clock != RT_NULL ? hrtimer_clock->count() : 0;
+}
+
+void rt_hrtimer_get_stat(struct rt_hrtimer_stat *stat)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    *stat = hrtimer_stat;
+    rt_hw_interrupt_enable(level);
+}
+
+/* =================================================================================
+ * 3. 到期处理
+ * ================================================================================= */
+
+void rt_hrtimer_isr(void)
+{
+    rt_hrtimer_t timer;
+    rt_uint32_t now, late;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    now = hrtimer_clock->count();
+
+    while (!rt_list_isempty(&hrtimer_list))
+    {
+        timer = rt_list_entry(hrtimer_list.next, struct rt_hrtimer, list);
+        if (!HRTIMER_BEFORE_EQ(timer->expire, now))
+            break;
+
+        late = now - timer->expire;
+        if (late > hrtimer_stat.late_max)
+            hrtimer_stat.late_max = late;
+        hrtimer_stat.fired++;
+
+        rt_list_remove(&timer->list);
+        if (timer->flag & RT_HRTIMER_FLAG_PERIODIC)
+        {
+            timer->expire += timer->time;
+            if (HRTIMER_BEFORE_EQ(timer->expire, now))
+            {
+                timer->expire = now + timer->time;
+                hrtimer_stat.overruns++;
+            }
+            hrtimer_insert(timer);
+        }
+        else
+        {
+            timer->flag &= ~RT_HRTIMER_FLAG_ACTIVATED;
+        }
+
+        if (timer->flag & RT_HRTIMER_FLAG_SOFT_TIMER)
+        {
+            hrtimer_stat.soft++;
+            if (rt_list_isempty(&timer->soft))
+            {
+                rt_list_insert_before(&hrtimer_soft_list, &timer->soft);
+                rt_sem_release(&hrtimer_sem);
+            }
+            else
+            {
+                hrtimer_stat.soft_missed++;
+            }
+        }
+        else
+        {
+            /* 回调中可以重新启动或停止任何定时器, 链表每次从头取 */
+            rt_hw_interrupt_enable(level);
+            timer->timeout(timer->parameter);
+            level = rt_hw_interrupt_disable();
+            now = hrtimer_clock->count();
+        }
+    }
+
+    hrtimer_program();
+    rt_hw_interrupt_enable(level);
+}
+
+static void hrtimer_soft_process(void)
+{
+    rt_hrtimer_t timer;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    while (!rt_list_isempty(&hrtimer_soft_list))
+    {
+        timer = rt_list_entry(hrtimer_soft_list.next, struct rt_hrtimer, soft);
+        rt_list_remove(&timer->soft);
+        rt_hw_interrupt_enable(level);
+        timer->timeout(timer->parameter);
+        level = rt_hw_interrupt_disable();
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+static void hrtimer_thread_entry(void *parameter)
+{
+    while (1)
+    {
+        rt_sem_take(&hrtimer_sem, RT_WAITING_FOREVER);
+        hrtimer_soft_process();
+    }
+}
+
+/* =================================================================================
+ * 4. 初始化
+ * ================================================================================= */
+
+rt_err_t rt_hrtimer_system_init(const struct rt_hrtimer_clock *clock)
+{
+    rt_thread_t tid;
+    rt_err_t result;
+
+    RT_ASSERT(clock != RT_NULL);
+
+    if (hrtimer_clock != RT_NULL)
+        return -RT_EBUSY;
+
+    result = rt_sem_init(&hrtimer_sem, "hrtimer", 0, RT_IPC_FLAG_FIFO);
+    if (result != RT_EOK)
+        return result;
+
+    tid = rt_thread_create("hrtimer", hrtimer_thread_entry, RT_NULL,
+                           HRTIMER_THREAD_STACK_SIZE, HRTIMER_THREAD_PRIORITY, 5);
+    if (tid == RT_NULL)
+    {
+        rt_sem_detach(&hrtimer_sem);
+        return -RT_ENOMEM;
+    }
+
+    hrtimer_clock = clock;
+    rt_thread_startup(tid);
+
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 5. 调试命令
+ * ================================================================================= */
+
+#ifdef RT_USING_FINSH
+static int hrtimer(int argc, char **argv)
+{
+    struct rt_hrtimer_stat st;
+    rt_list_t *n;
+    rt_base_t level;
+    int active = 0;
+
+    level = rt_hw_interrupt_disable();
+    for (n = hrtimer_list.next; n != &hrtimer_list; n = n->next)
+        active++;
+    rt_hw_interrupt_enable(level);
+
+    rt_hrtimer_get_stat(&st);
+    rt_kprintf("now      : %u us, %d active\n", rt_hrtimer_now(), active);
+    rt_kprintf("fired    : %u (thread %u, merged %u), overruns %u\n", st.fired, st.soft, st.soft_missed,
+               st.overruns);
+    rt_kprintf("late max : %u us\n", st.late_max);
+
+    return 0;
+}
+MSH_CMD_EXPORT(hrtimer, show high resolution timer stats);
+#endif
@@ -0,0 +1,84 @@
+/* hrtimer.h - 微秒级高精度定时器: 自由运行的 32 位 1 MHz 计数器 + 比较中断 */
+#ifndef __HRTIMER_H__
+#define __HRTIMER_H__
+
+#include <rtthread.h>
+
+#define HRTIMER_THREAD_STACK_SIZE   1024
+#define HRTIMER_THREAD_PRIORITY     4       /* 线程上下文回调, 高于桥接与 CRYP 服务线程 */
+#define HRTIMER_IRQ_PRIORITY        1       /* 与桥接串口同级 */
+
+/* 计数器 32 位回绕 (约 71 分钟), 超时须小于半个周期才能判断先后 */
+#define RT_HRTIMER_MAX_US           0x7FFFFFFFu
+
+#define RT_HRTIMER_FLAG_ACTIVATED   0x01    /* 已启动 */
+#define RT_HRTIMER_FLAG_ONE_SHOT    0x00
+#define RT_HRTIMER_FLAG_PERIODIC    0x02    /* 按到期时刻 (而非回调时刻) 累加周期, 不漂移 */
+#define RT_HRTIMER_FLAG_HARD_TIMER  0x00    /* 回调在比较中断中执行 */
+#define RT_HRTIMER_FLAG_SOFT_TIMER  0x04    /* 回调在 hrtimer 线程中执行 */
+
+struct rt_hrtimer
+{
+    rt_list_t            list;          /* 按到期时刻排序的激活链表 */
+    rt_list_t            soft;          /* 等待 hrtimer 线程回调 */
+    void               (*timeout)(void *parameter);
+    void                *parameter;
+    rt_uint32_t          time;          /* 超时/周期 (us) */
+    rt_uint32_t          expire;        /* 到期计数值 (us) */
+    rt_uint8_t           flag;
+};
+typedef struct rt_hrtimer *rt_hrtimer_t;
+
+/*
+ * 计数器后端: count 返回当前计数 (1 MHz, 32 位回绕); set_compare 设置比较值,
+ * 计数到达时调用 rt_hrtimer_isr(); trigger 立即挂起同一中断, 用于比较值写入
+ * 时已经错过的情况. 三者都在关中断下调用.
+ */
+struct rt_hrtimer_clock
+{
+    rt_uint32_t        (*count)(void);
+    void               (*set_compare)(rt_uint32_t value);
+    void               (*trigger)(void);
+};
+
+struct rt_hrtimer_stat
+{
+    rt_uint32_t          fired;         /* 到期次数 */
+    rt_uint32_t          soft;          /* 其中交给线程回调的次数 */
+    rt_uint32_t          soft_missed;   /* 上次线程回调未执行又到期 (合并为一次) */
+    rt_uint32_t          overruns;      /* 周期定时器错过整周期, 从当前时刻重新计 */
+    rt_uint32_t          late_max;      /* 中断处理时刻相对到期的最大延迟 (us) */
+};
+
+/* 注册计数器后端, 创建 hrtimer 线程. 由后端初始化 (如 hrtimer_tim_init) 调用 */
+rt_err_t rt_hrtimer_system_init(const struct rt_hrtimer_clock *clock);
+
+void rt_hrtimer_init(rt_hrtimer_t timer, void (*timeout)(void *parameter), void *parameter,
+                     rt_uint32_t us, rt_uint8_t flag);
+
+/* 从当前时刻起 time 微秒后到期; 已启动的定时器重新计时 */
+rt_err_t rt_hrtimer_start(rt_hrtimer_t timer);
+
+/* 在计数值 expire 到期, 用于按绝对时刻排程 (如 expire += 间隔 的节拍发送) */
+rt_err_t rt_hrtimer_start_at(rt_hrtimer_t timer, rt_uint32_t expire);
+
+rt_err_t rt_hrtimer_stop(rt_hrtimer_t timer);
+
+/* 修改超时/周期, 下次启动 (周期定时器为下一周期) 生效 */
+void rt_hrtimer_set_time(rt_hrtimer_t timer, rt_uint32_t us);
+
+/* 当前计数值 (us) */
+rt_uint32_t rt_hrtimer_now(void);
+
+void rt_hrtimer_get_stat(struct rt_hrtimer_stat *stat);
+
+/* 后端比较中断调用, 须在 rt_interrupt_enter/leave 之间 */
+void rt_hrtimer_isr(void);
+
+/* TIM2 后端 (hrtimer_tim.c): 配置 TIM2 为 1 MHz 自由运行计数器并注册 */
+rt_err_t hrtimer_tim_init(void);
+
+/* 时钟档位切换后按新的 APB1 定时器时钟重设分频, 由 clock_profile_apply() 在关中断下调用 */
+void hrtimer_tim_reclock(void);
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * hrtimer_tim.c - 高精度定时器的 TIM2 后端
+ *
+ * TIM2 是 APB1 上的 32 位定时器, 分频到 1 MHz 后自由运行 (ARR = 0xFFFFFFFF),
+ * 比较通道 1 (冻结模式, 不驱动引脚) 的匹配中断调用 rt_hrtimer_isr().
+ *
+ * APB1 分频不为 1 时定时器时钟是 PCLK1 的两倍, 三个时钟档位分别为
+ * 275/200/64 MHz, 都能整除到 1 MHz. 切换档位时 hrtimer_tim_reclock() 重设
+ * 分频; 切换过程 (数百微秒) 中计数器仍按旧分频计数, 期间计时会有偏差.
+ */
+
+#include "hrtimer.h"
+#include "stm32h7xx_hal.h"
+
+#define HRTIMER_TIM_HZ          1000000
+
+static TIM_HandleTypeDef htim_hr;
+
+/* =================================================================================
+ * 1. 计数器后端
+ * ================================================================================= */
+
+static rt_uint32_t hrtimer_tim_count(void)
+{
+    return htim_hr.Instance->CNT;
+}
+
+static void hrtimer_tim_set_compare(rt_uint32_t value)
+{
+    htim_hr.Instance->CCR1 = value;
+}
+
+static void hrtimer_tim_trigger(void)
+{
+    /* 软件产生比较事件, 置位 CC1IF 并挂起中断 */
+    htim_hr.Instance->EGR = TIM_EGR_CC1G;
+}
+
+static const struct rt_hrtimer_clock hrtimer_tim_clock =
+{
+    hrtimer_tim_count,
+    hrtimer_tim_set_compare,
+    hrtimer_tim_trigger,
+};
+
+static rt_uint32_t hrtimer_tim_prescaler(void)
+{
+    rt_uint32_t hz = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_APB1_DIV1)
+        hz *= 2;
+
+    return hz / HRTIMER_TIM_HZ - 1;
+}
+
+/* =================================================================================
+ * 2. 初始化与时钟切换
+ * ================================================================================= */
+
+rt_err_t hrtimer_tim_init(void)
+{
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    htim_hr.Instance               = TIM2;
+    htim_hr.Init.Prescaler         = hrtimer_tim_prescaler();
+    htim_hr.Init.CounterMode       = TIM_COUNTERMODE_UP;
+    htim_hr.Init.Period            = 0xFFFFFFFF;
+    htim_hr.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+    htim_hr.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    if (HAL_TIM_Base_Init(&htim_hr) != HAL_OK)
+    {
+        htim_hr.Instance = RT_NULL;
+        return -RT_ERROR;
+    }
+
+    /* CCMR1 复位值即冻结模式且无预装载, 写 CCR1 立即生效 */
+    __HAL_TIM_CLEAR_IT(&htim_hr, TIM_IT_CC1);
+    __HAL_TIM_ENABLE_IT(&htim_hr, TIM_IT_CC1);
+    HAL_NVIC_SetPriority(TIM2_IRQn, HRTIMER_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+    __HAL_TIM_ENABLE(&htim_hr);
+
+    return rt_hrtimer_system_init(&hrtimer_tim_clock);
+}
+
+void hrtimer_tim_reclock(void)
+{
+    rt_uint32_t cnt;
+
+    if (htim_hr.Instance == RT_NULL)
+        return;
+
+    /* PSC 只在更新事件时装载, 软件更新事件会清零计数, 前后保存恢复 */
+    cnt = htim_hr.Instance->CNT;
+    htim_hr.Instance->PSC = hrtimer_tim_prescaler();
+    htim_hr.Instance->EGR = TIM_EGR_UG;
+    htim_hr.Instance->CNT = cnt;
+}
+
+/* =================================================================================
+ * 3. 中断
+ * ================================================================================= */
+
+void TIM2_IRQHandler(void)
+{
+    rt_interrupt_enter();
+    /* 先清标志再处理, 处理中 trigger() 重新置位的不会丢 */
+    __HAL_TIM_CLEAR_IT(&htim_hr, TIM_IT_CC1);
+    rt_hrtimer_isr();
+    rt_interrupt_leave();
+}
@@ -0,0 +1,57 @@
+/* lat_hist.h - DWT 周期计数时间戳与对数分桶延迟直方图 */
+#ifndef __LAT_HIST_H__
+#define __LAT_HIST_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+#define LAT_HIST_SUB_BITS       2       /* 每个 2 的幂区间再分 4 档, 分辨率 25% */
+#define LAT_HIST_BUCKETS        ((32 - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS)
+#define LAT_HIST_MAX            40      /* lat_hist 命令可列出的直方图数 (8 条链路 x 5 段) */
+
+/*
+ * 每个直方图只允许一个写者 (一个线程或一个中断), 计数无需加锁;
+ * lat_hist reset 与写者并发时最多丢失一次计数.
+ */
+struct lat_hist
+{
+    const char          *channel;
+    const char          *stage;
+
+    volatile rt_uint32_t count;
+    volatile rt_uint32_t min;           /* 周期 */
+    volatile rt_uint32_t max;
+    volatile rt_uint32_t bucket[LAT_HIST_BUCKETS];
+};
+
+/*
+ * 睡眠 (WFI) 期间 DWT 停止计数, 由睡眠方 (tickless.c) 按 LPTIM 测得的睡眠时间
+ * 折算成周期补上. 只在空闲线程中关中断更新, 这时没有其他线程在取时间戳.
+ */
+extern volatile rt_uint32_t lat_sleep_cycles;
+
+/* 打开 DWT 周期计数器 */
+void lat_cycle_init(void);
+
+/* 时间戳 (CPU 周期), 含睡眠时间 */
+rt_inline rt_uint32_t lat_now(void)
+{
+    return DWT->CYCCNT + lat_sleep_cycles;
+}
+
+/* 周期数换算成 us (按当前 SystemCoreClock) */
+rt_inline rt_uint32_t lat_us(rt_uint32_t cycles)
+{
+    rt_uint32_t per_us = SystemCoreClock / 1000000;
+
+    return per_us ? cycles / per_us : cycles;
+}
+
+void lat_hist_init(struct lat_hist *hist, const char *channel, const char *stage);
+void lat_hist_add(struct lat_hist *hist, rt_uint32_t cycles);
+void lat_hist_reset(struct lat_hist *hist);
+
+/* 第 percent 百分位 (周期, 取所在分桶的上界) */
+rt_uint32_t lat_hist_percentile(struct lat_hist *hist, rt_uint32_t percent);
+
+#endif
@@ -0,0 +1,60 @@
+/* rtconfig.h - 主机仿真 (sim/) 的内核配置, 与目标板 RTE 配置的功能一致, 另开启本仓库新增的内核选项 */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+/* 内核 */
+#define RT_NAME_MAX                 8
+#define RT_ALIGN_SIZE               8
+#define RT_THREAD_PRIORITY_MAX      32
+#define RT_TICK_PER_SECOND          1000
+#define RT_USING_OVERFLOW_CHECK
+#define RT_USING_HOOK
+#define RT_USING_IDLE_HOOK
+#define RT_IDLE_HOOK_LIST_SIZE      4
+#define IDLE_THREAD_STACK_SIZE      1024
+#define RT_DEBUG
+#define RT_CPU_CACHE_LINE_SZ        32
+
+/* 定时器 */
+#define RT_USING_TIMER_SOFT
+#define RT_TIMER_THREAD_PRIO        4
+#define RT_TIMER_THREAD_STACK_SIZE  1024
+#define RT_USING_TIMER_WHEEL
+
+/* IPC */
+#define RT_USING_SEMAPHORE
+#define RT_USING_SEM_HANDOFF
+#define RT_USING_IPC_PRIO_BUCKET
+#define RT_USING_MUTEX
+#define RT_USING_EVENT
+#define RT_USING_MAILBOX
+#define RT_USING_MESSAGEQUEUE
+
+/* 内存 */
+#define RT_USING_MEMPOOL
+#define RT_USING_HEAP
+#define RT_USING_SMALL_MEM
+
+/* 设备与控制台 */
+#define RT_USING_DEVICE
+#define RT_USING_CONSOLE
+#define RT_CONSOLEBUF_SIZE          256
+
+/* 启动 */
+#define RT_USING_COMPONENTS_INIT
+#define RT_USING_USER_MAIN
+#define RT_MAIN_THREAD_STACK_SIZE   2048
+
+/* finsh */
+#define RT_USING_FINSH
+#define FINSH_USING_MSH
+#define FINSH_USING_MSH_ONLY
+#define FINSH_USING_SYMTAB
+#define FINSH_USING_DESCRIPTION
+#define FINSH_THREAD_PRIORITY       20
+#define FINSH_THREAD_STACK_SIZE     2048
+#define FINSH_CMD_SIZE              80
+#define FINSH_USING_HISTORY
+#define FINSH_HISTORY_LINES         5
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * sim.h - 主机仿真: 外设模型之间的公共接口与测试注入接口
+ *
+ * 固件的全部 RT-Thread 线程运行在一个主机线程 ("CPU", 见 libcpu/posix) 上,
+ * 外设模型 (UART 收发、CRYP、定时事件) 各自运行在独立的主机线程中, 通过
+ * rt_hw_posix_irq_trigger() 向 CPU 线程挂起中断, 与真实外设和 CPU 并行
+ * 工作的方式一致.
+ *
+ * 外设寄存器与模型状态由一把全局锁保护:
+ *   CPU 线程 (应用代码、中断处理) 用 sim_lock()/sim_unlock(), 先关中断再加锁,
+ *   持锁期间不会被模拟中断打断而在同一线程上重入;
+ *   模型线程直接加锁, 不关中断 (rt_hw_interrupt_disable 只属于 CPU 线程).
+ * sim_lock() 在两种线程上都可以调用, 按调用线程自动选择.
+ */
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <rtthread.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32h7xx_hal.h"
+
+/* 仿真中断向量: 外设中断为 IRQn + 1, 0 为 SysTick, 最后一个用于仿真器自身 */
+#define SIM_IRQ_VECTOR(irqn)    ((int)(irqn) + 1)
+#define SIM_IRQ_EXIT            31
+
+/* =================================================================================
+ * 1. 锁、时间与模型线程
+ * ================================================================================= */
+
+/* 全局锁本身, 模型线程在它上面等待条件变量 */
+extern pthread_mutex_t sim_mutex;
+
+rt_base_t sim_lock(void);
+void      sim_unlock(rt_base_t level);
+
+/* 主机单调时钟 (ns) */
+uint64_t  sim_now_ns(void);
+
+/* 睡眠到主机时刻 at_ns; 仿真进程的定时器松弛设为最小, 唤醒延迟在数微秒 */
+void      sim_sleep_until(uint64_t at_ns);
+
+/*
+ * 主机让调用线程在运行队列上等待的累计时间 (ns), 取自 /proc/thread-self/schedstat,
+ * 不可用时为 0. 在 CPU 线程调用: 这段时间里仿真 CPU 没有执行而主机时钟照走,
+ * 测试从主机时间中扣除它, 得到不受主机负载影响的仿真时间.
+ */
+uint64_t  sim_cpu_stall_ns(void);
+
+/* 创建模型线程: 屏蔽模拟中断使用的信号, 保证它们只投递到 CPU 线程 */
+int       sim_thread_create(pthread_t *tid, void *(*entry)(void *), void *arg);
+
+/*
+ * 定时事件: 由仿真器的事件线程在 at_ns 到达时调用 fire (持有全局锁).
+ * arm/cancel 须在持锁时调用; 重复 arm 改为新的时刻.
+ */
+struct sim_event
+{
+    struct sim_event    *next;
+    uint64_t             at_ns;
+    int                  armed;
+    void               (*fire)(struct sim_event *ev);
+};
+
+void      sim_event_arm(struct sim_event *ev, uint64_t at_ns);
+void      sim_event_cancel(struct sim_event *ev);
+
+/* =================================================================================
+ * 2. NVIC 与 DMA
+ * ================================================================================= */
+
+/* 挂起外设中断, 任何线程可调用; NVIC 未使能时保持挂起, 使能后再进入 */
+void      sim_irq_raise(IRQn_Type irqn);
+
+/*
+ * DMA 流由外设模型占用: 模型置位完成/半满标志并挂起流中断, 应用的
+ * DMAx_Streamy_IRQHandler 调用 HAL_DMA_IRQHandler(), 后者取走标志交给占用者
+ * 的回调 (在中断上下文中, 不持锁), 即真实 HAL 中 XferCpltCallback 的位置.
+ */
+#define SIM_DMA_FLAG_HT         0x01U
+#define SIM_DMA_FLAG_TC         0x02U
+#define SIM_DMA_FLAG_TE         0x04U
+
+void      sim_dma_bind(DMA_Stream_TypeDef *stream, void (*irq)(void *owner, uint32_t flags), void *owner);
+void      sim_dma_raise(DMA_Stream_TypeDef *stream, uint32_t flags);
+void      sim_dma_clear(DMA_Stream_TypeDef *stream);
+int       sim_dma_pending(DMA_Stream_TypeDef *stream);
+
+/* =================================================================================
+ * 3. 时钟
+ * ================================================================================= */
+
+uint32_t  sim_rcc_hclk(void);
+uint32_t  sim_rcc_usart_hz(USART_TypeDef *instance);
+
+/* 注入时钟故障 (0 清除), 检查 clock_profile_apply() 的超时与回退 */
+#define SIM_RCC_FAULT_PLL_LOCK  0x01U       /* PLL1 不锁定 */
+#define SIM_RCC_FAULT_VOSRDY    0x02U       /* 改电压档位后 VOSRDY 不置位 */
+
+void      sim_rcc_inject(uint32_t faults);
+
+/*
+ * SysTick 计到零而还没进 rt_tick 的次数: 挂起未处理的、事件线程还没处理的,
+ * 以及主机停顿时合并掉的 (累计). rt_tick + sim_systick_behind() 按仿真时间走.
+ */
+uint32_t  sim_systick_behind(void);
+
+/* 睡眠期间 (WFI) 经过的 CPU 周期, DWT 不计这部分 */
+uint64_t  sim_sleep_cycles(void);
+
+/*
+ * CRYP 模型累计的处理时间 (ns), 每个任务开始时按当时的 HCLK 折算计入;
+ * 不含主机计算 AES 的时间, 与主机负载无关.
+ */
+uint64_t  sim_cryp_busy_ns(void);
+
+/* =================================================================================
+ * 4. UART
+ * ================================================================================= */
+
+/*
+ * 端口名 "uart1"/"uart3"/"uart7", 后端 spec:
+ *   none     收发都在内存中, 由 sim_uart_input/sim_uart_output 注入和取出
+ *   stdio    标准输入/输出 (终端时切换为原始模式)
+ *   pty      新建伪终端, 路径打印到 stderr, 外部程序 (如 bridge_bench) 打开收发
+ *   <路径>   打开已有的设备或伪终端
+ * 由 sim_init() 按命令行设置, 之后不能再改.
+ */
+int       sim_uart_backend(const char *name, const char *spec);
+
+/* 追加到端口的输入 (任何后端都可用), 在接收开始后按波特率逐字节到达 */
+int       sim_uart_input(const char *name, const void *data, size_t len);
+
+/* 取出 none 后端已发送的数据, 返回字节数 */
+size_t    sim_uart_output(const char *name, void *buf, size_t size);
+
+/*
+ * 端口发出 str (最长 SIM_UART_UNTIL_MAX 字节) 后请求以 0 退出, 见 --until.
+ * 在 sim_uart_start() 之前调用.
+ */
+#define SIM_UART_UNTIL_MAX      64
+
+int       sim_uart_until(const char *name, const char *str);
+
+/* 发送 DMA 或轮询发送仍有数据未发出 */
+int       sim_uart_tx_busy(const char *name);
+
+/* 注入线路错误 (HAL_UART_ERROR_ORE/FE/NE/PE), 置位 ISR 标志并进入串口中断 */
+int       sim_uart_inject_error(const char *name, uint32_t error);
+
+/* 已到达但因 FIFO 满 (无流控) 丢弃的字节数 */
+uint32_t  sim_uart_overruns(const char *name);
+
+void      sim_uart_start(void);
+
+/* 等待各端口发完待发送的数据 (最多 1 s) 并恢复终端设置, 由 sim_exit() 调用 */
+void      sim_uart_stop(void);
+
+/* =================================================================================
+ * 5. 启动与退出
+ * ================================================================================= */
+
+/*
+ * 解析命令行并启动模型线程, 之后调用 entry() 进入 rtthread_startup().
+ *   --uart1/--uart3/--uart7 SPEC   串口后端, 默认 uart3 为 stdio, 其余为 none
+ *   --input STR                    控制台 (uart3) 输入, 支持 \n 转义
+ *   --until STR                    控制台 (uart3) 发出 STR 后刷新输出并退出 (退出码 0),
+ *                                  不依赖主机时间, 适合 --input 脚本的测试
+ *   --run-ms N                     运行 N ms 后刷新输出并退出; 与 --until 同用时为上限,
+ *                                  到时还没发出 STR 则退出码 1
+ * 返回非 0 表示参数错误.
+ */
+int       sim_init(int argc, char **argv);
+
+/* 请求 CPU 线程经仿真中断调用 sim_exit(code), 任何线程可调用; 只有第一次请求有效 */
+void      sim_exit_request(int code);
+
+/* 刷新控制台与各串口的待发送数据后退出进程, 在 CPU 线程 (线程或中断上下文) 调用 */
+void      sim_exit(int code);
+
+#endif
@@ -0,0 +1,873 @@
+/*
+ * sim_board.c - 主机仿真: 板级初始化、NVIC、SysTick、DWT、DMA 公共部分与事件线程
+ *
+ * 代替目标上的 board.c: 堆和 DMA 缓冲池是静态数组, 中断向量由 libcpu/posix
+ * 的信号分发, 每个外设中断号对应一个仿真向量 (SIM_IRQ_VECTOR), 进入时按
+ * NVIC 使能/挂起位决定是否调用应用的 xxx_IRQHandler, 与真实 NVIC 一样
+ * 未使能时保持挂起.
+ *
+ * SysTick 与各外设模型的定时都由事件线程按主机单调时钟触发; SysTick 周期
+ * 为 (LOAD + 1) 个仿真 CPU 周期, 切换时钟档位后由 HAL_SYSTICK_Config 重新
+ * 计算; 经 SysTick 访问时按当前时刻刷新 VAL, 并处理停止/重新使能 (tickless.c).
+ * DWT->CYCCNT 按仿真 CPU 频率计数, 与真实内核一样在 WFI 睡眠期间停止.
+ */
+
+#define _GNU_SOURCE
+#include "sim.h"
+#include "board.h"
+#include "console.h"
+#include "uart_port.h"
+#include "clock_profile.h"
+#include <rthw.h>
+#include <cpuport.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_HEAP_SIZE           (128 * 1024)
+
+SysTick_Type            sim_systick;
+SCB_Type                sim_scb;
+CoreDebug_Type          sim_coredebug;
+GPIO_TypeDef            sim_gpio[11];
+DMA_Stream_TypeDef      sim_dma_stream[16];
+
+uint32_t                SystemCoreClock = HSI_VALUE;
+__IO uint32_t           uwTick;
+uint32_t                uwTickFreq = 1;
+
+/* =================================================================================
+ * 1. 锁、时间与模型线程
+ * ================================================================================= */
+
+pthread_mutex_t sim_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread int sim_on_cpu;
+
+rt_base_t sim_lock(void)
+{
+    rt_base_t level = 0;
+
+    if (sim_on_cpu)
+        level = rt_hw_interrupt_disable();
+    pthread_mutex_lock(&sim_mutex);
+
+    return level;
+}
+
+void sim_unlock(rt_base_t level)
+{
+    pthread_mutex_unlock(&sim_mutex);
+    if (sim_on_cpu)
+        rt_hw_interrupt_enable(level);
+}
+
+uint64_t sim_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void sim_sleep_until(uint64_t at_ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = at_ns / 1000000000ULL;
+    ts.tv_nsec = at_ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, RT_NULL) == EINTR);
+}
+
+uint64_t sim_cpu_stall_ns(void)
+{
+    char buf[64], *wait;
+    rt_base_t level;
+    ssize_t n = -1;
+    int fd;
+
+    /* 字段: 运行时间 运行队列等待时间 调度次数 (ns); 关中断读, 不会切换线程 */
+    level = sim_lock();
+    fd = open("/proc/thread-self/schedstat", O_RDONLY);
+    if (fd >= 0)
+    {
+        n = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+    }
+    sim_unlock(level);
+    if (n <= 0)
+        return 0;
+    buf[n] = '\0';
+    wait = strchr(buf, ' ');
+
+    return (wait != RT_NULL) ? strtoull(wait + 1, RT_NULL, 10) : 0;
+}
+
+int sim_thread_create(pthread_t *tid, void *(*entry)(void *), void *arg)
+{
+    sigset_t block, old;
+    int result;
+
+    /* 新线程继承调用者的信号屏蔽字 */
+    sigemptyset(&block);
+    sigaddset(&block, SIGALRM);
+    sigaddset(&block, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    result = pthread_create(tid, RT_NULL, entry, arg);
+    pthread_sigmask(SIG_SETMASK, &old, RT_NULL);
+
+    return result;
+}
+
+/* 事件线程: 按到期时刻排序的单链表, 到期时持锁调用 fire */
+static struct sim_event *event_list;
+static pthread_cond_t event_cond;
+
+void sim_event_arm(struct sim_event *ev, uint64_t at_ns)
+{
+    struct sim_event **p;
+
+    sim_event_cancel(ev);
+    ev->at_ns = at_ns;
+    for (p = &event_list; *p != RT_NULL && (*p)->at_ns <= at_ns; p = &(*p)->next);
+    ev->next = *p;
+    *p = ev;
+    ev->armed = 1;
+
+    if (event_list == ev)
+        pthread_cond_signal(&event_cond);
+}
+
+void sim_event_cancel(struct sim_event *ev)
+{
+    struct sim_event **p;
+
+    if (!ev->armed)
+        return;
+
+    for (p = &event_list; *p != RT_NULL; p = &(*p)->next)
+    {
+        if (*p == ev)
+        {
+            *p = ev->next;
+            break;
+        }
+    }
+    ev->armed = 0;
+}
+
+static void *sim_event_entry(void *parameter)
+{
+    struct sim_event *ev;
+    struct timespec ts;
+    uint64_t now;
+
+    pthread_mutex_lock(&sim_mutex);
+    while (1)
+    {
+        ev = event_list;
+        if (ev == RT_NULL)
+        {
+            pthread_cond_wait(&event_cond, &sim_mutex);
+            continue;
+        }
+
+        now = sim_now_ns();
+        if (ev->at_ns > now)
+        {
+            ts.tv_sec  = ev->at_ns / 1000000000ULL;
+            ts.tv_nsec = ev->at_ns % 1000000000ULL;
+            pthread_cond_timedwait(&event_cond, &sim_mutex, &ts);
+            continue;
+        }
+
+        event_list = ev->next;
+        ev->armed = 0;
+        ev->fire(ev);
+    }
+
+    return RT_NULL;
+}
+
+/* =================================================================================
+ * 2. NVIC 与中断向量
+ * ================================================================================= */
+
+static volatile uint32_t nvic_enabled;
+static volatile uint32_t nvic_pending;
+static volatile uint32_t sim_ipsr_value;
+
+/* 应用的中断处理函数, 测试程序可能只链接其中一部分 */
+extern void USART1_IRQHandler(void) RT_WEAK;
+extern void USART3_IRQHandler(void) RT_WEAK;
+extern void UART7_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream0_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream1_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream2_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream3_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream4_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream5_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream6_IRQHandler(void) RT_WEAK;
+extern void DMA1_Stream7_IRQHandler(void) RT_WEAK;
+extern void DMA2_Stream0_IRQHandler(void) RT_WEAK;
+extern void DMA2_Stream1_IRQHandler(void) RT_WEAK;
+extern void TIM2_IRQHandler(void) RT_WEAK;
+extern void LPTIM1_IRQHandler(void) RT_WEAK;
+
+static void (*const sim_vector[SIM_IRQn_MAX])(void) =
+{
+    [USART1_IRQn]       = USART1_IRQHandler,
+    [USART3_IRQn]       = USART3_IRQHandler,
+    [UART7_IRQn]        = UART7_IRQHandler,
+    [DMA1_Stream0_IRQn] = DMA1_Stream0_IRQHandler,
+    [DMA1_Stream1_IRQn] = DMA1_Stream1_IRQHandler,
+    [DMA1_Stream2_IRQn] = DMA1_Stream2_IRQHandler,
+    [DMA1_Stream3_IRQn] = DMA1_Stream3_IRQHandler,
+    [DMA1_Stream4_IRQn] = DMA1_Stream4_IRQHandler,
+    [DMA1_Stream5_IRQn] = DMA1_Stream5_IRQHandler,
+    [DMA1_Stream6_IRQn] = DMA1_Stream6_IRQHandler,
+    [DMA1_Stream7_IRQn] = DMA1_Stream7_IRQHandler,
+    [DMA2_Stream0_IRQn] = DMA2_Stream0_IRQHandler,
+    [DMA2_Stream1_IRQn] = DMA2_Stream1_IRQHandler,
+    [TIM2_IRQn]         = TIM2_IRQHandler,
+    [LPTIM1_IRQn]       = LPTIM1_IRQHandler,
+};
+
+void sim_irq_raise(IRQn_Type irqn)
+{
+    uint32_t bit = 1UL << irqn;
+
+    __atomic_fetch_or(&nvic_pending, bit, __ATOMIC_SEQ_CST);
+    if (nvic_enabled & bit)
+        rt_hw_posix_irq_trigger(SIM_IRQ_VECTOR(irqn));
+}
+
+/* 仿真向量的处理函数: 使能且挂起时清挂起位, 以 IPSR = 16 + IRQn 调用应用的处理函数 */
+static void sim_irq_entry(int vector, void *param)
+{
+    IRQn_Type irqn = (IRQn_Type)(rt_ubase_t)param;
+    uint32_t bit = 1UL << irqn, ipsr;
+
+    if (!(nvic_enabled & bit))
+        return;
+    if (!(__atomic_fetch_and(&nvic_pending, ~bit, __ATOMIC_SEQ_CST) & bit))
+        return;
+
+    ipsr = sim_ipsr_value;
+    sim_ipsr_value = 16 + irqn;
+    if (sim_vector[irqn] != RT_NULL)
+        sim_vector[irqn]();
+    sim_ipsr_value = ipsr;
+}
+
+uint32_t sim_ipsr(void)
+{
+    return sim_ipsr_value;
+}
+
+/* CPU 线程上中断是否被屏蔽; 模型线程没有 PRIMASK, 返回 0 */
+uint32_t sim_primask(void)
+{
+    rt_base_t level;
+
+    if (!sim_on_cpu)
+        return 0;
+
+    level = rt_hw_interrupt_disable();
+    rt_hw_interrupt_enable(level);
+
+    return level != 0;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    /* 仿真中断不嵌套, 优先级只影响同一批挂起中断的先后 (按向量号) */
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if ((int)IRQn < 0)
+        return;
+
+    __atomic_fetch_or(&nvic_enabled, 1UL << IRQn, __ATOMIC_SEQ_CST);
+    if (nvic_pending & (1UL << IRQn))
+        rt_hw_posix_irq_trigger(SIM_IRQ_VECTOR(IRQn));
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if ((int)IRQn >= 0)
+        __atomic_fetch_and(&nvic_enabled, ~(1UL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int)IRQn >= 0)
+        __atomic_fetch_and(&nvic_pending, ~(1UL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+/* =================================================================================
+ * 3. DMA 公共部分
+ * ================================================================================= */
+
+static struct
+{
+    void               (*irq)(void *owner, uint32_t flags);
+    void                *owner;
+    volatile uint32_t    flags;
+} sim_dma[16];
+
+static IRQn_Type sim_dma_irqn(DMA_Stream_TypeDef *stream)
+{
+    int idx = stream - sim_dma_stream;
+
+    return (idx < 8) ? (IRQn_Type)(DMA1_Stream0_IRQn + idx) : (IRQn_Type)(DMA2_Stream0_IRQn + idx - 8);
+}
+
+void sim_dma_bind(DMA_Stream_TypeDef *stream, void (*irq)(void *owner, uint32_t flags), void *owner)
+{
+    int idx = stream - sim_dma_stream;
+
+    sim_dma[idx].irq   = irq;
+    sim_dma[idx].owner = owner;
+    sim_dma[idx].flags = 0;
+}
+
+void sim_dma_raise(DMA_Stream_TypeDef *stream, uint32_t flags)
+{
+    __atomic_fetch_or(&sim_dma[stream - sim_dma_stream].flags, flags, __ATOMIC_SEQ_CST);
+    sim_irq_raise(sim_dma_irqn(stream));
+}
+
+void sim_dma_clear(DMA_Stream_TypeDef *stream)
+{
+    __atomic_store_n(&sim_dma[stream - sim_dma_stream].flags, 0, __ATOMIC_SEQ_CST);
+}
+
+/* 已置位的标志还没有被流中断取走 */
+int sim_dma_pending(DMA_Stream_TypeDef *stream)
+{
+    return __atomic_load_n(&sim_dma[stream - sim_dma_stream].flags, __ATOMIC_SEQ_CST) != 0;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == RT_NULL || hdma->Instance == RT_NULL)
+        return HAL_ERROR;
+
+    hdma->ErrorCode = 0;
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->Lock = HAL_UNLOCKED;
+
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    int idx = (DMA_Stream_TypeDef *)hdma->Instance - sim_dma_stream;
+    uint32_t flags;
+
+    flags = __atomic_exchange_n(&sim_dma[idx].flags, 0, __ATOMIC_SEQ_CST);
+    if (flags != 0 && sim_dma[idx].irq != RT_NULL)
+        sim_dma[idx].irq(sim_dma[idx].owner, flags);
+}
+
+/* =================================================================================
+ * 4. SysTick 与 HAL 节拍
+ * ================================================================================= */
+
+static struct sim_event systick_event;
+static uint64_t systick_period_ns;
+static uint32_t systick_hz;
+static uint64_t systick_base_ns;        /* 当前周期开始 (VAL = LOAD) 的时刻 */
+static uint64_t systick_access_ns;      /* 最近一次经 SysTick 访问的时刻, 之后的写入视为发生在此刻 */
+static uint32_t systick_running;        /* 上次同步时的 ENABLE */
+static uint32_t systick_dropped;        /* 计到零时上一次仍挂起, 或事件线程迟到超过一个周期而合并掉的次数 */
+
+static uint32_t sim_systick_val(uint64_t t)
+{
+    uint64_t cycles = (t - systick_base_ns) * systick_hz / 1000000000ULL;
+
+    return sim_systick.LOAD - (uint32_t)(cycles % ((uint64_t)sim_systick.LOAD + 1));
+}
+
+/* 计到零: 置 COUNTFLAG 并挂起 SysTick 异常 */
+static void sim_systick_pend(void)
+{
+    __atomic_fetch_or(&sim_systick.CTRL, SysTick_CTRL_COUNTFLAG_Msk, __ATOMIC_SEQ_CST);
+    if (__atomic_fetch_or(&sim_scb.ICSR, SCB_ICSR_PENDSTSET_Msk, __ATOMIC_SEQ_CST) & SCB_ICSR_PENDSTSET_Msk)
+        systick_dropped++;
+    rt_hw_posix_irq_trigger(POSIX_IRQ_SYSTICK);
+}
+
+/*
+ * 持锁调用: 处理上一次访问之后对 CTRL 的写入, 运行时按 now 刷新 VAL.
+ * 停止时 VAL 停在写入时刻的值; 重新使能时从 VAL 继续, VAL 被写为 0 则从 LOAD 开始整周期.
+ */
+static void sim_systick_sync(uint64_t now)
+{
+    uint64_t n;
+    uint32_t running = sim_systick.CTRL & SysTick_CTRL_ENABLE_Msk;
+
+    if (running && !systick_running)
+    {
+        systick_base_ns = systick_access_ns;
+        if (sim_systick.VAL != 0)
+            systick_base_ns -= (uint64_t)(sim_systick.LOAD - sim_systick.VAL) * 1000000000ULL / systick_hz;
+        sim_event_arm(&systick_event, systick_base_ns + systick_period_ns);
+    }
+    else if (!running && systick_running)
+    {
+        /* 停止前已计到零而事件线程还没处理: 真实 SysTick 此时已挂起, 不能丢这一拍 */
+        if (systick_access_ns - systick_base_ns >= systick_period_ns)
+        {
+            n = (systick_access_ns - systick_base_ns) / systick_period_ns;
+            sim_systick_pend();
+            systick_dropped += (uint32_t)(n - 1);
+            systick_base_ns += n * systick_period_ns;
+        }
+        sim_systick.VAL = sim_systick_val(systick_access_ns);
+    }
+    systick_running = running;
+
+    if (running)
+        sim_systick.VAL = sim_systick_val(now);
+}
+
+SysTick_Type *sim_systick_regs(void)
+{
+    rt_base_t level;
+    uint64_t now;
+
+    level = sim_lock();
+    now = sim_now_ns();
+    sim_systick_sync(now);
+    systick_access_ns = now;
+    sim_unlock(level);
+
+    return &sim_systick;
+}
+
+static void sim_systick_fire(struct sim_event *ev)
+{
+    uint64_t now = sim_now_ns();
+    uint32_t was_running = systick_running;
+
+    sim_systick_sync(now);
+    if (!systick_running)
+    {
+        /* 停止期间按周期检查是否重新使能 */
+        sim_event_arm(ev, now + systick_period_ns);
+        return;
+    }
+    /* 刚发现重新使能, sync 已按使能时刻排好第一个周期 */
+    if (!was_running)
+        return;
+
+    sim_systick_pend();
+
+    /* 主机调度延迟超过一个周期时不补发, 与真实 SysTick 合并挂起一致; 周期边界不变 */
+    if (now - systick_base_ns < 2 * systick_period_ns)
+        systick_base_ns += systick_period_ns;
+    else
+    {
+        systick_dropped += (uint32_t)((now - systick_base_ns) / systick_period_ns - 1);
+        systick_base_ns += (now - systick_base_ns) / systick_period_ns * systick_period_ns;
+    }
+    sim_event_arm(ev, systick_base_ns + systick_period_ns);
+}
+
+static void sim_systick_isr(int vector, void *param)
+{
+    if (!(__atomic_fetch_and(&sim_scb.ICSR, ~SCB_ICSR_PENDSTSET_Msk, __ATOMIC_SEQ_CST) & SCB_ICSR_PENDSTSET_Msk))
+        return;
+
+    sim_ipsr_value = 15;
+    rt_tick_increase();
+    HAL_IncTick();
+    sim_ipsr_value = 0;
+}
+
+uint32_t HAL_SYSTICK_Config(uint32_t TicksNumb)
+{
+    rt_base_t level;
+
+    if (TicksNumb == 0 || TicksNumb - 1 > 0xFFFFFF)
+        return 1;
+
+    level = sim_lock();
+    sim_systick.LOAD = TicksNumb - 1;
+    sim_systick.VAL  = 0;
+    sim_systick.CTRL = 7;
+    systick_hz = SystemCoreClock;
+    systick_period_ns = (uint64_t)TicksNumb * 1000000000ULL / systick_hz;
+    systick_base_ns = systick_access_ns = sim_now_ns();
+    systick_running = SysTick_CTRL_ENABLE_Msk;
+    systick_event.fire = sim_systick_fire;
+    sim_event_arm(&systick_event, systick_base_ns + systick_period_ns);
+    sim_unlock(level);
+
+    return 0;
+}
+
+uint32_t sim_systick_behind(void)
+{
+    rt_base_t level;
+    uint64_t now;
+    uint32_t behind;
+
+    level = sim_lock();
+    now = sim_now_ns();
+    sim_systick_sync(now);
+    behind = systick_dropped;
+    if (sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk)
+        behind++;
+    if (systick_running)
+        behind += (uint32_t)((now - systick_base_ns) / systick_period_ns);
+    sim_unlock(level);
+
+    return behind;
+}
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+    uwTickFreq = 1;
+    HAL_SYSTICK_Config(SystemCoreClock / 1000);
+
+    return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+    uwTick += uwTickFreq;
+}
+
+/* 与 board.c 相同: 关中断时按 COUNTFLAG (读后清零) 推进, HAL 的超时不会卡住 */
+uint32_t HAL_GetTick(void)
+{
+    if (__get_PRIMASK() &&
+        (__atomic_fetch_and(&sim_systick.CTRL, ~SysTick_CTRL_COUNTFLAG_Msk, __ATOMIC_SEQ_CST) &
+         SysTick_CTRL_COUNTFLAG_Msk))
+        uwTick += uwTickFreq;
+
+    return uwTick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (HAL_GetTick() - start < Delay);
+}
+
+/* =================================================================================
+ * 5. DWT 与 WFI
+ * ================================================================================= */
+
+static DWT_Type sim_dwt_regs;
+static uint32_t dwt_offset;
+static uint32_t dwt_shadow;
+static volatile uint64_t sleep_cycles;
+
+DWT_Type *sim_dwt(void)
+{
+    uint32_t raw;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    raw = rt_hw_posix_cycles() - (uint32_t)sleep_cycles;
+
+    /* 应用写过 CYCCNT 或计数器停止时以当前值为新起点 */
+    if (!(sim_dwt_regs.CTRL & DWT_CTRL_CYCCNTENA_Msk) || sim_dwt_regs.CYCCNT != dwt_shadow)
+        dwt_offset = sim_dwt_regs.CYCCNT - raw;
+    else
+        sim_dwt_regs.CYCCNT = raw + dwt_offset;
+    dwt_shadow = sim_dwt_regs.CYCCNT;
+    rt_hw_interrupt_enable(level);
+
+    return &sim_dwt_regs;
+}
+
+uint64_t sim_sleep_cycles(void)
+{
+    return sleep_cycles;
+}
+
+void sim_wfi(void)
+{
+    uint32_t start = rt_hw_posix_cycles();
+
+    rt_hw_posix_wfi();
+    sleep_cycles += (uint32_t)(rt_hw_posix_cycles() - start);
+}
+
+/* =================================================================================
+ * 6. GPIO
+ * ================================================================================= */
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    int pin;
+
+    for (pin = 0; pin < 16; pin++)
+    {
+        if (GPIO_Init->Pin & (1UL << pin))
+            GPIOx->MODER = (GPIOx->MODER & ~(3UL << (pin * 2))) | ((GPIO_Init->Mode & 3UL) << (pin * 2));
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+/* =================================================================================
+ * 7. 板级初始化
+ * ================================================================================= */
+
+ALIGN(RT_ALIGN_SIZE) static rt_uint8_t sim_heap[SIM_HEAP_SIZE];
+ALIGN(32) static rt_uint8_t dma_pool[BOARD_DMA_POOL_SIZE];
+static rt_size_t dma_pool_used = 0;
+
+void *board_dma_alloc(rt_size_t size)
+{
+    void *ptr = RT_NULL;
+    rt_base_t level;
+
+    size = RT_ALIGN(size, RT_CPU_CACHE_LINE_SZ);
+
+    level = rt_hw_interrupt_disable();
+    if (dma_pool_used + size <= BOARD_DMA_POOL_SIZE)
+    {
+        ptr = &dma_pool[dma_pool_used];
+        dma_pool_used += size;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return ptr;
+}
+
+/* 固件 (main.c) 中有同名函数; 只链接部分模块的测试程序用这里的 */
+RT_WEAK void SystemClock_Config(void)
+{
+    HAL_PWREx_ConfigSupply(PWR_DIRECT_SMPS_SUPPLY);
+    clock_profile_apply(CLOCK_PROFILE_DEFAULT);
+}
+
+#ifdef RT_DEBUG
+static void sim_assert_hook(const char *ex, const char *func, rt_size_t line)
+{
+    console_panic();
+    rt_kprintf("(%s) assertion failed at function:%s, line number:%d \n", ex, func, line);
+    sim_exit(1);
+}
+#endif
+
+void rt_hw_board_init(void)
+{
+    int irqn;
+
+    rt_hw_interrupt_init();
+    rt_hw_interrupt_install(POSIX_IRQ_SYSTICK, sim_systick_isr, RT_NULL, "tick");
+    for (irqn = 0; irqn < SIM_IRQn_MAX; irqn++)
+        rt_hw_interrupt_install(SIM_IRQ_VECTOR(irqn), sim_irq_entry, (void *)(rt_ubase_t)irqn, "irq");
+
+    /* 空闲时主机线程睡眠到下一个仿真中断 */
+    rt_thread_idle_sethook(rt_hw_posix_idle);
+
+    /* SysTick 由 clock_profile_apply() 按 CPU 频率和 RT_TICK_PER_SECOND 配置 */
+    HAL_Init();
+    SystemClock_Config();
+
+    rt_system_heap_init(sim_heap, sim_heap + SIM_HEAP_SIZE);
+
+    uart_port_init();
+    console_init(uart_port_find("uart3"));
+#ifdef RT_DEBUG
+    /* 断言失败时刷新输出后退出, 而不是像目标上那样停住 */
+    rt_assert_set_hook(sim_assert_hook);
+#endif
+
+#ifdef RT_USING_COMPONENTS_INIT
+    rt_components_board_init();
+#endif
+
+    rt_kprintf("\r\n[Board] Host simulation Init OK\r\n");
+}
+
+void rt_hw_console_output(const char *str)
+{
+    console_output(str);
+}
+
+char rt_hw_console_getchar(void)
+{
+    return console_getchar();
+}
+
+/* =================================================================================
+ * 8. 启动与退出
+ * ================================================================================= */
+
+static struct sim_event exit_event;
+static int exit_requested;
+static int exit_code;
+static int exit_until;
+
+void sim_exit_request(int code)
+{
+    if (__atomic_exchange_n(&exit_requested, 1, __ATOMIC_SEQ_CST))
+        return;
+
+    exit_code = code;
+    rt_hw_posix_irq_trigger(SIM_IRQ_EXIT);
+}
+
+static void sim_exit_fire(struct sim_event *ev)
+{
+    if (exit_until)
+        fprintf(stderr, "sim: --until text not seen before --run-ms\n");
+    sim_exit_request(exit_until ? 1 : 0);
+}
+
+static void sim_exit_isr(int vector, void *param)
+{
+    sim_exit(exit_code);
+}
+
+void sim_exit(int code)
+{
+    /* 控制台切换为同步模式, 队列中的输出直接写 TDR */
+    console_panic();
+    sim_uart_stop();
+    fflush(stdout);
+    fflush(stderr);
+    _exit(code);
+}
+
+/* --input 中的 \n \r \t \\ 转义 */
+static size_t sim_unescape(const char *in, char *out)
+{
+    size_t n = 0;
+
+    while (*in)
+    {
+        if (*in == '\\' && in[1] != '\0')
+        {
+            in++;
+            switch (*in)
+            {
+            case 'n': out[n++] = '\n'; break;
+            case 'r': out[n++] = '\r'; break;
+            case 't': out[n++] = '\t'; break;
+            default:  out[n++] = *in;  break;
+            }
+            in++;
+        }
+        else
+        {
+            out[n++] = *in++;
+        }
+    }
+
+    return n;
+}
+
+static void sim_usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [--uart1 SPEC] [--uart3 SPEC] [--uart7 SPEC] [--input STR] [--until STR] [--run-ms N]\n"
+            "  SPEC: none | stdio | pty | <device path>\n", prog);
+}
+
+int sim_init(int argc, char **argv)
+{
+    pthread_condattr_t attr;
+    pthread_t tid;
+    char *input = RT_NULL;
+    size_t input_len = 0;
+    long run_ms = 0;
+    int i;
+
+    /* 本线程即仿真 CPU, 其余线程都是外设模型 */
+    sim_on_cpu = 1;
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    signal(SIGPIPE, SIG_IGN);
+    rt_hw_interrupt_init();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            goto usage;
+
+        if (strcmp(argv[i], "--uart1") == 0 || strcmp(argv[i], "--uart3") == 0 ||
+            strcmp(argv[i], "--uart7") == 0)
+        {
+            if (sim_uart_backend(argv[i] + 2, argv[i + 1]) != 0)
+                goto usage;
+        }
+        else if (strcmp(argv[i], "--input") == 0)
+        {
+            input = malloc(strlen(argv[i + 1]) + 1);
+            if (input == RT_NULL)
+                return 1;
+            input_len = sim_unescape(argv[i + 1], input);
+        }
+        else if (strcmp(argv[i], "--until") == 0)
+        {
+            if (sim_uart_until("uart3", argv[i + 1]) != 0)
+                goto usage;
+            exit_until = 1;
+        }
+        else if (strcmp(argv[i], "--run-ms") == 0)
+        {
+            run_ms = atol(argv[i + 1]);
+            if (run_ms <= 0)
+                goto usage;
+        }
+        else
+        {
+            goto usage;
+        }
+        i++;
+    }
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&event_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (sim_thread_create(&tid, sim_event_entry, RT_NULL) != 0)
+        return 1;
+    pthread_detach(tid);
+
+    sim_uart_start();
+
+    if (input != RT_NULL)
+    {
+        sim_uart_input("uart3", input, input_len);
+        free(input);
+    }
+
+    rt_hw_interrupt_install(SIM_IRQ_EXIT, sim_exit_isr, RT_NULL, "exit");
+    if (run_ms > 0)
+    {
+        rt_base_t level;
+
+        exit_event.fire = sim_exit_fire;
+        level = sim_lock();
+        sim_event_arm(&exit_event, sim_now_ns() + (uint64_t)run_ms * 1000000ULL);
+        sim_unlock(level);
+    }
+
+    return 0;
+
+usage:
+    sim_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,99 @@
+/*
+ * sim_crc.c - 主机仿真: CRC 计算单元
+ *
+ * 32 位多项式, 按 MSB 先行移位; 输入可按字节反转 (每个字节位序反转后
+ * 送入), 输出可整体位反转, 与 H7 CRC 外设的 REV_IN = 字节、REV_OUT 一致.
+ * 只支持字节输入格式 (CRC_INPUTDATA_FORMAT_BYTES), BufferLength 为字节数.
+ */
+
+#include "sim.h"
+
+#define SIM_CRC_DEFAULT_POLY    0x04C11DB7UL
+#define SIM_CRC_DEFAULT_INIT    0xFFFFFFFFUL
+#define SIM_CRC_CR_REV_IN       (1UL << 5)
+#define SIM_CRC_CR_REV_OUT      (1UL << 7)
+
+CRC_TypeDef sim_crc;
+
+/* 移位寄存器; DR 读出的是按 REV_OUT 处理后的值 */
+static uint32_t crc_state;
+
+static uint8_t sim_crc_rev8(uint8_t b)
+{
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+
+    return b;
+}
+
+static uint32_t sim_crc_rev32(uint32_t v)
+{
+    return (uint32_t)sim_crc_rev8(v) << 24 | (uint32_t)sim_crc_rev8(v >> 8) << 16 |
+           (uint32_t)sim_crc_rev8(v >> 16) << 8 | sim_crc_rev8(v >> 24);
+}
+
+static uint32_t sim_crc_feed(CRC_HandleTypeDef *hcrc, const uint8_t *data, uint32_t len)
+{
+    CRC_TypeDef *regs = hcrc->Instance;
+    uint32_t crc = crc_state;
+    uint8_t b;
+    int bit;
+
+    while (len--)
+    {
+        b = *data++;
+        if (regs->CR & SIM_CRC_CR_REV_IN)
+            b = sim_crc_rev8(b);
+
+        crc ^= (uint32_t)b << 24;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80000000UL) ? (crc << 1) ^ regs->POL : crc << 1;
+    }
+
+    crc_state = crc;
+    regs->DR = (regs->CR & SIM_CRC_CR_REV_OUT) ? sim_crc_rev32(crc) : crc;
+
+    return regs->DR;
+}
+
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef *hcrc)
+{
+    CRC_TypeDef *regs;
+
+    if (hcrc == RT_NULL || hcrc->Instance == RT_NULL)
+        return HAL_ERROR;
+    if (hcrc->InputDataFormat != CRC_INPUTDATA_FORMAT_BYTES)
+        return HAL_ERROR;
+
+    regs = hcrc->Instance;
+    regs->POL  = (hcrc->Init.DefaultPolynomialUse == DEFAULT_POLYNOMIAL_ENABLE) ?
+                 SIM_CRC_DEFAULT_POLY : hcrc->Init.GeneratingPolynomial;
+    regs->INIT = (hcrc->Init.DefaultInitValueUse == DEFAULT_INIT_VALUE_ENABLE) ?
+                 SIM_CRC_DEFAULT_INIT : hcrc->Init.InitValue;
+    regs->CR   = 0;
+    if (hcrc->Init.InputDataInversionMode == CRC_INPUTDATA_INVERSION_BYTE)
+        regs->CR |= SIM_CRC_CR_REV_IN;
+    if (hcrc->Init.OutputDataInversionMode == CRC_OUTPUTDATA_INVERSION_ENABLE)
+        regs->CR |= SIM_CRC_CR_REV_OUT;
+
+    crc_state = regs->INIT;
+    regs->DR  = crc_state;
+    hcrc->Lock  = HAL_UNLOCKED;
+    hcrc->State = 1;
+
+    return HAL_OK;
+}
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength)
+{
+    /* 从初值开始 */
+    crc_state = hcrc->Instance->INIT;
+
+    return sim_crc_feed(hcrc, (const uint8_t *)pBuffer, BufferLength);
+}
+
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength)
+{
+    return sim_crc_feed(hcrc, (const uint8_t *)pBuffer, BufferLength);
+}
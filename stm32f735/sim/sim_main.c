@@ -0,0 +1,21 @@
+/*
+ * sim_main.c - 主机仿真的进程入口
+ *
+ * 固件的 main() 以 -Dmain=app_main 编译, 由 RT-Thread 的 main 线程调用;
+ * 这里是主机进程的 main: 解析命令行、启动外设模型后进入 rtthread_startup(),
+ * 不再返回. 测试程序提供自己的 app_main() 并链接同一个入口.
+ */
+
+#include "sim.h"
+
+extern int entry(void);
+
+int main(int argc, char **argv)
+{
+    if (sim_init(argc, argv) != 0)
+        return 2;
+
+    entry();
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * sim_rcc.c - 主机仿真: RCC/PWR/FLASH
+ *
+ * 只建模 clock_profile.c 用到的部分: 系统时钟在 HSI 与 PLL1 之间切换,
+ * AHB/APB 分频, USART 内核时钟源, 电压档位与 VOSRDY. 系统时钟改变时按
+ * 新频率更新 SystemCoreClock 与仿真 CPU 频率 (rt_hw_posix_core_clock_set),
+ * 并像真实 HAL 的 HAL_InitTick 一样把 SysTick 重装为 1 kHz.
+ *
+ * sim_rcc_inject() 可让 PLL1 不锁定或 VOSRDY 不置位, PLL 的等待与真实 HAL
+ * 一样以 HAL_GetTick 计时, 超时返回 HAL_TIMEOUT.
+ */
+
+#include "sim.h"
+#include <cpuport.h>
+
+#define SIM_RCC_VOS_DELAY_NS    20000ULL        /* 改电压档位到 VOSRDY 的时间 */
+#define SIM_RCC_PLL_TIMEOUT_MS  2U              /* HAL 的 PLL_TIMEOUT_VALUE */
+
+RCC_TypeDef   sim_rcc;
+/* 选项字节按出厂设置, CPUFREQ_BOOST 已置位 */
+FLASH_TypeDef sim_flash = { 0, 0, FLASH_OPTSR2_CPUFREQ_BOOST };
+
+static struct
+{
+    uint32_t             sysclk_src;
+    uint32_t             pll_hz;            /* 0: PLL1 关闭 */
+    uint32_t             sys_div;
+    uint32_t             ahb_div;
+    uint32_t             apb1_div;
+    uint32_t             apb2_div;
+    uint32_t             usart16_src;
+    uint32_t             usart234578_src;
+    uint32_t             vos;
+    uint64_t             vos_ready_ns;
+    uint32_t             faults;            /* SIM_RCC_FAULT_xxx */
+} rcc =
+{
+    RCC_SYSCLKSOURCE_HSI, 0, 1, 1, 1, 1,
+    RCC_USART16CLKSOURCE_D2PCLK2, RCC_USART234578CLKSOURCE_D2PCLK1,
+    PWR_REGULATOR_VOLTAGE_SCALE3, 0, 0,
+};
+
+/* =================================================================================
+ * 1. RCC
+ * ================================================================================= */
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    RCC_PLLInitTypeDef *pll = &RCC_OscInitStruct->PLL;
+    uint32_t tickstart;
+
+    if (pll->PLLState == RCC_PLL_NONE)
+        return HAL_OK;
+
+    /* 正在作为系统时钟的 PLL 不能重配 */
+    if (rcc.sysclk_src == RCC_SYSCLKSOURCE_PLLCLK)
+        return HAL_ERROR;
+
+    if (pll->PLLState == RCC_PLL_OFF)
+    {
+        rcc.pll_hz = 0;
+        return HAL_OK;
+    }
+
+    if (pll->PLLM == 0 || pll->PLLP == 0)
+        return HAL_ERROR;
+
+    /* 等待 PLLRDY 直到超时, PLL1 留在关闭状态 */
+    if (rcc.faults & SIM_RCC_FAULT_PLL_LOCK)
+    {
+        rcc.pll_hz = 0;
+        tickstart = HAL_GetTick();
+        while (HAL_GetTick() - tickstart <= SIM_RCC_PLL_TIMEOUT_MS);
+        return HAL_TIMEOUT;
+    }
+    rcc.pll_hz = (uint32_t)((uint64_t)HSI_VALUE / pll->PLLM * pll->PLLN / pll->PLLP);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    RCC_ClkInitTypeDef *clk = RCC_ClkInitStruct;
+    uint32_t sysclk;
+
+    sim_flash.ACR = FLatency;
+
+    if (clk->ClockType & RCC_CLOCKTYPE_SYSCLK)
+    {
+        if (clk->SYSCLKSource == RCC_SYSCLKSOURCE_PLLCLK && rcc.pll_hz == 0)
+            return HAL_ERROR;
+        rcc.sysclk_src = clk->SYSCLKSource;
+        rcc.sys_div = clk->SYSCLKDivider ? clk->SYSCLKDivider : 1;
+    }
+    if (clk->ClockType & RCC_CLOCKTYPE_HCLK)
+        rcc.ahb_div = clk->AHBCLKDivider ? clk->AHBCLKDivider : 1;
+    if (clk->ClockType & RCC_CLOCKTYPE_PCLK1)
+    {
+        rcc.apb1_div = clk->APB1CLKDivider ? clk->APB1CLKDivider : 1;
+        sim_rcc.D2CFGR = (sim_rcc.D2CFGR & ~RCC_D2CFGR_D2PPRE1) | rcc.apb1_div;
+    }
+    if (clk->ClockType & RCC_CLOCKTYPE_PCLK2)
+        rcc.apb2_div = clk->APB2CLKDivider ? clk->APB2CLKDivider : 1;
+
+    sysclk = (rcc.sysclk_src == RCC_SYSCLKSOURCE_PLLCLK) ? rcc.pll_hz : HSI_VALUE;
+    SystemCoreClock = sysclk / rcc.sys_div;
+    rt_hw_posix_core_clock_set(SystemCoreClock);
+
+    return HAL_SYSTICK_Config(SystemCoreClock / (1000U / uwTickFreq)) == 0 ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+    if (PeriphClkInit->PeriphClockSelection & RCC_PERIPHCLK_USART16)
+        rcc.usart16_src = PeriphClkInit->Usart16ClockSelection;
+    if (PeriphClkInit->PeriphClockSelection & RCC_PERIPHCLK_USART234578)
+        rcc.usart234578_src = PeriphClkInit->Usart234578ClockSelection;
+
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock / rcc.ahb_div;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return HAL_RCC_GetHCLKFreq() / rcc.apb1_div;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return HAL_RCC_GetHCLKFreq() / rcc.apb2_div;
+}
+
+uint32_t sim_rcc_hclk(void)
+{
+    return HAL_RCC_GetHCLKFreq();
+}
+
+uint32_t sim_rcc_usart_hz(USART_TypeDef *instance)
+{
+    if (instance == USART1 || instance == USART6)
+        return (rcc.usart16_src == RCC_USART16CLKSOURCE_HSI) ? HSI_VALUE : HAL_RCC_GetPCLK2Freq();
+
+    return (rcc.usart234578_src == RCC_USART234578CLKSOURCE_HSI) ? HSI_VALUE : HAL_RCC_GetPCLK1Freq();
+}
+
+void sim_rcc_inject(uint32_t faults)
+{
+    rcc.faults = faults;
+}
+
+/* =================================================================================
+ * 2. PWR
+ * ================================================================================= */
+
+HAL_StatusTypeDef HAL_PWREx_ConfigSupply(uint32_t SupplySource)
+{
+    return HAL_OK;
+}
+
+void sim_pwr_voltage_scaling(uint32_t scale)
+{
+    if (scale != rcc.vos)
+    {
+        rcc.vos = scale;
+        rcc.vos_ready_ns = sim_now_ns() + SIM_RCC_VOS_DELAY_NS;
+    }
+}
+
+uint32_t sim_pwr_get_flag(uint32_t flag)
+{
+    if (flag == PWR_FLAG_VOSRDY)
+        return !(rcc.faults & SIM_RCC_FAULT_VOSRDY) && sim_now_ns() >= rcc.vos_ready_ns;
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * sim_tim.c - 主机仿真: 高精度定时器的 TIM2 后端 (代替 hrtimer_tim.c) 与 LPTIM1
+ *
+ * TIM2 计数器为主机单调时钟上的 1 MHz 自由运行计数, 与 TIM2 分频到 1 MHz 后
+ * 一样不随时钟档位变化; 比较值写入后由事件线程在匹配时刻挂起 TIM2 中断.
+ *
+ * LPTIM1 同样以主机时钟折算, 按 LSI_VALUE 计数, ARR 处回绕; 比较匹配时置位
+ * CMPM, 开了 CMPM 中断时挂起 LPTIM1 中断, 用于把 tickless.c 从 WFI 中唤醒.
+ */
+
+#include "sim.h"
+#include "hrtimer.h"
+
+LPTIM_TypeDef sim_lptim1;
+
+static uint64_t lptim_base_ns;
+static struct sim_event lptim_event;
+
+static uint64_t tim_base_ns;
+static uint32_t tim_compare;
+static struct sim_event tim_event;
+
+/* =================================================================================
+ * 1. 计数器后端
+ * ================================================================================= */
+
+static rt_uint32_t sim_tim_count(void)
+{
+    return (rt_uint32_t)((sim_now_ns() - tim_base_ns) / 1000);
+}
+
+static void sim_tim_fire(struct sim_event *ev)
+{
+    sim_irq_raise(TIM2_IRQn);
+}
+
+static void sim_tim_set_compare(rt_uint32_t value)
+{
+    rt_base_t level;
+    uint64_t now, at;
+    rt_uint32_t delta;
+
+    level = sim_lock();
+    tim_compare = value;
+    now = sim_now_ns();
+
+    /* 匹配时刻: 从当前计数向前, 计数回绕后同一个值要一整圈 */
+    delta = value - (rt_uint32_t)((now - tim_base_ns) / 1000);
+    at = tim_base_ns + ((now - tim_base_ns) / 1000 + delta) * 1000;
+    sim_event_arm(&tim_event, at);
+    sim_unlock(level);
+}
+
+static void sim_tim_trigger(void)
+{
+    sim_irq_raise(TIM2_IRQn);
+}
+
+static const struct rt_hrtimer_clock sim_tim_clock =
+{
+    sim_tim_count,
+    sim_tim_set_compare,
+    sim_tim_trigger,
+};
+
+/* =================================================================================
+ * 2. 初始化与时钟切换
+ * ================================================================================= */
+
+rt_err_t hrtimer_tim_init(void)
+{
+    tim_base_ns = sim_now_ns();
+    tim_event.fire = sim_tim_fire;
+
+    HAL_NVIC_SetPriority(TIM2_IRQn, HRTIMER_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+
+    return rt_hrtimer_system_init(&sim_tim_clock);
+}
+
+void hrtimer_tim_reclock(void)
+{
+    /* 计数频率与时钟档位无关 */
+}
+
+void TIM2_IRQHandler(void)
+{
+    rt_interrupt_enter();
+    rt_hrtimer_isr();
+    rt_interrupt_leave();
+}
+
+/* =================================================================================
+ * 3. LPTIM1
+ * ================================================================================= */
+
+/* 从 HAL_LPTIM_Init 起经过的 LPTIM 计数 (不回绕) */
+static uint64_t sim_lptim_ticks(uint64_t now)
+{
+    return (now - lptim_base_ns) / 1000000000ULL * LSI_VALUE +
+           (now - lptim_base_ns) % 1000000000ULL * LSI_VALUE / 1000000000ULL;
+}
+
+static uint64_t sim_lptim_period(void)
+{
+    return (uint64_t)(sim_lptim1.ARR ? sim_lptim1.ARR : 0xFFFF) + 1;
+}
+
+static void sim_lptim_fire(struct sim_event *ev)
+{
+    __atomic_fetch_or(&sim_lptim1.ISR, LPTIM_FLAG_CMPM, __ATOMIC_SEQ_CST);
+    if (sim_lptim1.IER & LPTIM_IT_CMPM)
+        sim_irq_raise(LPTIM1_IRQn);
+
+    /* 计数器每转一圈匹配一次 */
+    sim_event_arm(ev, ev->at_ns + sim_lptim_period() * 1000000000ULL / LSI_VALUE);
+}
+
+HAL_StatusTypeDef HAL_LPTIM_Init(LPTIM_HandleTypeDef *hlptim)
+{
+    if (hlptim == RT_NULL || hlptim->Instance == RT_NULL)
+        return HAL_ERROR;
+
+    lptim_base_ns = sim_now_ns();
+    lptim_event.fire = sim_lptim_fire;
+    hlptim->Lock  = HAL_UNLOCKED;
+    hlptim->State = 1;
+
+    return HAL_OK;
+}
+
+uint32_t HAL_LPTIM_ReadCounter(const LPTIM_HandleTypeDef *hlptim)
+{
+    hlptim->Instance->CNT = (uint32_t)(sim_lptim_ticks(sim_now_ns()) % sim_lptim_period());
+
+    return hlptim->Instance->CNT;
+}
+
+void sim_lptim_compare_set(LPTIM_HandleTypeDef *hlptim, uint32_t value)
+{
+    uint64_t ticks, period, target;
+    rt_base_t level;
+
+    level = sim_lock();
+    hlptim->Instance->CMP = value;
+    __atomic_fetch_or(&hlptim->Instance->ISR, LPTIM_FLAG_CMPOK, __ATOMIC_SEQ_CST);
+
+    /* 下一次计数到达 value 的时刻, 向上取整到主机纳秒 */
+    ticks  = sim_lptim_ticks(sim_now_ns());
+    period = sim_lptim_period();
+    target = ticks - ticks % period + value % period;
+    if (target <= ticks)
+        target += period;
+    sim_event_arm(&lptim_event, lptim_base_ns + (target * 1000000000ULL + LSI_VALUE - 1) / LSI_VALUE);
+    sim_unlock(level);
+}
@@ -0,0 +1,1053 @@
+/*
+ * sim_uart.c - 主机仿真: USART1/USART3/UART7 与其 DMA1 收发流
+ *
+ * 每个端口三个模型线程:
+ *   读线程   从后端 (标准输入/伪终端/设备) 读入字节, 追加到线路输入队列;
+ *   接收线程 按字符时间 (10 位, 由 BRR 和 UART 内核时钟折算) 把输入队列中的
+ *            字节送上"线路": DMAR 置位时由 DMA 写入循环缓冲区 (半满/全满
+ *            置位 HT/TC), 否则进入 16 字节接收 FIFO; FIFO 满时有 RTS 流控
+ *            则停止对端 (字节留在输入队列), 否则丢弃并置位 ORE.
+ *            最后一个字节后一个字符时间线路空闲, 置位 IDLE;
+ *   发送线程 按字符时间从 DMA 发送缓冲区或轮询写入的 TDR 取数, 写到后端.
+ *
+ * HAL_UART_IRQHandler 与 DMA 回调按真实 HAL 的分支处理 IDLE/HT/TC 与错误:
+ * 阻塞性错误 (DMAR 置位时的任何错误, 或 ORE) 结束接收并中止 DMA 后调用
+ * HAL_UART_ErrorCallback, 由应用重新启动接收.
+ */
+
+#define _GNU_SOURCE
+#include "sim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* <termios.h> 的 CR1/CR2/CR3 (回车延时) 与 USART 寄存器同名 */
+#undef CR1
+#undef CR2
+#undef CR3
+
+#define SIM_UART_FIFO           16
+#define SIM_UART_BATCH          16          /* 接收/发送线程每次处理的最多字节数 */
+#define SIM_UART_TDR_EMPTY      0xFFFFFFFFUL
+#define SIM_UART_OUT_MAX        (1024 * 1024)
+
+USART_TypeDef sim_usart[8];
+
+struct sim_uart
+{
+    const char          *name;
+    USART_TypeDef       *instance;
+    IRQn_Type            irqn;
+    const char          *spec;
+    UART_HandleTypeDef  *huart;
+
+    int                  in_fd;
+    int                  out_fd;
+    int                  tty_fd;            /* 切换为原始模式的终端, 退出时恢复 */
+    struct termios       tty_saved;
+    pthread_cond_t       rx_cond;
+    pthread_cond_t       tx_cond;
+
+    /* 线路输入队列 */
+    uint8_t             *in_buf;
+    size_t               in_head;
+    size_t               in_len;
+    size_t               in_cap;
+
+    /* 接收 */
+    uint8_t              fifo[SIM_UART_FIFO];
+    int                  fifo_len;
+    int                  fifo_en;
+    int                  line_busy;
+    uint64_t             line_ns;           /* 最近一个字节停止位结束的时刻 */
+    int                  rx_dma_on;
+    int                  rx_it;             /* 错误与 IDLE 中断已使能 */
+    uint32_t             errors;            /* 待处理的线路错误 (HAL_UART_ERROR_xxx) */
+    int                  idle;
+    uint32_t             overruns;
+    struct sim_event     idle_event;
+
+    /* 发送 */
+    int                  tx_dma_on;
+    uint32_t             tx_gen;
+    uint8_t              poll[SIM_UART_FIFO];
+    int                  poll_len;
+    int                  poll_idle;         /* 轮询发送时发送线程检查 TDR, 空闲若干次后停止 */
+    int                  tx_writing;
+    uint8_t             *out_mem;           /* none 后端的输出 */
+    size_t               out_len;
+    size_t               out_cap;
+
+    /* 输出中出现 until 后请求退出 (--until), 只由发送线程访问 */
+    char                 until[SIM_UART_UNTIL_MAX];
+    size_t               until_len;
+    char                 until_tail[SIM_UART_UNTIL_MAX];
+    size_t               until_seen;
+};
+
+static struct sim_uart sim_uarts[] =
+{
+    { "uart1", USART1, USART1_IRQn, "none"  },
+    { "uart3", USART3, USART3_IRQn, "stdio" },
+    { "uart7", UART7,  UART7_IRQn,  "none"  },
+};
+
+#define SIM_UART_NUM            (sizeof(sim_uarts) / sizeof(sim_uarts[0]))
+
+static struct sim_uart *sim_uart_find(const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        if (strcmp(sim_uarts[i].name, name) == 0)
+            return &sim_uarts[i];
+    }
+
+    return RT_NULL;
+}
+
+static struct sim_uart *sim_uart_of(USART_TypeDef *instance)
+{
+    unsigned int i;
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        if (sim_uarts[i].instance == instance)
+            return &sim_uarts[i];
+    }
+
+    return RT_NULL;
+}
+
+/* 一个字符 (起始位 + 8 数据位 + 停止位) 的时间 */
+static uint64_t sim_uart_char_ns(struct sim_uart *u)
+{
+    uint32_t brr = u->instance->BRR;
+
+    if (brr == 0)
+        return 10000000000ULL / 115200;
+
+    return 10000000000ULL * brr / sim_rcc_usart_hz(u->instance);
+}
+
+/* =================================================================================
+ * 1. 接收
+ * ================================================================================= */
+
+static void sim_uart_dma_put(struct sim_uart *u, uint8_t c)
+{
+    UART_HandleTypeDef *huart = u->huart;
+    DMA_Stream_TypeDef *stream = (DMA_Stream_TypeDef *)huart->hdmarx->Instance;
+    uint16_t size = huart->RxXferSize;
+
+    huart->pRxBuffPtr[size - stream->NDTR] = c;
+    stream->NDTR--;
+    if (stream->NDTR == size / 2)
+    {
+        sim_dma_raise(stream, SIM_DMA_FLAG_HT);
+    }
+    else if (stream->NDTR == 0)
+    {
+        /* 循环模式: 计数重装, 继续从缓冲区起点写 */
+        stream->NDTR = size;
+        sim_dma_raise(stream, SIM_DMA_FLAG_TC);
+    }
+}
+
+static int sim_uart_dma_ready(struct sim_uart *u)
+{
+    return u->rx_dma_on && (u->instance->CR3 & USART_CR3_DMAR);
+}
+
+/*
+ * 下一个字节又会置位半满/全满, 而上一个还没有被中断取走: 主机线程被推迟了
+ * 半个缓冲区以上, 真实 CPU 不会落后这么多. 对端暂停, 否则补发积压的字节时
+ * DMA 会覆盖未读的数据
+ */
+static int sim_uart_dma_behind(struct sim_uart *u)
+{
+    DMA_Stream_TypeDef *stream;
+
+    if (!sim_uart_dma_ready(u))
+        return 0;
+
+    stream = (DMA_Stream_TypeDef *)u->huart->hdmarx->Instance;
+    if (stream->NDTR - 1 != u->huart->RxXferSize / 2 && stream->NDTR - 1 != 0)
+        return 0;
+
+    return sim_dma_pending(stream);
+}
+
+static void sim_uart_fifo_drain(struct sim_uart *u)
+{
+    int i;
+
+    if (u->fifo_len == 0 || !sim_uart_dma_ready(u))
+        return;
+
+    for (i = 0; i < u->fifo_len; i++)
+        sim_uart_dma_put(u, u->fifo[i]);
+    u->fifo_len = 0;
+}
+
+/* 一个字节到达; 返回 0 表示被 RTS 挡住, 留在对端 */
+static int sim_uart_rx_byte(struct sim_uart *u, uint8_t c)
+{
+    if (sim_uart_dma_ready(u) && u->fifo_len == 0)
+    {
+        sim_uart_dma_put(u, c);
+        return 1;
+    }
+
+    if (u->fifo_len < (u->fifo_en ? SIM_UART_FIFO : 1))
+    {
+        u->fifo[u->fifo_len++] = c;
+        return 1;
+    }
+
+    if (u->instance->CR3 & USART_CR3_RTSE)
+        return 0;
+
+    u->overruns++;
+    u->errors |= HAL_UART_ERROR_ORE;
+    if (u->rx_it)
+        sim_irq_raise(u->irqn);
+
+    return 1;
+}
+
+static void sim_uart_idle_fire(struct sim_event *ev)
+{
+    struct sim_uart *u = rt_container_of(ev, struct sim_uart, idle_event);
+
+    /* 对端仍在连续发送 */
+    if (u->line_busy && u->in_len > 0)
+        return;
+
+    u->idle = 1;
+    if (u->rx_it)
+        sim_irq_raise(u->irqn);
+}
+
+static void *sim_uart_rx_entry(void *parameter)
+{
+    struct sim_uart *u = (struct sim_uart *)parameter;
+    struct timespec ts;
+    uint64_t now, char_ns, wait_ns;
+    size_t due, n;
+    int held;
+
+    pthread_mutex_lock(&sim_mutex);
+    while (1)
+    {
+        /* FIFO 中的字节等待接收启动 (由 HAL_UARTEx_ReceiveToIdle_DMA 唤醒) */
+        if (u->in_len == 0 && (u->fifo_len == 0 || !u->rx_dma_on))
+        {
+            u->line_busy = 0;
+            pthread_cond_wait(&u->rx_cond, &sim_mutex);
+            continue;
+        }
+
+        now = sim_now_ns();
+        char_ns = sim_uart_char_ns(u);
+        wait_ns = char_ns * SIM_UART_BATCH;
+        held = 0;
+
+        sim_uart_fifo_drain(u);
+
+        if (u->in_len > 0 && (u->instance->CR1 & USART_CR1_UE))
+        {
+            /* 线路空闲后的第一个字节从现在开始发送 */
+            if (!u->line_busy)
+            {
+                u->line_busy = 1;
+                if (u->line_ns < now)
+                    u->line_ns = now;
+            }
+
+            due = (now > u->line_ns) ? (now - u->line_ns) / char_ns : 0;
+            for (n = 0; n < due && u->in_len > 0; n++)
+            {
+                if (sim_uart_dma_behind(u))
+                {
+                    held = 1;
+                    break;
+                }
+                if (!sim_uart_rx_byte(u, u->in_buf[u->in_head]))
+                {
+                    held = 1;
+                    break;
+                }
+                u->in_head++;
+                u->in_len--;
+                u->line_ns += char_ns;
+            }
+
+            if (held)
+            {
+                /* RTS 撤销或中断落后, 对端停在字节边界, 恢复后重新计时 */
+                u->line_busy = 0;
+            }
+            else if (n > 0)
+            {
+                sim_event_arm(&u->idle_event, u->line_ns + char_ns);
+            }
+
+            if (!held && u->in_len > 0)
+            {
+                n = u->in_len < SIM_UART_BATCH ? u->in_len : SIM_UART_BATCH;
+                wait_ns = u->line_ns + n * char_ns - now;
+            }
+        }
+
+        /* 等待下一批字节, 或 FIFO 中的字节等待 DMA 请求恢复 */
+        now += wait_ns;
+        ts.tv_sec  = now / 1000000000ULL;
+        ts.tv_nsec = now % 1000000000ULL;
+        pthread_cond_timedwait(&u->rx_cond, &sim_mutex, &ts);
+    }
+
+    return RT_NULL;
+}
+
+static void sim_uart_rx_dma_irq(void *owner, uint32_t flags)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)owner;
+
+    if (huart->RxState != HAL_UART_STATE_BUSY_RX || huart->ReceptionType != HAL_UART_RECEPTION_TOIDLE)
+        return;
+
+    /* 两个标志同时到达时按发生顺序: 先半满后全满 */
+    if (flags & SIM_DMA_FLAG_HT)
+        HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize / 2U);
+    if (flags & SIM_DMA_FLAG_TC)
+        HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+}
+
+/* 结束接收: 清 DMA 请求与中断使能, DMA 计数保留 */
+static void sim_uart_rx_stop(struct sim_uart *u)
+{
+    rt_base_t level;
+
+    level = sim_lock();
+    u->rx_dma_on = 0;
+    u->rx_it = 0;
+    CLEAR_BIT(u->instance->CR3, USART_CR3_DMAR);
+    if (u->huart->hdmarx != RT_NULL)
+        sim_dma_clear((DMA_Stream_TypeDef *)u->huart->hdmarx->Instance);
+    sim_unlock(level);
+
+    u->huart->RxState = HAL_UART_STATE_READY;
+    u->huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    struct sim_uart *u = sim_uart_of(huart->Instance);
+    DMA_Stream_TypeDef *stream;
+    rt_base_t level;
+
+    if (huart->RxState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if (pData == RT_NULL || Size == 0 || huart->hdmarx == RT_NULL)
+        return HAL_ERROR;
+
+    huart->ErrorCode     = HAL_UART_ERROR_NONE;
+    huart->RxState       = HAL_UART_STATE_BUSY_RX;
+    huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+    huart->pRxBuffPtr    = pData;
+    huart->RxXferSize    = Size;
+    huart->RxXferCount   = Size;
+
+    stream = (DMA_Stream_TypeDef *)huart->hdmarx->Instance;
+    level = sim_lock();
+    sim_dma_bind(stream, sim_uart_rx_dma_irq, huart);
+    stream->M0AR = (uint32_t)(uintptr_t)pData;
+    stream->NDTR = Size;
+    u->rx_dma_on = 1;
+    u->rx_it = 1;
+    u->errors &= ~HAL_UART_ERROR_ORE;
+    u->idle = 0;
+    SET_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+    pthread_cond_signal(&u->rx_cond);
+    sim_unlock(level);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    sim_uart_rx_stop(sim_uart_of(huart->Instance));
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    struct sim_uart *u = sim_uart_of(huart->Instance);
+    uint32_t errors, rem;
+    int idle, it;
+    rt_base_t level;
+
+    level = sim_lock();
+    it = u->rx_it;
+    errors = it ? u->errors : 0;
+    idle = it ? u->idle : 0;
+    u->errors &= ~errors;
+    u->idle = 0;
+    sim_unlock(level);
+
+    if (errors != 0)
+    {
+        huart->ErrorCode |= errors;
+
+        if ((huart->Instance->CR3 & USART_CR3_DMAR) || (errors & HAL_UART_ERROR_ORE))
+        {
+            /* 阻塞性错误: 结束接收, 中止 DMA, 由回调重新启动 */
+            sim_uart_rx_stop(u);
+            HAL_UART_ErrorCallback(huart);
+        }
+        else
+        {
+            HAL_UART_ErrorCallback(huart);
+            huart->ErrorCode = HAL_UART_ERROR_NONE;
+        }
+        return;
+    }
+
+    /* 空闲: 报告 DMA 当前写位置, 位置未变 (0 或整圈) 时不报告 */
+    if (idle && huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE &&
+        (huart->Instance->CR3 & USART_CR3_DMAR))
+    {
+        rem = __HAL_DMA_GET_COUNTER(huart->hdmarx);
+        if (rem > 0 && rem < huart->RxXferSize)
+        {
+            huart->RxXferCount = rem;
+            HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize - rem);
+        }
+    }
+}
+
+/* =================================================================================
+ * 2. 发送
+ * ================================================================================= */
+
+/* 最近发出的 until_len 个字节与 until 比较, 一致时请求退出 */
+static void sim_uart_until_scan(struct sim_uart *u, const uint8_t *data, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len && u->until_len > 0; i++)
+    {
+        if (u->until_seen == u->until_len)
+        {
+            memmove(u->until_tail, u->until_tail + 1, u->until_len - 1);
+            u->until_seen--;
+        }
+        u->until_tail[u->until_seen++] = (char)data[i];
+        if (u->until_seen == u->until_len && memcmp(u->until_tail, u->until, u->until_len) == 0)
+        {
+            u->until_len = 0;
+            sim_exit_request(0);
+        }
+    }
+}
+
+static void sim_uart_out(struct sim_uart *u, const uint8_t *data, size_t len)
+{
+    ssize_t n;
+
+    sim_uart_until_scan(u, data, len);
+
+    if (u->out_fd >= 0)
+    {
+        while (len > 0)
+        {
+            n = write(u->out_fd, data, len);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            data += n;
+            len -= n;
+        }
+        return;
+    }
+
+    /* none 后端: 保存给 sim_uart_output(), 超过上限时丢弃 */
+    pthread_mutex_lock(&sim_mutex);
+    if (u->out_len + len > u->out_cap && u->out_len + len <= SIM_UART_OUT_MAX)
+    {
+        size_t cap = u->out_cap ? u->out_cap : 4096;
+        uint8_t *buf;
+
+        while (cap < u->out_len + len)
+            cap *= 2;
+        buf = realloc(u->out_mem, cap);
+        if (buf != RT_NULL)
+        {
+            u->out_mem = buf;
+            u->out_cap = cap;
+        }
+    }
+    if (u->out_len + len <= u->out_cap)
+    {
+        memcpy(u->out_mem + u->out_len, data, len);
+        u->out_len += len;
+    }
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+/* 轮询发送写入的 TDR 移入发送 FIFO, 持锁调用 */
+static void sim_uart_tdr_take(struct sim_uart *u)
+{
+    uint32_t tdr = __atomic_exchange_n(&u->instance->TDR, SIM_UART_TDR_EMPTY, __ATOMIC_SEQ_CST);
+
+    if (tdr <= 0xFF && u->poll_len < SIM_UART_FIFO)
+    {
+        u->poll[u->poll_len++] = (uint8_t)tdr;
+        u->poll_idle = 0;
+    }
+}
+
+static void *sim_uart_tx_entry(void *parameter)
+{
+    struct sim_uart *u = (struct sim_uart *)parameter;
+    UART_HandleTypeDef *huart;
+    DMA_Stream_TypeDef *stream;
+    uint8_t chunk[SIM_UART_BATCH];
+    struct timespec ts;
+    uint64_t now, next = 0, wait;
+    uint32_t gen, n;
+
+    pthread_mutex_lock(&sim_mutex);
+    while (1)
+    {
+        huart = u->huart;
+        if (huart == RT_NULL)
+        {
+            pthread_cond_wait(&u->tx_cond, &sim_mutex);
+            continue;
+        }
+        stream = (huart->hdmatx != RT_NULL) ? (DMA_Stream_TypeDef *)huart->hdmatx->Instance : RT_NULL;
+        sim_uart_tdr_take(u);
+
+        n = 0;
+        gen = u->tx_gen;
+        if (!(u->instance->CR1 & USART_CR1_UE))
+        {
+            /* 切换时钟期间暂停 */
+        }
+        else if (u->tx_dma_on && stream->NDTR > 0)
+        {
+            n = stream->NDTR < SIM_UART_BATCH ? stream->NDTR : SIM_UART_BATCH;
+            memcpy(chunk, huart->pTxBuffPtr + huart->TxXferSize - stream->NDTR, n);
+            stream->NDTR -= n;
+        }
+        else if (u->poll_len > 0)
+        {
+            n = u->poll_len;
+            memcpy(chunk, u->poll, n);
+            u->poll_len = 0;
+        }
+
+        if (n > 0)
+        {
+            u->tx_writing = 1;
+            wait = sim_uart_char_ns(u) * n;
+            pthread_mutex_unlock(&sim_mutex);
+
+            /*
+             * 连续发送时按绝对截止时间计: 主机负载下本线程迟到后随即补发, 线路
+             * 平均仍是波特率, 与按主机时间计的超时 (如控制台等待空间) 一致
+             */
+            sim_uart_out(u, chunk, n);
+            next = next ? next + wait : sim_now_ns() + wait;
+            sim_sleep_until(next);
+
+            pthread_mutex_lock(&sim_mutex);
+            u->tx_writing = 0;
+            if (gen == u->tx_gen && u->tx_dma_on && stream->NDTR == 0)
+            {
+                u->tx_dma_on = 0;
+                sim_dma_raise(stream, SIM_DMA_FLAG_TC);
+            }
+            continue;
+        }
+
+        /* 线路空闲, 下次发送从当时算起 */
+        next = 0;
+
+        if (u->poll_idle < 1000)
+        {
+            /* 轮询发送时最后一个字符写入 TDR 后没有人再查询标志, 定时取走 */
+            u->poll_idle++;
+            now = sim_now_ns() + 2 * sim_uart_char_ns(u);
+            ts.tv_sec  = now / 1000000000ULL;
+            ts.tv_nsec = now % 1000000000ULL;
+            pthread_cond_timedwait(&u->tx_cond, &sim_mutex, &ts);
+        }
+        else
+        {
+            pthread_cond_wait(&u->tx_cond, &sim_mutex);
+        }
+    }
+
+    return RT_NULL;
+}
+
+static void sim_uart_tx_dma_irq(void *owner, uint32_t flags)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)owner;
+
+    if (huart->gState != HAL_UART_STATE_BUSY_TX)
+        return;
+
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+    huart->gState = HAL_UART_STATE_READY;
+    if (flags & SIM_DMA_FLAG_TE)
+    {
+        huart->ErrorCode |= HAL_UART_ERROR_DMA;
+        HAL_UART_ErrorCallback(huart);
+    }
+    else if (flags & SIM_DMA_FLAG_TC)
+    {
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    struct sim_uart *u = sim_uart_of(huart->Instance);
+    DMA_Stream_TypeDef *stream;
+    rt_base_t level;
+
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if (pData == RT_NULL || Size == 0 || huart->hdmatx == RT_NULL)
+        return HAL_ERROR;
+
+    huart->ErrorCode   = HAL_UART_ERROR_NONE;
+    huart->gState      = HAL_UART_STATE_BUSY_TX;
+    huart->pTxBuffPtr  = pData;
+    huart->TxXferSize  = Size;
+    huart->TxXferCount = Size;
+
+    stream = (DMA_Stream_TypeDef *)huart->hdmatx->Instance;
+    level = sim_lock();
+    sim_dma_bind(stream, sim_uart_tx_dma_irq, huart);
+    stream->M0AR = (uint32_t)(uintptr_t)pData;
+    stream->NDTR = Size;
+    u->tx_dma_on = 1;
+    u->tx_gen++;
+    SET_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+    pthread_cond_signal(&u->tx_cond);
+    sim_unlock(level);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart)
+{
+    struct sim_uart *u = sim_uart_of(huart->Instance);
+    rt_base_t level;
+
+    /* 已取走的字节照常发出, NDTR 保留为未发送的字节数 */
+    level = sim_lock();
+    u->tx_dma_on = 0;
+    u->tx_gen++;
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+    if (huart->hdmatx != RT_NULL)
+        sim_dma_clear((DMA_Stream_TypeDef *)huart->hdmatx->Instance);
+    sim_unlock(level);
+
+    huart->gState = HAL_UART_STATE_READY;
+
+    return HAL_OK;
+}
+
+uint32_t sim_uart_get_flag(UART_HandleTypeDef *huart, uint32_t flag)
+{
+    struct sim_uart *u = sim_uart_of(huart->Instance);
+    uint32_t set = 0;
+    rt_base_t level;
+
+    level = sim_lock();
+    if (flag == UART_FLAG_TXE)
+    {
+        sim_uart_tdr_take(u);
+        set = u->poll_len < (u->fifo_en ? SIM_UART_FIFO : 1);
+        u->poll_idle = 0;
+        pthread_cond_signal(&u->tx_cond);
+    }
+    else if (flag == UART_FLAG_RXNE)
+    {
+        set = u->fifo_len > 0;
+    }
+    sim_unlock(level);
+
+    /* 单核主机上让发送线程有机会运行 */
+    if (!set)
+        sched_yield();
+
+    return set;
+}
+
+/* =================================================================================
+ * 3. 初始化
+ * ================================================================================= */
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    struct sim_uart *u;
+    rt_base_t level;
+
+    if (huart == RT_NULL || (u = sim_uart_of(huart->Instance)) == RT_NULL)
+        return HAL_ERROR;
+
+    level = sim_lock();
+    huart->Instance->CR1 = 0;
+    huart->Instance->BRR = UART_DIV_SAMPLING16(sim_rcc_usart_hz(huart->Instance), huart->Init.BaudRate,
+                                               huart->Init.ClockPrescaler);
+    huart->Instance->CR3 = huart->Init.HwFlowCtl;
+    huart->Instance->TDR = SIM_UART_TDR_EMPTY;
+    u->huart = huart;
+    u->fifo_en = 0;
+    huart->Instance->CR1 = USART_CR1_UE;
+    pthread_cond_signal(&u->tx_cond);
+    sim_unlock(level);
+
+    huart->ErrorCode     = HAL_UART_ERROR_NONE;
+    huart->gState        = HAL_UART_STATE_READY;
+    huart->RxState       = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    huart->Lock          = HAL_UNLOCKED;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart)
+{
+    sim_uart_of(huart->Instance)->fifo_en = 1;
+
+    return HAL_OK;
+}
+
+/* 与真实 HAL 一样提供弱回调, 不链接 uart_port.c 的测试程序也能用 DMA 接口 */
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+}
+
+/* =================================================================================
+ * 4. 后端与测试接口
+ * ================================================================================= */
+
+static void sim_uart_raw(struct sim_uart *u, int fd)
+{
+    struct termios tio;
+
+    if (!isatty(fd) || tcgetattr(fd, &u->tty_saved) != 0)
+        return;
+
+    /* 控制台输出已经是 CRLF */
+    tio = u->tty_saved;
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    u->tty_fd = fd;
+}
+
+static int sim_uart_open(struct sim_uart *u)
+{
+    int fd;
+
+    u->in_fd = u->out_fd = u->tty_fd = -1;
+
+    if (strcmp(u->spec, "none") == 0)
+        return 0;
+
+    if (strcmp(u->spec, "stdio") == 0)
+    {
+        u->in_fd  = STDIN_FILENO;
+        u->out_fd = STDOUT_FILENO;
+        sim_uart_raw(u, STDIN_FILENO);
+        return 0;
+    }
+
+    if (strcmp(u->spec, "pty") == 0)
+    {
+        fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+            return -1;
+
+        /* 保持从端打开: 对端关闭后主端读不会返回 EIO */
+        u->tty_fd = -1;
+        sim_uart_raw(u, open(ptsname(fd), O_RDWR | O_NOCTTY));
+        u->tty_fd = -1;
+        fprintf(stderr, "sim: %s on %s\n", u->name, ptsname(fd));
+        u->in_fd = u->out_fd = fd;
+        return 0;
+    }
+
+    fd = open(u->spec, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "sim: %s: cannot open %s: %s\n", u->name, u->spec, strerror(errno));
+        return -1;
+    }
+    sim_uart_raw(u, fd);
+    u->tty_fd = -1;
+    u->in_fd = u->out_fd = fd;
+
+    return 0;
+}
+
+static void *sim_uart_read_entry(void *parameter)
+{
+    struct sim_uart *u = (struct sim_uart *)parameter;
+    uint8_t buf[256];
+    ssize_t n;
+
+    while (1)
+    {
+        n = read(u->in_fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        sim_uart_input(u->name, buf, n);
+    }
+
+    return RT_NULL;
+}
+
+int sim_uart_backend(const char *name, const char *spec)
+{
+    struct sim_uart *u = sim_uart_find(name);
+
+    if (u == RT_NULL)
+        return -1;
+
+    u->spec = spec;
+
+    return 0;
+}
+
+int sim_uart_input(const char *name, const void *data, size_t len)
+{
+    struct sim_uart *u = sim_uart_find(name);
+    rt_base_t level;
+    int result = 0;
+
+    if (u == RT_NULL)
+        return -1;
+
+    level = sim_lock();
+    if (u->in_head + u->in_len + len > u->in_cap)
+    {
+        /* 先把未发送的部分移到开头, 仍不够时扩大 */
+        memmove(u->in_buf, u->in_buf + u->in_head, u->in_len);
+        u->in_head = 0;
+        if (u->in_len + len > u->in_cap)
+        {
+            size_t cap = u->in_cap ? u->in_cap : 4096;
+            uint8_t *buf;
+
+            while (cap < u->in_len + len)
+                cap *= 2;
+            buf = realloc(u->in_buf, cap);
+            if (buf == RT_NULL)
+                result = -1;
+            else
+            {
+                u->in_buf = buf;
+                u->in_cap = cap;
+            }
+        }
+    }
+    if (result == 0)
+    {
+        memcpy(u->in_buf + u->in_head + u->in_len, data, len);
+        u->in_len += len;
+        pthread_cond_signal(&u->rx_cond);
+    }
+    sim_unlock(level);
+
+    return result;
+}
+
+int sim_uart_until(const char *name, const char *str)
+{
+    struct sim_uart *u = sim_uart_find(name);
+    size_t len = strlen(str);
+
+    if (u == RT_NULL || len == 0 || len > SIM_UART_UNTIL_MAX)
+        return -1;
+
+    memcpy(u->until, str, len);
+    u->until_len = len;
+    u->until_seen = 0;
+
+    return 0;
+}
+
+size_t sim_uart_output(const char *name, void *buf, size_t size)
+{
+    struct sim_uart *u = sim_uart_find(name);
+    rt_base_t level;
+
+    if (u == RT_NULL)
+        return 0;
+
+    level = sim_lock();
+    if (size > u->out_len)
+        size = u->out_len;
+    memcpy(buf, u->out_mem, size);
+    memmove(u->out_mem, u->out_mem + size, u->out_len - size);
+    u->out_len -= size;
+    sim_unlock(level);
+
+    return size;
+}
+
+static int sim_uart_busy(struct sim_uart *u)
+{
+    sim_uart_tdr_take(u);
+
+    return u->tx_dma_on || u->poll_len > 0 || u->tx_writing;
+}
+
+int sim_uart_tx_busy(const char *name)
+{
+    struct sim_uart *u = sim_uart_find(name);
+    rt_base_t level;
+    int busy;
+
+    if (u == RT_NULL)
+        return 0;
+
+    level = sim_lock();
+    busy = sim_uart_busy(u);
+    sim_unlock(level);
+
+    return busy;
+}
+
+int sim_uart_inject_error(const char *name, uint32_t error)
+{
+    struct sim_uart *u = sim_uart_find(name);
+    rt_base_t level;
+
+    if (u == RT_NULL)
+        return -1;
+
+    level = sim_lock();
+    u->errors |= error;
+    if (u->rx_it)
+        sim_irq_raise(u->irqn);
+    sim_unlock(level);
+
+    return 0;
+}
+
+uint32_t sim_uart_overruns(const char *name)
+{
+    struct sim_uart *u = sim_uart_find(name);
+
+    return (u != RT_NULL) ? u->overruns : 0;
+}
+
+void sim_uart_start(void)
+{
+    pthread_condattr_t attr;
+    pthread_t tid;
+    unsigned int i;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        struct sim_uart *u = &sim_uarts[i];
+
+        pthread_cond_init(&u->rx_cond, &attr);
+        pthread_cond_init(&u->tx_cond, &attr);
+        u->idle_event.fire = sim_uart_idle_fire;
+        u->poll_idle = 1000;
+
+        if (sim_uart_open(u) != 0)
+        {
+            fprintf(stderr, "sim: %s: backend %s unavailable, using none\n", u->name, u->spec);
+            u->in_fd = u->out_fd = -1;
+        }
+
+        sim_thread_create(&tid, sim_uart_rx_entry, u);
+        pthread_detach(tid);
+        sim_thread_create(&tid, sim_uart_tx_entry, u);
+        pthread_detach(tid);
+        if (u->in_fd >= 0)
+        {
+            sim_thread_create(&tid, sim_uart_read_entry, u);
+            pthread_detach(tid);
+        }
+    }
+
+    pthread_condattr_destroy(&attr);
+}
+
+void sim_uart_stop(void)
+{
+    uint64_t deadline = sim_now_ns() + 1000000000ULL;
+    unsigned int i;
+    rt_base_t level;
+    int busy;
+
+    do
+    {
+        busy = 0;
+        level = sim_lock();
+        for (i = 0; i < SIM_UART_NUM; i++)
+        {
+            if (sim_uart_busy(&sim_uarts[i]))
+            {
+                sim_uarts[i].poll_idle = 0;
+                pthread_cond_signal(&sim_uarts[i].tx_cond);
+                busy = 1;
+            }
+        }
+        sim_unlock(level);
+        if (busy)
+            sim_sleep_until(sim_now_ns() + 100000);
+    } while (busy && sim_now_ns() < deadline);
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        if (sim_uarts[i].tty_fd >= 0)
+            tcsetattr(sim_uarts[i].tty_fd, TCSANOW, &sim_uarts[i].tty_saved);
+    }
+}
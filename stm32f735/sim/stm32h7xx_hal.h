@@ -0,0 +1,721 @@
+/*
+ * stm32h7xx_hal.h - 主机仿真用的 HAL 子集
+ *
+ * 只包含应用代码 (main.c, uart_port.c, crypto_*.c, bridge_*.c, clock_profile.c,
+ * lat_hist.c, trace.c, tickless.c ...) 用到的类型、常量和函数. 句柄结构与
+ * 真实 HAL 的同名字段保持一致, 寄存器块是主机内存中的结构体, 由 sim_*.c
+ * 中的外设模型读写:
+ *
+ *   USART1/3/UART7 + DMA1   sim_uart.c   按 BRR 和内核时钟折算的字节时序, FIFO, HT/TC/IDLE/ORE
+ *   CRYP + DMA2             sim_cryp.c   软件 AES-128 ECB, 密钥寄存器与解密密钥准备状态
+ *   CRC                     sim_crc.c    可配置的 CRC-32 寄存器
+ *   RCC/PWR/FLASH           sim_rcc.c    PLL/分频/电压档位, 驱动仿真 CPU 频率
+ *   NVIC/SysTick/DWT/GPIO   sim_board.c  SysTick 按 LOAD 和仿真 CPU 频率定时, DWT 计仿真 CPU 周期
+ *   TIM2                    sim_tim.c    主机时钟上的 1 MHz 计数器, 作 hrtimer 后端
+ *   LPTIM1                  sim_tim.c    主机时钟上的 LSI 计数器与比较匹配中断
+ *
+ * 数值常量与真实 HAL 不同 (只保证互不相同), 应用代码只能通过宏名使用它们.
+ * 中断号即仿真中断向量减 1, SysTick 为 POSIX_IRQ_SYSTICK.
+ */
+#ifndef __STM32H7xx_HAL_H
+#define __STM32H7xx_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* =================================================================================
+ * 1. CMSIS
+ * ================================================================================= */
+
+#define __IO                    volatile
+#define __I                     volatile const
+#define __O                     volatile
+#define __weak                  __attribute__((weak))
+#define __STATIC_INLINE         static inline
+
+#define SET_BIT(REG, BIT)       ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)     ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)      ((REG) & (BIT))
+#define WRITE_REG(REG, VAL)     ((REG) = (VAL))
+#define READ_REG(REG)           ((REG))
+
+typedef enum
+{
+    SysTick_IRQn        = -1,
+    USART1_IRQn         = 1,
+    USART3_IRQn,
+    UART7_IRQn,
+    DMA1_Stream0_IRQn,
+    DMA1_Stream1_IRQn,
+    DMA1_Stream2_IRQn,
+    DMA1_Stream3_IRQn,
+    DMA1_Stream4_IRQn,
+    DMA1_Stream5_IRQn,
+    DMA1_Stream6_IRQn,
+    DMA1_Stream7_IRQn,
+    DMA2_Stream0_IRQn,
+    DMA2_Stream1_IRQn,
+    TIM2_IRQn,
+    LPTIM1_IRQn,
+    SIM_IRQn_MAX,
+} IRQn_Type;
+
+typedef struct { __IO uint32_t CTRL, LOAD, VAL, CALIB; } SysTick_Type;
+typedef struct { __IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR, CPACR; } SCB_Type;
+typedef struct { __IO uint32_t CTRL, CYCCNT, LAR; } DWT_Type;
+typedef struct { __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+
+#define SysTick_CTRL_ENABLE_Msk         (1UL << 0)
+#define SysTick_CTRL_COUNTFLAG_Msk      (1UL << 16)
+#define SCB_ICSR_PENDSTSET_Msk          (1UL << 26)
+#define SCB_CCR_UNALIGN_TRP_Msk         (1UL << 3)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+extern SysTick_Type     sim_systick;
+extern SCB_Type         sim_scb;
+extern CoreDebug_Type   sim_coredebug;
+SysTick_Type *sim_systick_regs(void);
+DWT_Type *sim_dwt(void);
+
+/* 每次访问按当前时刻刷新 VAL; 对 CTRL 的写入在下一次访问或下一个周期时生效 */
+#define SysTick                 (sim_systick_regs())
+#define SCB                     (&sim_scb)
+#define CoreDebug               (&sim_coredebug)
+/* 每次访问都按仿真 CPU 周期刷新 CYCCNT, 应用写入的值作为新的起点 */
+#define DWT                     (sim_dwt())
+
+uint32_t sim_ipsr(void);
+uint32_t sim_primask(void);
+void     sim_wfi(void);
+
+#define __DMB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __NOP()                 ((void)0)
+#define __WFI()                 sim_wfi()
+#define __CLZ(x)                ((uint32_t)((x) ? __builtin_clz(x) : 32))
+#define __get_IPSR()            sim_ipsr()
+#define __get_PRIMASK()         sim_primask()
+
+extern uint32_t SystemCoreClock;
+
+/* =================================================================================
+ * 2. HAL 公共
+ * ================================================================================= */
+
+typedef enum
+{
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U,
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED   = 0x01U,
+} HAL_LockTypeDef;
+
+typedef enum { RESET = 0U, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0U, ENABLE = !DISABLE } FunctionalState;
+
+#define HAL_MAX_DELAY           0xFFFFFFFFU
+#define __HAL_UNLOCK(h)         do { (h)->Lock = HAL_UNLOCKED; } while (0)
+#define __HAL_LINKDMA(h, field, dma) do { (h)->field = &(dma); (dma).Parent = (h); } while (0)
+
+extern __IO uint32_t uwTick;
+extern uint32_t uwTickFreq;
+
+HAL_StatusTypeDef HAL_Init(void);
+void              HAL_IncTick(void);
+uint32_t          HAL_GetTick(void);
+void              HAL_Delay(uint32_t Delay);
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+uint32_t HAL_SYSTICK_Config(uint32_t TicksNumb);
+
+/* =================================================================================
+ * 3. GPIO
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2]; } GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef sim_gpio[11];
+#define GPIOA                   (&sim_gpio[0])
+#define GPIOB                   (&sim_gpio[1])
+#define GPIOC                   (&sim_gpio[2])
+#define GPIOD                   (&sim_gpio[3])
+#define GPIOE                   (&sim_gpio[4])
+#define GPIOF                   (&sim_gpio[5])
+#define GPIOG                   (&sim_gpio[6])
+
+#define GPIO_PIN_0              0x0001U
+#define GPIO_PIN_1              0x0002U
+#define GPIO_PIN_2              0x0004U
+#define GPIO_PIN_3              0x0008U
+#define GPIO_PIN_4              0x0010U
+#define GPIO_PIN_5              0x0020U
+#define GPIO_PIN_6              0x0040U
+#define GPIO_PIN_7              0x0080U
+#define GPIO_PIN_8              0x0100U
+#define GPIO_PIN_9              0x0200U
+#define GPIO_PIN_10             0x0400U
+#define GPIO_PIN_11             0x0800U
+#define GPIO_PIN_12             0x1000U
+#define GPIO_PIN_13             0x2000U
+#define GPIO_PIN_14             0x4000U
+#define GPIO_PIN_15             0x8000U
+
+#define GPIO_MODE_INPUT         0U
+#define GPIO_MODE_OUTPUT_PP     1U
+#define GPIO_MODE_AF_PP         2U
+#define GPIO_NOPULL             0U
+#define GPIO_PULLUP             1U
+#define GPIO_PULLDOWN           2U
+#define GPIO_AF4_USART1         4U
+#define GPIO_AF7_USART1         7U
+#define GPIO_AF7_USART3         7U
+#define GPIO_AF7_UART7          7U
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+/* =================================================================================
+ * 4. RCC / PWR / FLASH
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t CR, CFGR, D1CFGR, D2CFGR, D3CFGR; } RCC_TypeDef;
+typedef struct { __IO uint32_t ACR, OPTSR_CUR, OPTSR2_CUR; } FLASH_TypeDef;
+
+extern RCC_TypeDef   sim_rcc;
+extern FLASH_TypeDef sim_flash;
+#define RCC                     (&sim_rcc)
+#define FLASH                   (&sim_flash)
+
+#define HSI_VALUE               64000000UL
+#define LSI_VALUE               32000UL
+
+typedef struct
+{
+    uint32_t PLLState;
+    uint32_t PLLSource;
+    uint32_t PLLM;
+    uint32_t PLLN;
+    uint32_t PLLP;
+    uint32_t PLLQ;
+    uint32_t PLLR;
+    uint32_t PLLRGE;
+    uint32_t PLLVCOSEL;
+    uint32_t PLLFRACN;
+} RCC_PLLInitTypeDef;
+
+typedef struct
+{
+    uint32_t OscillatorType;
+    uint32_t HSEState;
+    uint32_t LSEState;
+    uint32_t HSIState;
+    uint32_t HSICalibrationValue;
+    uint32_t LSIState;
+    uint32_t HSI48State;
+    uint32_t CSIState;
+    uint32_t CSICalibrationValue;
+    RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct
+{
+    uint32_t ClockType;
+    uint32_t SYSCLKSource;
+    uint32_t SYSCLKDivider;
+    uint32_t AHBCLKDivider;
+    uint32_t APB3CLKDivider;
+    uint32_t APB1CLKDivider;
+    uint32_t APB2CLKDivider;
+    uint32_t APB4CLKDivider;
+} RCC_ClkInitTypeDef;
+
+typedef struct
+{
+    uint32_t PeriphClockSelection;
+    uint32_t Usart16ClockSelection;
+    uint32_t Usart234578ClockSelection;
+    uint32_t Lptim1ClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSI          0x02U
+#define RCC_OSCILLATORTYPE_LSI          0x08U
+#define RCC_HSI_DIV1                    1U
+#define RCC_HSICALIBRATION_DEFAULT      0x40U
+#define RCC_LSI_ON                      1U
+#define RCC_PLL_NONE                    0U
+#define RCC_PLL_OFF                     1U
+#define RCC_PLL_ON                      2U
+#define RCC_PLLSOURCE_HSI               0U
+#define RCC_PLL1VCIRANGE_1              1U
+#define RCC_PLL1VCOWIDE                 0U
+
+#define RCC_CLOCKTYPE_SYSCLK            0x01U
+#define RCC_CLOCKTYPE_HCLK              0x02U
+#define RCC_CLOCKTYPE_PCLK1             0x04U
+#define RCC_CLOCKTYPE_PCLK2             0x08U
+#define RCC_CLOCKTYPE_D1PCLK1           0x10U
+#define RCC_CLOCKTYPE_D3PCLK1           0x20U
+#define RCC_SYSCLKSOURCE_HSI            0U
+#define RCC_SYSCLKSOURCE_PLLCLK         3U
+
+/* 分频常量即分频系数 */
+#define RCC_SYSCLK_DIV1                 1U
+#define RCC_HCLK_DIV1                   1U
+#define RCC_HCLK_DIV2                   2U
+#define RCC_APB1_DIV1                   1U
+#define RCC_APB1_DIV2                   2U
+#define RCC_APB2_DIV1                   1U
+#define RCC_APB2_DIV2                   2U
+#define RCC_APB3_DIV1                   1U
+#define RCC_APB3_DIV2                   2U
+#define RCC_APB4_DIV1                   1U
+#define RCC_APB4_DIV2                   2U
+#define RCC_D2CFGR_D2PPRE1              0x0FU
+
+#define RCC_PERIPHCLK_USART16           0x01U
+#define RCC_PERIPHCLK_USART234578       0x02U
+#define RCC_PERIPHCLK_LPTIM1            0x04U
+#define RCC_USART16CLKSOURCE_D2PCLK2    0U
+#define RCC_USART16CLKSOURCE_HSI        3U
+#define RCC_USART234578CLKSOURCE_D2PCLK1 0U
+#define RCC_USART234578CLKSOURCE_HSI    3U
+#define RCC_LPTIM1CLKSOURCE_LSI         4U
+
+#define FLASH_LATENCY_0                 0U
+#define FLASH_LATENCY_1                 1U
+#define FLASH_LATENCY_2                 2U
+#define FLASH_LATENCY_3                 3U
+#define FLASH_LATENCY_4                 4U
+#define FLASH_OPTSR2_CPUFREQ_BOOST      (1UL << 2)
+
+#define PWR_DIRECT_SMPS_SUPPLY          0x04U
+#define PWR_REGULATOR_VOLTAGE_SCALE0    0U
+#define PWR_REGULATOR_VOLTAGE_SCALE1    1U
+#define PWR_REGULATOR_VOLTAGE_SCALE2    2U
+#define PWR_REGULATOR_VOLTAGE_SCALE3    3U
+#define PWR_FLAG_VOSRDY                 0x01U
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit);
+uint32_t          HAL_RCC_GetHCLKFreq(void);
+uint32_t          HAL_RCC_GetPCLK1Freq(void);
+uint32_t          HAL_RCC_GetPCLK2Freq(void);
+HAL_StatusTypeDef HAL_PWREx_ConfigSupply(uint32_t SupplySource);
+
+void     sim_pwr_voltage_scaling(uint32_t scale);
+uint32_t sim_pwr_get_flag(uint32_t flag);
+#define __HAL_PWR_VOLTAGESCALING_CONFIG(x)  sim_pwr_voltage_scaling(x)
+#define __HAL_PWR_GET_FLAG(f)               sim_pwr_get_flag(f)
+
+/* 外设时钟门控对模型没有影响 */
+#define __HAL_RCC_GPIOA_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_GPIOF_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_USART1_CLK_ENABLE()       ((void)0)
+#define __HAL_RCC_USART3_CLK_ENABLE()       ((void)0)
+#define __HAL_RCC_UART7_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()         ((void)0)
+#define __HAL_RCC_DMA2_CLK_ENABLE()         ((void)0)
+#define __HAL_RCC_CRYP_CLK_ENABLE()         ((void)0)
+#define __HAL_RCC_CRC_CLK_ENABLE()          ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()         ((void)0)
+#define __HAL_RCC_LPTIM1_CLK_ENABLE()       ((void)0)
+
+/* =================================================================================
+ * 5. DMA
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+
+extern DMA_Stream_TypeDef sim_dma_stream[16];
+#define DMA1_Stream0            (&sim_dma_stream[0])
+#define DMA1_Stream1            (&sim_dma_stream[1])
+#define DMA1_Stream2            (&sim_dma_stream[2])
+#define DMA1_Stream3            (&sim_dma_stream[3])
+#define DMA1_Stream4            (&sim_dma_stream[4])
+#define DMA1_Stream5            (&sim_dma_stream[5])
+#define DMA1_Stream6            (&sim_dma_stream[6])
+#define DMA1_Stream7            (&sim_dma_stream[7])
+#define DMA2_Stream0            (&sim_dma_stream[8])
+#define DMA2_Stream1            (&sim_dma_stream[9])
+
+typedef struct
+{
+    uint32_t Request;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+    uint32_t FIFOMode;
+    uint32_t FIFOThreshold;
+    uint32_t MemBurst;
+    uint32_t PeriphBurst;
+} DMA_InitTypeDef;
+
+typedef enum
+{
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY  = 0x02U,
+} HAL_DMA_StateTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+    void                    *Instance;
+    DMA_InitTypeDef          Init;
+    HAL_LockTypeDef          Lock;
+    __IO HAL_DMA_StateTypeDef State;
+    void                    *Parent;
+    __IO uint32_t            ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_REQUEST_USART1_RX   41U
+#define DMA_REQUEST_USART1_TX   42U
+#define DMA_REQUEST_USART3_RX   45U
+#define DMA_REQUEST_USART3_TX   46U
+#define DMA_REQUEST_UART7_RX    79U
+#define DMA_REQUEST_UART7_TX    80U
+#define DMA_REQUEST_CRYP_IN     113U
+#define DMA_REQUEST_CRYP_OUT    114U
+
+#define DMA_PERIPH_TO_MEMORY    0U
+#define DMA_MEMORY_TO_PERIPH    1U
+#define DMA_PINC_DISABLE        0U
+#define DMA_MINC_ENABLE         1U
+#define DMA_PDATAALIGN_BYTE     0U
+#define DMA_PDATAALIGN_WORD     2U
+#define DMA_MDATAALIGN_BYTE     0U
+#define DMA_MDATAALIGN_WORD     2U
+#define DMA_NORMAL              0U
+#define DMA_CIRCULAR            1U
+#define DMA_PRIORITY_LOW        0U
+#define DMA_PRIORITY_MEDIUM     1U
+#define DMA_PRIORITY_HIGH       2U
+#define DMA_PRIORITY_VERY_HIGH  3U
+#define DMA_FIFOMODE_DISABLE    0U
+
+#define __HAL_DMA_GET_COUNTER(h)    (((DMA_Stream_TypeDef *)(h)->Instance)->NDTR)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+void              HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+
+/* =================================================================================
+ * 6. UART
+ * ================================================================================= */
+
+typedef struct
+{
+    __IO uint32_t CR1, CR2, CR3, BRR, GTPR, RTOR, RQR, ISR, ICR, RDR, TDR, PRESC;
+} USART_TypeDef;
+
+extern USART_TypeDef sim_usart[8];
+#define USART1                  (&sim_usart[0])
+#define USART2                  (&sim_usart[1])
+#define USART3                  (&sim_usart[2])
+#define UART4                   (&sim_usart[3])
+#define UART5                   (&sim_usart[4])
+#define USART6                  (&sim_usart[5])
+#define UART7                   (&sim_usart[6])
+#define UART8                   (&sim_usart[7])
+
+#define USART_CR1_UE            (1UL << 0)
+#define USART_CR3_DMAR          (1UL << 6)
+#define USART_CR3_DMAT          (1UL << 7)
+#define USART_CR3_RTSE          (1UL << 8)
+#define USART_CR3_CTSE          (1UL << 9)
+
+typedef struct
+{
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+    uint32_t OneBitSampling;
+    uint32_t ClockPrescaler;
+} UART_InitTypeDef;
+
+typedef uint32_t HAL_UART_StateTypeDef;
+#define HAL_UART_STATE_RESET        0x00U
+#define HAL_UART_STATE_READY        0x20U
+#define HAL_UART_STATE_BUSY         0x24U
+#define HAL_UART_STATE_BUSY_TX      0x21U
+#define HAL_UART_STATE_BUSY_RX      0x22U
+
+#define HAL_UART_ERROR_NONE         0x00U
+#define HAL_UART_ERROR_PE           0x01U
+#define HAL_UART_ERROR_NE           0x02U
+#define HAL_UART_ERROR_FE           0x04U
+#define HAL_UART_ERROR_ORE          0x08U
+#define HAL_UART_ERROR_DMA          0x10U
+
+#define HAL_UART_RECEPTION_STANDARD 0x00U
+#define HAL_UART_RECEPTION_TOIDLE   0x01U
+
+typedef struct __UART_HandleTypeDef
+{
+    USART_TypeDef           *Instance;
+    UART_InitTypeDef         Init;
+    const uint8_t           *pTxBuffPtr;
+    uint16_t                 TxXferSize;
+    __IO uint16_t            TxXferCount;
+    uint8_t                 *pRxBuffPtr;
+    uint16_t                 RxXferSize;
+    __IO uint16_t            RxXferCount;
+    __IO uint32_t            ReceptionType;
+    DMA_HandleTypeDef       *hdmatx;
+    DMA_HandleTypeDef       *hdmarx;
+    HAL_LockTypeDef          Lock;
+    __IO HAL_UART_StateTypeDef gState;
+    __IO HAL_UART_StateTypeDef RxState;
+    __IO uint32_t            ErrorCode;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B          0U
+#define UART_STOPBITS_1             0U
+#define UART_PARITY_NONE            0U
+#define UART_MODE_TX_RX             0x0CU
+#define UART_HWCONTROL_NONE         0U
+#define UART_HWCONTROL_RTS          USART_CR3_RTSE
+#define UART_HWCONTROL_CTS          USART_CR3_CTSE
+#define UART_HWCONTROL_RTS_CTS      (USART_CR3_RTSE | USART_CR3_CTSE)
+#define UART_OVERSAMPLING_16        0U
+#define UART_TXFIFO_THRESHOLD_1_8   0U
+#define UART_RXFIFO_THRESHOLD_1_2   2U
+
+#define UART_FLAG_TXE               (1UL << 7)
+#define UART_FLAG_RXNE              (1UL << 5)
+
+#define UART_DIV_SAMPLING16(clk, baud, presc)   ((((clk) + ((baud) / 2U)) / (baud)))
+
+uint32_t sim_uart_get_flag(UART_HandleTypeDef *huart, uint32_t flag);
+#define __HAL_UART_GET_FLAG(h, f)   sim_uart_get_flag((h), (f))
+#define __HAL_UART_ENABLE(h)        ((h)->Instance->CR1 |= USART_CR1_UE)
+#define __HAL_UART_DISABLE(h)       ((h)->Instance->CR1 &= ~USART_CR1_UE)
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart);
+void              HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/* =================================================================================
+ * 7. CRYP
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t CR, SR, DINR, DOUTR, K0LR, K0RR, K1LR, K1RR, K2LR, K2RR, K3LR, K3RR; } CRYP_TypeDef;
+
+extern CRYP_TypeDef sim_cryp;
+#define CRYP                        (&sim_cryp)
+
+typedef struct
+{
+    uint32_t  DataType;
+    uint32_t  KeySize;
+    uint32_t *pKey;
+    uint32_t *pInitVect;
+    uint32_t  Algorithm;
+    uint32_t *Header;
+    uint32_t  HeaderSize;
+    uint32_t *B0;
+    uint32_t  DataWidthUnit;
+    uint32_t  HeaderWidthUnit;
+    uint32_t  KeyIVConfigSkip;
+} CRYP_ConfigTypeDef;
+
+typedef CRYP_ConfigTypeDef CRYP_InitTypeDef;
+
+typedef enum
+{
+    HAL_CRYP_STATE_RESET = 0x00U,
+    HAL_CRYP_STATE_READY = 0x01U,
+    HAL_CRYP_STATE_BUSY  = 0x02U,
+} HAL_CRYP_STATETypeDef;
+
+typedef struct __CRYP_HandleTypeDef
+{
+    CRYP_TypeDef            *Instance;
+    CRYP_ConfigTypeDef       Init;
+    uint32_t                *pCrypInBuffPtr;
+    uint32_t                *pCrypOutBuffPtr;
+    uint16_t                 Size;
+    DMA_HandleTypeDef       *hdmain;
+    DMA_HandleTypeDef       *hdmaout;
+    HAL_LockTypeDef          Lock;
+    __IO HAL_CRYP_STATETypeDef State;
+    __IO uint32_t            ErrorCode;
+    uint32_t                 KeyIVConfig;
+} CRYP_HandleTypeDef;
+
+#define CRYP_DATATYPE_8B            2U
+#define CRYP_KEYSIZE_128B           0U
+#define CRYP_AES_ECB                0x04U
+#define CRYP_DATAWIDTHUNIT_BYTE     1U
+#define CRYP_KEYIVCONFIG_ALWAYS     0U
+#define CRYP_KEYIVCONFIG_ONCE       1U
+#define CRYP_ALGOMODE_AES_KEY       0x07U
+
+HAL_StatusTypeDef HAL_CRYP_Init(CRYP_HandleTypeDef *hcryp);
+HAL_StatusTypeDef HAL_CRYP_DeInit(CRYP_HandleTypeDef *hcryp);
+HAL_StatusTypeDef HAL_CRYP_SetConfig(CRYP_HandleTypeDef *hcryp, CRYP_ConfigTypeDef *pConf);
+HAL_StatusTypeDef HAL_CRYP_GetConfig(CRYP_HandleTypeDef *hcryp, CRYP_ConfigTypeDef *pConf);
+HAL_StatusTypeDef HAL_CRYP_Encrypt(CRYP_HandleTypeDef *hcryp, uint32_t *Input, uint16_t Size, uint32_t *Output, uint32_t Timeout);
+HAL_StatusTypeDef HAL_CRYP_Decrypt(CRYP_HandleTypeDef *hcryp, uint32_t *Input, uint16_t Size, uint32_t *Output, uint32_t Timeout);
+HAL_StatusTypeDef HAL_CRYP_Encrypt_DMA(CRYP_HandleTypeDef *hcryp, uint32_t *Input, uint16_t Size, uint32_t *Output);
+HAL_StatusTypeDef HAL_CRYP_Decrypt_DMA(CRYP_HandleTypeDef *hcryp, uint32_t *Input, uint16_t Size, uint32_t *Output);
+
+void HAL_CRYP_OutCpltCallback(CRYP_HandleTypeDef *hcryp);
+void HAL_CRYP_ErrorCallback(CRYP_HandleTypeDef *hcryp);
+
+/* =================================================================================
+ * 8. CRC
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t DR, IDR, CR, INIT, POL; } CRC_TypeDef;
+
+extern CRC_TypeDef sim_crc;
+#define CRC                         (&sim_crc)
+
+typedef struct
+{
+    uint8_t  DefaultPolynomialUse;
+    uint8_t  DefaultInitValueUse;
+    uint32_t GeneratingPolynomial;
+    uint32_t CRCLength;
+    uint32_t InitValue;
+    uint32_t InputDataInversionMode;
+    uint32_t OutputDataInversionMode;
+} CRC_InitTypeDef;
+
+typedef struct
+{
+    CRC_TypeDef             *Instance;
+    CRC_InitTypeDef          Init;
+    HAL_LockTypeDef          Lock;
+    __IO uint32_t            State;
+    uint32_t                 InputDataFormat;
+} CRC_HandleTypeDef;
+
+#define DEFAULT_POLYNOMIAL_ENABLE       0U
+#define DEFAULT_POLYNOMIAL_DISABLE      1U
+#define DEFAULT_INIT_VALUE_ENABLE       0U
+#define DEFAULT_INIT_VALUE_DISABLE      1U
+#define CRC_INPUTDATA_INVERSION_NONE    0U
+#define CRC_INPUTDATA_INVERSION_BYTE    1U
+#define CRC_OUTPUTDATA_INVERSION_DISABLE 0U
+#define CRC_OUTPUTDATA_INVERSION_ENABLE 1U
+#define CRC_INPUTDATA_FORMAT_BYTES      1U
+#define CRC_POLYLENGTH_32B              0U
+
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef *hcrc);
+uint32_t          HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+uint32_t          HAL_CRC_Accumulate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+/* =================================================================================
+ * 9. LPTIM
+ * ================================================================================= */
+
+typedef struct { __IO uint32_t ISR, ICR, IER, CFGR, CR, CMP, ARR, CNT; } LPTIM_TypeDef;
+
+/*
+ * 计数器从 HAL_LPTIM_Init 起按主机时钟以 LSI_VALUE 计数, 只能经 HAL_LPTIM_ReadCounter
+ * 读取 (寄存器 CNT 不会自己变化); 比较值写入后在计数到达时置位 CMPM 并挂起中断.
+ */
+extern LPTIM_TypeDef sim_lptim1;
+#define LPTIM1                          (&sim_lptim1)
+
+typedef struct
+{
+    struct { uint32_t Source; uint32_t Prescaler; } Clock;
+    struct { uint32_t Source; uint32_t ActiveEdge; uint32_t SampleTime; } Trigger;
+    uint32_t OutputPolarity;
+    uint32_t UpdateMode;
+    uint32_t CounterSource;
+    uint32_t Input1Source;
+    uint32_t Input2Source;
+} LPTIM_InitTypeDef;
+
+typedef struct
+{
+    LPTIM_TypeDef           *Instance;
+    LPTIM_InitTypeDef        Init;
+    HAL_LockTypeDef          Lock;
+    __IO uint32_t            State;
+} LPTIM_HandleTypeDef;
+
+#define LPTIM_CLOCKSOURCE_APBCLOCK_LPOSC    0U
+#define LPTIM_PRESCALER_DIV1                0U
+#define LPTIM_TRIGSOURCE_SOFTWARE           0xFFFFU
+#define LPTIM_OUTPUTPOLARITY_HIGH           0U
+#define LPTIM_UPDATE_IMMEDIATE              0U
+#define LPTIM_COUNTERSOURCE_INTERNAL        0U
+#define LPTIM_INPUT1SOURCE_GPIO             0U
+#define LPTIM_INPUT2SOURCE_GPIO             0U
+
+#define LPTIM_FLAG_CMPM                     (1UL << 0)
+#define LPTIM_FLAG_ARRM                     (1UL << 1)
+#define LPTIM_FLAG_CMPOK                    (1UL << 3)
+#define LPTIM_FLAG_ARROK                    (1UL << 4)
+#define LPTIM_IT_CMPM                       LPTIM_FLAG_CMPM
+
+#define LPTIM_CR_ENABLE                     (1UL << 0)
+#define LPTIM_CR_CNTSTRT                    (1UL << 2)
+
+HAL_StatusTypeDef HAL_LPTIM_Init(LPTIM_HandleTypeDef *hlptim);
+uint32_t          HAL_LPTIM_ReadCounter(const LPTIM_HandleTypeDef *hlptim);
+void              sim_lptim_compare_set(LPTIM_HandleTypeDef *hlptim, uint32_t value);
+
+/* ARR/CMP 写入后立即同步 (ARROK/CMPOK); CMPM 由模型线程置位, 清标志须是原子操作 */
+#define __HAL_LPTIM_ENABLE_IT(h, it)        ((h)->Instance->IER |= (it))
+#define __HAL_LPTIM_ENABLE(h)               ((h)->Instance->CR |= LPTIM_CR_ENABLE)
+#define __HAL_LPTIM_START_CONTINUOUS(h)     ((h)->Instance->CR |= LPTIM_CR_CNTSTRT)
+#define __HAL_LPTIM_AUTORELOAD_SET(h, v)    ((h)->Instance->ARR = (v), (h)->Instance->ISR |= LPTIM_FLAG_ARROK)
+#define __HAL_LPTIM_COMPARE_SET(h, v)       sim_lptim_compare_set((h), (v))
+#define __HAL_LPTIM_CLEAR_FLAG(h, f)        ((void)__atomic_fetch_and(&(h)->Instance->ISR, ~(f), __ATOMIC_SEQ_CST))
+#define __HAL_LPTIM_GET_FLAG(h, f)          (((h)->Instance->ISR & (f)) == (f))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,7 @@
+/* stm32h7xx_hal_cryp.h - 主机仿真: CRYP 的类型与函数都在 stm32h7xx_hal.h 中 */
+#ifndef __STM32H7xx_HAL_CRYP_H
+#define __STM32H7xx_HAL_CRYP_H
+
+#include "stm32h7xx_hal.h"
+
+#endif
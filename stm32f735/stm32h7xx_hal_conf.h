@@ -11,6 +11,7 @@
 /* ============================================================================ */
 #define HAL_MODULE_ENABLED          /* 启用HAL库总开关 */
 #define HAL_CRYP_MODULE_ENABLED     /* 启用CRYP(加密)模块 */
+#define HAL_CRC_MODULE_ENABLED      /* 启用CRC(帧校验)模块 */
 #define HAL_GPIO_MODULE_ENABLED     /* 启用GPIO(通用输入输出)模块 */
 #define HAL_RCC_MODULE_ENABLED      /* 启用RCC(复位和时钟控制)模块 */
 #define HAL_PWR_MODULE_ENABLED      /* 启用PWR(电源控制)模块 */
@@ -18,6 +19,8 @@
 #define HAL_FLASH_MODULE_ENABLED    /* 启用FLASH(闪存)控制模块 */
 #define HAL_UART_MODULE_ENABLED     /* 启用UART(串口通信)模块 */
 #define HAL_DMA_MODULE_ENABLED      /* 启用DMA(直接内存访问)模块 */
+#define HAL_LPTIM_MODULE_ENABLED    /* 启用LPTIM(低功耗定时器)模块, 无节拍空闲唤醒 */
+#define HAL_TIM_MODULE_ENABLED      /* 启用TIM(通用定时器)模块, 高精度定时器计数 */
 
 /* ============================================================================ */
 /* 2. 回调函数注册功能配置 */
@@ -82,6 +85,18 @@
   #include "stm32h7xx_hal_cryp.h"
 #endif
 
+#ifdef HAL_CRC_MODULE_ENABLED
+  #include "stm32h7xx_hal_crc.h"
+#endif
+
+#ifdef HAL_LPTIM_MODULE_ENABLED
+  #include "stm32h7xx_hal_lptim.h"
+#endif
+
+#ifdef HAL_TIM_MODULE_ENABLED
+  #include "stm32h7xx_hal_tim.h"
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,287 @@
+/*
+ * tickless.c - 无节拍空闲
+ *
+ * 桥接在两次突发之间几乎所有线程都阻塞, 但 SysTick 仍每 tick 中断一次.
+ * 空闲钩子在关中断下取 rt_timer_next_timeout_tick(), 若下一个到期在
+ * TICKLESS_MIN_TICKS 之后:
+ *
+ *   1. 停 SysTick, 当前 tick 已过去的部分按 SysTick->VAL 折算;
+ *   2. LPTIM1 (LSI, 自由运行的 16 位计数器) 比较值设在到期 tick 的边界;
+ *   3. WFI 进入 Sleep, LPTIM 比较匹配或任何其他中断唤醒;
+ *   4. 按 LPTIM 计数补上经过的整 tick (rt_tick 与 HAL uwTick), 不足一个
+ *      tick 的部分留到下次睡眠再计入, 然后 rt_tick_increase() 处理到期定时器;
+ *   5. 重启 SysTick.
+ *
+ * 余数结转保证 rt_tick 相对 LPTIM 不累积误差; rt_thread_delay_until 以截止
+ * tick 而非实际唤醒 tick 推进, 周期不会因补 tick 而漂移. 长期精度取决于
+ * LSI (未校准约 ±5%).
+ *
+ * 睡眠期间 DWT 周期计数停止, 而工作线程常在等 CRYP/UART DMA 时让出 CPU,
+ * lat_hist、blog 和 trace 的时间戳跨过睡眠会少算. 唤醒后按 LPTIM 计数折算
+ * 睡眠的周期数 (减去同一段时间内 DWT 自己计到的), 补进 lat_now(); 误差在
+ * 一个 LPTIM 计数 (约 31 us) 以内.
+ *
+ * 只用 Sleep 模式: 外设与 DMA 照常运行, 唤醒后无需恢复时钟. LPTIM1 中断
+ * 只在 WFI 期间于 NVIC 使能, 用于唤醒, 处理函数不会执行.
+ */
+
+#include "tickless.h"
+#include "lat_hist.h"
+#include "stm32h7xx_hal.h"
+#include <rthw.h>
+
+#define TICKLESS_LPTIM_HZ       LSI_VALUE
+#define TICKLESS_MAX_TICKS      ((rt_uint32_t)((rt_uint64_t)TICKLESS_MAX_COUNTS * RT_TICK_PER_SECOND / TICKLESS_LPTIM_HZ))
+
+static LPTIM_HandleTypeDef hlptim;
+
+static struct
+{
+    volatile rt_uint8_t  enable;
+    rt_uint8_t           cmp_pending;   /* 比较值写入后尚未同步 (CMPOK) */
+    rt_uint32_t          carry;         /* 未计入 rt_tick 的时间, 单位 1/TICKLESS_LPTIM_HZ tick */
+    struct tickless_stat stat;
+} idle_sleep;
+
+/* =================================================================================
+ * 1. LPTIM1
+ * ================================================================================= */
+
+static rt_uint32_t tickless_lptim_count(void)
+{
+    rt_uint32_t a, b;
+
+    /* 计数时钟与总线异步, 连续两次读数相同才可靠 */
+    do
+    {
+        a = HAL_LPTIM_ReadCounter(&hlptim);
+        b = HAL_LPTIM_ReadCounter(&hlptim);
+    } while (a != b);
+
+    return a;
+}
+
+static rt_err_t tickless_lptim_init(void)
+{
+    RCC_OscInitTypeDef osc = {0};
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    /* LSI 作 LPTIM1 内核时钟, 与时钟档位无关 */
+    osc.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+    osc.LSIState       = RCC_LSI_ON;
+    osc.PLL.PLLState   = RCC_PLL_NONE;
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+        return -RT_ERROR;
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_LPTIM1;
+    clk.Lptim1ClockSelection = RCC_LPTIM1CLKSOURCE_LSI;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+        return -RT_ERROR;
+    __HAL_RCC_LPTIM1_CLK_ENABLE();
+
+    hlptim.Instance                = LPTIM1;
+    hlptim.Init.Clock.Source       = LPTIM_CLOCKSOURCE_APBCLOCK_LPOSC;
+    hlptim.Init.Clock.Prescaler    = LPTIM_PRESCALER_DIV1;
+    hlptim.Init.Trigger.Source     = LPTIM_TRIGSOURCE_SOFTWARE;
+    hlptim.Init.OutputPolarity     = LPTIM_OUTPUTPOLARITY_HIGH;
+    hlptim.Init.UpdateMode         = LPTIM_UPDATE_IMMEDIATE;
+    hlptim.Init.CounterSource      = LPTIM_COUNTERSOURCE_INTERNAL;
+    hlptim.Init.Input1Source       = LPTIM_INPUT1SOURCE_GPIO;
+    hlptim.Init.Input2Source       = LPTIM_INPUT2SOURCE_GPIO;
+    if (HAL_LPTIM_Init(&hlptim) != HAL_OK)
+        return -RT_ERROR;
+
+    /* IER 只能在 LPTIM 关闭时写, ARR/CMP 只能在开启后写 */
+    __HAL_LPTIM_ENABLE_IT(&hlptim, LPTIM_IT_CMPM);
+    __HAL_LPTIM_ENABLE(&hlptim);
+    __HAL_LPTIM_AUTORELOAD_SET(&hlptim, 0xFFFF);
+    while (!__HAL_LPTIM_GET_FLAG(&hlptim, LPTIM_FLAG_ARROK));
+    __HAL_LPTIM_CLEAR_FLAG(&hlptim, LPTIM_FLAG_ARROK);
+    __HAL_LPTIM_START_CONTINUOUS(&hlptim);
+
+    HAL_NVIC_SetPriority(LPTIM1_IRQn, 15, 0);
+    HAL_NVIC_DisableIRQ(LPTIM1_IRQn);
+
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 2. 空闲钩子
+ * ================================================================================= */
+
+static void tickless_idle(void)
+{
+    rt_uint32_t load, val, frac, counts, cnt0, cyc0, awake, elapsed, total, ticks;
+    rt_uint64_t slept;
+    rt_tick_t next, delta;
+    rt_base_t level;
+
+    if (!idle_sleep.enable)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    next = rt_timer_next_timeout_tick();
+    if (next == RT_TICK_MAX)
+    {
+        delta = TICKLESS_MAX_TICKS;
+    }
+    else
+    {
+        delta = next - rt_tick_get();
+        if (delta >= RT_TICK_MAX / 2)           /* 已到期, 等 SysTick 中断处理 */
+            delta = 0;
+        else if (delta > TICKLESS_MAX_TICKS)
+            delta = TICKLESS_MAX_TICKS;
+    }
+
+    if (delta < TICKLESS_MIN_TICKS)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    /* 上次写入的比较值还没同步 (被提前唤醒后立即再次进入) */
+    if (idle_sleep.cmp_pending && !__HAL_LPTIM_GET_FLAG(&hlptim, LPTIM_FLAG_CMPOK))
+        goto skip;
+    __HAL_LPTIM_CLEAR_FLAG(&hlptim, LPTIM_FLAG_CMPOK);
+    idle_sleep.cmp_pending = 0;
+
+    /* 1. 停 SysTick; 停之前或之后节拍已到则让 SysTick 中断先处理 */
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+        goto skip;
+    load = SysTick->LOAD;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    val = SysTick->VAL;
+    cnt0 = tickless_lptim_count();
+    cyc0 = DWT->CYCCNT;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        goto skip;
+    }
+    frac = idle_sleep.carry + (rt_uint32_t)((rt_uint64_t)(load - val) * TICKLESS_LPTIM_HZ / (load + 1));
+
+    /* 2. 比较值: 到期 tick 边界, 向上取整到 LPTIM 计数 */
+    counts = (delta * TICKLESS_LPTIM_HZ - frac + RT_TICK_PER_SECOND - 1) / RT_TICK_PER_SECOND;
+    __HAL_LPTIM_COMPARE_SET(&hlptim, (cnt0 + counts) & 0xFFFF);
+    idle_sleep.cmp_pending = 1;
+    __HAL_LPTIM_CLEAR_FLAG(&hlptim, LPTIM_FLAG_CMPM);
+    HAL_NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+    HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+    /* 3. Sleep, 关中断下任何挂起的中断都会唤醒 WFI */
+    __DSB();
+    __WFI();
+    __ISB();
+
+    HAL_NVIC_DisableIRQ(LPTIM1_IRQn);
+    __HAL_LPTIM_CLEAR_FLAG(&hlptim, LPTIM_FLAG_CMPM);
+    HAL_NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+
+    /* 4. 补 tick, 余数结转; 睡眠的周期数补进时间戳 */
+    elapsed = (tickless_lptim_count() - cnt0) & 0xFFFF;
+    awake = DWT->CYCCNT - cyc0;
+    slept = (rt_uint64_t)elapsed * SystemCoreClock / TICKLESS_LPTIM_HZ;
+    if (slept > awake)
+        lat_sleep_cycles += (rt_uint32_t)(slept - awake);
+    total = frac + elapsed * RT_TICK_PER_SECOND;
+    ticks = total / TICKLESS_LPTIM_HZ;
+    idle_sleep.carry = total % TICKLESS_LPTIM_HZ;
+
+    /* 5. 先重启 SysTick (整周期), 再补 tick: rt_tick_increase() 可能切换线程 */
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    if (ticks > 0)
+    {
+        uwTick += ticks * uwTickFreq;
+        rt_tick_set(rt_tick_get() + ticks - 1);
+        rt_tick_increase();
+    }
+
+    idle_sleep.stat.sleeps++;
+    idle_sleep.stat.slept_ticks += ticks;
+    if (ticks < delta)
+        idle_sleep.stat.early++;
+    if (ticks > idle_sleep.stat.max_ticks)
+        idle_sleep.stat.max_ticks = ticks;
+
+    rt_hw_interrupt_enable(level);
+    return;
+
+skip:
+    idle_sleep.stat.skipped++;
+    rt_hw_interrupt_enable(level);
+}
+
+/* =================================================================================
+ * 3. 初始化
+ * ================================================================================= */
+
+rt_err_t tickless_init(void)
+{
+#if defined(RT_USING_IDLE_HOOK) || defined(RT_USING_HOOK)
+    rt_err_t result;
+
+    result = tickless_lptim_init();
+    if (result != RT_EOK)
+        return result;
+
+    result = rt_thread_idle_sethook(tickless_idle);
+    if (result != RT_EOK)
+        return result;
+
+    idle_sleep.enable = TICKLESS_DEFAULT_ENABLE;
+
+    return RT_EOK;
+#else
+    /* 空闲钩子需要 RT_USING_IDLE_HOOK */
+    return -RT_ENOSYS;
+#endif
+}
+
+void tickless_enable(rt_bool_t enable)
+{
+    idle_sleep.enable = enable ? 1 : 0;
+}
+
+void tickless_get_stat(struct tickless_stat *stat)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    *stat = idle_sleep.stat;
+    rt_hw_interrupt_enable(level);
+}
+
+/* =================================================================================
+ * 4. 调试命令
+ * ================================================================================= */
+
+static int tickless(int argc, char **argv)
+{
+    struct tickless_stat st;
+
+    if (argc > 1)
+    {
+        if (rt_strcmp(argv[1], "on") == 0)
+            tickless_enable(RT_TRUE);
+        else if (rt_strcmp(argv[1], "off") == 0)
+            tickless_enable(RT_FALSE);
+        else
+        {
+            rt_kprintf("usage: tickless [on|off]\n");
+            return -1;
+        }
+    }
+
+    tickless_get_stat(&st);
+    rt_kprintf("tickless : %s, lptim %d Hz, max %d ticks\n", idle_sleep.enable ? "on" : "off",
+               TICKLESS_LPTIM_HZ, TICKLESS_MAX_TICKS);
+    rt_kprintf("sleeps   : %d (early wakeup %d, skipped %d)\n", st.sleeps, st.early, st.skipped);
+    rt_kprintf("ticks    : %d slept of %d, longest %d\n", st.slept_ticks, rt_tick_get(), st.max_ticks);
+
+    return 0;
+}
+MSH_CMD_EXPORT(tickless, tickless idle stats and switch: tickless [on|off]);
@@ -0,0 +1,33 @@
+/* tickless.h - 无节拍空闲: 空闲时停掉 SysTick, 由 LPTIM1 在下一个定时器到期时唤醒 */
+#ifndef __TICKLESS_H__
+#define __TICKLESS_H__
+
+#include <rtthread.h>
+
+#ifndef TICKLESS_DEFAULT_ENABLE
+#define TICKLESS_DEFAULT_ENABLE 1
+#endif
+
+#define TICKLESS_MIN_TICKS      2       /* 距下一个到期不足此 tick 数时不停节拍 */
+#define TICKLESS_MAX_COUNTS     0xF000  /* 一次睡眠最多的 LPTIM 计数 (16 位计数器留出余量), LSI 下约 1.9 s */
+
+struct tickless_stat
+{
+    rt_uint32_t          sleeps;        /* 停节拍睡眠次数 */
+    rt_uint32_t          early;         /* 被其他中断提前唤醒的次数 */
+    rt_uint32_t          skipped;       /* 节拍将到或 LPTIM 比较值未同步而放弃的次数 */
+    rt_uint32_t          slept_ticks;   /* 睡眠期间补上的 tick 数, 即省掉的 SysTick 中断数 */
+    rt_uint32_t          max_ticks;     /* 单次最长睡眠 (tick) */
+};
+
+/*
+ * 以 LSI 为时钟配置 LPTIM1 并注册空闲钩子. 在调度器启动前或空闲线程
+ * 之外的线程中调用一次.
+ */
+rt_err_t tickless_init(void);
+
+void tickless_enable(rt_bool_t enable);
+
+void tickless_get_stat(struct tickless_stat *stat);
+
+#endif
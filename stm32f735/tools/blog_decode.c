@@ -0,0 +1,529 @@
+/*
+ * blog_decode.c - 二进制延迟日志 (blog.c) 主机侧解码工具
+ *
+ * 从控制台串口 (或捕获文件、标准输入) 读取字节流: 普通文本原样输出,
+ * 0x00 分隔的 COBS 帧按 blog.c 的包格式解析, 用固件映像 (.axf/.elf) 中的
+ * 格式串还原文本. 格式 ID 是格式串相对 BlogFmt 段起点的偏移, 段起点取自
+ * 符号 BlogFmt$$Base (armlink) 或 __start_BlogFmt (GNU ld), 找不到时按段名
+ * 查找; %s 参数按地址从映像的加载段读取. 映像须与目标上运行的固件一致.
+ *
+ * 时间戳 = 包头 tick / tick 频率 + (记录周期数 - 包头周期数) / CPU 频率,
+ * 即以发送时刻为锚点换算, 周期计数器回绕不影响结果.
+ *
+ * 编译 (Linux):
+ *   gcc -O2 -o blog_decode blog_decode.c
+ *
+ * 示例:
+ *   blog_decode -p /dev/ttyUSB1 -b 115200 Objects/stm32f735.axf
+ *   blog_decode -f 400000000 stm32f735.axf < console.log
+ */
+
+#define _GNU_SOURCE
+#include <elf.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* 与 blog.c 保持一致 */
+#define BLOG_PACKET_VERSION 1
+#define BLOG_PACKET_HDR     16
+#define BLOG_MAX_ARGS       6
+#define BLOG_FRAME_MAX      1024
+
+static struct
+{
+    const char *path;
+    int         baud;
+    double      cpu_hz;
+    double      tick_hz;
+} cfg =
+{
+    .path    = NULL,
+    .baud    = 115200,
+    .cpu_hz  = 550e6,
+    .tick_hz = 1000,
+};
+
+/* 映像: 整个文件读入内存, 记录各加载段的地址与文件偏移 */
+struct image_seg
+{
+    uint32_t addr;
+    uint32_t size;
+    uint32_t offset;
+};
+
+static struct
+{
+    uint8_t          *data;
+    size_t            size;
+    struct image_seg *seg;
+    int               nseg;
+    uint32_t          fmt_base;
+} image;
+
+static struct
+{
+    unsigned long packets;
+    unsigned long records;
+    unsigned long bad_frames;
+    uint32_t      dropped;
+} stats;
+
+/* =================================================================================
+ * 1. 映像
+ * ================================================================================= */
+
+static const char *image_ptr(uint32_t addr, uint32_t *avail)
+{
+    int i;
+
+    for (i = 0; i < image.nseg; i++)
+    {
+        if (addr >= image.seg[i].addr && addr - image.seg[i].addr < image.seg[i].size)
+        {
+            *avail = image.seg[i].size - (addr - image.seg[i].addr);
+            return (const char *)image.data + image.seg[i].offset + (addr - image.seg[i].addr);
+        }
+    }
+    return NULL;
+}
+
+/* 返回映像中以 NUL 结尾的字符串, 越界或不在映像中时返回 NULL */
+static const char *image_str(uint32_t addr)
+{
+    uint32_t avail;
+    const char *p = image_ptr(addr, &avail);
+
+    if (p == NULL || memchr(p, 0, avail) == NULL)
+        return NULL;
+    return p;
+}
+
+static int image_load(const char *path)
+{
+    const Elf32_Ehdr *eh;
+    const Elf32_Shdr *sh;
+    const char *shstr;
+    FILE *f;
+    int i, found = 0;
+
+    f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    image.size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    image.data = malloc(image.size);
+    if (image.data == NULL || fread(image.data, 1, image.size, f) != image.size)
+    {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    eh = (const Elf32_Ehdr *)image.data;
+    if (image.size < sizeof(*eh) || memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 ||
+        eh->e_ident[EI_CLASS] != ELFCLASS32 || eh->e_ident[EI_DATA] != ELFDATA2LSB ||
+        eh->e_shoff == 0 || eh->e_shoff + (size_t)eh->e_shnum * sizeof(*sh) > image.size)
+    {
+        fprintf(stderr, "%s: not a little-endian ELF32 image\n", path);
+        return -1;
+    }
+
+    sh = (const Elf32_Shdr *)(image.data + eh->e_shoff);
+    shstr = (const char *)image.data + sh[eh->e_shstrndx].sh_offset;
+    image.seg = calloc(eh->e_shnum, sizeof(*image.seg));
+
+    for (i = 0; i < eh->e_shnum; i++)
+    {
+        if (sh[i].sh_type == SHT_PROGBITS && (sh[i].sh_flags & SHF_ALLOC) &&
+            sh[i].sh_offset + (size_t)sh[i].sh_size <= image.size)
+        {
+            image.seg[image.nseg].addr   = sh[i].sh_addr;
+            image.seg[image.nseg].size   = sh[i].sh_size;
+            image.seg[image.nseg].offset = sh[i].sh_offset;
+            image.nseg++;
+        }
+    }
+
+    /* 优先用链接器生成的段起点符号 */
+    for (i = 0; i < eh->e_shnum && !found; i++)
+    {
+        const Elf32_Sym *sym;
+        const char *str;
+        size_t j, n;
+
+        if (sh[i].sh_type != SHT_SYMTAB)
+            continue;
+        sym = (const Elf32_Sym *)(image.data + sh[i].sh_offset);
+        str = (const char *)image.data + sh[sh[i].sh_link].sh_offset;
+        n = sh[i].sh_size / sizeof(*sym);
+        for (j = 0; j < n; j++)
+        {
+            if (strcmp(str + sym[j].st_name, "BlogFmt$$Base") == 0 ||
+                strcmp(str + sym[j].st_name, "__start_BlogFmt") == 0)
+            {
+                image.fmt_base = sym[j].st_value;
+                found = 1;
+                break;
+            }
+        }
+    }
+
+    for (i = 0; i < eh->e_shnum && !found; i++)
+    {
+        if (strcmp(shstr + sh[i].sh_name, "BlogFmt") == 0)
+        {
+            image.fmt_base = sh[i].sh_addr;
+            found = 1;
+        }
+    }
+
+    if (!found)
+    {
+        fprintf(stderr, "%s: no BlogFmt section (firmware built without BLOG() sites?)\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* =================================================================================
+ * 2. 格式化
+ * ================================================================================= */
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* 按目标上 32 位参数的语义展开 printf 格式串 */
+static void blog_format(const char *fmt, const uint32_t *args, int nargs)
+{
+    char spec[32], conv;
+    const char *s;
+    int argi = 0, n;
+
+    while (*fmt)
+    {
+        if (*fmt != '%')
+        {
+            putchar(*fmt++);
+            continue;
+        }
+
+        /* 复制 % 标志 宽度 精度, 丢弃长度修饰符 */
+        n = 0;
+        spec[n++] = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.*", *fmt) && n < (int)sizeof(spec) - 4)
+        {
+            if (*fmt == '*')
+            {
+                n += snprintf(spec + n, sizeof(spec) - n, "%d", argi < nargs ? (int32_t)args[argi] : 0);
+                argi++;
+                fmt++;
+                continue;
+            }
+            spec[n++] = *fmt++;
+        }
+        while (*fmt && strchr("hlzjtL", *fmt))
+            fmt++;
+        if (*fmt == 0)
+            break;
+        conv = *fmt++;
+
+        if (conv == '%')
+        {
+            putchar('%');
+            continue;
+        }
+        if (argi >= nargs)
+        {
+            fputs("<?>", stdout);
+            continue;
+        }
+
+        spec[n++] = conv;
+        spec[n] = 0;
+        switch (conv)
+        {
+        case 'd':
+        case 'i':
+            printf(spec, (int)(int32_t)args[argi]);
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            printf(spec, (unsigned int)args[argi]);
+            break;
+        case 'p':
+            printf("0x%08x", args[argi]);
+            break;
+        case 's':
+            s = image_str(args[argi]);
+            if (s != NULL)
+                printf(spec, s);
+            else
+                printf("<0x%08x>", args[argi]);
+            break;
+        default:
+            printf("<%%%c?>", conv);
+            break;
+        }
+        argi++;
+    }
+}
+
+/* =================================================================================
+ * 3. 包解析
+ * ================================================================================= */
+
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0, n = 0;
+    uint8_t code, k;
+
+    while (i < len)
+    {
+        code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (k = 1; k < code; k++)
+            out[n++] = in[i++];
+        if (code != 0xFF && i < len)
+            out[n++] = 0;
+    }
+    return n;
+}
+
+/* 校验并输出一个包, 格式不符时返回 -1 (调用者按普通文本处理) */
+static int blog_packet(const uint8_t *pkt, size_t len)
+{
+    uint32_t tick, cycles, dropped, hdr, id, args[BLOG_MAX_ARGS];
+    const char *fmt;
+    size_t pos;
+    int count, i, j, nargs;
+    double t;
+
+    if (len < BLOG_PACKET_HDR || pkt[0] != 'B' || pkt[1] != 'L' || pkt[2] != BLOG_PACKET_VERSION)
+        return -1;
+
+    /* 先完整走一遍, 记录边界与 count 不符的包整体丢弃 */
+    count = pkt[3];
+    for (pos = BLOG_PACKET_HDR, i = 0; i < count; i++)
+    {
+        if (pos + 8 > len)
+            return -1;
+        nargs = pkt[pos + 3];
+        if (nargs > BLOG_MAX_ARGS || pos + 8 + nargs * 4 > len)
+            return -1;
+        pos += 8 + nargs * 4;
+    }
+    if (pos != len)
+        return -1;
+
+    tick    = get32(pkt + 4);
+    cycles  = get32(pkt + 8);
+    dropped = get32(pkt + 12);
+
+    /* 目标复位后计数归零 */
+    if (dropped < stats.dropped)
+        stats.dropped = 0;
+    if (dropped != stats.dropped)
+    {
+        printf("[blog] %u record(s) dropped on target\n", dropped - stats.dropped);
+        stats.dropped = dropped;
+    }
+
+    for (pos = BLOG_PACKET_HDR, i = 0; i < count; i++)
+    {
+        hdr   = get32(pkt + pos);
+        nargs = hdr >> 24;
+        id    = hdr & 0xFFFFFF;
+        t     = tick / cfg.tick_hz - (int32_t)(cycles - get32(pkt + pos + 4)) / cfg.cpu_hz;
+        for (j = 0; j < nargs; j++)
+            args[j] = get32(pkt + pos + 8 + j * 4);
+        pos += 8 + nargs * 4;
+
+        printf("[%12.6f] ", t);
+        fmt = image_str(image.fmt_base + id);
+        if (fmt != NULL)
+        {
+            blog_format(fmt, args, nargs);
+        }
+        else
+        {
+            printf("<unknown format id 0x%06x>", id);
+            for (j = 0; j < nargs; j++)
+                printf(" 0x%08x", args[j]);
+            putchar('\n');
+        }
+        stats.records++;
+    }
+
+    stats.packets++;
+    return 0;
+}
+
+/* =================================================================================
+ * 4. 字节流
+ * ================================================================================= */
+
+static int port_open(const char *path)
+{
+    struct termios tio;
+    int fd;
+
+    if (path == NULL)
+        return STDIN_FILENO;
+
+    fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0)
+    {
+        speed_t speed;
+
+        switch (cfg.baud)
+        {
+        case 115200:  speed = B115200; break;
+        case 230400:  speed = B230400; break;
+        case 460800:  speed = B460800; break;
+        case 921600:  speed = B921600; break;
+        case 2000000: speed = B2000000; break;
+        default:      speed = B115200; break;
+        }
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, speed);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    return fd;
+}
+
+/*
+ * 0x00 之间的内容先按帧尝试解码; 失败时 (例如从帧中间开始接收) 原样作为
+ * 文本输出, 结尾的 0x00 视为下一帧的起点, 最多错过一帧即可重新对齐.
+ */
+static void blog_stream(int fd)
+{
+    static uint8_t frame[BLOG_FRAME_MAX], pkt[BLOG_FRAME_MAX];
+    uint8_t buf[512];
+    size_t len = 0, n;
+    int in_frame = 0;
+    ssize_t r, i;
+
+    while ((r = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (i = 0; i < r; i++)
+        {
+            if (!in_frame)
+            {
+                if (buf[i] == 0)
+                {
+                    in_frame = 1;
+                    len = 0;
+                }
+                else
+                {
+                    putchar(buf[i]);
+                }
+                continue;
+            }
+
+            if (buf[i] != 0)
+            {
+                frame[len++] = buf[i];
+                if (len == sizeof(frame))
+                {
+                    /* 超长, 不是帧 */
+                    fwrite(frame, 1, len, stdout);
+                    stats.bad_frames++;
+                    in_frame = 0;
+                }
+                continue;
+            }
+
+            /* 连续的 0x00 是上一帧的结尾加下一帧的起点 */
+            if (len == 0)
+                continue;
+
+            n = cobs_decode(frame, len, pkt);
+            if (n > 0 && blog_packet(pkt, n) == 0)
+            {
+                in_frame = 0;
+            }
+            else
+            {
+                fwrite(frame, 1, len, stdout);
+                stats.bad_frames++;
+            }
+            len = 0;
+        }
+        fflush(stdout);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] IMAGE\n"
+            "  IMAGE      firmware ELF (.axf/.elf) matching the running target\n"
+            "  -p DEV     serial port or capture file (default stdin)\n"
+            "  -b BAUD    serial baud rate (default 115200)\n"
+            "  -f HZ      CPU clock for cycle stamps (default 550000000)\n"
+            "  -t HZ      RT_TICK_PER_SECOND (default 1000)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    int fd, opt;
+
+    while ((opt = getopt(argc, argv, "p:b:f:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p': cfg.path = optarg; break;
+        case 'b': cfg.baud = atoi(optarg); break;
+        case 'f': cfg.cpu_hz = atof(optarg); break;
+        case 't': cfg.tick_hz = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - 1 || cfg.cpu_hz <= 0 || cfg.tick_hz <= 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (image_load(argv[optind]) < 0)
+        return 1;
+
+    fd = port_open(cfg.path);
+    if (fd < 0)
+    {
+        perror(cfg.path);
+        return 1;
+    }
+
+    blog_stream(fd);
+
+    fprintf(stderr, "blog: %lu packets, %lu records, %lu bad frames, %u dropped on target\n",
+            stats.packets, stats.records, stats.bad_frames, stats.dropped);
+    return 0;
+}
@@ -0,0 +1,781 @@
+/*
+ * bridge_bench.c - 桥接端口主机侧压测工具
+ *
+ * 通过串口 (或伪终端, 对接主机仿真的 USART1/UART7) 按 bridge_frame.h 的帧格式
+ * 发送 AES 块, 用参考 AES 校验回传结果, 统计吞吐、丢帧和往返延迟百分位.
+ * 非零退出码表示校验失败、丢帧超限或吞吐低于门限, 便于在 CI 中检查回归.
+ *
+ * -C 按回传帧中的 credit (链路接收窗口, 块) 限制在途块数, 开环模式也不会
+ * 压满链路接收队列; 首个回传到达前按一个最大帧的窗口发送.
+ *
+ * -S 由本工具启动主机仿真 (build/stm32f735_sim), 把新建的伪终端作为仿真的
+ * UART7/USART1 后端, 压测结束后结束仿真; 仿真提前退出按失败处理.
+ *
+ * 编译 (Linux, 或顶层 CMakeLists.txt 中的 bridge_bench 目标):
+ *   gcc -O2 -o bridge_bench bridge_bench.c -lcrypto -lpthread -lm
+ *
+ * 示例:
+ *   bridge_bench -e /dev/ttyUSB0 -P b2b -w 3 -c 20000
+ *   bridge_bench -e pty -d pty -S build/stm32f735_sim -P poisson -R 2000 -t 10
+ *   bridge_bench -e /dev/ttyUSB0 -P burst -B 64 -n 0 -C -D 0
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+/* 与 bridge_frame.h 保持一致 */
+#define FRAME_SYNC0         0xA5
+#define FRAME_SYNC1         0x5A
+#define FRAME_HDR_SIZE      8
+#define FRAME_CRC_SIZE      4
+#define FRAME_MAX_LEN       256
+#define FRAME_MAX_SIZE      (FRAME_HDR_SIZE + FRAME_MAX_LEN + FRAME_CRC_SIZE)
+#define BLOCK_SIZE          16
+
+#define BENCH_SLOTS         4096    /* 在途帧表, 按 seq 取模; 须整除 65536 */
+#define BENCH_PORTS         2
+
+enum bench_pattern
+{
+    PATTERN_B2B = 0,                /* 闭环: 在途帧数达到窗口即等待回传 */
+    PATTERN_BURST,                  /* 开环: 连发 burst 帧后空闲 gap */
+    PATTERN_POISSON,                /* 开环: 指数分布间隔, 平均速率 rate */
+};
+
+struct bench_slot
+{
+    int             valid;
+    int             expired;        /* 已按超时计为丢失 */
+    uint16_t        len;
+    struct timespec sent;
+    uint8_t         expect[FRAME_MAX_LEN];
+};
+
+struct bench_port
+{
+    const char      *name;
+    const char      *path;
+    char             tty[64];       /* path 为 "pty" 时的从端路径 */
+    int              fd;
+    int              encrypt;
+
+    pthread_t        tx_thread;
+    pthread_t        rx_thread;
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    struct bench_slot slot[BENCH_SLOTS];
+    int              inflight;
+    int              inflight_blocks;
+    int              credit;        /* 最近一次回传帧通告的窗口 (块) */
+    uint16_t         next_seq;
+    uint32_t         rand_state;
+
+    /* 统计 */
+    unsigned long    tx_frames;
+    unsigned long    tx_blocks;
+    unsigned long    rx_frames;
+    unsigned long    rx_blocks;
+    unsigned long    dropped;       /* 超时未回传或在途表被覆盖 */
+    unsigned long    mismatches;    /* 回传内容与参考 AES 不符 */
+    unsigned long    crc_errors;
+    unsigned long    bad_frames;    /* 帧头非法或 seq 未知 */
+    unsigned long    late;          /* 超时后才回传 (已计入丢失) */
+    unsigned long    credit_waits;  /* 窗口用尽等待回传的次数 */
+
+    double          *lat;           /* 往返延迟 (us) */
+    size_t           lat_count;
+    size_t           lat_cap;
+};
+
+static struct
+{
+    enum bench_pattern pattern;
+    int             nblocks;        /* 0: 每帧随机 1..16 块 */
+    int             window;
+    int             credit;         /* 遵守链路通告的 credit 窗口 */
+    int             burst;
+    int             gap_ms;
+    double          rate;
+    unsigned long   count;
+    double          seconds;
+    int             timeout_ms;     /* 回传超时, 超时计为丢失 */
+    int             baud;
+    unsigned long   max_drops;
+    double          min_rate;
+    uint8_t         key[16];
+    const char     *sim;            /* 主机仿真程序, 由本工具启动 */
+    volatile int    stop;
+    volatile int    rx_stop;
+} cfg = {
+    .pattern   = PATTERN_B2B,
+    .nblocks   = 1,
+    .window    = 3,
+    .burst     = 16,
+    .gap_ms    = 10,
+    .rate      = 1000,
+    .count     = 10000,
+    .timeout_ms = 1000,
+    .baud      = 921600,
+    /* 与 main.c 中 pKeyAES 相同 (FIPS-197 示例密钥) */
+    .key       = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                   0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C },
+};
+
+/* =================================================================================
+ * 1. 基础工具
+ * ================================================================================= */
+
+static uint32_t crc_table[256];
+
+static void crc32_init(void)
+{
+    uint32_t c;
+    int i, k;
+
+    for (i = 0; i < 256; i++)
+    {
+        c = i;
+        for (k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+/* 标准 CRC-32 (zlib), 与 CRC 外设配置一致 */
+static uint32_t crc32_calc(const uint8_t *p, size_t n)
+{
+    uint32_t c = 0xFFFFFFFF;
+
+    while (n--)
+        c = crc_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return ~c;
+}
+
+static uint32_t bench_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static double ts_us(const struct timespec *a, const struct timespec *b)
+{
+    return (b->tv_sec - a->tv_sec) * 1e6 + (b->tv_nsec - a->tv_nsec) / 1e3;
+}
+
+static void sleep_us(double us)
+{
+    struct timespec ts;
+
+    if (us <= 0) return;
+    ts.tv_sec = (time_t)(us / 1e6);
+    ts.tv_nsec = (long)((us - ts.tv_sec * 1e6) * 1e3);
+    nanosleep(&ts, NULL);
+}
+
+static int write_all(int fd, const uint8_t *p, size_t n)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+    ssize_t r;
+
+    while (n > 0)
+    {
+        r = write(fd, p, n);
+        if (r < 0)
+        {
+            if (errno == EAGAIN)
+                poll(&pfd, 1, 100);
+            else if (errno != EINTR)
+                return -1;
+            continue;
+        }
+        p += r;
+        n -= r;
+    }
+    return 0;
+}
+
+static speed_t baud_to_speed(int baud)
+{
+    switch (baud)
+    {
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default:      return B921600;
+    }
+}
+
+/* 打开串口并设为 raw; path 为 "pty" 时新建伪终端并打印从端路径 */
+static int port_open(struct bench_port *port)
+{
+    struct termios tio;
+    int fd;
+
+    if (strcmp(port->path, "pty") == 0)
+    {
+        fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0)
+            return -1;
+        snprintf(port->tty, sizeof(port->tty), "%s", ptsname(fd));
+        printf("%s: %s\n", port->name, port->tty);
+        fflush(stdout);
+    }
+    else
+    {
+        fd = open(port->path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0)
+            return -1;
+    }
+
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, baud_to_speed(cfg.baud));
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    port->fd = fd;
+    return 0;
+}
+
+/* 启动主机仿真, 加密端口接 UART7, 解密端口接 USART1; 控制台不接 */
+static pid_t sim_start(struct bench_port *ports, int nports)
+{
+    const char *argv[8];
+    int argc = 0, i;
+    pid_t pid;
+
+    argv[argc++] = cfg.sim;
+    for (i = 0; i < nports; i++)
+    {
+        argv[argc++] = ports[i].encrypt ? "--uart7" : "--uart1";
+        argv[argc++] = ports[i].tty;
+    }
+    argv[argc++] = "--uart3";
+    argv[argc++] = "none";
+    argv[argc] = NULL;
+
+    pid = fork();
+    if (pid == 0)
+    {
+        execv(cfg.sim, (char **)argv);
+        perror(cfg.sim);
+        _exit(127);
+    }
+
+    return pid;
+}
+
+/* =================================================================================
+ * 2. 发送线程
+ * ================================================================================= */
+
+/* 回收超时未回传的在途帧, 调用时持有 port->lock */
+static void port_expire(struct bench_port *port)
+{
+    struct timespec now;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (i = 0; i < BENCH_SLOTS; i++)
+    {
+        if (port->slot[i].valid && ts_us(&port->slot[i].sent, &now) >= cfg.timeout_ms * 1e3)
+        {
+            port->slot[i].valid = 0;
+            port->slot[i].expired = 1;
+            port->inflight--;
+            port->inflight_blocks -= port->slot[i].len / BLOCK_SIZE;
+            port->dropped++;
+        }
+    }
+}
+
+static int port_frame_blocks(struct bench_port *port)
+{
+    if (cfg.nblocks > 0)
+        return cfg.nblocks;
+    return 1 + bench_rand(&port->rand_state) % (FRAME_MAX_LEN / BLOCK_SIZE);
+}
+
+static void *port_tx_entry(void *parameter)
+{
+    struct bench_port *port = parameter;
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    uint8_t frame[FRAME_MAX_SIZE];
+    struct bench_slot *slot;
+    struct timespec start, now;
+    uint32_t crc;
+    uint16_t seq;
+    int i, len, outl;
+
+    EVP_CipherInit_ex(ctx, EVP_aes_128_ecb(), NULL, cfg.key, NULL, port->encrypt);
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (!cfg.stop)
+    {
+        if (cfg.count && port->tx_frames >= cfg.count)
+            break;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (cfg.seconds > 0 && ts_us(&start, &now) >= cfg.seconds * 1e6)
+            break;
+
+        /* 组帧: 载荷随机, 期望结果由参考 AES 算出 */
+        len = port_frame_blocks(port) * BLOCK_SIZE;
+        for (i = 0; i < len; i++)
+            frame[FRAME_HDR_SIZE + i] = bench_rand(&port->rand_state);
+
+        pthread_mutex_lock(&port->lock);
+        if (cfg.credit && port->inflight_blocks + len / BLOCK_SIZE > port->credit && !cfg.stop)
+        {
+            port->credit_waits++;
+            while (port->inflight_blocks + len / BLOCK_SIZE > port->credit && !cfg.stop)
+            {
+                clock_gettime(CLOCK_REALTIME, &now);
+                now.tv_sec += 1;
+                if (pthread_cond_timedwait(&port->cond, &port->lock, &now) == ETIMEDOUT)
+                    port_expire(port);
+            }
+        }
+        if (cfg.pattern == PATTERN_B2B)
+        {
+            while (port->inflight >= cfg.window && !cfg.stop)
+            {
+                clock_gettime(CLOCK_REALTIME, &now);
+                now.tv_sec += 1;
+                if (pthread_cond_timedwait(&port->cond, &port->lock, &now) == ETIMEDOUT)
+                    port_expire(port);
+            }
+        }
+
+        seq = port->next_seq++;
+        slot = &port->slot[seq % BENCH_SLOTS];
+        if (slot->valid)
+        {
+            /* 开环发送时在途帧过多, 旧帧视为丢失 */
+            port->dropped++;
+            port->inflight--;
+            port->inflight_blocks -= slot->len / BLOCK_SIZE;
+        }
+        slot->expired = 0;
+        slot->len = len;
+        EVP_CipherUpdate(ctx, slot->expect, &outl, frame + FRAME_HDR_SIZE, len);
+
+        frame[0] = FRAME_SYNC0;
+        frame[1] = FRAME_SYNC1;
+        frame[2] = seq & 0xFF;
+        frame[3] = seq >> 8;
+        frame[4] = len & 0xFF;
+        frame[5] = len >> 8;
+        frame[6] = 0;
+        frame[7] = 0;
+        crc = crc32_calc(frame + 2, FRAME_HDR_SIZE - 2 + len);
+        frame[FRAME_HDR_SIZE + len + 0] = crc & 0xFF;
+        frame[FRAME_HDR_SIZE + len + 1] = (crc >> 8) & 0xFF;
+        frame[FRAME_HDR_SIZE + len + 2] = (crc >> 16) & 0xFF;
+        frame[FRAME_HDR_SIZE + len + 3] = crc >> 24;
+
+        clock_gettime(CLOCK_MONOTONIC, &slot->sent);
+        slot->valid = 1;
+        port->inflight++;
+        port->inflight_blocks += len / BLOCK_SIZE;
+        port->tx_frames++;
+        port->tx_blocks += len / BLOCK_SIZE;
+        pthread_mutex_unlock(&port->lock);
+
+        if (write_all(port->fd, frame, FRAME_HDR_SIZE + len + FRAME_CRC_SIZE) < 0)
+        {
+            perror(port->name);
+            break;
+        }
+
+        if (cfg.pattern == PATTERN_BURST && port->tx_frames % cfg.burst == 0)
+            sleep_us(cfg.gap_ms * 1e3);
+        else if (cfg.pattern == PATTERN_POISSON)
+            sleep_us(-log(1.0 - (bench_rand(&port->rand_state) + 0.5) / 4294967296.0) / cfg.rate * 1e6);
+    }
+
+    EVP_CIPHER_CTX_free(ctx);
+    return NULL;
+}
+
+/* =================================================================================
+ * 3. 接收线程
+ * ================================================================================= */
+
+static void port_lat_add(struct bench_port *port, double us)
+{
+    if (port->lat_count == port->lat_cap)
+    {
+        port->lat_cap = port->lat_cap ? port->lat_cap * 2 : 65536;
+        port->lat = realloc(port->lat, port->lat_cap * sizeof(double));
+    }
+    port->lat[port->lat_count++] = us;
+}
+
+/* 校验一个完整回传帧 (CRC 已通过) */
+static void port_rx_frame(struct bench_port *port, const uint8_t *frame, int len)
+{
+    struct bench_slot *slot;
+    struct timespec now;
+    uint16_t seq = frame[2] | (frame[3] << 8);
+    uint16_t credit = frame[6] | (frame[7] << 8);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&port->lock);
+    if (credit >= FRAME_MAX_LEN / BLOCK_SIZE)
+        port->credit = credit;
+    slot = &port->slot[seq % BENCH_SLOTS];
+    if (!slot->valid && slot->expired && slot->len == len)
+    {
+        port->late++;
+        slot->expired = 0;
+    }
+    else if (!slot->valid || slot->len != len)
+    {
+        port->bad_frames++;
+    }
+    else
+    {
+        if (memcmp(slot->expect, frame + FRAME_HDR_SIZE, len) != 0)
+            port->mismatches++;
+        port_lat_add(port, ts_us(&slot->sent, &now));
+        port->rx_frames++;
+        port->rx_blocks += len / BLOCK_SIZE;
+        slot->valid = 0;
+        port->inflight--;
+        port->inflight_blocks -= len / BLOCK_SIZE;
+        pthread_cond_signal(&port->cond);
+    }
+    pthread_mutex_unlock(&port->lock);
+}
+
+static void *port_rx_entry(void *parameter)
+{
+    struct bench_port *port = parameter;
+    uint8_t buf[4 * FRAME_MAX_SIZE];
+    struct pollfd pfd = { .fd = port->fd, .events = POLLIN };
+    size_t fill = 0, pos, size;
+    uint32_t crc;
+    ssize_t r;
+    int len;
+
+    while (!cfg.rx_stop)
+    {
+        /* 非阻塞读, poll 限时以便退出 */
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        r = read(port->fd, buf + fill, sizeof(buf) - fill);
+        if (r <= 0)
+            continue;
+        fill += r;
+
+        pos = 0;
+        while (fill - pos >= FRAME_HDR_SIZE)
+        {
+            if (buf[pos] != FRAME_SYNC0 || buf[pos + 1] != FRAME_SYNC1)
+            {
+                pos++;
+                continue;
+            }
+
+            len = buf[pos + 4] | (buf[pos + 5] << 8);
+            /* 回传帧的第三个字段是 credit, 不检查 */
+            if (len == 0 || len > FRAME_MAX_LEN || len % BLOCK_SIZE)
+            {
+                port->bad_frames++;
+                pos++;
+                continue;
+            }
+
+            size = FRAME_HDR_SIZE + len + FRAME_CRC_SIZE;
+            if (fill - pos < size)
+                break;
+
+            crc = buf[pos + size - 4] | (buf[pos + size - 3] << 8) |
+                  (buf[pos + size - 2] << 16) | ((uint32_t)buf[pos + size - 1] << 24);
+            if (crc32_calc(buf + pos + 2, FRAME_HDR_SIZE - 2 + len) != crc)
+            {
+                port->crc_errors++;
+                pos++;
+                continue;
+            }
+
+            port_rx_frame(port, buf + pos, len);
+            pos += size;
+        }
+
+        memmove(buf, buf + pos, fill - pos);
+        fill -= pos;
+    }
+
+    return NULL;
+}
+
+/* =================================================================================
+ * 4. 报告
+ * ================================================================================= */
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *v, size_t n, double p)
+{
+    size_t i;
+
+    if (n == 0) return 0;
+    i = (size_t)ceil(n * p / 100.0);
+    return v[i ? i - 1 : 0];
+}
+
+static void port_report(struct bench_port *port, double elapsed_us)
+{
+    size_t n = port->lat_count;
+
+    qsort(port->lat, n, sizeof(double), cmp_double);
+    printf("%-4s %9lu %9lu %10.0f %7lu %7lu %8.0f %8.0f %8.0f %8.0f %8.0f\n",
+           port->name, port->rx_frames, port->rx_blocks,
+           port->rx_blocks / (elapsed_us / 1e6), port->dropped,
+           port->mismatches + port->crc_errors + port->bad_frames,
+           percentile(port->lat, n, 50), percentile(port->lat, n, 90),
+           percentile(port->lat, n, 99), percentile(port->lat, n, 99.9),
+           n ? port->lat[n - 1] : 0);
+    if (port->mismatches || port->crc_errors || port->bad_frames || port->late)
+        printf("     mismatch %lu, crc %lu, bad %lu, late %lu\n",
+               port->mismatches, port->crc_errors, port->bad_frames, port->late);
+    if (cfg.credit)
+        printf("     credit %d blocks, waits %lu\n", port->credit, port->credit_waits);
+}
+
+/* =================================================================================
+ * 5. 主程序
+ * ================================================================================= */
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-e DEV] [-d DEV] [options]\n"
+            "  -e DEV     encrypt port (UART7), DEV may be \"pty\"\n"
+            "  -d DEV     decrypt port (USART1), both ports run mixed traffic\n"
+            "  -P PAT     b2b | burst | poisson (default b2b)\n"
+            "  -n N       blocks per frame 1..16, 0 = random (default 1)\n"
+            "  -w N       b2b: frames in flight (default 3)\n"
+            "  -C         limit blocks in flight to the credit advertised in replies\n"
+            "  -B N -g MS burst: frames per burst and idle gap (default 16, 10ms)\n"
+            "  -R RATE    poisson: mean frames/s per port (default 1000)\n"
+            "  -c N       frames per port, 0 = unlimited (default 10000)\n"
+            "  -t SEC     stop after SEC seconds\n"
+            "  -T MS      reply timeout, late frames count as dropped (default 1000)\n"
+            "  -b BAUD    serial baud rate (default 921600)\n"
+            "  -k HEX     AES-128 key (default: firmware key)\n"
+            "  -s SEED    random seed\n"
+            "  -W MS      wait before start, e.g. for a simulator to open the pty\n"
+            "  -S PATH    run the host simulator on the ptys (-e/-d must be \"pty\", default -W 500)\n"
+            "  -D N       fail if more than N frames are dropped (default 0)\n"
+            "  -r RATE    fail if total blocks/s is below RATE\n",
+            prog);
+}
+
+static int parse_key(const char *hex)
+{
+    unsigned int b;
+    int i;
+
+    if (strlen(hex) != 32)
+        return -1;
+    for (i = 0; i < 16; i++)
+    {
+        if (sscanf(hex + i * 2, "%2x", &b) != 1)
+            return -1;
+        cfg.key[i] = b;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static struct bench_port ports[BENCH_PORTS];
+    struct timespec start, end;
+    unsigned long drops = 0, errors = 0, blocks = 0;
+    uint32_t seed = (uint32_t)time(NULL);
+    double elapsed;
+    int nports = 0, wait_ms = -1, opt, i, status, ret = 0;
+    pid_t sim = -1;
+
+    while ((opt = getopt(argc, argv, "e:d:P:n:w:CB:g:R:c:t:T:b:k:s:W:S:D:r:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'e':
+        case 'd':
+            if (nports == BENCH_PORTS) { usage(argv[0]); return 2; }
+            ports[nports].name = (opt == 'e') ? "enc" : "dec";
+            ports[nports].encrypt = (opt == 'e');
+            ports[nports].path = optarg;
+            nports++;
+            break;
+        case 'P':
+            if (strcmp(optarg, "b2b") == 0) cfg.pattern = PATTERN_B2B;
+            else if (strcmp(optarg, "burst") == 0) cfg.pattern = PATTERN_BURST;
+            else if (strcmp(optarg, "poisson") == 0) cfg.pattern = PATTERN_POISSON;
+            else { usage(argv[0]); return 2; }
+            break;
+        case 'n': cfg.nblocks = atoi(optarg); break;
+        case 'w': cfg.window = atoi(optarg); break;
+        case 'C': cfg.credit = 1; break;
+        case 'B': cfg.burst = atoi(optarg); break;
+        case 'g': cfg.gap_ms = atoi(optarg); break;
+        case 'R': cfg.rate = atof(optarg); break;
+        case 'c': cfg.count = strtoul(optarg, NULL, 0); break;
+        case 't': cfg.seconds = atof(optarg); cfg.count = 0; break;
+        case 'T': cfg.timeout_ms = atoi(optarg); break;
+        case 'b': cfg.baud = atoi(optarg); break;
+        case 'k':
+            if (parse_key(optarg) < 0) { usage(argv[0]); return 2; }
+            break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        case 'W': wait_ms = atoi(optarg); break;
+        case 'S': cfg.sim = optarg; break;
+        case 'D': cfg.max_drops = strtoul(optarg, NULL, 0); break;
+        case 'r': cfg.min_rate = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (nports == 0 || cfg.nblocks < 0 || cfg.nblocks > FRAME_MAX_LEN / BLOCK_SIZE ||
+        cfg.window < 1 || cfg.window >= BENCH_SLOTS || cfg.burst < 1 || cfg.rate <= 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    for (i = 0; i < nports && cfg.sim != NULL; i++)
+    {
+        if (strcmp(ports[i].path, "pty") != 0)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (wait_ms < 0)
+        wait_ms = (cfg.sim != NULL) ? 500 : 0;
+
+    crc32_init();
+    for (i = 0; i < nports; i++)
+    {
+        if (port_open(&ports[i]) < 0)
+        {
+            perror(ports[i].path);
+            return 2;
+        }
+        pthread_mutex_init(&ports[i].lock, NULL);
+        pthread_cond_init(&ports[i].cond, NULL);
+        ports[i].rand_state = (seed + i * 0x9E3779B9) | 1;
+        ports[i].credit = FRAME_MAX_LEN / BLOCK_SIZE;
+    }
+    if (cfg.sim != NULL && (sim = sim_start(ports, nports)) < 0)
+    {
+        perror("fork");
+        return 2;
+    }
+    sleep_us(wait_ms * 1e3);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < nports; i++)
+    {
+        pthread_create(&ports[i].rx_thread, NULL, port_rx_entry, &ports[i]);
+        pthread_create(&ports[i].tx_thread, NULL, port_tx_entry, &ports[i]);
+    }
+    for (i = 0; i < nports; i++)
+        pthread_join(ports[i].tx_thread, NULL);
+
+    /* 等待在途帧回传, 超时未回的计为丢失 */
+    for (i = 0; i < cfg.timeout_ms; i++)
+    {
+        int inflight = 0, k;
+
+        for (k = 0; k < nports; k++)
+            inflight += ports[k].inflight;
+        if (inflight == 0) break;
+        sleep_us(1000);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    cfg.rx_stop = 1;
+    for (i = 0; i < nports; i++)
+    {
+        pthread_join(ports[i].rx_thread, NULL);
+        ports[i].dropped += ports[i].inflight;
+    }
+
+    elapsed = ts_us(&start, &end);
+    printf("port    frames    blocks   blocks/s   drops  errors  p50(us)  p90(us)  p99(us) p999(us)  max(us)\n");
+    for (i = 0; i < nports; i++)
+    {
+        port_report(&ports[i], elapsed);
+        drops += ports[i].dropped;
+        errors += ports[i].mismatches + ports[i].crc_errors + ports[i].bad_frames;
+        blocks += ports[i].rx_blocks;
+    }
+    printf("total %lu blocks in %.3f s, %.0f blocks/s\n", blocks, elapsed / 1e6, blocks / (elapsed / 1e6));
+
+    if (errors > 0)
+    {
+        printf("FAIL: %lu corrupted frames\n", errors);
+        ret = 1;
+    }
+    if (drops > cfg.max_drops)
+    {
+        printf("FAIL: %lu frames dropped (allowed %lu)\n", drops, cfg.max_drops);
+        ret = 1;
+    }
+    if (cfg.min_rate > 0 && blocks / (elapsed / 1e6) < cfg.min_rate)
+    {
+        printf("FAIL: %.0f blocks/s below %.0f\n", blocks / (elapsed / 1e6), cfg.min_rate);
+        ret = 1;
+    }
+    if (sim > 0)
+    {
+        if (waitpid(sim, &status, WNOHANG) == sim)
+        {
+            printf("FAIL: simulator exited early (status %d)\n", status);
+            ret = 1;
+        }
+        else
+        {
+            kill(sim, SIGTERM);
+            waitpid(sim, &status, 0);
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,308 @@
+/*
+ * bridge_rx_test.c - 桥接接收引擎 (bridge_rx.c) 主机测试
+ *
+ * 在仿真目标上 (sim/) 运行, 同一段字节流 (不同长度的帧, 夹杂非法帧头、
+ * 载荷中的假同步字和一个 CRC 错误帧) 分两种方式送入 bridge_rx:
+ *
+ *   direct  自备 256 字节环形缓冲区, 按随机步长写入后以循环 DMA 的写位置
+ *           (1 ~ ring_size, 全满时为 ring_size) 直接调用 bridge_rx_input():
+ *           覆盖缓冲区回绕、半满/全满处的事件、事件落在块内/帧头内/CRC 内
+ *           (部分块)、同一位置的重复事件, 以不同随机种子和起点跑多轮
+ *   uart7   经仿真 UART7 与 DMA1_Stream1 送入: 按字符时间到达, 由半满/全满/
+ *           线路空闲事件驱动; 分段发送使每段以空闲结束; 最后在半帧处注入
+ *           ORE, 检查端口重启后半帧被丢弃、后续帧正常收到
+ *
+ * 每一帧的序号、块数和载荷都须与发送的一致, 非法帧只计入统计.
+ * 任何一项失败时退出码非 0.
+ *
+ * 编译 (Linux, 顶层 CMakeLists.txt 中的 bridge_rx_test 目标):
+ *   cmake -S . -B build && cmake --build build --target bridge_rx_test
+ *
+ * 示例:
+ *   build/bridge_rx_test --uart3 stdio
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "bridge_rx.h"
+
+#define TEST_FRAMES             40
+#define TEST_TRIALS             64
+#define TEST_RING_SIZE          256
+
+static int failures;
+
+#define CHECK(cond, ...)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(cond))                                            \
+        {                                                       \
+            rt_kprintf("FAIL %s:%d: ", __func__, __LINE__);     \
+            rt_kprintf(__VA_ARGS__);                            \
+            rt_kprintf("\n");                                   \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+static CRC_HandleTypeDef hcrc;
+
+/* =================================================================================
+ * 1. 测试字节流
+ * ================================================================================= */
+
+static rt_uint8_t  stream[TEST_FRAMES * BRIDGE_FRAME_MAX_SIZE + 64];
+static rt_size_t   stream_len;
+static rt_uint16_t expect_seq[TEST_FRAMES];
+static rt_size_t   expect_num;
+
+static rt_uint8_t test_payload_byte(rt_uint16_t seq, rt_size_t i)
+{
+    /* 每隔一段放一个同步字, 检查载荷中的巧合不影响解析 */
+    if (i % 37 == 5)
+        return BRIDGE_FRAME_SYNC0;
+    if (i % 37 == 6)
+        return BRIDGE_FRAME_SYNC1;
+
+    return (rt_uint8_t)(seq * 31 + i * 7);
+}
+
+static rt_size_t test_blocks(rt_uint16_t seq)
+{
+    return 1 + (seq * 5) % (BRIDGE_FRAME_MAX_LEN / BRIDGE_BLOCK_SIZE);
+}
+
+static void test_build_stream(void)
+{
+    static const rt_uint8_t bad_header[] = { BRIDGE_FRAME_SYNC0, BRIDGE_FRAME_SYNC1, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00 };
+    rt_uint8_t *p;
+    rt_size_t len, i;
+    rt_uint16_t seq;
+
+    stream_len = 0;
+    expect_num = 0;
+    for (seq = 0; seq < TEST_FRAMES; seq++)
+    {
+        /* 帧间的杂散字节与非法帧头 (长度不是块的整数倍) */
+        if (seq % 7 == 3)
+        {
+            stream[stream_len++] = 0x00;
+            stream[stream_len++] = BRIDGE_FRAME_SYNC0;
+            memcpy(&stream[stream_len], bad_header, sizeof(bad_header));
+            stream_len += sizeof(bad_header);
+        }
+
+        p = &stream[stream_len];
+        len = test_blocks(seq) * BRIDGE_BLOCK_SIZE;
+        for (i = 0; i < len; i++)
+            p[BRIDGE_FRAME_HDR_SIZE + i] = test_payload_byte(seq, i);
+        stream_len += bridge_frame_seal(p, seq, len, 0);
+
+        /* 第 11 帧载荷损坏, 只丢弃这一帧 */
+        if (seq == 11)
+            p[BRIDGE_FRAME_HDR_SIZE + 3] ^= 0x40;
+        else
+            expect_seq[expect_num++] = seq;
+    }
+}
+
+/* 取空接收队列, 与期望的帧逐一比较; next 为下一个期望帧的下标 */
+static void test_pop(struct bridge_rx *rx, rt_size_t *next)
+{
+    static rt_uint8_t blocks[BRIDGE_FRAME_MAX_LEN];
+    struct bridge_rx_frame info;
+    rt_size_t count, i;
+    rt_uint16_t seq;
+
+    while ((count = bridge_rx_pop(rx, blocks, BRIDGE_FRAME_MAX_LEN / BRIDGE_BLOCK_SIZE, &info)) > 0)
+    {
+        if (*next >= expect_num)
+        {
+            CHECK(0, "%s: unexpected frame seq %d", rx->name, info.seq);
+            continue;
+        }
+
+        seq = expect_seq[(*next)++];
+        CHECK(info.seq == seq && count == test_blocks(seq) && info.nblocks == count,
+              "%s: got seq %d (%d blocks), expected seq %d (%d blocks)", rx->name, info.seq, count, seq,
+              test_blocks(seq));
+        for (i = 0; i < count * BRIDGE_BLOCK_SIZE && info.seq == seq; i++)
+        {
+            if (blocks[i] != test_payload_byte(seq, i))
+            {
+                CHECK(0, "%s: seq %d payload differs at %d", rx->name, seq, i);
+                break;
+            }
+        }
+    }
+}
+
+/* =================================================================================
+ * 2. 直接驱动 bridge_rx_input
+ * ================================================================================= */
+
+static struct bridge_rx rx_direct;
+ALIGN(32) static rt_uint8_t ring[TEST_RING_SIZE];
+
+/*
+ * 一次事件前 DMA 写入的字节数: 空闲事件可以在任意位置, 但半满/全满
+ * 事件保证不会越过缓冲区的一半或末尾
+ */
+static rt_size_t test_step(rt_uint32_t write)
+{
+    rt_size_t step, limit;
+
+    switch (rand() % 8)
+    {
+    case 0:  step = 1; break;
+    case 1:  step = 1 + rand() % 8; break;
+    case 2:  step = BRIDGE_BLOCK_SIZE; break;
+    case 3:  step = TEST_RING_SIZE; break;
+    default: step = 1 + rand() % TEST_RING_SIZE; break;
+    }
+
+    limit = (write < TEST_RING_SIZE / 2 ? TEST_RING_SIZE / 2 : TEST_RING_SIZE) - write;
+
+    return step < limit ? step : limit;
+}
+
+static void test_direct(void)
+{
+    rt_size_t offset, step, i, next;
+    rt_uint32_t write, crc_errors, bad_header;
+    rt_uint16_t pos;
+    int trial;
+
+    bridge_rx_init(&rx_direct, "direct", uart_port_find("uart1"));
+    rx_direct.ring      = ring;
+    rx_direct.ring_size = TEST_RING_SIZE;
+
+    for (trial = 0; trial < TEST_TRIALS; trial++)
+    {
+        srand(trial + 1);
+        crc_errors = rx_direct.crc_errors;
+        bad_header = rx_direct.bad_header;
+
+        /* 每轮从环形缓冲区的不同位置开始, 与端口停止后重新打开相同 */
+        write = rand() % TEST_RING_SIZE;
+        rx_direct.ring_pos = write;
+        next = 0;
+
+        for (offset = 0; offset < stream_len; offset += step)
+        {
+            step = test_step(write);
+            if (step > stream_len - offset)
+                step = stream_len - offset;
+
+            for (i = 0; i < step; i++)
+                ring[(write + i) % TEST_RING_SIZE] = stream[offset + i];
+            write = (write + step) % TEST_RING_SIZE;
+
+            /* HAL 回调的 Size: 全满 (TC) 时为缓冲区长度 */
+            pos = (write == 0) ? TEST_RING_SIZE : write;
+            bridge_rx_input(&rx_direct, pos);
+            if (rand() % 4 == 0)
+                bridge_rx_input(&rx_direct, pos);
+
+            test_pop(&rx_direct, &next);
+        }
+
+        CHECK(next == expect_num, "trial %d: %d of %d frames", trial, next, expect_num);
+        CHECK(rx_direct.crc_errors == crc_errors + 1, "trial %d: %d crc errors", trial,
+              rx_direct.crc_errors - crc_errors);
+        CHECK(rx_direct.bad_header > bad_header, "trial %d: bad header not counted", trial);
+        CHECK(rx_direct.state == BRIDGE_RX_SYNC0, "trial %d: parser left in state %d", trial, rx_direct.state);
+        CHECK(rx_direct.dropped == 0, "trial %d: %d frames dropped", trial, rx_direct.dropped);
+    }
+}
+
+/* =================================================================================
+ * 3. 经仿真 UART7 + DMA
+ * ================================================================================= */
+
+static struct bridge_rx rx_uart;
+
+/*
+ * 以下等待都按条件而不按固定时间: 主机负载下仿真线路上的字节会晚到, 上限
+ * (10 s) 只在失败时用到
+ */
+#define TEST_UART_WAIT_MAX      2000
+
+/* 等待收到 count 帧 (或超时), 边收边比较 */
+static void test_uart_wait(rt_size_t *next, rt_size_t count)
+{
+    int i;
+
+    for (i = 0; i < TEST_UART_WAIT_MAX && *next < count; i++)
+    {
+        bridge_rx_wait(&rx_uart, rt_tick_from_millisecond(5));
+        test_pop(&rx_uart, next);
+    }
+}
+
+static void test_uart(void)
+{
+    rt_size_t next = 0, offset, chunk, half;
+    rt_uint16_t seq = TEST_FRAMES;
+    rt_uint8_t frame[BRIDGE_FRAME_MAX_SIZE];
+    rt_size_t len, i;
+
+    CHECK(bridge_rx_init(&rx_uart, "uart7", uart_port_find("uart7")) == RT_EOK, "init");
+    CHECK(bridge_rx_start(&rx_uart) == RT_EOK, "start");
+
+    /* 分段发送, 段长与帧边界无关, 每段之后线路空闲 */
+    for (offset = 0, chunk = 1; offset < stream_len; offset += chunk, chunk = chunk * 3 % 509 + 1)
+    {
+        if (chunk > stream_len - offset)
+            chunk = stream_len - offset;
+        sim_uart_input("uart7", &stream[offset], chunk);
+        rt_thread_mdelay(1 + chunk / 64);
+        test_pop(&rx_uart, &next);
+    }
+    test_uart_wait(&next, expect_num);
+
+    CHECK(next == expect_num, "uart7: %d of %d frames", next, expect_num);
+    CHECK(rx_uart.crc_errors == 1, "uart7: %d crc errors", rx_uart.crc_errors);
+    CHECK(rx_uart.bytes == stream_len, "uart7: %d of %d bytes", rx_uart.bytes, stream_len);
+    CHECK(rx_uart.events > 0 && rx_uart.port->overruns == 0, "uart7: events %d, overruns %d", rx_uart.events,
+          rx_uart.port->overruns);
+
+    /* 半帧后 ORE: 端口从缓冲区起点重启, 半帧丢弃, 之后的帧照常收到 */
+    len = test_blocks(seq) * BRIDGE_BLOCK_SIZE;
+    for (i = 0; i < len; i++)
+        frame[BRIDGE_FRAME_HDR_SIZE + i] = test_payload_byte(seq, i);
+    len = bridge_frame_seal(frame, seq, len, 0);
+    half = len / 2 + 3;
+
+    /* 半帧全部进入缓冲区之后才注入, 否则剩下的字节在重启后到达 */
+    sim_uart_input("uart7", frame, half);
+    for (i = 0; i < TEST_UART_WAIT_MAX && rx_uart.bytes != stream_len + half; i++)
+        rt_thread_mdelay(5);
+    CHECK(rx_uart.bytes == stream_len + half, "uart7: %d of %d half frame bytes", rx_uart.bytes - stream_len, half);
+    sim_uart_inject_error("uart7", HAL_UART_ERROR_ORE);
+    for (i = 0; i < TEST_UART_WAIT_MAX && rx_uart.resets == 0; i++)
+        rt_thread_mdelay(5);
+    CHECK(rx_uart.resets == 1, "uart7: %d resets after ORE", rx_uart.resets);
+
+    expect_seq[expect_num++] = seq;
+    sim_uart_input("uart7", frame, len);
+    test_uart_wait(&next, expect_num);
+
+    CHECK(next == expect_num, "uart7: frame after restart not received");
+    CHECK(rx_uart.crc_errors == 1, "uart7: stale half frame parsed (%d crc errors)", rx_uart.crc_errors);
+}
+
+int app_main(void)
+{
+    hcrc.Instance = CRC;
+    bridge_frame_init(&hcrc);
+    test_build_stream();
+
+    test_direct();
+    test_uart();
+
+    rt_kprintf("bridge_rx_test: %s (%d failures)\n", failures ? "FAIL" : "PASS", failures);
+    sim_exit(failures ? 1 : 0);
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+/* rtconfig.h - bufq_bench 主机编译用的最小内核配置 (编译 ipc.c, mempool.c, bufq.c) */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+#define RT_NAME_MAX             8
+#define RT_ALIGN_SIZE           4
+#define RT_THREAD_PRIORITY_MAX  32
+#define RT_TICK_PER_SECOND      1000
+#define RT_USING_MAILBOX
+#define RT_USING_MESSAGEQUEUE
+#define RT_USING_MEMPOOL
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * clock_profile_test.c - 时钟档位切换 (clock_profile.c) 主机测试
+ *
+ * 在仿真目标上 (sim/) 运行, 启动时已切到默认档位 (perf), 之后检查:
+ *   boost   CPUFREQ_BOOST 选项字节未置位时 perf 档位降为 520 MHz
+ *   fault   PLL 不锁定、VOSRDY 不置位时切换在有限时间内返回错误, 系统留在
+ *           HSI 64 MHz; 关中断期间 HAL 的超时仍在计时; 故障清除后能切回 perf
+ *   scale   各档位下 UART 的 BRR 按内核时钟重算 (波特率不变), 仿真 CRYP 的
+ *           处理时间随 HCLK 变化 (lowpower 明显慢于 perf)
+ * 用时都按仿真时间检查 (见 test_apply 与 sim_cryp_busy_ns), 与主机负载无关.
+ * 任何一项失败时退出码非 0.
+ *
+ * 编译 (Linux, 顶层 CMakeLists.txt 中的 clock_profile_test 目标):
+ *   cmake -S . -B build && cmake --build build --target clock_profile_test
+ *
+ * 示例:
+ *   build/clock_profile_test --uart3 stdio
+ */
+
+#include "sim.h"
+#include "clock_profile.h"
+#include "uart_port.h"
+
+#define TEST_SWITCH_MAX_MS      100     /* 出故障时一次切换的上限 */
+#define TEST_CRYP_SIZE          32768
+#define TEST_CRYP_RUNS          4
+
+static int failures;
+
+#define CHECK(cond, ...)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(cond))                                            \
+        {                                                       \
+            rt_kprintf("FAIL %s:%d: ", __func__, __LINE__);     \
+            rt_kprintf(__VA_ARGS__);                            \
+            rt_kprintf("\n");                                   \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+/*
+ * 切换并返回用时 (ms): 主机时间扣除 CPU 线程在主机运行队列上等待的时间, 主机
+ * 负载 (并行的 ctest) 不会让它变长; host_ms 不为空时另给出主机时间, 只会更长.
+ */
+static rt_uint32_t test_apply(enum clock_profile_id id, rt_err_t *result, rt_uint32_t *host_ms)
+{
+    uint64_t start = sim_now_ns(), stall = sim_cpu_stall_ns();
+
+    *result = clock_profile_apply(id);
+
+    stall = sim_cpu_stall_ns() - stall;
+    if (host_ms != RT_NULL)
+        *host_ms = (rt_uint32_t)((sim_now_ns() - start) / 1000000);
+
+    return (rt_uint32_t)((sim_now_ns() - start - stall) / 1000000);
+}
+
+/* =================================================================================
+ * 1. CPUFREQ_BOOST
+ * ================================================================================= */
+
+static void test_boost(void)
+{
+    rt_err_t result;
+
+    CHECK(clock_profile_current() != RT_NULL && SystemCoreClock == 550000000UL, "boot: cpu %d Hz",
+          SystemCoreClock);
+
+    FLASH->OPTSR2_CUR &= ~FLASH_OPTSR2_CPUFREQ_BOOST;
+    test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+    CHECK(result == RT_EOK && SystemCoreClock == 520000000UL && HAL_RCC_GetHCLKFreq() == 260000000UL,
+          "no boost: result %d, cpu %d Hz", result, SystemCoreClock);
+
+    FLASH->OPTSR2_CUR |= FLASH_OPTSR2_CPUFREQ_BOOST;
+    test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+    CHECK(result == RT_EOK && SystemCoreClock == 550000000UL, "boost: result %d, cpu %d Hz", result,
+          SystemCoreClock);
+}
+
+/* =================================================================================
+ * 2. 故障与超时
+ * ================================================================================= */
+
+static void test_fault(void)
+{
+    rt_tick_t tick;
+    rt_uint32_t ms, host_ms;
+    rt_err_t result;
+
+    test_apply(CLOCK_PROFILE_LOWPOWER, &result, RT_NULL);
+    CHECK(result == RT_EOK && SystemCoreClock == HSI_VALUE, "lowpower: result %d", result);
+
+    /* 升压不就绪: 不提频 */
+    sim_rcc_inject(SIM_RCC_FAULT_VOSRDY);
+    ms = test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+    CHECK(result != RT_EOK, "perf without VOSRDY succeeded");
+    CHECK(ms < TEST_SWITCH_MAX_MS, "VOSRDY timeout took %d ms", ms);
+    CHECK(clock_profile_current() == RT_NULL && SystemCoreClock == HSI_VALUE, "VOSRDY: cpu %d Hz",
+          SystemCoreClock);
+
+    /* PLL 不锁定: HAL 在关中断时等满 PLL 超时后返回 (主机时间至少 1 ms) */
+    sim_rcc_inject(SIM_RCC_FAULT_PLL_LOCK);
+    ms = test_apply(CLOCK_PROFILE_BALANCED, &result, &host_ms);
+    CHECK(result != RT_EOK, "balanced without PLL lock succeeded");
+    CHECK(host_ms >= 1 && ms < TEST_SWITCH_MAX_MS, "PLL timeout took %d ms (host %d ms)", ms, host_ms);
+    CHECK(clock_profile_current() == RT_NULL && SystemCoreClock == HSI_VALUE, "PLL: cpu %d Hz",
+          SystemCoreClock);
+
+    /* 留在 HSI 时系统节拍照常 */
+    tick = rt_tick_get();
+    rt_thread_mdelay(20);
+    CHECK(rt_tick_get() - tick >= 20, "tick after failed switch: %d", rt_tick_get() - tick);
+
+    sim_rcc_inject(0);
+    test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+    CHECK(result == RT_EOK && SystemCoreClock == 550000000UL && clock_profile_current() != RT_NULL,
+          "perf after faults cleared: result %d, cpu %d Hz", result, SystemCoreClock);
+}
+
+/* =================================================================================
+ * 3. 外设时序随档位变化
+ * ================================================================================= */
+
+static const uint32_t aes_key[4] = { 0x2B7E1516, 0x28AED2A6, 0xABF71588, 0x09CF4F3C };
+static CRYP_HandleTypeDef hcryp;
+ALIGN(32) static uint8_t cryp_buf[TEST_CRYP_SIZE];
+
+/* 数次轮询加密在 CRYP 模型中的处理时间 (us), 不含主机计算 AES 的时间 */
+static rt_uint32_t test_cryp_us(void)
+{
+    uint64_t start = sim_cryp_busy_ns();
+    int n;
+
+    for (n = 0; n < TEST_CRYP_RUNS; n++)
+        HAL_CRYP_Encrypt(&hcryp, (uint32_t *)cryp_buf, TEST_CRYP_SIZE, (uint32_t *)cryp_buf, 10);
+
+    return (rt_uint32_t)((sim_cryp_busy_ns() - start) / 1000);
+}
+
+/* BRR 按当前 UART 内核时钟换算的波特率与配置的相差不超过 1% */
+static void test_uart_baud(const char *name, const char *profile)
+{
+    struct uart_port *port = uart_port_find(name);
+    rt_uint32_t baud;
+
+    CHECK(port != RT_NULL, "%s missing", name);
+    if (port == RT_NULL)
+        return;
+
+    baud = sim_rcc_usart_hz(port->huart.Instance) / port->huart.Instance->BRR;
+    CHECK(baud * 100 >= port->hw->baud * 99 && baud * 100 <= port->hw->baud * 101, "%s: %s baud %d, expected %d",
+          profile, name, baud, port->hw->baud);
+}
+
+static void test_scale(void)
+{
+    rt_uint32_t perf_us, low_us;
+    rt_err_t result;
+
+    hcryp.Instance             = CRYP;
+    hcryp.Init.DataType        = CRYP_DATATYPE_8B;
+    hcryp.Init.KeySize         = CRYP_KEYSIZE_128B;
+    hcryp.Init.Algorithm       = CRYP_AES_ECB;
+    hcryp.Init.pKey            = (uint32_t *)aes_key;
+    hcryp.Init.DataWidthUnit   = CRYP_DATAWIDTHUNIT_BYTE;
+    hcryp.Init.KeyIVConfigSkip = CRYP_KEYIVCONFIG_ONCE;
+    CHECK(HAL_CRYP_Init(&hcryp) == HAL_OK, "HAL_CRYP_Init");
+
+    test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+    test_uart_baud("uart1", "perf");
+    test_uart_baud("uart7", "perf");
+    perf_us = test_cryp_us();
+
+    test_apply(CLOCK_PROFILE_LOWPOWER, &result, RT_NULL);
+    CHECK(result == RT_EOK && sim_rcc_hclk() == HSI_VALUE, "lowpower hclk %d Hz", sim_rcc_hclk());
+    test_uart_baud("uart1", "lowpower");
+    test_uart_baud("uart7", "lowpower");
+    low_us = test_cryp_us();
+
+    /*
+     * 每轮 4 x 2048 块, 每块 38 个 HCLK 周期: perf (275 MHz) 约 1.1 ms,
+     * lowpower (64 MHz) 约 4.9 ms, 两者之比即 HCLK 之比 (约 4.3)
+     */
+    CHECK(perf_us > 1000 && low_us > perf_us * 4, "cryp: perf %d us, lowpower %d us", perf_us, low_us);
+
+    test_apply(CLOCK_PROFILE_PERF, &result, RT_NULL);
+}
+
+int app_main(void)
+{
+    test_boost();
+    test_fault();
+    test_scale();
+
+    rt_kprintf("clock_profile_test: %s (%d failures)\n", failures ? "FAIL" : "PASS", failures);
+    sim_exit(failures ? 1 : 0);
+
+    return 0;
+}
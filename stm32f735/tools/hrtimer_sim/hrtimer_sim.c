@@ -0,0 +1,413 @@
+/*
+ * hrtimer_sim.c - 高精度定时器主机侧虚拟时间测试
+ *
+ * 直接编译 hrtimer.c, 后端换成虚拟计数器: 计数只在模拟中推进, 比较值被
+ * 越过 (而不是写入时已过去) 才挂起中断, 与 TIM 比较通道一致. 每次读计数
+ * 额外推进 0~-k 微秒, 模拟代码执行时间, 覆盖 "写比较值时已经错过" 的情况.
+ *
+ * 主循环每步推进 1~-s 微秒后分发挂起的比较中断; hrtimer 线程以 1/4 的概率
+ * 在每步运行, 模拟线程调度延迟 (覆盖软定时器合并与重新启动). 每步另外
+ * 随机启动/停止/按绝对时刻启动 -c 个定时器, 超时 40% 在 1~20 us, 50% 在
+ * 20~2000 us, 10% 在 2~100 ms; 1/8 的定时器为周期定时器, 1/3 为软定时器;
+ * 硬单次定时器的回调以随机超时重新启动自身, 或停止另一个定时器.
+ *
+ * 检查: 回调不早于到期时刻, 已停止的定时器不回调, 周期定时器 (除错过
+ * 整周期外) 不漂移, 硬定时器延迟不超过一步加处理时间, 结束时没有丢失的
+ * 定时器. 计数器从回绕前 5 秒开始. 有错误时退出码非零.
+ *
+ * 编译 (Linux, 在本目录下):
+ *   gcc -O2 -I. -I../.. -I../../RT-Thread/include -o hrtimer_sim hrtimer_sim.c
+ *
+ * 示例:
+ *   hrtimer_sim -n 64 -t 2000000
+ *   hrtimer_sim -n 16 -t 500000 -s 5 -k 4 -c 2 -r 3
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../hrtimer.c"
+
+/* =================================================================================
+ * 1. 虚拟计数器与内核桩
+ * ================================================================================= */
+
+static struct
+{
+    uint32_t    cnt;
+    uint32_t    cmp;
+    int         pending;                /* 比较中断挂起 */
+    int         cost;                   /* 每次读计数推进 0~cost us */
+    uint64_t    elapsed;
+    uint64_t    matches;                /* 计数越过比较值 */
+    uint64_t    triggers;               /* 软件挂起 (写入时已错过) */
+} vclk;
+
+static int sem_value;
+static int irq_nest;
+static int in_isr;
+
+static void vclk_advance(uint32_t n)
+{
+    /* 比较值落在 (cnt, cnt + n] 内即匹配 */
+    if (n != 0 && vclk.cmp - vclk.cnt - 1 < n)
+    {
+        vclk.pending = 1;
+        vclk.matches++;
+    }
+    vclk.cnt += n;
+    vclk.elapsed += n;
+}
+
+static rt_uint32_t vclk_count(void)
+{
+    vclk_advance(rand() % (vclk.cost + 1));
+    return vclk.cnt;
+}
+
+static void vclk_set_compare(rt_uint32_t value)
+{
+    vclk.cmp = value;
+}
+
+static void vclk_trigger(void)
+{
+    vclk.pending = 1;
+    vclk.triggers++;
+}
+
+static const struct rt_hrtimer_clock vclk_clock = { vclk_count, vclk_set_compare, vclk_trigger };
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    return irq_nest++;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    irq_nest = (int)level;
+}
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    sem_value = value;
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    sem_value++;
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    static struct rt_thread dummy;
+
+    return &dummy;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    return RT_EOK;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "assert %s failed at %s:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/* =================================================================================
+ * 2. 负载
+ * ================================================================================= */
+
+struct sim_timer
+{
+    struct rt_hrtimer timer;
+    uint32_t        due;                /* 期望的到期计数值 */
+    int             armed;
+    int             stale;              /* 重新启动前已排队的线程回调, 按旧时刻检查 */
+    uint32_t        stale_due;
+};
+
+static struct sim_timer *timers;
+static int ntimers;
+static int step_max = 20;
+static uint64_t fired, early, late, spurious, drift, lost;
+static uint32_t late_max_hard, late_max_soft;
+static uint32_t late_limit;             /* 硬定时器允许的延迟: 一步加上一次中断处理所有定时器的读数开销 */
+
+static uint32_t random_timeout(void)
+{
+    int r = rand() % 100;
+
+    if (r < 40)
+        return 1 + rand() % 20;
+    if (r < 90)
+        return 20 + rand() % 1980;
+    return 2000 + rand() % 98000;
+}
+
+static void sim_mark_stale(struct sim_timer *st)
+{
+    /* 线程回调仍在排队: 重新计时保留它, 它对应旧的到期时刻 */
+    if (!rt_list_isempty(&st->timer.soft) && !st->stale)
+    {
+        st->stale = 1;
+        st->stale_due = st->due;
+    }
+}
+
+static void sim_start(struct sim_timer *st, uint32_t us)
+{
+    sim_mark_stale(st);
+    rt_hrtimer_set_time(&st->timer, us);
+    rt_hrtimer_start(&st->timer);
+    st->due = st->timer.expire;
+    st->armed = 1;
+}
+
+static void sim_start_at(struct sim_timer *st, uint32_t expire)
+{
+    sim_mark_stale(st);
+    rt_hrtimer_start_at(&st->timer, expire);
+    /* 已经过去的时刻立即到期, 延迟从启动时算 */
+    st->due = ((int32_t)(expire - vclk.cnt) < 0) ? vclk.cnt : expire;
+    st->armed = 1;
+}
+
+static void sim_stop(struct sim_timer *st)
+{
+    rt_hrtimer_stop(&st->timer);
+    st->armed = 0;
+    st->stale = 0;
+}
+
+static void sim_timeout(void *parameter)
+{
+    struct sim_timer *st = parameter;
+    int soft = (st->timer.flag & RT_HRTIMER_FLAG_SOFT_TIMER) != 0;
+    int periodic = (st->timer.flag & RT_HRTIMER_FLAG_PERIODIC) != 0;
+    static uint32_t overruns_seen;
+    uint32_t now = vclk.cnt, due, dt;
+
+    if (soft != !in_isr)
+    {
+        fprintf(stderr, "callback in wrong context\n");
+        exit(1);
+    }
+
+    if (st->stale)
+    {
+        due = st->stale_due;
+        st->stale = 0;
+        /* 新的一次在线程回调前也已到期, 两次合并为这一次回调 */
+        if (!periodic && !(st->timer.flag & RT_HRTIMER_FLAG_ACTIVATED))
+            st->armed = 0;
+    }
+    else if (!st->armed)
+    {
+        spurious++;
+        return;
+    }
+    else
+    {
+        due = st->due;
+        if (periodic)
+        {
+            /* 硬周期定时器在回调前已按到期时刻累加一个周期 */
+            if (!soft && st->timer.expire != due + st->timer.time && hrtimer_stat.overruns == overruns_seen)
+                drift++;
+            overruns_seen = hrtimer_stat.overruns;
+            st->due = st->timer.expire;
+        }
+        else
+        {
+            st->armed = 0;
+        }
+    }
+
+    fired++;
+    dt = now - due;
+    if ((int32_t)dt < 0)
+    {
+        early++;
+        return;
+    }
+    if (soft)
+    {
+        if (dt > late_max_soft)
+            late_max_soft = dt;
+    }
+    else
+    {
+        if (dt > late_max_hard)
+            late_max_hard = dt;
+        if (dt > late_limit)
+            late++;
+    }
+
+    /* 硬单次定时器: 重新启动自身或停止另一个 */
+    if (!soft && !periodic && !st->armed)
+    {
+        int r = rand() % 10;
+
+        if (r < 5)
+            sim_start(st, random_timeout());
+        else if (r == 5)
+            sim_stop(&timers[rand() % ntimers]);
+    }
+}
+
+static void sim_step(uint32_t us, int thread_prob)
+{
+    vclk_advance(us);
+
+    if (vclk.pending)
+    {
+        /* 与 TIM2_IRQHandler 一致, 先清挂起再处理 */
+        vclk.pending = 0;
+        in_isr = 1;
+        rt_hrtimer_isr();
+        in_isr = 0;
+    }
+
+    if (sem_value > 0 && rand() % thread_prob == 0)
+    {
+        sem_value = 0;
+        hrtimer_soft_process();
+    }
+
+    if (irq_nest != 0)
+    {
+        fprintf(stderr, "interrupts left disabled\n");
+        exit(1);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n timers] [-t steps] [-s max us/step] [-k max us/read] [-c churn/step] "
+            "[-r seed]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int steps = 1000000, churn = 1, seed = 1;
+    int opt, i, k;
+
+    ntimers = 32;
+    vclk.cost = 2;
+    while ((opt = getopt(argc, argv, "n:t:s:k:c:r:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': ntimers = atoi(optarg); break;
+        case 't': steps = atoi(optarg); break;
+        case 's': step_max = atoi(optarg); break;
+        case 'k': vclk.cost = atoi(optarg); break;
+        case 'c': churn = atoi(optarg); break;
+        case 'r': seed = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (ntimers <= 0 || steps <= 0 || step_max <= 0 || vclk.cost < 0 || churn < 0)
+        usage(argv[0]);
+
+    srand(seed);
+    late_limit = step_max + (ntimers + 8) * (vclk.cost + 1);
+    /* 从回绕前 5 秒开始 */
+    vclk.cnt = 0u - 5000000u;
+    vclk.cmp = vclk.cnt - 1;
+    rt_hrtimer_system_init(&vclk_clock);
+
+    timers = calloc(ntimers, sizeof(*timers));
+    if (timers == NULL)
+        return 1;
+
+    for (i = 0; i < ntimers; i++)
+    {
+        rt_uint8_t flag = (i % 8 == 7) ? RT_HRTIMER_FLAG_PERIODIC : RT_HRTIMER_FLAG_ONE_SHOT;
+
+        if (i % 3 == 2)
+            flag |= RT_HRTIMER_FLAG_SOFT_TIMER;
+        rt_hrtimer_init(&timers[i].timer, sim_timeout, &timers[i], 1, flag);
+        sim_start(&timers[i], (flag & RT_HRTIMER_FLAG_PERIODIC) ? 50 + rand() % 5000 : random_timeout());
+    }
+
+    for (k = 0; k < steps; k++)
+    {
+        sim_step(1 + rand() % step_max, 4);
+
+        for (i = 0; i < churn; i++)
+        {
+            struct sim_timer *st = &timers[rand() % ntimers];
+            int r = rand() % 10;
+
+            if (st->timer.flag & RT_HRTIMER_FLAG_PERIODIC)
+            {
+                /* 周期定时器偶尔改周期重启 */
+                if (r == 0)
+                    sim_start(st, 50 + rand() % 5000);
+                continue;
+            }
+            if (r < 6)
+                sim_start(st, random_timeout());
+            else if (r < 8)
+                sim_stop(st);
+            else
+                sim_start_at(st, rt_hrtimer_now() - 20 + rand() % 1000);
+        }
+    }
+
+    /* 不再改动, 推进到所有单次定时器到期, 线程每步都运行 */
+    for (k = 0; k < 200000 / step_max; k++)
+        sim_step(step_max, 1);
+
+    for (i = 0; i < ntimers; i++)
+    {
+        struct sim_timer *st = &timers[i];
+
+        if (st->timer.flag & RT_HRTIMER_FLAG_PERIODIC)
+        {
+            /* 可能被其他回调停止 */
+            if (st->armed && ((int32_t)(st->due - vclk.cnt) < 0 || !(st->timer.flag & RT_HRTIMER_FLAG_ACTIVATED)))
+                lost++;
+        }
+        else if (st->armed || st->stale)
+        {
+            lost++;
+        }
+    }
+
+    printf("%d timers, %d steps, %.3f s virtual, <= %d us/step, <= %d us/read, %d churn/step\n", ntimers,
+           steps, vclk.elapsed / 1e6, step_max, vclk.cost, churn);
+    printf("compare matches %llu, missed-compare triggers %llu\n", (unsigned long long)vclk.matches,
+           (unsigned long long)vclk.triggers);
+    printf("hrtimer: fired %u, thread %u, merged %u, overruns %u, late max %u us\n", hrtimer_stat.fired,
+           hrtimer_stat.soft, hrtimer_stat.soft_missed, hrtimer_stat.overruns, hrtimer_stat.late_max);
+    printf("callbacks %llu, late max hard %u us, thread %u us\n", (unsigned long long)fired, late_max_hard,
+           late_max_soft);
+    printf("early %llu, late %llu, spurious %llu, drift %llu, lost %llu\n", (unsigned long long)early,
+           (unsigned long long)late, (unsigned long long)spurious, (unsigned long long)drift,
+           (unsigned long long)lost);
+
+    return (early || late || spurious || drift || lost) ? 1 : 0;
+}
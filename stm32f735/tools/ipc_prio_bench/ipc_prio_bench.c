@@ -0,0 +1,391 @@
+/*
+ * ipc_prio_bench.c - IPC 等待队列优先级分桶索引 (RT_USING_IPC_PRIO_BUCKET) 主机侧基准
+ *
+ * 直接编译 RT-Thread/src/ipc.c, 用一个 RT_IPC_FLAG_PRIO 信号量和 -n 个等待
+ * 线程 (优先级从 -p 个不同值中随机), 随机执行三种操作:
+ *   take     一个未等待的线程 rt_sem_take(RT_WAITING_FOREVER) 挂入等待队列
+ *   release  rt_sem_release() 唤醒队首
+ *   timeout  随机一个等待线程超时, 与 thread.c 的 rt_thread_timeout 相同地移出
+ * 统计每次操作中最长的一段关中断时间 (最外层 disable 到 enable), 给出
+ * 平均 / p99 / 最大值. 队列长度保持在 -n 的一半到全满之间.
+ *
+ * 每次操作后检查: 队列按优先级非降序, 同优先级内按挂入顺序 (FIFO),
+ * 分桶索引 (打开时) 恰好串起每个优先级的最后一个等待线程. 不一致时退出码非零.
+ *
+ * 编译 (Linux, 在本目录下):
+ *   原路径 (线性插入):
+ *     gcc -O2 -I. -I../../RT-Thread/include -o ipc_bench_base ipc_prio_bench.c
+ *   分桶索引:
+ *     gcc -O2 -I. -I../../RT-Thread/include -DRT_USING_IPC_PRIO_BUCKET -o ipc_bench_bucket ipc_prio_bench.c
+ *   256 级优先级加 -DRT_THREAD_PRIORITY_MAX=256.
+ *
+ * 示例:
+ *   ipc_bench_bucket -n 64 -p 8
+ *   ipc_bench_bucket -n 1024 -p 32 -c 200000 -s 7
+ *
+ * cycles 为 x86 TSC 计数 (其他主机为纳秒), 含计时本身的开销, 只用于比较
+ * 同一台机器上两种编译的相对开销.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../../RT-Thread/src/ipc.c"
+
+/* =================================================================================
+ * 1. 内核桩
+ * ================================================================================= */
+
+static struct rt_thread *current;       /* rt_sem_take 的调用者 */
+static int irq_nest;
+static uint64_t irq_start, irq_longest; /* 当前操作中最长的关中断时间 */
+
+static uint64_t now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    if (irq_nest++ == 0)
+        irq_start = now_cycles();
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    uint64_t span;
+
+    if (--irq_nest == 0)
+    {
+        span = now_cycles() - irq_start;
+        if (span > irq_longest)
+            irq_longest = span;
+    }
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return current;
+}
+
+rt_err_t rt_thread_suspend(rt_thread_t thread)
+{
+    thread->stat = RT_THREAD_SUSPEND;
+    return RT_EOK;
+}
+
+/* 与 thread.c 相同: 移出等待队列, 就绪表不参与比较 */
+static void thread_list_remove(rt_thread_t thread)
+{
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    rt_ipc_list_remove(thread);
+#else
+    rt_list_remove(&(thread->tlist));
+#endif
+}
+
+rt_err_t rt_thread_resume(rt_thread_t thread)
+{
+    register rt_base_t temp;
+
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
+        return -RT_ERROR;
+
+    temp = rt_hw_interrupt_disable();
+    thread_list_remove(thread);
+    rt_hw_interrupt_enable(temp);
+
+    thread->stat = RT_THREAD_READY;
+
+    return RT_EOK;
+}
+
+void rt_schedule(void)
+{
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return 0;
+}
+
+rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_start(rt_timer_t timer)
+{
+    return RT_EOK;
+}
+
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+    return memset(s, c, count);
+}
+
+void rt_object_init(struct rt_object *object, enum rt_object_class_type type, const char *name)
+{
+    memset(object, 0, sizeof(*object));
+    object->type = type | RT_Object_Class_Static;
+    strncpy(object->name, name, RT_NAME_MAX - 1);
+}
+
+void rt_object_detach(rt_object_t object)
+{
+    object->type = 0;
+}
+
+rt_uint8_t rt_object_get_type(rt_object_t object)
+{
+    return object->type & ~RT_Object_Class_Static;
+}
+
+rt_bool_t rt_object_is_systemobject(rt_object_t object)
+{
+    return (object->type & RT_Object_Class_Static) ? RT_TRUE : RT_FALSE;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "assert %s failed at %s:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/* =================================================================================
+ * 2. 队列检查
+ * ================================================================================= */
+
+enum { OP_TAKE, OP_RELEASE, OP_TIMEOUT, OP_NUM };
+
+static const char *op_name[OP_NUM] = { "take", "release", "timeout" };
+
+static struct rt_thread *threads;
+static uint64_t *seq;                   /* 每个线程挂入时的序号 */
+static int *waiting, *idle;             /* 等待 / 未等待线程的下标 */
+static int nwaiting, nidle;
+static struct rt_semaphore sem;
+static uint32_t rng = 1;
+
+static uint32_t rand_u32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int check_list(void)
+{
+    rt_list_t *list = &sem.parent.suspend_thread, *node;
+    struct rt_thread *thread, *prev = RT_NULL;
+    int count = 0;
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    struct rt_thread *last;
+    int tails = 0, indexed = 0;
+#endif
+
+    for (node = list->next; node != list; node = node->next, count++)
+    {
+        thread = rt_list_entry(node, struct rt_thread, tlist);
+        if (prev != RT_NULL)
+        {
+            if (thread->current_priority < prev->current_priority)
+                return -1;
+            if (thread->current_priority == prev->current_priority &&
+                seq[thread - threads] < seq[prev - threads])
+                return -2;
+        }
+#ifdef RT_USING_IPC_PRIO_BUCKET
+        /* 恰好每个优先级的最后一个线程在索引中 */
+        if ((node->next == list ||
+             rt_list_entry(node->next, struct rt_thread, tlist)->current_priority != thread->current_priority) !=
+            (thread->ipc_bucket.next != RT_NULL))
+            return -3;
+        tails += thread->ipc_bucket.next != RT_NULL;
+#endif
+        prev = thread;
+    }
+    if (count != nwaiting)
+        return -4;
+
+#ifdef RT_USING_IPC_PRIO_BUCKET
+    /* 索引从队尾环回, 按优先级升序串起全部桶尾 */
+    if (count > 0)
+    {
+        last = rt_list_entry(list->prev, struct rt_thread, tlist);
+        node = last->ipc_bucket.next;
+        prev = last;
+        do
+        {
+            thread = IPC_BUCKET_ENTRY(node);
+            if (thread != last && prev != last && thread->ipc_priority <= prev->ipc_priority)
+                return -5;
+            prev = thread;
+            node = node->next;
+            indexed++;
+        } while (thread != last && indexed <= count);
+        if (indexed != tails)
+            return -6;
+    }
+#endif
+
+    return 0;
+}
+
+/* =================================================================================
+ * 3. 基准
+ * ================================================================================= */
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n waiters] [-p priorities] [-c ops] [-s seed]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t *samples[OP_NUM], sum, next_seq = 0;
+    unsigned long ops = 100000, count[OP_NUM] = { 0 }, i;
+    int nthreads = 64, nprio = 8, opt, op, k, err;
+    rt_uint8_t *prios;
+
+    while ((opt = getopt(argc, argv, "n:p:c:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': nthreads = atoi(optarg); break;
+        case 'p': nprio = atoi(optarg); break;
+        case 'c': ops = strtoul(optarg, NULL, 0); break;
+        case 's': rng = (uint32_t)atoi(optarg) * 2 + 1; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nthreads < 2 || nprio < 1 || nprio > RT_THREAD_PRIORITY_MAX || ops == 0)
+        usage(argv[0]);
+
+    threads = calloc(nthreads, sizeof(*threads));
+    seq     = calloc(nthreads, sizeof(*seq));
+    waiting = calloc(nthreads, sizeof(*waiting));
+    idle    = calloc(nthreads, sizeof(*idle));
+    prios   = calloc(nprio, sizeof(*prios));
+    for (op = 0; op < OP_NUM; op++)
+        samples[op] = calloc(ops, sizeof(uint64_t));
+
+    /* -p 个不同优先级, 在全部优先级中均匀散开 */
+    for (k = 0; k < nprio; k++)
+        prios[k] = (rt_uint8_t)(k * RT_THREAD_PRIORITY_MAX / nprio);
+
+    rt_sem_init(&sem, "bench", 0, RT_IPC_FLAG_PRIO);
+    for (k = 0; k < nthreads; k++)
+    {
+        rt_list_init(&threads[k].tlist);
+#ifdef RT_USING_IPC_PRIO_BUCKET
+        threads[k].ipc_bucket.next = RT_NULL;
+#endif
+        threads[k].current_priority = prios[rand_u32() % nprio];
+        threads[k].stat = RT_THREAD_READY;
+        idle[nidle++] = k;
+    }
+
+    for (i = 0; i < ops; i++)
+    {
+        /* 队列长度保持在一半到全满之间 */
+        if (nwaiting < nthreads / 2)
+            op = OP_TAKE;
+        else if (nidle == 0)
+            op = 1 + rand_u32() % 2;
+        else
+            op = rand_u32() % OP_NUM;
+
+        irq_longest = 0;
+        switch (op)
+        {
+        case OP_TAKE:
+            k = rand_u32() % nidle;
+            current = &threads[idle[k]];
+            seq[idle[k]] = next_seq++;
+            waiting[nwaiting++] = idle[k];
+            idle[k] = idle[--nidle];
+            rt_sem_take(&sem, RT_WAITING_FOREVER);
+            break;
+
+        case OP_RELEASE:
+            rt_sem_release(&sem);
+            /* 找到被唤醒的线程 */
+            for (k = 0; threads[waiting[k]].stat != RT_THREAD_READY; k++);
+            idle[nidle++] = waiting[k];
+            waiting[k] = waiting[--nwaiting];
+            break;
+
+        case OP_TIMEOUT:
+            k = rand_u32() % nwaiting;
+            {
+                struct rt_thread *thread = &threads[waiting[k]];
+                rt_base_t temp;
+
+                temp = rt_hw_interrupt_disable();
+                thread->error = -RT_ETIMEOUT;
+                thread_list_remove(thread);
+                thread->stat = RT_THREAD_READY;
+                rt_hw_interrupt_enable(temp);
+            }
+            idle[nidle++] = waiting[k];
+            waiting[k] = waiting[--nwaiting];
+            break;
+        }
+        samples[op][count[op]++] = irq_longest;
+
+        if ((err = check_list()) != 0)
+        {
+            printf("FAIL: list check %d after op %lu (%s)\n", err, i, op_name[op]);
+            return 1;
+        }
+    }
+
+    printf("%s, %d threads over %d priorities (max %d), %lu ops\n",
+#ifdef RT_USING_IPC_PRIO_BUCKET
+           "bucket index",
+#else
+           "linear insert",
+#endif
+           nthreads, nprio, RT_THREAD_PRIORITY_MAX, ops);
+    printf("%-8s %10s %10s %10s %10s   (irq-off cycles)\n", "op", "count", "mean", "p99", "max");
+    for (op = 0; op < OP_NUM; op++)
+    {
+        if (count[op] == 0)
+            continue;
+        qsort(samples[op], count[op], sizeof(uint64_t), cmp_u64);
+        for (sum = 0, i = 0; i < count[op]; i++)
+            sum += samples[op][i];
+        printf("%-8s %10lu %10.1f %10llu %10llu\n", op_name[op], count[op], (double)sum / count[op],
+               (unsigned long long)samples[op][count[op] * 99 / 100],
+               (unsigned long long)samples[op][count[op] - 1]);
+    }
+    printf("list checks passed\n");
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+/* rtconfig.h - ipc_prio_bench 主机编译用的最小内核配置 (编译 ipc.c) */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+#define RT_NAME_MAX             8
+#define RT_ALIGN_SIZE           4
+#ifndef RT_THREAD_PRIORITY_MAX
+#define RT_THREAD_PRIORITY_MAX  32
+#endif
+#define RT_TICK_PER_SECOND      1000
+#define RT_USING_SEMAPHORE
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * ringbuf_stress.c - rt_ringbuf 主机侧并发压力测试
+ *
+ * 直接编译 RT-Thread/src/ringbuf.c, 生产者与消费者各跑在一个 pthread 上
+ * (多核主机上真正并发, 屏障由 rthw.h 的 __atomic 栅栏实现), 信号量桩
+ * 映射到 POSIX sem_t. 字节流第 i 个字节为 i 的散列, 消费者逐字节校验,
+ * 顺序错乱、重复、丢失或读到未写完的数据都会被发现.
+ *
+ * 生产者每次写入 1~size 字节 (满时让出 CPU), 消费者每次读出 1~size 字节;
+ * -m 选择拷贝 (put/get)、零拷贝 (reserve/commit, peek/consume) 或每次随机.
+ * -w 时消费者在数据不足时以 rt_ringbuf_wait() 阻塞 (无超时), 等待随机
+ * 1~size/2 字节; 唤醒丢失会使测试停住, 5 秒无进展即判为失败.
+ * 校验失败或停住时退出码非零.
+ *
+ * 编译 (Linux, 在本目录下):
+ *   gcc -O2 -I. -I../../RT-Thread/include -o ringbuf_stress ringbuf_stress.c -lpthread
+ *
+ * 示例:
+ *   ringbuf_stress -s 256 -n 512
+ *   ringbuf_stress -s 64 -n 128 -m zero -w
+ *   ringbuf_stress -s 4096 -n 2048 -m mix -w -r 3
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../RT-Thread/src/ringbuf.c"
+
+/* =================================================================================
+ * 1. 内核桩
+ * ================================================================================= */
+
+static sem_t host_sem;                  /* 只有一个环形缓冲区, 对应它的唤醒信号量 */
+static volatile unsigned long sem_releases;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return (rt_tick_t)(now_ns() / (1000000000ull / RT_TICK_PER_SECOND));
+}
+
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    return memcpy(dst, src, count);
+}
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    return sem_init(&host_sem, 0, value) == 0 ? RT_EOK : -RT_ERROR;
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+    sem_destroy(&host_sem);
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+    struct timespec ts;
+    int ret;
+
+    if (time == RT_WAITING_FOREVER)
+    {
+        while ((ret = sem_wait(&host_sem)) != 0 && errno == EINTR);
+    }
+    else if (time == RT_WAITING_NO)
+    {
+        ret = sem_trywait(&host_sem);
+    }
+    else
+    {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += (long)time * (1000000000l / RT_TICK_PER_SECOND);
+        ts.tv_sec  += ts.tv_nsec / 1000000000l;
+        ts.tv_nsec %= 1000000000l;
+        while ((ret = sem_timedwait(&host_sem, &ts)) != 0 && errno == EINTR);
+    }
+
+    return ret == 0 ? RT_EOK : -RT_ETIMEOUT;
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    sem_releases++;
+    sem_post(&host_sem);
+    return RT_EOK;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "assert %s failed at %s:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/* =================================================================================
+ * 2. 生产者与消费者
+ * ================================================================================= */
+
+enum { MODE_COPY, MODE_ZERO, MODE_MIX };
+
+static struct rt_ringbuf rb;
+static int mode = MODE_COPY;
+static int use_wait;
+static uint32_t size = 256;
+static uint64_t total;                  /* 消费者需要校验的字节数 */
+
+static volatile uint64_t consumed;      /* 供看门狗观察进展 */
+static volatile int done;
+static unsigned long full_spins, empty_spins, waits, mismatches;
+
+static uint8_t stream_byte(uint64_t i)
+{
+    uint32_t x = (uint32_t)i ^ (uint32_t)(i >> 32) * 0x9E3779B9u;
+
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    return (uint8_t)x;
+}
+
+static uint32_t rand_r32(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static int pick_zero_copy(uint32_t *state)
+{
+    if (mode == MODE_MIX)
+        return rand_r32(state) & 1;
+    return mode == MODE_ZERO;
+}
+
+static void *producer_entry(void *arg)
+{
+    uint32_t state = (uint32_t)(uintptr_t)arg;
+    uint8_t *chunk = malloc(size);
+    uint64_t pos = 0;
+    rt_size_t n, len, i;
+    void *ptr;
+
+    /* 持续生产直到消费者校验完, 消费者等待的门限总能达到 */
+    while (!done)
+    {
+        len = 1 + rand_r32(&state) % size;
+
+        if (pick_zero_copy(&state))
+        {
+            n = rt_ringbuf_reserve(&rb, &ptr);
+            if (n > len)
+                n = len;
+            for (i = 0; i < n; i++)
+                ((uint8_t *)ptr)[i] = stream_byte(pos + i);
+            rt_ringbuf_commit(&rb, n);
+        }
+        else
+        {
+            for (i = 0; i < len; i++)
+                chunk[i] = stream_byte(pos + i);
+            n = rt_ringbuf_put(&rb, chunk, len);
+        }
+
+        pos += n;
+        if (n == 0)
+        {
+            full_spins++;
+            sched_yield();
+        }
+    }
+
+    free(chunk);
+    return NULL;
+}
+
+static void *consumer_entry(void *arg)
+{
+    uint32_t state = (uint32_t)(uintptr_t)arg;
+    uint8_t *chunk = malloc(size);
+    uint64_t pos = 0;
+    rt_size_t n, len, i;
+    void *ptr;
+
+    while (pos < total)
+    {
+        if (rt_ringbuf_data_len(&rb) == 0)
+        {
+            if (use_wait)
+            {
+                waits++;
+                if (rt_ringbuf_wait(&rb, 1 + rand_r32(&state) % (size / 2), RT_WAITING_FOREVER) != RT_EOK)
+                    break;
+            }
+            else
+            {
+                empty_spins++;
+                sched_yield();
+                continue;
+            }
+        }
+
+        len = 1 + rand_r32(&state) % size;
+        if (pick_zero_copy(&state))
+        {
+            n = rt_ringbuf_peek(&rb, &ptr);
+            if (n > len)
+                n = len;
+            for (i = 0; i < n; i++)
+                mismatches += ((uint8_t *)ptr)[i] != stream_byte(pos + i);
+            rt_ringbuf_consume(&rb, n);
+        }
+        else
+        {
+            n = rt_ringbuf_get(&rb, chunk, len);
+            for (i = 0; i < n; i++)
+                mismatches += chunk[i] != stream_byte(pos + i);
+        }
+
+        pos += n;
+        consumed = pos;
+        if (mismatches)
+            break;
+    }
+
+    done = 1;
+    free(chunk);
+    return NULL;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-s size] [-n MB] [-m copy|zero|mix] [-w] [-r seed]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t producer, consumer;
+    uint64_t t0, last = 0, stall_ns = 0;
+    unsigned long mb = 256;
+    int opt, seed = 1, stalled = 0;
+    double secs;
+    void *pool;
+
+    while ((opt = getopt(argc, argv, "s:n:m:wr:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's': size = strtoul(optarg, NULL, 0); break;
+        case 'n': mb = strtoul(optarg, NULL, 0); break;
+        case 'm':
+            if (strcmp(optarg, "copy") == 0) mode = MODE_COPY;
+            else if (strcmp(optarg, "zero") == 0) mode = MODE_ZERO;
+            else if (strcmp(optarg, "mix") == 0) mode = MODE_MIX;
+            else usage(argv[0]);
+            break;
+        case 'w': use_wait = 1; break;
+        case 'r': seed = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (size < 2 || (size & (size - 1)) != 0 || mb == 0)
+        usage(argv[0]);
+
+    total = (uint64_t)mb << 20;
+    pool = malloc(size);
+    if (pool == NULL || rt_ringbuf_init(&rb, "stress", pool, size) != RT_EOK)
+        return 1;
+    /* 从计数器回绕前开始, 覆盖 head/tail 回绕 */
+    rb.head = rb.tail = 0u - size * 3;
+
+    t0 = now_ns();
+    pthread_create(&producer, NULL, producer_entry, (void *)(uintptr_t)(seed * 2 + 1));
+    pthread_create(&consumer, NULL, consumer_entry, (void *)(uintptr_t)(seed * 2 + 2));
+
+    /* 看门狗: 5 秒没有进展视为唤醒丢失 */
+    while (!done)
+    {
+        usleep(10000);
+        if (consumed != last)
+        {
+            last = consumed;
+            stall_ns = 0;
+        }
+        else if ((stall_ns += 10000000ull) >= 5000000000ull)
+        {
+            stalled = 1;
+            fprintf(stderr, "stalled at %llu bytes: data %u, wait %u\n", (unsigned long long)consumed,
+                    (unsigned)rt_ringbuf_data_len(&rb), (unsigned)rb.wait);
+            break;
+        }
+    }
+    secs = (now_ns() - t0) / 1e9;
+    if (stalled)
+    {
+        printf("FAIL: stalled\n");
+        return 1;
+    }
+    pthread_join(consumer, NULL);
+    pthread_join(producer, NULL);
+
+    printf("size %u, %s%s, %.1f MB in %.2f s, %.1f MB/s\n", size,
+           mode == MODE_COPY ? "copy" : mode == MODE_ZERO ? "zero-copy" : "mixed", use_wait ? ", wait" : "",
+           consumed / 1048576.0, secs, consumed / 1048576.0 / secs);
+    printf("full spins %lu, empty spins %lu, waits %lu, wake-ups %lu\n", full_spins, empty_spins, waits,
+           (unsigned long)sem_releases);
+    printf("mismatches %lu\n", mismatches);
+
+    return (mismatches || consumed < total) ? 1 : 0;
+}
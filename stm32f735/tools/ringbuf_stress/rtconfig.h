@@ -0,0 +1,12 @@
+/* rtconfig.h - ringbuf_stress 主机编译用的最小内核配置 (只编译 ringbuf.c) */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+#define RT_NAME_MAX             8
+#define RT_ALIGN_SIZE           4
+#define RT_THREAD_PRIORITY_MAX  32
+#define RT_TICK_PER_SECOND      1000
+#define RT_DEBUG
+#define RT_USING_SEMAPHORE
+
+#endif
@@ -0,0 +1,394 @@
+/*
+ * sem_handoff_bench.c - 信号量释放直接切换 (RT_USING_SEM_HANDOFF) 主机侧基准
+ *
+ * 直接编译 RT-Thread/src/ipc.c 与 scheduler.c, 线程对象与就绪表是真实的,
+ * 上下文切换只记录目标线程. 每轮构造一个现场: 当前线程 (就绪表中优先级
+ * 最高) + 若干就绪线程 + 挂在信号量上的等待线程, 然后在中断 (或线程)
+ * 上下文中 rt_sem_release(), 统计该调用的耗时、关中断次数与 __rt_ffs 调用
+ * 次数, 并检查请求的切换目标与按就绪表重新选出的最高优先级线程一致.
+ * 一轮结束后把被唤醒的线程放回等待队列, 恢复现场.
+ *
+ * 场景:
+ *   high     一个等待线程, 优先级高于当前线程 (直接切换的目标场景)
+ *   low      一个等待线程, 优先级低于当前线程, 不切换
+ *   mixed    -w 个等待线程与 -r 个就绪线程, 优先级随机
+ *   locked   同 high, 但释放时调度器上锁, 解锁时由 rt_exit_critical 切换
+ *
+ * 编译 (Linux, 在本目录下):
+ *   原路径:
+ *     gcc -O2 -I. -I../../RT-Thread/include -o sem_bench_base sem_handoff_bench.c
+ *   直接切换:
+ *     gcc -O2 -I. -I../../RT-Thread/include -DRT_USING_SEM_HANDOFF -o sem_bench_handoff sem_handoff_bench.c
+ *   256 级优先级 (加 -DRT_THREAD_PRIORITY_MAX=256) 检查两级就绪表的分支.
+ *
+ * 示例:
+ *   sem_bench_handoff -n 1000000
+ *   sem_bench_handoff -n 200000 -w 8 -r 8 -i 50 -s 3
+ *
+ * cycles 为 x86 TSC 计数 (其他主机为纳秒), 含计时本身的开销, 只用于比较
+ * 同一台机器上两种编译的相对开销. 切换目标不一致时退出码非零.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../../RT-Thread/src/scheduler.c"
+#include "../../RT-Thread/src/ipc.c"
+
+#define MAX_THREADS         64
+
+/* =================================================================================
+ * 1. 内核桩
+ * ================================================================================= */
+
+volatile rt_uint8_t rt_interrupt_nest;
+
+static struct rt_thread *switch_to;     /* 最近一次请求切换的目标 */
+static uint64_t irq_sections, ffs_calls;
+
+static uint64_t now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    irq_sections++;
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+}
+
+int __rt_ffs(int value)
+{
+    ffs_calls++;
+    return __builtin_ffs(value);
+}
+
+void rt_hw_context_switch(rt_ubase_t from, rt_ubase_t to)
+{
+    switch_to = rt_container_of((void *)to, struct rt_thread, sp);
+}
+
+void rt_hw_context_switch_interrupt(rt_ubase_t from, rt_ubase_t to)
+{
+    switch_to = rt_container_of((void *)to, struct rt_thread, sp);
+}
+
+void rt_hw_context_switch_to(rt_ubase_t to)
+{
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return rt_current_thread;
+}
+
+rt_err_t rt_thread_suspend(rt_thread_t thread)
+{
+    return RT_EOK;
+}
+
+/* 与 thread.c 相同: 移出等待队列, 停超时定时器, 插入就绪表 */
+rt_err_t rt_thread_resume(rt_thread_t thread)
+{
+    register rt_base_t temp;
+
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
+        return -RT_ERROR;
+
+    temp = rt_hw_interrupt_disable();
+    rt_list_remove(&(thread->tlist));
+    rt_hw_interrupt_enable(temp);
+
+    rt_schedule_insert_thread(thread);
+
+    return RT_EOK;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return 0;
+}
+
+rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_timer_start(rt_timer_t timer)
+{
+    return RT_EOK;
+}
+
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+    return memset(s, c, count);
+}
+
+void rt_object_init(struct rt_object *object, enum rt_object_class_type type, const char *name)
+{
+    memset(object, 0, sizeof(*object));
+    object->type = type | RT_Object_Class_Static;
+    strncpy(object->name, name, RT_NAME_MAX - 1);
+}
+
+void rt_object_detach(rt_object_t object)
+{
+    object->type = 0;
+}
+
+rt_uint8_t rt_object_get_type(rt_object_t object)
+{
+    return object->type & ~RT_Object_Class_Static;
+}
+
+rt_bool_t rt_object_is_systemobject(rt_object_t object)
+{
+    return (object->type & RT_Object_Class_Static) ? RT_TRUE : RT_FALSE;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "assert %s failed at %s:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/* =================================================================================
+ * 2. 现场构造
+ * ================================================================================= */
+
+enum { SC_HIGH, SC_LOW, SC_MIXED, SC_LOCKED, SC_NUM };
+
+static const char *scene_name[SC_NUM] = { "high", "low", "mixed", "locked" };
+
+static struct rt_thread threads[MAX_THREADS];
+static struct rt_semaphore sem;
+static int nwaiters = 4, nready = 4, irq_percent = 100;
+static uint32_t rng = 1;
+static unsigned long mismatches;
+
+static uint32_t rand_u32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void thread_setup(struct rt_thread *thread, int priority)
+{
+    rt_list_init(&thread->tlist);
+    thread->current_priority = (rt_uint8_t)priority;
+#if RT_THREAD_PRIORITY_MAX > 32
+    thread->number      = (rt_uint8_t)(priority >> 3);
+    thread->number_mask = 1L << thread->number;
+    thread->high_mask   = (rt_uint8_t)(1L << (priority & 0x07));
+#else
+    thread->number_mask = 1L << priority;
+#endif
+}
+
+static void thread_wait(struct rt_thread *thread)
+{
+    thread->stat = RT_THREAD_SUSPEND;
+    rt_list_insert_before(&sem.parent.suspend_thread, &thread->tlist);
+}
+
+/* 按就绪表重新选出的最高优先级线程, 即 rt_schedule 的选择 */
+static struct rt_thread *highest_ready(void)
+{
+    int prio;
+
+    for (prio = 0; prio < RT_THREAD_PRIORITY_MAX; prio++)
+    {
+        if (!rt_list_isempty(&rt_thread_priority_table[prio]))
+            return rt_list_entry(rt_thread_priority_table[prio].next, struct rt_thread, tlist);
+    }
+    return RT_NULL;
+}
+
+/*
+ * threads[0] 为当前线程 (优先级 cur), 其余就绪线程优先级不高于它,
+ * 等待线程优先级随机. 返回等待线程个数.
+ */
+static void build(int scene)
+{
+    int cur = RT_THREAD_PRIORITY_MAX / 2, i, n = 1, prio;
+
+    rt_system_scheduler_init();
+    rt_sem_init(&sem, "bench", 0, RT_IPC_FLAG_FIFO);
+
+    thread_setup(&threads[0], cur);
+    rt_schedule_insert_thread(&threads[0]);
+    rt_current_thread   = &threads[0];
+    rt_current_priority = (rt_uint8_t)cur;
+
+    switch (scene)
+    {
+    case SC_HIGH:
+    case SC_LOCKED:
+        thread_setup(&threads[n], cur - 1 - rand_u32() % (cur - 1));
+        thread_wait(&threads[n++]);
+        break;
+    case SC_LOW:
+        thread_setup(&threads[n], cur + 1 + rand_u32() % (RT_THREAD_PRIORITY_MAX - cur - 2));
+        thread_wait(&threads[n++]);
+        break;
+    case SC_MIXED:
+        for (i = 0; i < nready; i++, n++)
+        {
+            thread_setup(&threads[n], cur + rand_u32() % (RT_THREAD_PRIORITY_MAX - cur - 1));
+            rt_schedule_insert_thread(&threads[n]);
+        }
+        for (i = 0; i < nwaiters; i++, n++)
+        {
+            prio = 1 + rand_u32() % (RT_THREAD_PRIORITY_MAX - 2);
+            thread_setup(&threads[n], prio);
+            thread_wait(&threads[n]);
+        }
+        break;
+    }
+}
+
+/* =================================================================================
+ * 3. 测量
+ * ================================================================================= */
+
+struct scene_stat
+{
+    uint64_t count, cycles, irq, ffs, switches;
+    uint64_t cycles_max;
+};
+
+static struct scene_stat stats[SC_NUM];
+
+static void run_once(int scene)
+{
+    struct scene_stat *st = &stats[scene];
+    struct rt_thread *woken, *expect;
+    uint64_t c0, c1, irq0, ffs0;
+    int in_irq = (int)(rand_u32() % 100) < irq_percent;
+
+    build(scene);
+    woken = rt_list_entry(sem.parent.suspend_thread.next, struct rt_thread, tlist);
+    switch_to = RT_NULL;
+
+    if (scene == SC_LOCKED)
+        rt_enter_critical();
+
+    rt_interrupt_nest = in_irq ? 1 : 0;
+    irq0 = irq_sections;
+    ffs0 = ffs_calls;
+    c0   = now_cycles();
+    rt_sem_release(&sem);
+    c1   = now_cycles();
+    rt_interrupt_nest = 0;
+
+    st->count++;
+    st->cycles += c1 - c0;
+    if (c1 - c0 > st->cycles_max)
+        st->cycles_max = c1 - c0;
+    st->irq += irq_sections - irq0;
+    st->ffs += ffs_calls - ffs0;
+
+    if (scene == SC_LOCKED)
+    {
+        if (switch_to != RT_NULL)
+            mismatches++;
+        rt_exit_critical();
+    }
+
+    /* 请求的切换目标必须与就绪表的最高优先级线程一致 */
+    expect = highest_ready();
+    if (expect != rt_current_thread ||
+        (expect != &threads[0] && switch_to != expect) ||
+        (expect == &threads[0] && switch_to != RT_NULL) ||
+        (woken->stat & RT_THREAD_STAT_MASK) != RT_THREAD_READY)
+    {
+        mismatches++;
+    }
+    if (switch_to != RT_NULL)
+        st->switches++;
+
+    rt_sem_detach(&sem);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n rounds] [-w waiters] [-r ready] [-i irq%%] [-s seed]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long rounds = 200000, i;
+    int opt, sc;
+
+    while ((opt = getopt(argc, argv, "n:w:r:i:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': rounds = strtoul(optarg, NULL, 0); break;
+        case 'w': nwaiters = atoi(optarg); break;
+        case 'r': nready = atoi(optarg); break;
+        case 'i': irq_percent = atoi(optarg); break;
+        case 's': rng = (uint32_t)strtoul(optarg, NULL, 0) | 1; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (rounds == 0 || nwaiters < 1 || nready < 0 || 1 + nwaiters + nready > MAX_THREADS)
+        usage(argv[0]);
+
+    for (i = 0; i < rounds; i++)
+    {
+        for (sc = 0; sc < SC_NUM; sc++)
+            run_once(sc);
+    }
+
+#ifdef RT_USING_SEM_HANDOFF
+    printf("handoff build, %d priorities, %lu rounds, irq context %d%%\n",
+           RT_THREAD_PRIORITY_MAX, rounds, irq_percent);
+#else
+    printf("base build, %d priorities, %lu rounds, irq context %d%%\n",
+           RT_THREAD_PRIORITY_MAX, rounds, irq_percent);
+#endif
+    printf("scene     cycles/rel  max    irq/rel ffs/rel switch%%\n");
+    for (sc = 0; sc < SC_NUM; sc++)
+    {
+        struct scene_stat *st = &stats[sc];
+
+        printf("%-8s %9.1f %6llu %8.2f %7.2f %6.1f\n", scene_name[sc],
+               (double)st->cycles / st->count, (unsigned long long)st->cycles_max,
+               (double)st->irq / st->count, (double)st->ffs / st->count,
+               100.0 * st->switches / st->count);
+    }
+#ifdef RT_USING_SEM_HANDOFF
+    {
+        struct rt_sem_stat stat;
+
+        rt_sem_get_stat(&stat);
+        printf("release: post %u, handoff %u, schedule %u\n", stat.post, stat.handoff, stat.schedule);
+    }
+#endif
+    printf("mismatches %lu\n", mismatches);
+
+    return mismatches ? 1 : 0;
+}
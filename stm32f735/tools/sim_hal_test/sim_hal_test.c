@@ -0,0 +1,227 @@
+/*
+ * sim_hal_test.c - 主机仿真外设模型自检
+ *
+ * 在仿真目标上 (sim/) 以固件相同的方式启动 RT-Thread, 由 main 线程检查
+ * 各外设模型对 HAL 调用的行为与真实外设一致, 之后的桥接/控制台测试依赖
+ * 这些模型:
+ *   crc     CRC-32 (IEEE 802.3) 的标准校验值, 以及 Accumulate 分段计算
+ *   aes     FIPS-197 / SP 800-38A 的 AES-128 ECB 向量, 轮询与 DMA 两条路径,
+ *           以及 KeyIVConfigSkip = ONCE 时加解密方向切换需重新装载密钥
+ *   uart    UART7 (none 后端) 的循环 DMA 接收 (含回绕)、直接 DMA 发送和 ORE 后重启
+ * 任何一项失败时退出码非 0.
+ *
+ * 编译 (Linux, 顶层 CMakeLists.txt 中的 sim_hal_test 目标):
+ *   cmake -S . -B build && cmake --build build --target sim_hal_test
+ *
+ * 示例:
+ *   build/sim_hal_test --uart3 stdio
+ */
+
+#include <string.h>
+#include "sim.h"
+#include "uart_port.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(cond))                                            \
+        {                                                       \
+            rt_kprintf("FAIL %s:%d: ", __func__, __LINE__);     \
+            rt_kprintf(__VA_ARGS__);                            \
+            rt_kprintf("\n");                                   \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+/* =================================================================================
+ * 1. CRC
+ * ================================================================================= */
+
+static void test_crc(void)
+{
+    static const char check[] = "123456789";
+    CRC_HandleTypeDef hcrc;
+    uint32_t crc;
+
+    memset(&hcrc, 0, sizeof(hcrc));
+    hcrc.Instance = CRC;
+    hcrc.Init.DefaultPolynomialUse    = DEFAULT_POLYNOMIAL_ENABLE;
+    hcrc.Init.DefaultInitValueUse     = DEFAULT_INIT_VALUE_ENABLE;
+    hcrc.Init.InputDataInversionMode  = CRC_INPUTDATA_INVERSION_BYTE;
+    hcrc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
+    hcrc.InputDataFormat              = CRC_INPUTDATA_FORMAT_BYTES;
+    CHECK(HAL_CRC_Init(&hcrc) == HAL_OK, "HAL_CRC_Init");
+
+    crc = ~HAL_CRC_Calculate(&hcrc, (uint32_t *)check, 9);
+    CHECK(crc == 0xCBF43926UL, "crc32(\"123456789\") = %08x", crc);
+
+    HAL_CRC_Calculate(&hcrc, (uint32_t *)check, 4);
+    crc = ~HAL_CRC_Accumulate(&hcrc, (uint32_t *)(check + 4), 5);
+    CHECK(crc == 0xCBF43926UL, "accumulated crc32 = %08x", crc);
+}
+
+/* =================================================================================
+ * 2. AES
+ * ================================================================================= */
+
+static const uint32_t aes_key[4] = { 0x2B7E1516, 0x28AED2A6, 0xABF71588, 0x09CF4F3C };
+
+static const uint8_t aes_plain[32] =
+{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+};
+
+static const uint8_t aes_cipher[32] =
+{
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+    0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+};
+
+static CRYP_HandleTypeDef hcryp;
+static DMA_HandleTypeDef  hdma_cryp_in;
+static DMA_HandleTypeDef  hdma_cryp_out;
+static struct rt_semaphore cryp_done;
+static volatile int cryp_error;
+
+void HAL_CRYP_OutCpltCallback(CRYP_HandleTypeDef *h)
+{
+    rt_sem_release(&cryp_done);
+}
+
+void HAL_CRYP_ErrorCallback(CRYP_HandleTypeDef *h)
+{
+    cryp_error = 1;
+    rt_sem_release(&cryp_done);
+}
+
+void DMA2_Stream0_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&hdma_cryp_in); rt_interrupt_leave(); }
+void DMA2_Stream1_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&hdma_cryp_out); rt_interrupt_leave(); }
+
+static void test_aes_init(void)
+{
+    hdma_cryp_in.Instance  = DMA2_Stream0;
+    hdma_cryp_out.Instance = DMA2_Stream1;
+    HAL_DMA_Init(&hdma_cryp_in);
+    HAL_DMA_Init(&hdma_cryp_out);
+    __HAL_LINKDMA(&hcryp, hdmain, hdma_cryp_in);
+    __HAL_LINKDMA(&hcryp, hdmaout, hdma_cryp_out);
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    HAL_NVIC_EnableIRQ(DMA2_Stream1_IRQn);
+
+    hcryp.Instance             = CRYP;
+    hcryp.Init.DataType        = CRYP_DATATYPE_8B;
+    hcryp.Init.KeySize         = CRYP_KEYSIZE_128B;
+    hcryp.Init.Algorithm       = CRYP_AES_ECB;
+    hcryp.Init.pKey            = (uint32_t *)aes_key;
+    hcryp.Init.DataWidthUnit   = CRYP_DATAWIDTHUNIT_BYTE;
+    hcryp.Init.KeyIVConfigSkip = CRYP_KEYIVCONFIG_ONCE;
+
+    rt_sem_init(&cryp_done, "cryp", 0, RT_IPC_FLAG_FIFO);
+}
+
+static void test_aes_poll(void)
+{
+    ALIGN(32) static uint8_t out[32];
+    ALIGN(32) static uint8_t back[32];
+
+    CHECK(HAL_CRYP_Init(&hcryp) == HAL_OK, "HAL_CRYP_Init");
+
+    CHECK(HAL_CRYP_Encrypt(&hcryp, (uint32_t *)aes_plain, 32, (uint32_t *)out, 10) == HAL_OK, "encrypt");
+    CHECK(memcmp(out, aes_cipher, 32) == 0, "poll encrypt mismatch");
+
+    /* ONCE: 不复位 KeyIVConfig 直接换方向, 寄存器中仍是加密密钥, 结果应是错的 */
+    HAL_CRYP_Decrypt(&hcryp, (uint32_t *)out, 32, (uint32_t *)back, 10);
+    CHECK(memcmp(back, aes_plain, 32) != 0, "decrypt without key reload unexpectedly correct");
+
+    hcryp.KeyIVConfig = 0;
+    CHECK(HAL_CRYP_Decrypt(&hcryp, (uint32_t *)out, 32, (uint32_t *)back, 10) == HAL_OK, "decrypt");
+    CHECK(memcmp(back, aes_plain, 32) == 0, "poll decrypt mismatch");
+}
+
+static void test_aes_dma(void)
+{
+    ALIGN(32) static uint8_t out[32];
+
+    CHECK(HAL_CRYP_DeInit(&hcryp) == HAL_OK && HAL_CRYP_Init(&hcryp) == HAL_OK, "reinit");
+
+    cryp_error = 0;
+    CHECK(HAL_CRYP_Encrypt_DMA(&hcryp, (uint32_t *)aes_plain, 32, (uint32_t *)out) == HAL_OK, "encrypt dma");
+    CHECK(rt_sem_take(&cryp_done, RT_TICK_PER_SECOND) == RT_EOK, "dma completion timeout");
+    CHECK(!cryp_error && memcmp(out, aes_cipher, 32) == 0, "dma encrypt mismatch");
+    CHECK(hcryp.State == HAL_CRYP_STATE_READY, "state %d after completion", hcryp.State);
+}
+
+/* =================================================================================
+ * 3. UART
+ * ================================================================================= */
+
+static void test_uart(void)
+{
+    struct uart_port *port = uart_port_find("uart7");
+    static const char msg[] = "The quick brown fox jumps over the lazy dog, 0123456789 ABCDEF";
+    ALIGN(32) static char tx[sizeof(msg)];
+    char buf[400];
+    rt_size_t got, n, i;
+    rt_uint32_t restarts;
+
+    CHECK(port != RT_NULL, "uart7 missing");
+    if (port == RT_NULL)
+        return;
+    CHECK(uart_port_open(port, UART_PORT_DMA_RX) == RT_EOK, "open");
+
+    /* 接收: 5 段共 310 字节, 每段以线路空闲结束, 环形缓冲区 (256) 回绕一次 */
+    got = 0;
+    for (n = 0; n < 5; n++)
+    {
+        sim_uart_input("uart7", msg, sizeof(msg) - 1);
+        for (i = 0; i < 100 && got < (n + 1) * (sizeof(msg) - 1); i++)
+        {
+            rt_thread_mdelay(1);
+            got += uart_port_read(port, buf + got, sizeof(buf) - got);
+        }
+    }
+    CHECK(got == 5 * (sizeof(msg) - 1), "received %d bytes", got);
+    for (i = 0; i + sizeof(msg) - 1 <= got; i += sizeof(msg) - 1)
+        CHECK(memcmp(buf + i, msg, sizeof(msg) - 1) == 0, "rx data at %d", i);
+    CHECK(port->rx_events > 0, "no rx events");
+
+    /* 发送: 桥接端口没有发送队列, 从调用者的缓冲区直接 DMA 发送 */
+    memcpy(tx, msg, sizeof(msg));
+    CHECK(uart_port_send(port, tx, sizeof(msg) - 1) == RT_EOK, "send");
+    for (i = 0; i < 100 && sim_uart_tx_busy("uart7"); i++)
+        rt_thread_mdelay(1);
+    n = sim_uart_output("uart7", buf, sizeof(buf));
+    CHECK(n == sizeof(msg) - 1 && memcmp(buf, msg, n) == 0, "tx output %d bytes", n);
+
+    /* ORE: 接收被终止并从缓冲区起点重启, 之后的数据照常到达 */
+    restarts = port->rx_restarts;
+    sim_uart_inject_error("uart7", HAL_UART_ERROR_ORE);
+    rt_thread_mdelay(2);
+    CHECK(port->rx_restarts == restarts + 1 && port->overruns > 0, "restart after ORE");
+
+    sim_uart_input("uart7", msg, 10);
+    got = 0;
+    for (i = 0; i < 100 && got < 10; i++)
+    {
+        rt_thread_mdelay(2);
+        got += uart_port_read(port, buf + got, sizeof(buf) - got);
+    }
+    CHECK(got == 10 && memcmp(buf, msg, 10) == 0, "rx after restart: %d bytes", got);
+}
+
+int app_main(void)
+{
+    test_crc();
+    test_aes_init();
+    test_aes_poll();
+    test_aes_dma();
+    test_uart();
+
+    rt_kprintf("sim_hal_test: %s (%d failures)\n", failures ? "FAIL" : "PASS", failures);
+    sim_exit(failures ? 1 : 0);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * tickless_test.c - 无节拍空闲 (tickless.c) 主机测试
+ *
+ * 在仿真目标上 (sim/) 运行 tickless.c 本身: SysTick 的 VAL/停止/重新使能与
+ * LPTIM1 (LSI 计数、比较匹配唤醒 WFI) 都由 sim/ 按主机时钟建模. main 线程以
+ * rt_thread_delay_until 每 50 tick 醒来一次, 分两段:
+ *   quiet   其间没有其他中断, 每个周期基本整段睡眠
+ *   irq     另有 7.3 ms 周期的 hrtimer (线程回调) 不断提前唤醒, 检查余数结转
+ * 每段检查:
+ *   - 截止 tick 按 inc_tick 推进; 每次醒来时 rt_tick 既不超前于主机时间, 也不
+ *     落后于仿真时间 (主机时间扣除 CPU 线程被主机挂起的时间与 SysTick 因此合并
+ *     的周期), 结果与主机负载无关
+ *   - 睡眠确实发生 (补上的 tick 占大部分), irq 段有提前唤醒
+ *   - lat_now() 时间戳跨过睡眠时与仿真 CPU 的真实周期数一致 (DWT 在 WFI 中
+ *     停止, 差额由 LPTIM 补上)
+ * 任何一项失败时退出码非 0.
+ *
+ * 编译 (Linux, 顶层 CMakeLists.txt 中的 tickless_test 目标):
+ *   cmake -S . -B build && cmake --build build --target tickless_test
+ *
+ * 示例:
+ *   build/tickless_test --uart3 stdio
+ */
+
+#include "sim.h"
+#include "tickless.h"
+#include "lat_hist.h"
+#include "hrtimer.h"
+#include <cpuport.h>
+
+#define TEST_PERIOD             50      /* tick */
+#define TEST_PERIODS            40
+#define TEST_IRQ_US             7300    /* 与 tick 不成整数倍 */
+/*
+ * rt_tick 相对仿真时间的偏差: 起止各在 tick 中的位置不同 (1 ms), 睡眠后的余数
+ * (1 tick 以内) 与每次睡眠的 LPTIM 计数取整 (31 us, 正负抵消为主) 之和.
+ * 余数不结转时每次提前唤醒平均丢半个 tick, irq 段累计 100 ms 以上.
+ */
+#define TEST_EARLY_US           1500
+#define TEST_LATE_US            3000
+
+static int failures;
+
+#define CHECK(cond, ...)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(cond))                                            \
+        {                                                       \
+            rt_kprintf("FAIL %s:%d: ", __func__, __LINE__);     \
+            rt_kprintf(__VA_ARGS__);                            \
+            rt_kprintf("\n");                                   \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+static struct rt_hrtimer irq_timer;
+static volatile rt_uint32_t irq_count;
+
+static void test_irq_timeout(void *parameter)
+{
+    irq_count++;
+}
+
+/*
+ * 时间快照. 主机负载下仿真会整个停顿: CPU 线程等在运行队列上 (stall_ns), 或
+ * 事件线程迟到而 SysTick 合并; tick 加上 SysTick 已计到零而没进 rt_tick 的
+ * 次数, 偏差只反映 tickless.c 的补 tick.
+ */
+struct test_time
+{
+    uint64_t    host_ns;
+    uint64_t    stall_ns;
+    rt_tick_t   tick;
+};
+
+static void test_time_get(struct test_time *t)
+{
+    rt_base_t level;
+    uint64_t stall;
+
+    /* 取值之间被主机挂起则重取: 否则主机时间与 SysTick 计数不是同一时刻 */
+    level = sim_lock();
+    do
+    {
+        stall       = sim_cpu_stall_ns();
+        t->host_ns  = sim_now_ns();
+        t->tick     = rt_tick_get() + sim_systick_behind();
+        t->stall_ns = sim_cpu_stall_ns();
+    } while (t->stall_ns != stall);
+    sim_unlock(level);
+}
+
+/* rt_tick 落后于时间的 us 数, 负数为超前 (stall 为真时扣除主机停顿) */
+static int32_t test_time_lag(const struct test_time *t0, const struct test_time *t, int stall)
+{
+    int64_t ns = (int64_t)(t->host_ns - t0->host_ns) - (int64_t)(t->tick - t0->tick) * (1000000000 / RT_TICK_PER_SECOND);
+
+    if (stall)
+        ns -= (int64_t)(t->stall_ns - t0->stall_ns);
+
+    return (int32_t)(ns / 1000);
+}
+
+/* 以 rt_thread_delay_until 跑 TEST_PERIODS 个周期并检查 */
+static void test_periods(const char *name, struct tickless_stat *before, struct tickless_stat *after)
+{
+    struct test_time start, now;
+    rt_tick_t t0, t;
+    rt_uint32_t lat0, cyc0, lat, cyc, k;
+    int32_t early_max = 0, late_max = 0;
+
+    rt_thread_mdelay(TEST_PERIOD);
+    t0 = t = rt_tick_get();
+    test_time_get(&start);
+    lat0 = lat_now();
+    cyc0 = rt_hw_posix_cycles();
+    tickless_get_stat(before);
+
+    for (k = 1; k <= TEST_PERIODS; k++)
+    {
+        rt_thread_delay_until(&t, TEST_PERIOD);
+        CHECK(t == t0 + k * TEST_PERIOD, "%s: period %d: tick %d, expected %d", name, k, t - t0, k * TEST_PERIOD);
+
+        /* 超前按主机时间算 (停顿只会让 rt_tick 落后), 落后按扣除停顿的仿真时间算 */
+        test_time_get(&now);
+        if (-test_time_lag(&start, &now, 0) > early_max)
+            early_max = -test_time_lag(&start, &now, 0);
+        if (test_time_lag(&start, &now, 1) > late_max)
+            late_max = test_time_lag(&start, &now, 1);
+    }
+
+    lat = lat_now() - lat0;
+    cyc = rt_hw_posix_cycles() - cyc0;
+    tickless_get_stat(after);
+
+    CHECK(early_max <= TEST_EARLY_US, "%s: rt_tick %d us ahead of time", name, early_max);
+    CHECK(late_max <= TEST_LATE_US, "%s: rt_tick %d us behind time", name, late_max);
+    CHECK(lat / 100 * 99 <= cyc && cyc <= lat / 100 * 101, "%s: lat_now %u cycles, cpu %u cycles", name, lat, cyc);
+}
+
+int app_main(void)
+{
+    struct tickless_stat before, after;
+    rt_uint32_t ticks = TEST_PERIODS * TEST_PERIOD;
+
+    lat_cycle_init();
+    CHECK(tickless_init() == RT_EOK, "tickless_init");
+    CHECK(hrtimer_tim_init() == RT_EOK, "hrtimer_tim_init");
+
+    test_periods("quiet", &before, &after);
+    CHECK(after.slept_ticks - before.slept_ticks >= ticks * 9 / 10, "quiet: %d of %d ticks slept",
+          after.slept_ticks - before.slept_ticks, ticks);
+
+    rt_hrtimer_init(&irq_timer, test_irq_timeout, RT_NULL, TEST_IRQ_US,
+                    RT_HRTIMER_FLAG_PERIODIC | RT_HRTIMER_FLAG_SOFT_TIMER);
+    rt_hrtimer_start(&irq_timer);
+    test_periods("irq", &before, &after);
+    rt_hrtimer_stop(&irq_timer);
+    CHECK(irq_count >= ticks * 1000 / RT_TICK_PER_SECOND * 9 / 10 / (TEST_IRQ_US / 1000), "irq: %d timer callbacks",
+          irq_count);
+    CHECK(after.early - before.early >= irq_count / 2, "irq: %d early wakeups for %d interrupts",
+          after.early - before.early, irq_count);
+    CHECK(after.slept_ticks - before.slept_ticks >= ticks / 2, "irq: %d of %d ticks slept",
+          after.slept_ticks - before.slept_ticks, ticks);
+
+    rt_kprintf("tickless_test: %s (%d failures)\n", failures ? "FAIL" : "PASS", failures);
+    sim_exit(failures ? 1 : 0);
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * timer_bench.c - 内核定时器主机侧基准
+ *
+ * 直接编译 RT-Thread/src/timer.c, 用打桩的 rt_hw_interrupt_disable/enable
+ * 测量每个关中断区间的长度 (最外层 disable 到 enable), 按操作分类统计:
+ *
+ *   start  线程上下文启动定时器 (随机改期)
+ *   stop   线程上下文停止定时器
+ *   check  rt_timer_check (SysTick 中断), 包括到期回调和回调中的重新启动
+ *   ctrl   rt_timer_control 改超时 (与实现无关, 作对照)
+ *   resume 全部停止后空闲 -g tick 不调用 rt_timer_check (如 tickless 睡眠),
+ *          再启动一个定时器后的第一次 rt_timer_check; 时间轮应直接跳到当前
+ *          tick, 而不是逐 tick 追赶
+ *
+ * 负载: -n 个单次定时器, 超时 70% 在 1~1000 tick, 25% 在 1000~60000 tick,
+ * 5% 在 60000~2^22 tick; 到期回调以新的随机超时重新启动; 每个 tick 另外
+ * 随机停止/启动 -c 个定时器. 回调检查到期 tick 是否准确, 有早到/迟到/丢失
+ * 时退出码非零, 兼作时间轮的正确性测试.
+ *
+ * 编译 (Linux, 在本目录下):
+ *   跳表 (默认 1 层):
+ *     gcc -O2 -I. -I../../RT-Thread/include -o timer_bench_list timer_bench.c
+ *   跳表 3 层:
+ *     gcc -O2 -I. -I../../RT-Thread/include -DRT_TIMER_SKIP_LIST_LEVEL=3 -o timer_bench_skip3 timer_bench.c
+ *   时间轮:
+ *     gcc -O2 -I. -I../../RT-Thread/include -DRT_USING_TIMER_WHEEL -o timer_bench_wheel timer_bench.c
+ *
+ * 示例:
+ *   timer_bench_list -n 10000 -t 20000
+ *   timer_bench_wheel -n 10000 -t 200000 -c 20 -s 7
+ *
+ * 时间为主机纳秒, 只用于比较同一台机器上不同实现的相对开销.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../RT-Thread/src/timer.c"
+
+/* =================================================================================
+ * 1. 内核桩
+ * ================================================================================= */
+
+enum { OP_START, OP_STOP, OP_CHECK, OP_CTRL, OP_RESUME, OP_NUM };
+
+#define HIST_NS             32              /* 直方图分辨率 */
+#define HIST_BUCKETS        65536
+
+struct op_stat
+{
+    const char *name;
+    uint64_t    count;
+    uint64_t    total_ns;
+    uint64_t    max_ns;
+    uint32_t    hist[HIST_BUCKETS];
+};
+
+static struct op_stat stats[OP_NUM] = { { "start" }, { "stop" }, { "check" }, { "ctrl" }, { "resume" } };
+static int      cur_op = OP_START;
+static int      irq_nest;
+static uint64_t irq_t0;
+static rt_tick_t sim_tick;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    if (irq_nest++ == 0)
+        irq_t0 = now_ns();
+    return irq_nest - 1;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    struct op_stat *st = &stats[cur_op];
+    uint64_t dt;
+
+    irq_nest = (int)level;
+    if (irq_nest != 0)
+        return;
+
+    dt = now_ns() - irq_t0;
+    st->count++;
+    st->total_ns += dt;
+    if (dt > st->max_ns)
+        st->max_ns = dt;
+    st->hist[dt / HIST_NS < HIST_BUCKETS ? dt / HIST_NS : HIST_BUCKETS - 1]++;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return sim_tick;
+}
+
+void rt_object_init(struct rt_object *object, enum rt_object_class_type type, const char *name)
+{
+    memset(object, 0, sizeof(*object));
+    object->type = type | RT_Object_Class_Static;
+    strncpy(object->name, name, RT_NAME_MAX - 1);
+}
+
+void rt_object_detach(rt_object_t object)
+{
+    object->type = 0;
+}
+
+rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
+{
+    return RT_NULL;
+}
+
+void rt_object_delete(rt_object_t object)
+{
+}
+
+rt_uint8_t rt_object_get_type(rt_object_t object)
+{
+    return object->type & ~RT_Object_Class_Static;
+}
+
+rt_bool_t rt_object_is_systemobject(rt_object_t object)
+{
+    return (object->type & RT_Object_Class_Static) ? RT_TRUE : RT_FALSE;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "assert %s failed at %s:%d\n", ex, func, (int)line);
+    abort();
+}
+
+/* =================================================================================
+ * 2. 负载
+ * ================================================================================= */
+
+struct bench_timer
+{
+    struct rt_timer timer;
+    rt_tick_t       due;                    /* 期望的到期 tick */
+};
+
+static struct bench_timer *timers;
+static uint64_t fired, early, late;
+
+static rt_tick_t random_timeout(void)
+{
+    int r = rand() % 100;
+
+    if (r < 70)
+        return 1 + rand() % 1000;
+    if (r < 95)
+        return 1000 + rand() % 59000;
+    return 60000 + rand() % ((1 << 22) - 60000);
+}
+
+static void bench_arm(struct bench_timer *bt)
+{
+    rt_tick_t timeout = random_timeout();
+    int op = cur_op;
+
+    cur_op = OP_CTRL;
+    rt_timer_control(&bt->timer, RT_TIMER_CTRL_SET_TIME, &timeout);
+    cur_op = op;
+    bt->due = sim_tick + timeout;
+    rt_timer_start(&bt->timer);
+}
+
+static void bench_timeout(void *parameter)
+{
+    struct bench_timer *bt = parameter;
+
+    fired++;
+    if ((rt_int32_t)(sim_tick - bt->due) < 0)
+        early++;
+    else if (sim_tick != bt->due)
+        late++;
+    bench_arm(bt);
+}
+
+static uint64_t percentile(const struct op_stat *st, double p)
+{
+    uint64_t want = (uint64_t)(st->count * p), seen = 0;
+    int i;
+
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += st->hist[i];
+        if (seen > want)
+            return (uint64_t)(i + 1) * HIST_NS;
+    }
+    return st->max_ns;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n timers] [-t ticks] [-c churn/tick] [-s seed] [-g idle ticks]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int ntimers = 10000, ticks = 20000, churn = 10, seed = 1, idle = 1 << 20;
+    uint64_t lost = 0, stale = 0, f0, t0;
+    int opt, i, k;
+
+    while ((opt = getopt(argc, argv, "n:t:c:s:g:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': ntimers = atoi(optarg); break;
+        case 't': ticks = atoi(optarg); break;
+        case 'c': churn = atoi(optarg); break;
+        case 's': seed = atoi(optarg); break;
+        case 'g': idle = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (ntimers <= 0 || ticks <= 0 || churn < 0 || idle < 0 || (rt_tick_t)idle >= RT_TICK_MAX / 2)
+        usage(argv[0]);
+
+    srand(seed);
+    /* 从接近回绕处开始, 覆盖 tick 计数回绕 */
+    sim_tick = 0u - (rt_tick_t)ticks / 2;
+    rt_system_timer_init();
+
+    timers = calloc(ntimers, sizeof(*timers));
+    if (timers == NULL)
+        return 1;
+
+    cur_op = OP_START;
+    for (i = 0; i < ntimers; i++)
+    {
+        rt_timer_init(&timers[i].timer, "bench", bench_timeout, &timers[i], 1, RT_TIMER_FLAG_ONE_SHOT);
+        bench_arm(&timers[i]);
+    }
+    /* 不计初始装填 */
+    for (i = 0; i < OP_NUM; i++)
+    {
+        memset(stats[i].hist, 0, sizeof(stats[i].hist));
+        stats[i].count = stats[i].total_ns = stats[i].max_ns = 0;
+    }
+
+    t0 = now_ns();
+    for (k = 0; k < ticks; k++)
+    {
+        sim_tick++;
+        cur_op = OP_CHECK;
+        rt_timer_check();
+
+        for (i = 0; i < churn; i++)
+        {
+            struct bench_timer *bt = &timers[rand() % ntimers];
+
+            cur_op = OP_STOP;
+            rt_timer_stop(&bt->timer);
+            cur_op = OP_START;
+            bench_arm(bt);
+        }
+    }
+    t0 = now_ns() - t0;
+
+    /* 所有定时器都应处于激活状态且未过期 */
+    for (i = 0; i < ntimers; i++)
+    {
+        if (!(timers[i].timer.parent.flag & RT_TIMER_FLAG_ACTIVATED) ||
+            (rt_tick_t)(timers[i].due - sim_tick - 1) >= RT_TICK_MAX / 2)
+            lost++;
+    }
+
+    /* 空闲后恢复: 全部停止, 跳过 idle 个 tick, 启动一个定时器并逐 tick 检查到它到期 */
+    for (i = 0; i < ntimers; i++)
+    {
+        cur_op = OP_STOP;
+        rt_timer_stop(&timers[i].timer);
+    }
+    sim_tick += idle;
+    cur_op = OP_START;
+    bench_arm(&timers[0]);
+#ifdef RT_USING_TIMER_WHEEL
+    if (rt_timer_wheel.tick != sim_tick)
+        stale++;
+#endif
+    f0 = fired;
+    cur_op = OP_RESUME;
+    rt_timer_check();
+    for (k = 0; fired == f0 && k <= (1 << 22); k++)
+    {
+        sim_tick++;
+        cur_op = OP_CHECK;
+        rt_timer_check();
+    }
+    if (fired == f0)
+        lost++;
+
+#ifdef RT_USING_TIMER_WHEEL
+    printf("timer wheel, %d levels x %d slots\n", RT_TIMER_WHEEL_LEVELS, 1 << RT_TIMER_WHEEL_BITS);
+#else
+    printf("timer list, %d skip list level(s)\n", RT_TIMER_SKIP_LIST_LEVEL);
+#endif
+    printf("%d timers, %d ticks, %d churn/tick, %.2f s\n", ntimers, ticks, churn, t0 / 1e9);
+    printf("%-6s %10s %10s %10s %10s %10s %10s\n", "op", "windows", "mean ns", "p99 ns", "p99.9 ns", "max ns",
+           "total ms");
+    for (i = 0; i < OP_NUM; i++)
+    {
+        struct op_stat *st = &stats[i];
+
+        printf("%-6s %10llu %10llu %10llu %10llu %10llu %10.1f\n", st->name, (unsigned long long)st->count,
+               (unsigned long long)(st->count ? st->total_ns / st->count : 0),
+               (unsigned long long)percentile(st, 0.99), (unsigned long long)percentile(st, 0.999),
+               (unsigned long long)st->max_ns, st->total_ns / 1e6);
+    }
+    printf("fired %llu, early %llu, late %llu, lost %llu, stale after idle %llu\n", (unsigned long long)fired,
+           (unsigned long long)early, (unsigned long long)late, (unsigned long long)lost,
+           (unsigned long long)stale);
+
+    return (early || late || lost || stale) ? 1 : 0;
+}
@@ -0,0 +1,456 @@
+/*
+ * trace_json.c - 调度跟踪 (trace.c) 导出转换工具
+ *
+ * 读取控制台上 trace dump 的输出 (可以是整段控制台日志, 只取 "# trace"
+ * 到 "# end" 之间的行), 生成 Chrome trace JSON, 用 chrome://tracing 或
+ * https://ui.perfetto.dev 打开:
+ *
+ *   每个线程一条轨道: 运行段 (线程名), 阻塞段 ("blocked: <IPC 对象>" 或
+ *   "suspended", 从挂起到被唤醒), 就绪等待段 ("ready" 被唤醒后等待调度,
+ *   "preempted" 被高优先级线程抢占); 唤醒与 IPC put 为瞬时事件, 参数中
+ *   注明唤醒者.
+ *   中断一条轨道: 每次 rt_interrupt_enter/leave 之间为一段, 按异常号命名.
+ *
+ * 周期计数按相邻事件差值展开, 要求相邻事件间隔小于一圈 (550 MHz 下约
+ * 7.8 s); 打开 irq 记录时 SysTick 保证了这一点.
+ *
+ * 导出不完整时仍输出已解析的部分, 但退出码非 0: 没有 "# end" 行、结尾行
+ * 报告控制台丢弃了输出, 或事件行数与帧头中的事件数不符.
+ *
+ * 编译 (Linux):
+ *   gcc -O2 -o trace_json trace_json.c
+ *
+ * 示例:
+ *   trace_json console.log > trace.json
+ *   trace_json -f 400000000 < dump.txt > trace.json
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* 与 trace.h 保持一致 */
+enum
+{
+    TRACE_SWITCH = 1,
+    TRACE_SUSPEND,
+    TRACE_READY,
+    TRACE_IRQ_ENTER,
+    TRACE_IRQ_LEAVE,
+    TRACE_TRYTAKE,
+    TRACE_TAKE,
+    TRACE_PUT,
+};
+
+#define TRACE_FLAG_ISR      0x01
+
+#define OBJ_MAX             256
+#define IRQ_NEST_MAX        16
+#define TID_IRQ             1
+#define TID_THREAD_BASE     10
+
+enum thread_state
+{
+    STATE_UNKNOWN = 0,
+    STATE_RUNNING,
+    STATE_BLOCKED,                      /* 已挂起, 等待唤醒 */
+    STATE_READY,                        /* 已唤醒, 等待调度 */
+    STATE_PREEMPTED,                    /* 未挂起即被切出 */
+};
+
+struct obj
+{
+    uint32_t    addr;
+    char        cls[16];
+    char        name[64];
+    int         tid;                    /* 线程的轨道号, 其他对象为 0 */
+
+    /* 线程状态 */
+    int         state;
+    int         suspended;
+    double      since;                  /* 当前状态的起点 (us) */
+    uint32_t    waiting;                /* 最近一次 trytake 且尚未 take 的对象 */
+    uint32_t    block_obj;              /* 挂起时正在等待的对象 */
+};
+
+static struct obj objs[OBJ_MAX];
+static int nobjs, nthreads;
+static double cpu_hz;
+static int first_event = 1;
+
+static struct
+{
+    int     exc;
+    double  start;
+} irq_stack[IRQ_NEST_MAX];
+static int irq_depth;
+
+/* =================================================================================
+ * 1. 对象表
+ * ================================================================================= */
+
+static struct obj *obj_find(uint32_t addr, int create_thread)
+{
+    int i;
+
+    if (addr == 0)
+        return NULL;
+    for (i = 0; i < nobjs; i++)
+    {
+        if (objs[i].addr == addr)
+            return &objs[i];
+    }
+    if (!create_thread || nobjs == OBJ_MAX)
+        return NULL;
+
+    /* dump 时已删除的线程, 用地址作名字 */
+    objs[nobjs].addr = addr;
+    strcpy(objs[nobjs].cls, "thread");
+    snprintf(objs[nobjs].name, sizeof(objs[nobjs].name), "0x%08x", addr);
+    objs[nobjs].tid = TID_THREAD_BASE + nthreads++;
+    printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+           objs[nobjs].tid, objs[nobjs].name);
+    return &objs[nobjs++];
+}
+
+static const char *obj_name(uint32_t addr, char *buf, size_t size)
+{
+    struct obj *o = obj_find(addr, 0);
+
+    if (o != NULL)
+        snprintf(buf, size, "%s %s", o->cls, o->name);
+    else
+        snprintf(buf, size, "0x%08x", addr);
+    return buf;
+}
+
+static const char *irq_name(int exc, char *buf, size_t size)
+{
+    switch (exc)
+    {
+    case 14: return "PendSV";
+    case 15: return "SysTick";
+    default:
+        snprintf(buf, size, "IRQ %d", exc - 16);
+        return buf;
+    }
+}
+
+/* 事件的上下文: 中断中为中断名, 否则为当前线程名 */
+static const char *ctx_name(int flags, int exc, uint32_t thread, char *buf, size_t size)
+{
+    struct obj *o;
+
+    if ((flags & TRACE_FLAG_ISR) || exc != 0)
+        return irq_name(exc, buf, size);
+    o = obj_find(thread, 0);
+    if (o != NULL)
+        return o->name;
+    snprintf(buf, size, "0x%08x", thread);
+    return buf;
+}
+
+/* =================================================================================
+ * 2. 输出
+ * ================================================================================= */
+
+static void emit_slice(int tid, const char *name, const char *cat, double start, double end, const char *arg)
+{
+    if (end < start)
+        return;
+    printf(",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+           name, cat, tid, start, end - start);
+    if (arg != NULL)
+        printf(",\"args\":{\"by\":\"%s\"}", arg);
+    putchar('}');
+}
+
+static void emit_instant(int tid, const char *name, double ts, const char *by)
+{
+    printf(",\n{\"name\":\"%s\",\"cat\":\"ipc\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+           "\"args\":{\"by\":\"%s\"}}", name, tid, ts, by);
+}
+
+/* 结束线程当前的非运行段 */
+static void thread_close_wait(struct obj *t, double now)
+{
+    char buf[80], name[96];
+
+    switch (t->state)
+    {
+    case STATE_BLOCKED:
+        if (t->block_obj)
+        {
+            snprintf(name, sizeof(name), "blocked: %s", obj_name(t->block_obj, buf, sizeof(buf)));
+            emit_slice(t->tid, name, "wait", t->since, now, NULL);
+        }
+        else
+        {
+            emit_slice(t->tid, "suspended", "wait", t->since, now, NULL);
+        }
+        break;
+    case STATE_READY:
+        emit_slice(t->tid, "ready", "sched", t->since, now, NULL);
+        break;
+    case STATE_PREEMPTED:
+        emit_slice(t->tid, "preempted", "sched", t->since, now, NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+/* =================================================================================
+ * 3. 事件
+ * ================================================================================= */
+
+static void trace_event(double now, int type, int flags, int exc, uint32_t obj, uint32_t thread)
+{
+    struct obj *t;
+    const char *by;
+    char buf[80], name[96];
+
+    switch (type)
+    {
+    case TRACE_SWITCH:
+        t = obj_find(thread, 1);
+        if (t != NULL && t->state == STATE_RUNNING)
+        {
+            emit_slice(t->tid, t->name, "run", t->since, now, NULL);
+            if (t->suspended)
+            {
+                t->state = STATE_BLOCKED;
+                t->block_obj = t->waiting;
+            }
+            else
+            {
+                t->state = STATE_PREEMPTED;
+            }
+            t->since = now;
+        }
+
+        t = obj_find(obj, 1);
+        if (t != NULL)
+        {
+            thread_close_wait(t, now);
+            t->state = STATE_RUNNING;
+            t->suspended = 0;
+            t->since = now;
+        }
+        break;
+
+    case TRACE_SUSPEND:
+        t = obj_find(obj, 1);
+        if (t != NULL)
+            t->suspended = 1;
+        break;
+
+    case TRACE_READY:
+        t = obj_find(obj, 1);
+        if (t == NULL)
+            break;
+        by = ctx_name(flags, exc, thread, buf, sizeof(buf));
+        if (t->state == STATE_BLOCKED)
+        {
+            thread_close_wait(t, now);
+            t->state = STATE_READY;
+            t->since = now;
+        }
+        t->suspended = 0;
+        emit_instant(t->tid, "wakeup", now, by);
+        break;
+
+    case TRACE_IRQ_ENTER:
+        if (irq_depth < IRQ_NEST_MAX)
+        {
+            irq_stack[irq_depth].exc = exc;
+            irq_stack[irq_depth].start = now;
+        }
+        irq_depth++;
+        break;
+
+    case TRACE_IRQ_LEAVE:
+        /* 记录开始时已在中断中, 没有对应的 enter */
+        if (irq_depth == 0)
+            break;
+        irq_depth--;
+        if (irq_depth < IRQ_NEST_MAX)
+            emit_slice(TID_IRQ, irq_name(irq_stack[irq_depth].exc, buf, sizeof(buf)), "irq",
+                       irq_stack[irq_depth].start, now, NULL);
+        break;
+
+    case TRACE_TRYTAKE:
+    case TRACE_TAKE:
+        if ((flags & TRACE_FLAG_ISR) || exc != 0)
+            break;
+        t = obj_find(thread, 1);
+        if (t != NULL)
+            t->waiting = (type == TRACE_TRYTAKE) ? obj : 0;
+        break;
+
+    case TRACE_PUT:
+        t = obj_find(thread, 1);
+        snprintf(name, sizeof(name), "put %s", obj_name(obj, buf, sizeof(buf)));
+        by = ctx_name(flags, exc, thread, buf, sizeof(buf));
+        if ((flags & TRACE_FLAG_ISR) || exc != 0)
+            emit_instant(TID_IRQ, name, now, by);
+        else if (t != NULL)
+            emit_instant(t->tid, name, now, by);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* =================================================================================
+ * 4. 解析
+ * ================================================================================= */
+
+static int trace_parse(FILE *in)
+{
+    char line[256], cls[16], name[64];
+    unsigned int version, hz, count, lost, addr, stamp, type, flags, exc, obj, thread, dropped = 0;
+    unsigned int events = 0;
+    uint32_t last = 0;
+    double cycles = 0, end = 0;
+    int started = 0, ended = 0, i;
+    struct obj *t;
+
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        if (!started)
+        {
+            if (sscanf(line, "# trace %u %u %u %u", &version, &hz, &count, &lost) == 4)
+            {
+                if (version != 1)
+                {
+                    fprintf(stderr, "unsupported trace version %u\n", version);
+                    return -1;
+                }
+                if (cpu_hz == 0)
+                    cpu_hz = hz ? hz : 550e6;
+                started = 1;
+                fprintf(stderr, "trace: %u events, %u overwritten, %.0f Hz\n", count, lost, cpu_hz);
+                printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                       "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"stm32h735\"}},\n"
+                       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"interrupts\"}}",
+                       TID_IRQ);
+            }
+            continue;
+        }
+
+        if (strncmp(line, "# end", 5) == 0)
+        {
+            sscanf(line, "# end %u", &dropped);
+            ended = 1;
+            break;
+        }
+
+        if (sscanf(line, "N %x %15s %63s", &addr, cls, name) == 3 && nobjs < OBJ_MAX)
+        {
+            objs[nobjs].addr = addr;
+            snprintf(objs[nobjs].cls, sizeof(objs[nobjs].cls), "%s", cls);
+            snprintf(objs[nobjs].name, sizeof(objs[nobjs].name), "%s", name);
+            if (strcmp(cls, "thread") == 0)
+            {
+                objs[nobjs].tid = TID_THREAD_BASE + nthreads++;
+                printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                       objs[nobjs].tid, name);
+            }
+            nobjs++;
+        }
+        else if (sscanf(line, "E %x %u %u %u %x %x", &stamp, &type, &flags, &exc, &obj, &thread) == 6)
+        {
+            /* 相邻事件差值展开为连续的周期数 */
+            if (!first_event)
+                cycles += (uint32_t)(stamp - last);
+            first_event = 0;
+            last = stamp;
+            events++;
+            end = cycles * 1e6 / cpu_hz;
+            trace_event(end, type, flags, exc, obj, thread);
+        }
+    }
+
+    if (!started)
+    {
+        fprintf(stderr, "no \"# trace\" header in input\n");
+        return -1;
+    }
+
+    /* 收尾: 关闭仍在进行的段 */
+    for (i = 0; i < nobjs; i++)
+    {
+        t = &objs[i];
+        if (t->tid == 0)
+            continue;
+        if (t->state == STATE_RUNNING)
+            emit_slice(t->tid, t->name, "run", t->since, end, NULL);
+        else
+            thread_close_wait(t, end);
+    }
+    printf("\n]}\n");
+
+    if (!ended)
+    {
+        fprintf(stderr, "truncated dump: no \"# end\" line\n");
+        return -1;
+    }
+    if (dropped > 0)
+    {
+        fprintf(stderr, "incomplete dump: console dropped %u line(s)\n", dropped);
+        return -1;
+    }
+    if (events != count)
+    {
+        fprintf(stderr, "incomplete dump: %u of %u events\n", events, count);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-f HZ] [FILE]\n"
+            "  FILE       console capture containing a trace dump (default stdin)\n"
+            "  -f HZ      CPU clock for cycle stamps (default: from the dump header)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    int opt, ret;
+
+    while ((opt = getopt(argc, argv, "f:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': cpu_hz = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind < argc)
+    {
+        in = fopen(argv[optind], "r");
+        if (in == NULL)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    ret = trace_parse(in);
+    if (in != stdin)
+        fclose(in);
+
+    return ret < 0 ? 1 : 0;
+}
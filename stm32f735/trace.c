@@ -0,0 +1,257 @@
+/*
+ * trace.c - 调度跟踪记录器
+ *
+ * 挂在内核钩子上, 每个事件在关中断下写入 16 字节 (周期时间戳、类型、
+ * 异常号、对象、当前线程), 缓冲区满后循环覆盖. trace dump 以文本
+ * 输出对象名表和事件, 主机端 tools/trace_json 转换为 Chrome trace JSON
+ * (chrome://tracing 或 ui.perfetto.dev 打开), 可以看到每个线程的运行段、
+ * 从挂起到就绪 (阻塞在哪个 IPC 对象上)、从就绪到运行 (被谁抢占) 的时间.
+ *
+ * 时间戳为 DWT 周期数, dump 时按当前 SystemCoreClock 换算; 记录期间
+ * 切换时钟档位会使换算失准.
+ *
+ * dump 约有 TRACE_EVENTS 行 (数十 KB), 远大于控制台发送队列, 逐行等待
+ * 队列空间后再输出, 与控制台策略无关; 结尾行带上期间控制台丢弃的条数,
+ * trace_json 据此拒绝不完整的导出.
+ */
+
+#include "trace.h"
+#include "lat_hist.h"
+#include "console.h"
+#include <rthw.h>
+
+#ifdef RT_USING_HOOK
+
+static struct
+{
+    struct trace_event   buf[TRACE_EVENTS];
+    volatile rt_uint32_t head;          /* 已写入的事件总数 */
+    volatile rt_uint32_t mask;          /* 正在记录的分类, 0 表示停止 */
+    rt_uint8_t           once;
+} recorder;
+
+/* =================================================================================
+ * 1. 记录
+ * ================================================================================= */
+
+static void trace_record(rt_uint32_t cls, rt_uint8_t type, void *obj, rt_thread_t thread)
+{
+    struct trace_event *ev;
+    rt_uint32_t head;
+    rt_base_t level;
+
+    if (!(recorder.mask & cls))
+        return;
+
+    level = rt_hw_interrupt_disable();
+    head = recorder.head;
+    if (recorder.once && head >= TRACE_EVENTS)
+    {
+        recorder.mask = 0;
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    ev = &recorder.buf[head & (TRACE_EVENTS - 1)];
+    ev->stamp  = lat_now();
+    ev->type   = type;
+    ev->flags  = rt_interrupt_get_nest() ? TRACE_FLAG_ISR : 0;
+    ev->irq    = __get_IPSR();
+    ev->obj    = obj;
+    ev->thread = thread;
+    recorder.head = head + 1;
+    rt_hw_interrupt_enable(level);
+}
+
+static void trace_switch_hook(rt_thread_t from, rt_thread_t to)
+{
+    trace_record(TRACE_CLASS_SCHED, TRACE_SWITCH, to, from);
+}
+
+static void trace_suspend_hook(rt_thread_t thread)
+{
+    trace_record(TRACE_CLASS_SCHED, TRACE_SUSPEND, thread, rt_thread_self());
+}
+
+static void trace_resume_hook(rt_thread_t thread)
+{
+    trace_record(TRACE_CLASS_SCHED, TRACE_READY, thread, rt_thread_self());
+}
+
+static void trace_irq_enter_hook(void)
+{
+    trace_record(TRACE_CLASS_IRQ, TRACE_IRQ_ENTER, RT_NULL, rt_thread_self());
+}
+
+static void trace_irq_leave_hook(void)
+{
+    trace_record(TRACE_CLASS_IRQ, TRACE_IRQ_LEAVE, RT_NULL, rt_thread_self());
+}
+
+static void trace_trytake_hook(struct rt_object *object)
+{
+    trace_record(TRACE_CLASS_IPC, TRACE_TRYTAKE, object, rt_thread_self());
+}
+
+static void trace_take_hook(struct rt_object *object)
+{
+    trace_record(TRACE_CLASS_IPC, TRACE_TAKE, object, rt_thread_self());
+}
+
+static void trace_put_hook(struct rt_object *object)
+{
+    trace_record(TRACE_CLASS_IPC, TRACE_PUT, object, rt_thread_self());
+}
+
+/* =================================================================================
+ * 2. 控制
+ * ================================================================================= */
+
+rt_err_t trace_init(void)
+{
+    rt_scheduler_sethook(trace_switch_hook);
+    rt_thread_suspend_sethook(trace_suspend_hook);
+    rt_thread_resume_sethook(trace_resume_hook);
+    rt_interrupt_enter_sethook(trace_irq_enter_hook);
+    rt_interrupt_leave_sethook(trace_irq_leave_hook);
+    rt_object_trytake_sethook(trace_trytake_hook);
+    rt_object_take_sethook(trace_take_hook);
+    rt_object_put_sethook(trace_put_hook);
+
+    return RT_EOK;
+}
+
+void trace_start(rt_uint32_t mask, rt_bool_t once)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    recorder.head = 0;
+    recorder.once = once;
+    recorder.mask = mask & TRACE_CLASS_ALL;
+    rt_hw_interrupt_enable(level);
+}
+
+void trace_stop(void)
+{
+    recorder.mask = 0;
+}
+
+/* =================================================================================
+ * 3. 导出
+ * ================================================================================= */
+
+static void trace_dump_names(enum rt_object_class_type type, const char *class_name)
+{
+    rt_object_t objs[TRACE_OBJ_MAX];
+    int i, n;
+
+    n = rt_object_get_pointers(type, objs, TRACE_OBJ_MAX);
+    for (i = 0; i < n; i++)
+    {
+        console_wait_space(TRACE_DUMP_LINE);
+        rt_kprintf("N %08x %s %.*s\n", (rt_uint32_t)(rt_ubase_t)objs[i], class_name, RT_NAME_MAX, objs[i]->name);
+    }
+}
+
+/*
+ * 文本格式 (tools/trace_json 的输入):
+ *   # trace <版本> <CPU 频率> <事件数> <被覆盖的事件数>
+ *   N <地址> <类别> <名字>
+ *   E <周期> <类型> <标志> <异常号> <对象> <线程>
+ *   # end <期间控制台丢弃的输出条数, 非 0 时导出不完整>
+ */
+static void trace_dump(void)
+{
+    struct trace_event *ev;
+    rt_uint32_t head = recorder.head, first, i;
+    rt_uint32_t dropped = console_dropped();
+
+    trace_stop();
+    first = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+
+    console_wait_space(TRACE_DUMP_LINE);
+    rt_kprintf("# trace 1 %u %u %u\n", SystemCoreClock, head - first, first);
+    trace_dump_names(RT_Object_Class_Thread, "thread");
+    trace_dump_names(RT_Object_Class_Semaphore, "sem");
+    trace_dump_names(RT_Object_Class_Mutex, "mutex");
+    trace_dump_names(RT_Object_Class_Event, "event");
+    trace_dump_names(RT_Object_Class_MailBox, "mailbox");
+    trace_dump_names(RT_Object_Class_MessageQueue, "mq");
+
+    for (i = first; i != head; i++)
+    {
+        ev = &recorder.buf[i & (TRACE_EVENTS - 1)];
+        console_wait_space(TRACE_DUMP_LINE);
+        rt_kprintf("E %08x %d %d %d %08x %08x\n", ev->stamp, ev->type, ev->flags, ev->irq,
+                   (rt_uint32_t)(rt_ubase_t)ev->obj, (rt_uint32_t)(rt_ubase_t)ev->thread);
+    }
+    console_wait_space(TRACE_DUMP_LINE);
+    rt_kprintf("# end %u\n", console_dropped() - dropped);
+}
+
+/* =================================================================================
+ * 4. 调试命令
+ * ================================================================================= */
+
+static int trace(int argc, char **argv)
+{
+    rt_uint32_t mask = 0;
+    rt_bool_t once = RT_FALSE;
+    int i;
+
+    if (argc < 2)
+    {
+        rt_kprintf("trace: %s, mask 0x%x, %d event(s) recorded, buffer %d\n",
+                   recorder.mask ? "running" : "stopped", recorder.mask, recorder.head, TRACE_EVENTS);
+        return 0;
+    }
+
+    if (rt_strcmp(argv[1], "start") == 0)
+    {
+        for (i = 2; i < argc; i++)
+        {
+            if (rt_strcmp(argv[i], "sched") == 0)     mask |= TRACE_CLASS_SCHED;
+            else if (rt_strcmp(argv[i], "irq") == 0)  mask |= TRACE_CLASS_IRQ;
+            else if (rt_strcmp(argv[i], "ipc") == 0)  mask |= TRACE_CLASS_IPC;
+            else if (rt_strcmp(argv[i], "once") == 0) once = RT_TRUE;
+            else goto usage;
+        }
+        trace_start(mask ? mask : TRACE_CLASS_ALL, once);
+    }
+    else if (rt_strcmp(argv[1], "stop") == 0)
+    {
+        trace_stop();
+    }
+    else if (rt_strcmp(argv[1], "dump") == 0)
+    {
+        trace_dump();
+    }
+    else
+    {
+        goto usage;
+    }
+    return 0;
+
+usage:
+    rt_kprintf("usage: trace [start [sched] [irq] [ipc] [once] | stop | dump]\n");
+    return -1;
+}
+MSH_CMD_EXPORT(trace, scheduler trace: trace [start [sched|irq|ipc|once] | stop | dump]);
+
+#else
+
+rt_err_t trace_init(void)
+{
+    return -RT_ENOSYS;
+}
+
+void trace_start(rt_uint32_t mask, rt_bool_t once)
+{
+}
+
+void trace_stop(void)
+{
+}
+
+#endif /* RT_USING_HOOK */
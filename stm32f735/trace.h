@@ -0,0 +1,56 @@
+/* trace.h - 调度跟踪: 线程切换、中断进出与 IPC 阻塞按周期时间戳记入 RAM 环形缓冲区 */
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <rtthread.h>
+
+#define TRACE_EVENTS            1024    /* 环形缓冲区事件数 (2 的幂), 每个 16 字节 */
+#define TRACE_OBJ_MAX           32      /* dump 时每类对象最多列出的名字数 */
+#define TRACE_DUMP_LINE         64      /* dump 单行上限 (含 CRLF), 每行输出前等待这么多控制台空间 */
+
+/* 事件分类, 用于 trace start 选择记录范围 */
+#define TRACE_CLASS_SCHED       0x01    /* 线程切换、挂起、就绪 */
+#define TRACE_CLASS_IRQ         0x02    /* 中断进出 */
+#define TRACE_CLASS_IPC         0x04    /* 信号量/互斥量/事件/邮箱/消息队列的 take 与 put */
+#define TRACE_CLASS_ALL         0x07
+
+enum trace_type
+{
+    TRACE_SWITCH = 1,                   /* obj = 切入线程, thread = 切出线程 */
+    TRACE_SUSPEND,                      /* obj = 被挂起的线程 */
+    TRACE_READY,                        /* obj = 被唤醒的线程 */
+    TRACE_IRQ_ENTER,                    /* irq = 异常号 (IPSR) */
+    TRACE_IRQ_LEAVE,
+    TRACE_TRYTAKE,                      /* obj = IPC 对象, 进入 take (可能阻塞) */
+    TRACE_TAKE,                         /* obj = IPC 对象, 已取得 */
+    TRACE_PUT,                          /* obj = IPC 对象, 释放/发送 */
+};
+
+#define TRACE_FLAG_ISR          0x01    /* 事件发生在中断上下文 */
+
+struct trace_event
+{
+    rt_uint32_t          stamp;         /* DWT 周期计数 */
+    rt_uint8_t           type;
+    rt_uint8_t           flags;
+    rt_uint16_t          irq;
+    void                *obj;
+    rt_thread_t          thread;        /* 当前线程 (中断上下文中为被打断的线程) */
+};
+
+/*
+ * 注册内核钩子, 需要 RT_USING_HOOK. 钩子常驻, 停止记录时只多一次判断.
+ * 中断只有调用 rt_interrupt_enter/leave 的处理函数才会被记录.
+ */
+rt_err_t trace_init(void);
+
+/*
+ * 开始记录 mask 中的事件. once 为真时缓冲区写满即停止 (记录开头),
+ * 否则循环覆盖 (保留最近的事件, 配合 trace_stop 作为触发点).
+ */
+void     trace_start(rt_uint32_t mask, rt_bool_t once);
+
+/* 停止记录, 可在中断中调用, 例如延迟超限时冻结缓冲区 */
+void     trace_stop(void);
+
+#endif
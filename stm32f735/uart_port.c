@@ -0,0 +1,674 @@
+/*
+ * uart_port.c - UART 端口驱动: DMA 循环接收 + DMA 发送队列, 可注册为 rt_device
+ *
+ * 全部 UART 由端口表描述 (引脚/DMA 流/中断优先级/缓冲区大小), 初始化、
+ * 中断入口和 HAL 回调都在本文件, 使用者只通过端口接口收发:
+ *
+ *   接收: DMA 以循环模式写入 rx_buf, HAL 在半满/全满/线路空闲时回调,
+ *         转发给使用者的接收回调 (桥接帧解析直接读缓冲区), 或由
+ *         uart_port_read() 非阻塞取数 (控制台/shell/rt_device).
+ *   发送: 以 UART_PORT_DMA_TX 打开时使用发送队列, 写者拷贝入队立即返回,
+ *         DMA 按队列中的连续段依次发送; 否则由 uart_port_send() 直接
+ *         从调用者的 DMA 缓冲区发送 (桥接回传帧零拷贝).
+ *   错误: ORE 等阻塞性错误终止 DMA 接收后立即重启, 通知使用者丢弃半帧;
+ *         TX DMA 出错按本次发送完成处理.
+ *
+ * 启用 RT_USING_DEVICE 时各端口注册为字符设备 ("uart1"/"uart3"/"uart7"),
+ * open/read/write 与上面的接口相同, 接收/发送事件同时转发给 rx_indicate/tx_complete.
+ */
+
+#include "uart_port.h"
+#include "board.h"
+#include "clock_profile.h"
+#include <rthw.h>
+#include <stddef.h>
+
+enum
+{
+    UART_PORT_USART1 = 0,
+    UART_PORT_USART3,
+    UART_PORT_UART7,
+};
+
+static void usart1_clk_enable(void) { __HAL_RCC_USART1_CLK_ENABLE(); __HAL_RCC_GPIOA_CLK_ENABLE(); __HAL_RCC_GPIOB_CLK_ENABLE(); }
+static void usart3_clk_enable(void) { __HAL_RCC_USART3_CLK_ENABLE(); __HAL_RCC_GPIOD_CLK_ENABLE(); }
+static void uart7_clk_enable(void)  { __HAL_RCC_UART7_CLK_ENABLE();  __HAL_RCC_GPIOF_CLK_ENABLE(); }
+
+static const struct uart_port_hw uart_port_hw[UART_PORT_MAX] =
+{
+    /* 解密端口 (D0/D1), 流控 PA11 CTS / PA12 RTS */
+    {
+        "uart1", USART1, USART1_IRQn, 921600, usart1_clk_enable,
+        GPIOB, GPIO_PIN_14 | GPIO_PIN_15, GPIO_NOPULL, GPIO_AF4_USART1,
+        UART_PORT_BRIDGE_FLOW, GPIOA, GPIO_PIN_11 | GPIO_PIN_12, GPIO_AF7_USART1, 1, DMA_PRIORITY_HIGH,
+        DMA1_Stream0, DMA1_Stream0_IRQn, DMA_REQUEST_USART1_RX, 256,
+        DMA1_Stream2, DMA1_Stream2_IRQn, DMA_REQUEST_USART1_TX, 0,
+    },
+    /* 调试控制台: 低于桥接端口, 不抢占数据通路; 接收缓冲区容纳整段粘贴的脚本 */
+    {
+        "uart3", USART3, USART3_IRQn, 115200, usart3_clk_enable,
+        GPIOD, GPIO_PIN_8 | GPIO_PIN_9, GPIO_NOPULL, GPIO_AF7_USART3,
+        UART_HWCONTROL_NONE, RT_NULL, 0, 0, 5, DMA_PRIORITY_LOW,
+        DMA1_Stream5, DMA1_Stream5_IRQn, DMA_REQUEST_USART3_RX, 1024,
+        DMA1_Stream4, DMA1_Stream4_IRQn, DMA_REQUEST_USART3_TX, 2048,
+    },
+    /* 加密端口 (D10/D13), 流控 PF8 RTS / PF9 CTS */
+    {
+        "uart7", UART7, UART7_IRQn, 921600, uart7_clk_enable,
+        GPIOF, GPIO_PIN_6 | GPIO_PIN_7, GPIO_PULLUP, GPIO_AF7_UART7,
+        UART_PORT_BRIDGE_FLOW, GPIOF, GPIO_PIN_8 | GPIO_PIN_9, GPIO_AF7_UART7, 1, DMA_PRIORITY_HIGH,
+        DMA1_Stream1, DMA1_Stream1_IRQn, DMA_REQUEST_UART7_RX, 256,
+        DMA1_Stream3, DMA1_Stream3_IRQn, DMA_REQUEST_UART7_TX, 0,
+    },
+};
+
+static struct uart_port uart_ports[UART_PORT_MAX];
+
+static struct uart_port *uart_port_of(UART_HandleTypeDef *huart)
+{
+    return (struct uart_port *)((rt_uint8_t *)huart - offsetof(struct uart_port, huart));
+}
+
+/* =================================================================================
+ * 1. 硬件初始化
+ * ================================================================================= */
+
+static rt_err_t uart_port_dma_init(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream, rt_uint32_t request,
+                                   rt_uint32_t direction, rt_uint32_t priority)
+{
+    hdma->Instance                 = stream;
+    hdma->Init.Request             = request;
+    hdma->Init.Direction           = direction;
+    hdma->Init.PeriphInc           = DMA_PINC_DISABLE;
+    hdma->Init.MemInc              = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma->Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    /* 接收为循环缓冲区, 发送每段一次 */
+    hdma->Init.Mode                = (direction == DMA_PERIPH_TO_MEMORY) ? DMA_CIRCULAR : DMA_NORMAL;
+    hdma->Init.Priority            = priority;
+    hdma->Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+
+    return HAL_DMA_Init(hdma) == HAL_OK ? RT_EOK : -RT_ERROR;
+}
+
+static rt_err_t uart_port_hw_init(struct uart_port *port)
+{
+    const struct uart_port_hw *hw = port->hw;
+    UART_HandleTypeDef *huart = &port->huart;
+    GPIO_InitTypeDef gpio = {0};
+
+    hw->clk_enable();
+    gpio.Pin       = hw->pins;
+    gpio.Mode      = GPIO_MODE_AF_PP;
+    gpio.Pull      = hw->pull;
+    gpio.Alternate = hw->af;
+    HAL_GPIO_Init(hw->gpio, &gpio);
+
+    if (hw->flow != UART_HWCONTROL_NONE)
+    {
+        gpio.Pin       = hw->flow_pins;
+        gpio.Pull      = GPIO_NOPULL;
+        gpio.Alternate = hw->flow_af;
+        HAL_GPIO_Init(hw->flow_gpio, &gpio);
+    }
+
+    huart->Instance          = hw->instance;
+    huart->Init.BaudRate     = hw->baud;
+    huart->Init.WordLength   = UART_WORDLENGTH_8B;
+    huart->Init.StopBits     = UART_STOPBITS_1;
+    huart->Init.Parity       = UART_PARITY_NONE;
+    huart->Init.Mode         = UART_MODE_TX_RX;
+    huart->Init.HwFlowCtl    = hw->flow;
+    huart->Init.OverSampling = UART_OVERSAMPLING_16;
+    if (HAL_UART_Init(huart) != HAL_OK)
+        return -RT_ERROR;
+
+    /* 开启 16 字节硬件 FIFO: DMA/中断被延迟时由 FIFO 缓冲, 不再逐字节溢出 */
+    HAL_UARTEx_SetTxFifoThreshold(huart, UART_TXFIFO_THRESHOLD_1_8);
+    HAL_UARTEx_SetRxFifoThreshold(huart, UART_RXFIFO_THRESHOLD_1_2);
+    HAL_UARTEx_EnableFifoMode(huart);
+
+    if (uart_port_dma_init(&port->hdma_rx, hw->rx_stream, hw->rx_request, DMA_PERIPH_TO_MEMORY, hw->dma_prio) != RT_EOK ||
+        uart_port_dma_init(&port->hdma_tx, hw->tx_stream, hw->tx_request, DMA_MEMORY_TO_PERIPH, hw->dma_prio) != RT_EOK)
+        return -RT_ERROR;
+    __HAL_LINKDMA(huart, hdmarx, port->hdma_rx);
+    __HAL_LINKDMA(huart, hdmatx, port->hdma_tx);
+
+    HAL_NVIC_SetPriority(hw->rx_irqn, hw->irq_prio, 0); HAL_NVIC_EnableIRQ(hw->rx_irqn);
+    HAL_NVIC_SetPriority(hw->tx_irqn, hw->irq_prio, 0); HAL_NVIC_EnableIRQ(hw->tx_irqn);
+    HAL_NVIC_SetPriority(hw->irqn, hw->irq_prio, 0);    HAL_NVIC_EnableIRQ(hw->irqn);
+
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 2. 接收
+ * ================================================================================= */
+
+static rt_err_t uart_port_rx_start(struct uart_port *port)
+{
+    port->rx_pos  = 0;
+    port->rx_read = 0;
+
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&port->huart, port->rx_buf, port->hw->rx_size) != HAL_OK)
+        return -RT_ERROR;
+
+    /* 错误重启会重新打开 DMA 请求, 暂停中须保持暂停 */
+    if (port->rx_throttled)
+        CLEAR_BIT(port->huart.Instance->CR3, USART_CR3_DMAR);
+
+    return RT_EOK;
+}
+
+rt_err_t uart_port_rx_throttle(struct uart_port *port, rt_bool_t on)
+{
+    rt_base_t level;
+
+    if (port->hw->flow == UART_HWCONTROL_NONE || port->hw->flow == UART_HWCONTROL_CTS)
+        return -RT_ENOSYS;
+
+    level = rt_hw_interrupt_disable();
+    if (on && !port->rx_throttled)
+    {
+        port->rx_throttled = 1;
+        port->rx_throttles++;
+        CLEAR_BIT(port->huart.Instance->CR3, USART_CR3_DMAR);
+    }
+    else if (!on && port->rx_throttled)
+    {
+        port->rx_throttled = 0;
+        if (port->flag & UART_PORT_DMA_RX)
+            SET_BIT(port->huart.Instance->CR3, USART_CR3_DMAR);
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+rt_size_t uart_port_read(struct uart_port *port, void *buffer, rt_size_t size)
+{
+    rt_uint8_t *data = (rt_uint8_t *)buffer;
+    rt_uint16_t rx_size = port->hw->rx_size;
+    rt_uint16_t pos, read;
+    rt_size_t n = 0;
+    rt_base_t level;
+
+    if (!(port->flag & UART_PORT_DMA_RX))
+        return 0;
+
+    /* 与错误重启互斥; 写位置确定后再失效缓存, 避免预取到 DMA 写入前的旧数据 */
+    level = rt_hw_interrupt_disable();
+    pos  = port->rx_pos;
+    read = port->rx_read;
+    if (pos != read)
+    {
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, port->rx_buf, rx_size);
+        while (n < size && read != pos)
+        {
+            data[n++] = port->rx_buf[read];
+            if (++read == rx_size)
+                read = 0;
+        }
+        port->rx_read = read;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+/*
+ * DMA 半满/全满/线路空闲. 写位置取自 NDTR 而不是 Size: 线路空闲中断可能在 DMA
+ * 回绕之后、全满中断之前处理, 随后的全满事件 Size 已过时, 按它会把整圈旧数据
+ * 当成新数据 (直接模式, NDTR 与已写入内存的字节一致)
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    struct uart_port *port = uart_port_of(huart);
+    rt_uint16_t pos = port->hw->rx_size - __HAL_DMA_GET_COUNTER(huart->hdmarx);
+
+    port->rx_events++;
+    port->rx_pos = pos;
+
+    if (port->rx_event != RT_NULL)
+        port->rx_event(port->rx_param, pos);
+#ifdef RT_USING_DEVICE
+    if (port->parent.rx_indicate != RT_NULL)
+        port->parent.rx_indicate(&port->parent, (port->rx_pos - port->rx_read + port->hw->rx_size) % port->hw->rx_size);
+#endif
+}
+
+/* =================================================================================
+ * 3. 发送
+ * ================================================================================= */
+
+rt_size_t uart_port_tx_space(struct uart_port *port)
+{
+    /* 无队列或同步模式下 put 直接轮询发送, 不受空间限制 */
+    if (port->sync || port->tx_buf == RT_NULL)
+        return (rt_size_t)-1;
+
+    return port->hw->tx_size - (port->tx_head - port->tx_tail);
+}
+
+rt_size_t uart_port_tx_put(struct uart_port *port, const void *buffer, rt_size_t size)
+{
+    const rt_uint8_t *data = (const rt_uint8_t *)buffer;
+    rt_uint32_t mask = port->hw->tx_size - 1;
+    rt_size_t space = uart_port_tx_space(port), i;
+    rt_uint32_t used;
+
+    if (port->sync || port->tx_buf == RT_NULL)
+    {
+        for (i = 0; i < size; i++)
+            uart_port_putc(port, data[i]);
+        return size;
+    }
+
+    if (size > space)
+        size = space;
+    for (i = 0; i < size; i++)
+        port->tx_buf[port->tx_head++ & mask] = data[i];
+
+    used = port->tx_head - port->tx_tail;
+    if (used > port->tx_max_used)
+        port->tx_max_used = used;
+
+    return size;
+}
+
+/* 启动下一段连续数据的发送, 调用时已关中断 */
+void uart_port_tx_kick(struct uart_port *port)
+{
+    rt_uint32_t tx_size = port->hw->tx_size;
+    rt_uint32_t start, len;
+
+    if (port->tx_len != 0 || port->tx_head == port->tx_tail || port->sync)
+        return;
+
+    start = port->tx_tail & (tx_size - 1);
+    len = port->tx_head - port->tx_tail;
+    if (len > tx_size - start)
+        len = tx_size - start;
+
+    /* 缓冲区在可缓存的 AXI SRAM 中, 启动 DMA 前回写 */
+    rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, port->tx_buf + start, len);
+    if (HAL_UART_Transmit_DMA(&port->huart, port->tx_buf + start, len) == HAL_OK)
+        port->tx_len = len;
+}
+
+rt_size_t uart_port_write(struct uart_port *port, const void *buffer, rt_size_t size)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    size = uart_port_tx_put(port, buffer, size);
+    uart_port_tx_kick(port);
+    rt_hw_interrupt_enable(level);
+
+    return size;
+}
+
+rt_err_t uart_port_send(struct uart_port *port, const void *buffer, rt_size_t size)
+{
+    rt_err_t result = -RT_EBUSY;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (port->tx_len == 0 && port->tx_buf == RT_NULL && !port->sync)
+    {
+        if (HAL_UART_Transmit_DMA(&port->huart, (const uint8_t *)buffer, size) == HAL_OK)
+        {
+            port->tx_len = size;
+            result = RT_EOK;
+        }
+        else
+        {
+            result = -RT_ERROR;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+static void uart_port_tx_complete(struct uart_port *port)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (port->tx_len == 0)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+    port->tx_bytes += port->tx_len;
+    if (port->tx_buf != RT_NULL)
+        port->tx_tail += port->tx_len;
+    port->tx_len = 0;
+    if (port->tx_buf != RT_NULL)
+        uart_port_tx_kick(port);
+    rt_hw_interrupt_enable(level);
+
+    if (port->tx_done != RT_NULL)
+        port->tx_done(port->tx_param);
+#ifdef RT_USING_DEVICE
+    if (port->parent.tx_complete != RT_NULL)
+        port->parent.tx_complete(&port->parent, RT_NULL);
+#endif
+}
+
+/* TX DMA 完成 */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    uart_port_tx_complete(uart_port_of(huart));
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    struct uart_port *port = uart_port_of(huart);
+
+    /* ORE 等阻塞性错误会终止 DMA 接收, 重新启动后通知使用者丢弃未完成的数据 */
+    if ((port->flag & UART_PORT_DMA_RX) && huart->RxState == HAL_UART_STATE_READY)
+    {
+        port->rx_restarts++;
+        if (huart->ErrorCode & HAL_UART_ERROR_ORE)
+            port->overruns++;
+        if (huart->ErrorCode & (HAL_UART_ERROR_FE | HAL_UART_ERROR_NE | HAL_UART_ERROR_PE))
+            port->line_errors++;
+        HAL_UART_AbortReceive(huart);
+        uart_port_rx_start(port);
+        if (port->rx_reset != RT_NULL)
+            port->rx_reset(port->rx_param);
+    }
+
+    /* TX DMA 出错后 HAL 已结束发送 (gState 回到 READY), 按完成处理 */
+    if (port->tx_len != 0 && huart->gState == HAL_UART_STATE_READY)
+    {
+        port->tx_errors++;
+        uart_port_tx_complete(port);
+    }
+}
+
+/* =================================================================================
+ * 4. 同步模式
+ * ================================================================================= */
+
+void uart_port_putc(struct uart_port *port, char c)
+{
+    while (!__HAL_UART_GET_FLAG(&port->huart, UART_FLAG_TXE));
+    port->huart.Instance->TDR = c;
+}
+
+void uart_port_sync(struct uart_port *port)
+{
+    rt_uint32_t mask = port->hw->tx_size - 1;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (!port->sync)
+    {
+        port->sync = 1;
+
+        /* 已由 DMA 送出的部分按剩余计数扣除, 队列中的其余内容同步补发 */
+        if (port->tx_len != 0)
+        {
+            if (port->tx_buf != RT_NULL)
+                port->tx_tail += port->tx_len - __HAL_DMA_GET_COUNTER(&port->hdma_tx);
+            HAL_UART_AbortTransmit(&port->huart);
+            port->tx_len = 0;
+        }
+        if (port->tx_buf != RT_NULL)
+        {
+            while (port->tx_tail != port->tx_head)
+                uart_port_putc(port, port->tx_buf[port->tx_tail++ & mask]);
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+/* =================================================================================
+ * 5. 时钟切换
+ * ================================================================================= */
+
+void uart_port_suspend(void)
+{
+    int i;
+
+    for (i = 0; i < UART_PORT_MAX; i++)
+    {
+        if (uart_ports[i].hw != RT_NULL)
+            __HAL_UART_DISABLE(&uart_ports[i].huart);
+    }
+}
+
+void uart_port_reclock(void)
+{
+    UART_HandleTypeDef *huart;
+    int i;
+
+    for (i = 0; i < UART_PORT_MAX; i++)
+    {
+        if (uart_ports[i].hw == RT_NULL)
+            continue;
+
+        /* BRR 只能在 UE=0 时写入 */
+        huart = &uart_ports[i].huart;
+        __HAL_UART_DISABLE(huart);
+        huart->Instance->BRR = UART_DIV_SAMPLING16(clock_profile_usart_hz(huart->Instance),
+                                                   huart->Init.BaudRate, huart->Init.ClockPrescaler);
+        __HAL_UART_ENABLE(huart);
+    }
+}
+
+/* =================================================================================
+ * 6. 打开与关闭
+ * ================================================================================= */
+
+void uart_port_set_rx_callback(struct uart_port *port, void (*event)(void *param, rt_uint16_t pos),
+                               void (*reset)(void *param), void *param)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    port->rx_event = event;
+    port->rx_reset = reset;
+    port->rx_param = param;
+    rt_hw_interrupt_enable(level);
+}
+
+void uart_port_set_tx_callback(struct uart_port *port, void (*done)(void *param), void *param)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    port->tx_done  = done;
+    port->tx_param = param;
+    rt_hw_interrupt_enable(level);
+}
+
+rt_err_t uart_port_open(struct uart_port *port, rt_uint16_t oflag)
+{
+    const struct uart_port_hw *hw = port->hw;
+
+    if ((oflag & UART_PORT_DMA_TX) && !(port->flag & UART_PORT_DMA_TX))
+    {
+        /* 直接发送进行中时不能切换为队列 */
+        if (hw->tx_size == 0 || port->tx_len != 0)
+            return -RT_EINVAL;
+        if (port->tx_buf == RT_NULL)
+            port->tx_buf = (rt_uint8_t *)board_dma_alloc(hw->tx_size);
+        if (port->tx_buf == RT_NULL)
+            return -RT_ENOMEM;
+        port->flag |= UART_PORT_DMA_TX;
+    }
+
+    if ((oflag & UART_PORT_DMA_RX) && !(port->flag & UART_PORT_DMA_RX))
+    {
+        if (port->rx_buf == RT_NULL)
+            port->rx_buf = (rt_uint8_t *)board_dma_alloc(hw->rx_size);
+        if (port->rx_buf == RT_NULL)
+            return -RT_ENOMEM;
+        port->flag |= UART_PORT_DMA_RX;
+        if (uart_port_rx_start(port) != RT_EOK)
+        {
+            port->flag &= ~UART_PORT_DMA_RX;
+            return -RT_ERROR;
+        }
+    }
+
+    return RT_EOK;
+}
+
+rt_err_t uart_port_close(struct uart_port *port)
+{
+    rt_base_t level;
+
+    /* 缓冲区来自不回收的 DMA 池, 留给下次打开 */
+    level = rt_hw_interrupt_disable();
+    if (port->flag & UART_PORT_DMA_RX)
+    {
+        port->flag &= ~UART_PORT_DMA_RX;
+        HAL_UART_AbortReceive(&port->huart);
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+/* =================================================================================
+ * 7. rt_device 接口
+ * ================================================================================= */
+
+#ifdef RT_USING_DEVICE
+static rt_err_t uart_dev_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    return uart_port_open((struct uart_port *)dev, oflag);
+}
+
+static rt_err_t uart_dev_close(rt_device_t dev)
+{
+    return uart_port_close((struct uart_port *)dev);
+}
+
+static rt_size_t uart_dev_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    return uart_port_read((struct uart_port *)dev, buffer, size);
+}
+
+static rt_size_t uart_dev_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    return uart_port_write((struct uart_port *)dev, buffer, size);
+}
+
+#ifdef RT_USING_DEVICE_OPS
+static const struct rt_device_ops uart_dev_ops =
+{
+    RT_NULL,
+    uart_dev_open,
+    uart_dev_close,
+    uart_dev_read,
+    uart_dev_write,
+    RT_NULL,
+};
+#endif
+
+static rt_err_t uart_port_register(struct uart_port *port)
+{
+    struct rt_device *dev = &port->parent;
+
+    dev->type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    dev->ops = &uart_dev_ops;
+#else
+    dev->init    = RT_NULL;
+    dev->open    = uart_dev_open;
+    dev->close   = uart_dev_close;
+    dev->read    = uart_dev_read;
+    dev->write   = uart_dev_write;
+    dev->control = RT_NULL;
+#endif
+
+    return rt_device_register(dev, port->hw->name,
+                              RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_DMA_RX | RT_DEVICE_FLAG_DMA_TX);
+}
+#endif
+
+/* =================================================================================
+ * 8. 初始化
+ * ================================================================================= */
+
+rt_err_t uart_port_init(void)
+{
+    rt_err_t result = RT_EOK;
+    int i;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    for (i = 0; i < UART_PORT_MAX; i++)
+    {
+        struct uart_port *port = &uart_ports[i];
+
+        port->hw = &uart_port_hw[i];
+        if (uart_port_hw_init(port) != RT_EOK)
+        {
+            result = -RT_ERROR;
+            continue;
+        }
+#ifdef RT_USING_DEVICE
+        uart_port_register(port);
+#endif
+    }
+
+    return result;
+}
+
+struct uart_port *uart_port_find(const char *name)
+{
+    int i;
+
+    for (i = 0; i < UART_PORT_MAX; i++)
+    {
+        if (uart_ports[i].hw != RT_NULL && rt_strcmp(uart_ports[i].hw->name, name) == 0)
+            return &uart_ports[i];
+    }
+
+    return RT_NULL;
+}
+
+/* 经 rt_interrupt_enter/leave 维护中断嵌套计数, trace 由此记录中断进出 */
+void USART1_IRQHandler(void)       { rt_interrupt_enter(); HAL_UART_IRQHandler(&uart_ports[UART_PORT_USART1].huart); rt_interrupt_leave(); }
+void USART3_IRQHandler(void)       { rt_interrupt_enter(); HAL_UART_IRQHandler(&uart_ports[UART_PORT_USART3].huart); rt_interrupt_leave(); }
+void UART7_IRQHandler(void)        { rt_interrupt_enter(); HAL_UART_IRQHandler(&uart_ports[UART_PORT_UART7].huart); rt_interrupt_leave(); }
+void DMA1_Stream0_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_USART1].hdma_rx); rt_interrupt_leave(); }
+void DMA1_Stream1_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_UART7].hdma_rx); rt_interrupt_leave(); }
+void DMA1_Stream2_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_USART1].hdma_tx); rt_interrupt_leave(); }
+void DMA1_Stream3_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_UART7].hdma_tx); rt_interrupt_leave(); }
+void DMA1_Stream4_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_USART3].hdma_tx); rt_interrupt_leave(); }
+void DMA1_Stream5_IRQHandler(void) { rt_interrupt_enter(); HAL_DMA_IRQHandler(&uart_ports[UART_PORT_USART3].hdma_rx); rt_interrupt_leave(); }
+
+/* =================================================================================
+ * 9. 调试命令
+ * ================================================================================= */
+
+static int uart_port(int argc, char **argv)
+{
+    int i;
+
+    rt_kprintf("port     baud     mode  rx_event restart  overrun  line_err throttle tx_bytes   tx_err   tx_max\n");
+    rt_kprintf("-------- -------- ----- -------- -------- -------- -------- -------- ---------- -------- --------\n");
+    for (i = 0; i < UART_PORT_MAX; i++)
+    {
+        struct uart_port *port = &uart_ports[i];
+
+        if (port->hw == RT_NULL) continue;
+
+        rt_kprintf("%-8s %8d %c%c%c%c  %8d %8d %8d %8d %8d %10d %8d %8d\n", port->hw->name, port->huart.Init.BaudRate,
+                   (port->flag & UART_PORT_DMA_RX) ? 'R' : '-', (port->flag & UART_PORT_DMA_TX) ? 'Q' : 'D',
+                   port->sync ? 'S' : '-', (port->hw->flow != UART_HWCONTROL_NONE) ? 'F' : '-',
+                   port->rx_events, port->rx_restarts, port->overruns, port->line_errors, port->rx_throttles,
+                   port->tx_bytes, port->tx_errors, port->tx_max_used);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(uart_port, show UART port mode and error counters);
@@ -0,0 +1,148 @@
+/* uart_port.h - UART 端口驱动: DMA 循环接收 + DMA 发送队列, 可注册为 rt_device */
+#ifndef __UART_PORT_H__
+#define __UART_PORT_H__
+
+#include <rtthread.h>
+#include "stm32h7xx_hal.h"
+
+#define UART_PORT_MAX           3       /* USART1 / USART3 / UART7 */
+
+/* 打开方式: 取值与 RT_DEVICE_FLAG_DMA_RX/TX 相同, 未启用 RT_USING_DEVICE 时也可用 */
+#define UART_PORT_DMA_RX        0x200   /* DMA 循环接收, 读者用 uart_port_read 或接收回调取数 */
+#define UART_PORT_DMA_TX        0x800   /* 发送队列, uart_port_write 拷贝入队立即返回 */
+
+/* 桥接端口 (uart1/uart7) 的硬件流控, 主机与线缆须连接 RTS/CTS; 默认关闭 */
+#ifndef UART_PORT_BRIDGE_FLOW
+#define UART_PORT_BRIDGE_FLOW   UART_HWCONTROL_NONE
+#endif
+
+/* 静态硬件描述, 见 uart_port.c 中的端口表 */
+struct uart_port_hw
+{
+    const char          *name;
+    USART_TypeDef       *instance;
+    IRQn_Type            irqn;
+    rt_uint32_t          baud;
+    void               (*clk_enable)(void);        /* UART 与 GPIO 时钟 */
+    GPIO_TypeDef        *gpio;
+    rt_uint32_t          pins;
+    rt_uint32_t          pull;
+    rt_uint8_t           af;
+    rt_uint32_t          flow;                      /* UART_HWCONTROL_xxx */
+    GPIO_TypeDef        *flow_gpio;                 /* RTS/CTS 引脚, 与 TX/RX 引脚复用号可能不同 */
+    rt_uint32_t          flow_pins;
+    rt_uint8_t           flow_af;
+    rt_uint8_t           irq_prio;                  /* UART 与两路 DMA 中断共用 */
+    rt_uint32_t          dma_prio;
+
+    DMA_Stream_TypeDef  *rx_stream;
+    IRQn_Type            rx_irqn;
+    rt_uint32_t          rx_request;
+    rt_uint16_t          rx_size;                   /* 接收环形缓冲区 (字节, 32 的倍数) */
+
+    DMA_Stream_TypeDef  *tx_stream;
+    IRQn_Type            tx_irqn;
+    rt_uint32_t          tx_request;
+    rt_uint16_t          tx_size;                   /* 发送队列 (字节, 2 的幂); 0 表示只能直接发送 */
+};
+
+struct uart_port
+{
+#ifdef RT_USING_DEVICE
+    struct rt_device     parent;
+#endif
+    const struct uart_port_hw *hw;
+    UART_HandleTypeDef   huart;
+    DMA_HandleTypeDef    hdma_rx;
+    DMA_HandleTypeDef    hdma_tx;
+    rt_uint16_t          flag;                      /* 已打开的方式 */
+    volatile rt_uint8_t  sync;                      /* 同步模式: 发送绕过 DMA 轮询 TDR */
+    volatile rt_uint8_t  rx_throttled;              /* 接收 DMA 已暂停, 由 RTS 反压对端 */
+
+    /* 接收: DMA 循环写入, 中断记录写位置 */
+    rt_uint8_t          *rx_buf;
+    volatile rt_uint16_t rx_pos;                    /* 最近一次事件时的 DMA 写位置 */
+    rt_uint16_t          rx_read;                   /* uart_port_read 的读位置 */
+
+    /* 发送队列: 写者关中断推进 head, TX 完成中断推进 tail */
+    rt_uint8_t          *tx_buf;
+    volatile rt_uint32_t tx_head;
+    volatile rt_uint32_t tx_tail;
+    rt_uint32_t          tx_len;                    /* 正在发送的字节数, 0 表示 DMA 空闲 */
+
+    /* 中断上下文回调 */
+    void               (*rx_event)(void *param, rt_uint16_t pos);
+    void               (*rx_reset)(void *param);
+    void                *rx_param;
+    void               (*tx_done)(void *param);
+    void                *tx_param;
+
+    /* 统计 */
+    rt_uint32_t          rx_events;                 /* HT/TC/IDLE 事件次数 */
+    rt_uint32_t          rx_restarts;               /* 接收错误后重启次数 */
+    rt_uint32_t          overruns;                  /* 其中 ORE (接收 FIFO 溢出) */
+    rt_uint32_t          line_errors;               /* 其中帧/噪声/校验错误 */
+    rt_uint32_t          rx_throttles;              /* 接收暂停次数 */
+    rt_uint32_t          tx_bytes;
+    rt_uint32_t          tx_errors;                 /* TX DMA 错误 */
+    rt_uint32_t          tx_max_used;
+};
+
+/* 初始化全部端口的 GPIO/UART/DMA/NVIC, 启用 RT_USING_DEVICE 时同时注册设备 */
+rt_err_t  uart_port_init(void);
+struct uart_port *uart_port_find(const char *name);
+
+/* 按需分配缓冲区 (只分配一次), 指定 UART_PORT_DMA_RX 时启动接收 */
+rt_err_t  uart_port_open(struct uart_port *port, rt_uint16_t oflag);
+rt_err_t  uart_port_close(struct uart_port *port);
+
+/*
+ * 中断上下文回调:
+ *   event: pos 为 DMA 在接收缓冲区中的写位置 (HAL_UARTEx_RxEventCallback 的 Size)
+ *   reset: ORE 等错误终止了接收, 已从缓冲区起点重新启动, 未完成的数据应丢弃
+ *   done:  一次 DMA 发送完成 (含出错提前结束)
+ */
+void      uart_port_set_rx_callback(struct uart_port *port, void (*event)(void *param, rt_uint16_t pos),
+                                    void (*reset)(void *param), void *param);
+void      uart_port_set_tx_callback(struct uart_port *port, void (*done)(void *param), void *param);
+
+/* 接收: 非阻塞, 返回读到的字节数; 读者慢于一圈缓冲区时旧数据被覆盖 */
+rt_size_t uart_port_read(struct uart_port *port, void *buffer, rt_size_t size);
+
+/*
+ * 接收反压 (中断/线程上下文): 暂停时停止 RX DMA 请求, 字节留在 16 字节硬件
+ * FIFO 中, FIFO 满后 RTS 失效, 对端停止发送; 恢复后 DMA 从 FIFO 继续搬运.
+ * 端口未启用硬件流控时返回 -RT_ENOSYS (暂停只会造成溢出).
+ */
+rt_err_t  uart_port_rx_throttle(struct uart_port *port, rt_bool_t on);
+
+/* 发送队列: 非阻塞, 返回入队的字节数; 未以 UART_PORT_DMA_TX 打开或同步模式下轮询发送 */
+rt_size_t uart_port_write(struct uart_port *port, const void *buffer, rt_size_t size);
+rt_size_t uart_port_tx_space(struct uart_port *port);
+
+/* 已关中断的调用者分段入队: put 只拷贝, 全部放入后 kick 一次启动 DMA */
+rt_size_t uart_port_tx_put(struct uart_port *port, const void *buffer, rt_size_t size);
+void      uart_port_tx_kick(struct uart_port *port);
+
+/*
+ * 直接发送: DMA 从调用者缓冲区发出, 不经过发送队列. 缓冲区须可被 DMA
+ * 访问且已回写; 完成前不可改动. 上一次未完成时返回 -RT_EBUSY.
+ */
+rt_err_t  uart_port_send(struct uart_port *port, const void *buffer, rt_size_t size);
+
+/*
+ * 切换时钟档位时调用 (已关中断): suspend 关闭全部端口 (UE=0), 时钟稳定后
+ * reclock 按新的内核时钟重算 BRR 再打开. DMA 配置和句柄状态保持不变,
+ * 切换瞬间移位寄存器和 FIFO 中的字节丢失.
+ */
+void      uart_port_suspend(void);
+void      uart_port_reclock(void);
+
+/*
+ * 进入同步模式: 中止 TX DMA, 轮询发出队列中的剩余内容, 之后的发送都
+ * 直接写 TDR. 用于断言失败和硬件异常, 不再恢复.
+ */
+void      uart_port_sync(struct uart_port *port);
+void      uart_port_putc(struct uart_port *port, char c);
+
+#endif